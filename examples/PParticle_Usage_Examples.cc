@@ -8,8 +8,8 @@
  * 3. Migration patterns
  */
 
-#include "../src/PParticle.h"
-#include "../src/BoostFrame.h"
+#include "../src/pparticle.h"
+#include "../src/boost_frame.h"
 #include "TLorentzVector.h"
 #include <iostream>
 
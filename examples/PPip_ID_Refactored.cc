@@ -6,8 +6,8 @@
  * and the refactored version using PParticle and BoostFrame.
  */
 
-#include "../src/PParticle.h"
-#include "../src/BoostFrame.h"
+#include "../src/pparticle.h"
+#include "../src/boost_frame.h"
 
 using namespace Physics;
 
@@ -0,0 +1,612 @@
+/**
+ * @file bench_fat.cc
+ * @brief Micro- and macro-benchmarks of the FAT hot paths
+ *
+ * Measures events/s and heap allocations per event for:
+ * 1. NTupleReader: operator[] by name vs pre-bound slots, block mode from
+ *    ROOT vs from the column cache
+ * 2. PParticle: creation, add/subtract, boosts (and the ParticleBlock batch path)
+ * 3. Histogram filling: Manager::fill by name vs typed handles (direct and
+ *    buffered through TH1::FillN), and a fine 1000x1000 2D histogram with
+ *    dense vs sparse storage
+ * 4. DynamicHNtuple: fill() + finalize() on synthetic events, with ROOT's
+ *    default, lz4 and zstd output compression
+ * 5. The full processEvent() pipeline of main.cc on a generated PPip_ID tree,
+ *    as a single analysis and as a three-wagon train over one input pass
+ * 6. Graphical cuts: TCutG::IsInside vs the rasterized CutManager path
+ * 7. Multi-candidate combinatorics: per-event std::vector vs CandidateArena
+ *
+ * The pipeline benchmark compiles main.cc into this program (its main() is
+ * renamed), so it measures exactly the analysis code that ./ana runs.
+ *
+ * Usage:
+ *   make bench                                   # from examples/ or top level
+ *   ./bench_fat [--events N] [--ntuple-events M] [--ntuple-mode convert|memory|tree]
+ *
+ * Allocations are counted by replacing the global operator new, so ROOT's
+ * own allocations in the measured code are included.
+ */
+
+#define main fat_analysis_main
+#include "../main.cc"
+#undef main
+
+#include "../src/particle_block.h"
+#include "../src/candidate_arena.h"
+#include <TFile.h>
+#include <TNtuple.h>
+#include <TRandom3.h>
+#include <TGenPhaseSpace.h>
+#include <TCutG.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <new>
+
+// ============================================================================
+// Allocation counting
+// ============================================================================
+
+namespace BenchAlloc {
+    std::atomic<long long> g_allocations{0};
+}
+
+void* operator new(size_t size) {
+    ++BenchAlloc::g_allocations;
+    void* ptr = std::malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+// ============================================================================
+// Measurement harness
+// ============================================================================
+
+struct BenchResult {
+    std::string name;
+    Long64_t events;
+    double seconds;
+    long long allocations;
+};
+
+template <typename Body>
+BenchResult measure(const std::string& name, Long64_t events, Body body) {
+    long long allocs_before = BenchAlloc::g_allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto end = std::chrono::steady_clock::now();
+    return {name, events, std::chrono::duration<double>(end - start).count(),
+            BenchAlloc::g_allocations.load() - allocs_before};
+}
+
+void printResults(const std::vector<BenchResult>& results) {
+    std::cout << "\n";
+    std::cout << "╔════════════════════════════════════════════════════════════════╗\n";
+    std::cout << "║                      BENCHMARK RESULTS                         ║\n";
+    std::cout << "╠════════════════════════════════════════════════════════════════╣\n";
+    std::cout << "║ " << std::left << std::setw(25) << "Benchmark"
+              << " │ " << std::right << std::setw(9) << "Events"
+              << " │ " << std::setw(11) << "Events/s"
+              << " │ " << std::setw(8) << "Alloc/ev" << " ║\n";
+    std::cout << "╠───────────────────────────┼───────────┼─────────────┼──────────╣\n";
+    for (const auto& r : results) {
+        double rate = r.seconds > 0 ? r.events / r.seconds : 0.0;
+        double allocs = r.events > 0 ? static_cast<double>(r.allocations) / r.events : 0.0;
+        std::cout << "║ " << std::left << std::setw(25) << r.name.substr(0, 25)
+                  << " │ " << std::right << std::setw(9) << r.events
+                  << " │ " << std::setw(11) << std::fixed << std::setprecision(0) << rate
+                  << " │ " << std::setw(8) << std::setprecision(2) << allocs << " ║\n";
+    }
+    std::cout << "╚════════════════════════════════════════════════════════════════╝\n";
+}
+
+// ============================================================================
+// Synthetic input: pp -> n p pi+ phase space in PPip_ID layout
+// ============================================================================
+
+/**
+ * @brief Write a PPip_ID TNtuple with n phase-space events
+ *
+ * Reconstructed momenta are smeared by 0.5% and biased by -0.3% (energy
+ * loss); the *_corr_* variables undo the bias. Angles are in degrees.
+ */
+void generatePPipTree(const std::string& filename, Long64_t n, double T_kin) {
+    TFile file(filename.c_str(), "RECREATE");
+    TNtuple tuple("PPip_ID", "Synthetic pp -> n p pi+",
+                  "p_p:p_theta:p_phi:p_p_corr_p:pip_p:pip_theta:pip_phi:pip_p_corr_pip:"
+                  "weight:eVertX:eVertY:eVertZ");
+
+    PParticle beam = ParticleFactory::createBeamProton(T_kin) + ParticleFactory::createTargetProton();
+    TLorentzVector initial = beam.vec();
+    double masses[3] = {MASS_PROTON, MASS_PION_PLUS, MASS_NEUTRON};
+    TGenPhaseSpace generator;
+    generator.SetDecay(initial, 3, masses);
+
+    TRandom3 rng(12345);
+    Float_t row[12];
+    for (Long64_t i = 0; i < n; ++i) {
+        double weight = generator.Generate();
+        const TLorentzVector* p = generator.GetDecay(0);
+        const TLorentzVector* pip = generator.GetDecay(1);
+
+        double p_true = p->P();
+        double pip_true = pip->P();
+        double p_phi = p->Phi() * R2D;
+        double pip_phi = pip->Phi() * R2D;
+
+        row[0] = p_true * rng.Gaus(0.997, 0.005);
+        row[1] = p->Theta() * R2D;
+        row[2] = p_phi < 0 ? p_phi + 360.0 : p_phi;
+        row[3] = row[0] / 0.997;
+        row[4] = pip_true * rng.Gaus(0.997, 0.005);
+        row[5] = pip->Theta() * R2D;
+        row[6] = pip_phi < 0 ? pip_phi + 360.0 : pip_phi;
+        row[7] = row[4] / 0.997;
+        row[8] = weight;
+        row[9] = rng.Gaus(0, 0.5);
+        row[10] = rng.Gaus(0, 0.5);
+        row[11] = rng.Uniform(-60, 0);
+        tuple.Fill(row);
+    }
+    tuple.Write();
+    file.Close();
+}
+
+// ============================================================================
+// 1. NTupleReader access
+// ============================================================================
+
+void benchReader(const std::string& input, Long64_t n, std::vector<BenchResult>& results) {
+    const char* names[6] = {"p_p", "p_theta", "p_phi", "pip_p", "pip_theta", "pip_phi"};
+    volatile double sink = 0;
+
+    {
+        NTupleReader reader;
+        reader.open(input, "PPip_ID");
+        for (Long64_t i = 0; i < n; ++i) reader.getEntry(i);   // warm page cache
+
+        results.push_back(measure("reader operator[]", n, [&]() {
+            for (Long64_t i = 0; i < n; ++i) {
+                reader.getEntry(i);
+                double sum = 0;
+                for (const char* name : names) sum += reader[name];
+                sink = sink + sum;
+            }
+        }));
+    }
+
+    {
+        NTupleReader reader;
+        reader.open(input, "PPip_ID");
+        const Float_t* slots[6];
+        for (int k = 0; k < 6; ++k) slots[k] = reader.slot(names[k]);
+
+        results.push_back(measure("reader pre-bound slots", n, [&]() {
+            for (Long64_t i = 0; i < n; ++i) {
+                reader.getEntry(i);
+                double sum = 0;
+                for (const Float_t* slot : slots) sum += *slot;
+                sink = sink + sum;
+            }
+        }));
+    }
+
+    // Block mode from ROOT baskets vs. from the mapped column cache
+    const std::string cache_dir = "bench_column_cache";
+    for (bool cached : {false, true}) {
+        NTupleReader reader;
+        reader.open(input, "PPip_ID");
+        const Float_t* slots[6];
+        for (int k = 0; k < 6; ++k) slots[k] = reader.slot(names[k]);
+        reader.setBlockMode(4096);
+        if (cached) reader.setColumnCache(cache_dir);   // builds it (not timed)
+
+        results.push_back(measure(cached ? "reader blocks, column cache" : "reader blocks, ROOT",
+                                  n, [&]() {
+            for (Long64_t i = 0; i < n; ++i) {
+                reader.getEntry(i);
+                double sum = 0;
+                for (const Float_t* slot : slots) sum += *slot;
+                sink = sink + sum;
+            }
+        }));
+    }
+    std::filesystem::remove_all(cache_dir);
+}
+
+// ============================================================================
+// 2. PParticle kinematics
+// ============================================================================
+
+void benchKinematics(Long64_t n, std::vector<BenchResult>& results) {
+    PParticle beam = ParticleFactory::createBeamProton(1580.0) + ParticleFactory::createTargetProton();
+    BoostFrame cms(beam);
+    volatile double sink = 0;
+
+    results.push_back(measure("PParticle add/subtract", n, [&]() {
+        for (Long64_t i = 0; i < n; ++i) {
+            PParticle proton = ParticleFactory::createProton(900.0 + (i & 255), 40.0, 30.0);
+            PParticle pion = ParticleFactory::createPiPlus(400.0, 25.0, 200.0);
+            PParticle neutron = beam - proton - pion;
+            PParticle ppip = proton + pion;
+            sink = sink + neutron.mass() + ppip.mass();
+        }
+    }));
+
+    PParticle proton = ParticleFactory::createProton(900.0, 40.0, 30.0);
+    results.push_back(measure("PParticle boost", n, [&]() {
+        for (Long64_t i = 0; i < n; ++i) {
+            PParticle boosted = cms.boost(proton);
+            sink = sink + boosted.cosTheta();
+        }
+    }));
+
+    const size_t block = 4096;
+    std::vector<float> p(block), theta(block), phi(block);
+    for (size_t i = 0; i < block; ++i) {
+        p[i] = 900.0f + (i & 255);
+        theta[i] = 40.0f;
+        phi[i] = 30.0f;
+    }
+    ParticleBlock protons;
+    std::vector<double> cos_theta(block);
+    Long64_t blocks = std::max<Long64_t>(n / block, 1);
+    results.push_back(measure("ParticleBlock boost", blocks * block, [&]() {
+        for (Long64_t b = 0; b < blocks; ++b) {
+            protons.setFromSpherical(p.data(), theta.data(), phi.data(), MASS_PROTON, block);
+            cms.applyTo(protons);
+            protons.cosTheta(cos_theta.data());
+            sink = sink + cos_theta[0];
+        }
+    }));
+}
+
+// ============================================================================
+// 3. Histogram filling
+// ============================================================================
+
+void benchFills(Long64_t n, std::vector<BenchResult>& results) {
+    Manager manager;
+    manager.openFile("bench_fills.root", "RECREATE");
+    H1Handle handle = manager.create1D("h_bench", "Bench", 100, 0.0, 1.0);
+
+    results.push_back(measure("Manager::fill by name", n, [&]() {
+        for (Long64_t i = 0; i < n; ++i) {
+            manager.fill("h_bench", (i & 1023) / 1024.0);
+        }
+    }));
+
+    results.push_back(measure("H1Handle::fill", n, [&]() {
+        for (Long64_t i = 0; i < n; ++i) {
+            handle.fill((i & 1023) / 1024.0);
+        }
+    }));
+
+    // Narrow band in a fine 2D grid: ~1% of the bins are ever filled
+    H2Handle dense = manager.create2D("h_bench_dense", "Bench", 1000, 0.0, 1.0, 1000, 0.0, 1.0);
+    H2Handle sparse = manager.create2D("h_bench_sparse", "Bench", 1000, 0.0, 1.0, 1000, 0.0, 1.0,
+                                       "", "", HistogramStorage::Sparse);
+    auto band = [](Long64_t i, double& x, double& y) {
+        x = (i % 9973) / 9973.0;
+        y = x + ((i % 7) - 3) * 1e-3;
+    };
+    results.push_back(measure("H2 dense fill", n, [&]() {
+        double x, y;
+        for (Long64_t i = 0; i < n; ++i) {
+            band(i, x, y);
+            dense.fill(x, y);
+        }
+    }));
+    results.push_back(measure("H2 sparse fill", n, [&]() {
+        double x, y;
+        for (Long64_t i = 0; i < n; ++i) {
+            band(i, x, y);
+            sparse.fill(x, y);
+        }
+    }));
+    std::cout << "  2D 1000x1000: dense "
+              << sparse.sparse()->denseBins() * sizeof(Float_t) / (1024 * 1024) << " MB, sparse "
+              << sparse.sparse()->memoryBytes() / 1024 << " kB ("
+              << sparse.sparse()->occupiedBins() << " bins filled)\n";
+
+    // Same fills through 1024-entry buffers ("output.fill_buffer": 1024)
+    OutputOptions buffered;
+    buffered.fill_buffer = 1024;
+    manager.setOutputOptions(buffered);
+    H1Handle handle_buffered = manager.handle1D("h_bench");
+    H2Handle dense_buffered = manager.handle2D("h_bench_dense");
+    results.push_back(measure("H1Handle::fill buffered", n, [&]() {
+        for (Long64_t i = 0; i < n; ++i) {
+            handle_buffered.fill((i & 1023) / 1024.0);
+        }
+        handle_buffered.flush();
+    }));
+    results.push_back(measure("H2 dense fill buffered", n, [&]() {
+        double x, y;
+        for (Long64_t i = 0; i < n; ++i) {
+            band(i, x, y);
+            dense_buffered.fill(x, y);
+        }
+        dense_buffered.flush();
+    }));
+
+    manager.closeFile();
+}
+
+// ============================================================================
+// 4. DynamicHNtuple fill + finalize
+// ============================================================================
+
+void benchNtuple(Long64_t n, const std::string& mode, const std::string& compression,
+                 std::vector<BenchResult>& results) {
+    OutputOptions options;
+    options.compression = OutputOptions::parseCompression(compression);
+    bool tuned = compression != "default";
+    std::string fill_label = tuned ? "NTuple fill [" + compression + "]" : "DynamicHNtuple fill";
+    std::string finalize_label = tuned ? "NTuple finalize [" + compression + "]"
+                                       : "DynamicHNtuple finalize";
+
+    Manager manager;
+    manager.setOutputOptions(options);
+    manager.openFile("bench_ntuple.root", "RECREATE");
+    DynamicHNtuple& nt = manager.createDynamicNtuple("bench", "Bench ntuple", -1.0f, false,
+                                                     DynamicHNtuple::parseMode(mode));
+    const std::vector<std::string> vars = {"a", "b", "c", "d", "e", "f", "g", "h", "i", "j"};
+    nt.declare(vars);
+    std::vector<DynamicHNtuple::Slot> slots;
+    for (const auto& var : vars) slots.push_back(nt.slot(var));
+
+    results.push_back(measure(fill_label, n, [&]() {
+        for (Long64_t i = 0; i < n; ++i) {
+            for (size_t k = 0; k < slots.size(); ++k) {
+                nt[slots[k]] = static_cast<Float_t>(i + k);
+            }
+            nt.fill();
+        }
+    }));
+
+    results.push_back(measure(finalize_label, n, [&]() {
+        manager.closeFile();
+    }));
+}
+
+// ============================================================================
+// 5. Full processEvent() pipeline
+// ============================================================================
+
+void benchPipeline(const std::string& input, Long64_t n, const std::string& mode,
+                   std::vector<BenchResult>& results) {
+    AnalysisConfig config;
+    config.loadFromString("{\"output\": {\"ntuple_mode\": \"" + mode + "\"}}");
+
+    PParticle projectile = ParticleFactory::createBeamProton(1580.0);
+    PParticle target = ParticleFactory::createTargetProton();
+    PParticle beam = projectile + target;
+    EventFrames frames;
+    frames.setBeamFrame(projectile, target);
+
+    Profiler profiler;  // disabled: measure the production path
+
+    // Single analysis, as ./ana without a "train" section
+    {
+        NTupleReader reader;
+        reader.open(input, "PPip_ID");
+        AnalysisConfig::WagonDef def;
+        def.name = "analysis";
+        def.output = "bench_pipeline.root";
+
+        Manager manager;
+        manager.openFile(def.output, "RECREATE");
+        Wagons wagons = setupWagons(reader, [&](size_t) -> Manager& { return manager; },
+                                    {def}, config, beam, projectile, frames);
+        const WagonState& wagon = static_cast<const WagonState&>(*wagons.front());
+
+        std::atomic<Long64_t> processed{0};
+        results.push_back(measure("processEvent pipeline", n, [&]() {
+            runEventRange(reader, wagons, profiler, 0, n, processed, nullptr);
+        }));
+        const EventCache& ev = wagon.kin->ev;
+        std::cout << "  EventCache: " << ev.size() << " quantities, "
+                  << ev.requests() << " requests, " << ev.computed() << " computed\n";
+
+        results.push_back(measure("pipeline closeFile", n, [&]() {
+            manager.closeFile();
+        }));
+        wagon.cuts.printCutFlow();
+    }
+
+    // Three wagons (nominal, raw momenta, no Delta++ cut) on one read pass
+    {
+        NTupleReader reader;
+        reader.open(input, "PPip_ID");
+        std::vector<AnalysisConfig::WagonDef> defs(3);
+        defs[0].name = "nominal";
+        defs[0].output = "bench_train_nominal.root";
+        defs[1].name = "raw";
+        defs[1].output = "bench_train_raw.root";
+        defs[1].use_corrected = false;
+        defs[2].name = "loose";
+        defs[2].output = "bench_train_loose.root";
+        defs[2].disabled_cuts.push_back("deltaPP_mass");
+
+        // nominal and loose share one kinematics cache
+        std::vector<std::unique_ptr<Manager>> managers;
+        Wagons wagons = setupWagons(reader, [&](size_t k) -> Manager& {
+            managers.push_back(std::make_unique<Manager>());
+            managers.back()->openFile(defs[k].output, "RECREATE");
+            return *managers.back();
+        }, defs, config, beam, projectile, frames);
+        const ThreadKinematics& kinematics = *static_cast<const WagonState&>(*wagons.front()).thread;
+
+        std::atomic<Long64_t> processed{0};
+        results.push_back(measure("train x3 pipeline", n, [&]() {
+            runEventRange(reader, wagons, profiler, 0, n, processed, nullptr);
+        }));
+        for (const auto& kin : kinematics.caches) {
+            std::cout << "  EventCache (" << (kin->use_corrected ? "corrected" : "raw")
+                      << "): " << kin->ev.requests() << " requests, "
+                      << kin->ev.computed() << " computed\n";
+        }
+
+        results.push_back(measure("train x3 closeFile", n, [&]() {
+            for (auto& manager : managers) manager->closeFile();
+        }));
+    }
+}
+
+// ============================================================================
+// 6. Graphical cuts
+// ============================================================================
+
+void benchGraphicalCut(Long64_t n, std::vector<BenchResult>& results) {
+    // PID-like banana with 400 points
+    const int points = 400;
+    TCutG banana("bench_banana", points);
+    for (int i = 0; i < points; ++i) {
+        double a = 2.0 * M_PI * i / points;
+        banana.SetPoint(i, 1000.0 * std::cos(a) * (1.0 + 0.2 * std::sin(5.0 * a)),
+                        400.0 * std::sin(a));
+    }
+
+    CutManager cuts;
+    GraphicalCutId id = cuts.addGraphicalCut("banana", &banana);
+
+    std::vector<double> x(static_cast<size_t>(n));
+    std::vector<double> y(static_cast<size_t>(n));
+    TRandom3 rng(4321);
+    for (Long64_t i = 0; i < n; ++i) {
+        x[i] = rng.Uniform(-1500.0, 1500.0);
+        y[i] = rng.Uniform(-500.0, 500.0);
+    }
+
+    Long64_t inside_root = 0;
+    results.push_back(measure("TCutG::IsInside", n, [&]() {
+        for (Long64_t i = 0; i < n; ++i) {
+            inside_root += banana.IsInside(x[i], y[i]);
+        }
+    }));
+
+    Long64_t inside_handle = 0;
+    results.push_back(measure("passGraphicalCut(id)", n, [&]() {
+        for (Long64_t i = 0; i < n; ++i) {
+            inside_handle += cuts.passGraphicalCut(id, x[i], y[i]);
+        }
+    }));
+
+    std::vector<uint8_t> out(static_cast<size_t>(n));
+    results.push_back(measure("passGraphicalCut batch", n, [&]() {
+        cuts.passGraphicalCut(id, x.data(), y.data(), x.size(), out.data());
+    }));
+    Long64_t inside_batch = 0;
+    for (uint8_t o : out) inside_batch += o;
+
+    if (inside_handle != inside_root || inside_batch != inside_root) {
+        throw std::runtime_error("benchGraphicalCut: raster disagrees with TCutG::IsInside");
+    }
+}
+
+// ============================================================================
+// 7. Multi-candidate combinatorics
+// ============================================================================
+
+void benchCombinatorics(Long64_t n, std::vector<BenchResult>& results) {
+    // 6 protons and 4 pi- per event: 24 (p, pi-) and 15 (p, p) pairs
+    const int n_p = 6, n_pim = 4;
+    auto track = [](Long64_t i, int k, double mass, const char* name) {
+        PParticle particle(mass, name);
+        particle.setFromSpherical(300.0 + (i + 37 * k) % 900, 10.0 + k * 7.0, (i * 13 + k * 50) % 360,
+                                  MomentumType::RECONSTRUCTED);
+        return particle;
+    };
+
+    double sum_vector = 0;
+    results.push_back(measure("pairs std::vector", n, [&]() {
+        for (Long64_t i = 0; i < n; ++i) {
+            std::vector<PParticle> protons, pims;
+            for (int k = 0; k < n_p; ++k) protons.push_back(track(i, k, MASS_PROTON, "p"));
+            for (int k = 0; k < n_pim; ++k) pims.push_back(track(i, k, MASS_PION_MINUS, "pi-"));
+            std::vector<PParticle> pairs;
+            for (const auto& p : protons) {
+                for (const auto& pim : pims) pairs.push_back(p + pim);
+            }
+            for (size_t a = 0; a < protons.size(); ++a) {
+                for (size_t b = a + 1; b < protons.size(); ++b) pairs.push_back(protons[a] + protons[b]);
+            }
+            for (const auto& c : pairs) sum_vector += c.mass();
+        }
+    }));
+
+    CandidateArena arena;
+    double sum_arena = 0;
+    results.push_back(measure("pairs CandidateArena", n, [&]() {
+        for (Long64_t i = 0; i < n; ++i) {
+            arena.reset();
+            ParticleList protons = arena.list<PParticle>();
+            ParticleList pims = arena.list<PParticle>();
+            protons.reserve(n_p);
+            pims.reserve(n_pim);
+            for (int k = 0; k < n_p; ++k) protons.push_back(track(i, k, MASS_PROTON, "p"));
+            for (int k = 0; k < n_pim; ++k) pims.push_back(track(i, k, MASS_PION_MINUS, "pi-"));
+            for (const auto& c : arena.pairs(protons, pims)) sum_arena += c.sum.mass();
+            for (const auto& c : arena.pairs(protons, protons)) sum_arena += c.sum.mass();
+        }
+    }));
+
+    if (std::abs(sum_arena - sum_vector) > 1e-6 * std::abs(sum_vector)) {
+        throw std::runtime_error("benchCombinatorics: arena and std::vector pairs disagree");
+    }
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char* argv[]) {
+    Long64_t events = 1000000;
+    Long64_t ntuple_events = 10000000;
+    std::string ntuple_mode = "convert";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--events" && i + 1 < argc) {
+            events = std::atoll(argv[++i]);
+        } else if (arg == "--ntuple-events" && i + 1 < argc) {
+            ntuple_events = std::atoll(argv[++i]);
+        } else if (arg == "--ntuple-mode" && i + 1 < argc) {
+            ntuple_mode = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--events N] [--ntuple-events M] [--ntuple-mode convert|memory|tree]\n";
+            return 1;
+        }
+    }
+
+    const std::string input = "bench_ppip.root";
+    std::cout << "Generating " << events << " synthetic PPip_ID events in " << input << "...\n";
+    generatePPipTree(input, events, 1580.0);
+
+    std::vector<BenchResult> results;
+    try {
+        benchReader(input, events, results);
+        benchKinematics(events, results);
+        benchFills(events, results);
+        for (const char* compression : {"default", "lz4", "zstd"}) {
+            benchNtuple(ntuple_events, ntuple_mode, compression, results);
+        }
+        benchPipeline(input, events, ntuple_mode, results);
+        benchGraphicalCut(events, results);
+        benchCombinatorics(events, results);
+    } catch (const std::exception& e) {
+        std::cerr << "Benchmark failed: " << e.what() << "\n";
+        printResults(results);
+        return 1;
+    }
+
+    printResults(results);
+    return 0;
+}
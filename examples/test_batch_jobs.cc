@@ -0,0 +1,212 @@
+/**
+ * @file test_batch_jobs.cc
+ * @brief Test of the batch-job helpers: JobSplitter::partition() and OutputMerger
+ *
+ * This test checks:
+ * 1. partition() groups are contiguous, non-empty and balanced
+ * 2. partition() with more jobs than files gives one file per job
+ * 3. Merged TNtuples have the union of the variables, missing_value
+ *    for variables an input lacks, and the rows in input order
+ *
+ * Run:
+ *   make test-batch-jobs
+ */
+
+#include <Rtypes.h>
+#include "../src/job_splitter.h"
+#include "../src/output_merger.h"
+#include <TFile.h>
+#include <TNtuple.h>
+#include <TLeaf.h>
+#include <TObjArray.h>
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using Groups = std::vector<std::vector<InputSegment>>;
+
+static int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "  ✅ " : "  ❌ ") << what << std::endl;
+    if (!ok) ++failures;
+}
+
+/// Input files f0, f1, ... with the given entries
+std::vector<InputSegment> makeFiles(const std::vector<Long64_t>& entries) {
+    std::vector<InputSegment> files;
+    Long64_t first = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        files.push_back(InputSegment{"f" + std::to_string(i) + ".root", first, entries[i]});
+        first += entries[i];
+    }
+    return files;
+}
+
+/// Groups are non-empty and, concatenated, give the files in list order
+bool contiguous(const Groups& groups, const std::vector<InputSegment>& files) {
+    size_t i = 0;
+    for (const auto& group : groups) {
+        if (group.empty()) return false;
+        for (const auto& f : group) {
+            if (i >= files.size() || f.file != files[i++].file) return false;
+        }
+    }
+    return i == files.size();
+}
+
+Long64_t entriesOf(const std::vector<InputSegment>& group) {
+    Long64_t sum = 0;
+    for (const auto& f : group) sum += f.entries;
+    return sum;
+}
+
+// ============================================================================
+// TEST 1: Contiguous, non-empty, balanced groups
+// ============================================================================
+void test1_partition_balance() {
+    std::cout << "\n=== TEST 1: partition() balance ===" << std::endl;
+
+    auto even = makeFiles({100, 100, 100, 100, 100, 100});
+    Groups groups = JobSplitter::partition(even, 3, JobSplitter::By::Entries);
+    bool pairs = groups.size() == 3;
+    for (const auto& g : groups) pairs = pairs && g.size() == 2;
+    check(contiguous(groups, even), "equal files: groups are contiguous and non-empty");
+    check(pairs, "equal files: 6 files into 3 jobs of 2");
+
+    // Uneven files: no group exceeds its share by more than one file
+    auto uneven = makeFiles({500, 20, 80, 300, 10, 90, 250, 150, 60, 40});
+    Long64_t total = entriesOf(uneven);
+    Long64_t largest = 500;
+    for (int n : {2, 3, 4, 7}) {
+        groups = JobSplitter::partition(uneven, n, JobSplitter::By::Entries);
+        bool balanced = static_cast<int>(groups.size()) == n;
+        for (const auto& g : groups) balanced = balanced && entriesOf(g) <= total / n + largest;
+        check(contiguous(groups, uneven) && balanced,
+              std::to_string(n) + " jobs: contiguous, non-empty, within one file of total/n");
+    }
+
+    // The big first file gets a job of its own
+    groups = JobSplitter::partition(makeFiles({500, 100, 100, 100, 100, 100}), 2, JobSplitter::By::Entries);
+    check(groups.size() == 2 && groups[0].size() == 1 && entriesOf(groups[1]) == 500,
+          "2 jobs: a file of half the entries is a job of its own");
+
+    // By files: group sizes differ by at most one
+    groups = JobSplitter::partition(uneven, 3, JobSplitter::By::Files);
+    size_t lo = uneven.size(), hi = 0;
+    for (const auto& g : groups) {
+        lo = std::min(lo, g.size());
+        hi = std::max(hi, g.size());
+    }
+    check(contiguous(groups, uneven) && hi - lo <= 1, "by files: 10 files into 3 jobs of 3-4 files");
+
+    bool threw = false;
+    try {
+        JobSplitter::partition(uneven, 0, JobSplitter::By::Entries);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    check(threw, "0 jobs is rejected");
+}
+
+// ============================================================================
+// TEST 2: More jobs than files
+// ============================================================================
+void test2_more_jobs_than_files() {
+    std::cout << "\n=== TEST 2: More jobs than files ===" << std::endl;
+
+    auto files = makeFiles({1000, 10, 10});
+    for (JobSplitter::By by : {JobSplitter::By::Entries, JobSplitter::By::Files}) {
+        Groups groups = JobSplitter::partition(files, 5, by);
+        bool single = groups.size() == 3;
+        for (const auto& g : groups) single = single && g.size() == 1;
+        check(contiguous(groups, files) && single,
+              std::string(by == JobSplitter::By::Entries ? "by entries" : "by files") +
+              ": 3 files into 5 jobs gives 3 jobs of one file");
+    }
+}
+
+// ============================================================================
+// TEST 3: Merging TNtuples with different variables
+// ============================================================================
+
+/// Write one job output with ntuple "nt" of the given variables and rows
+void writeJob(const std::string& file, const std::string& varlist,
+              const std::vector<std::vector<Float_t>>& rows) {
+    TFile out(file.c_str(), "RECREATE");
+    auto* nt = new TNtuple("nt", "test ntuple", varlist.c_str());   // Owned by out
+    for (const auto& row : rows) nt->Fill(row.data());
+    out.Write();
+    out.Close();
+}
+
+void test3_merge_ntuples() {
+    std::cout << "\n=== TEST 3: Merged ntuples ===" << std::endl;
+
+    const Float_t missing = -999.0f;
+    writeJob("test_batch_job0.root", "a:b", {{1, 2}, {3, 4}});
+    writeJob("test_batch_job1.root", "a:c", {{5, 6}});
+    writeJob("test_batch_job2.root", "b", {{7}});
+
+    OutputMerger merger(missing);
+    merger.merge("test_batch_merged.root",
+                 {"test_batch_job0.root", "test_batch_job1.root", "test_batch_job2.root"});
+    merger.printSummary();
+
+    const auto& stats = merger.ntuples();
+    check(stats.size() == 1 && stats[0].entries == 4 && stats[0].variables == 3 && stats[0].backfilled == 3,
+          "summary: 4 rows, 3 variables, every input backfilled");
+
+    TFile in("test_batch_merged.root", "READ");
+    TNtuple* nt = dynamic_cast<TNtuple*>(in.Get("nt"));
+    check(nt != nullptr, "the merged ntuple is still a TNtuple");
+    if (nt) {
+        std::vector<std::string> vars;
+        TObjArray* leaves = nt->GetListOfLeaves();
+        for (int i = 0; leaves && i < leaves->GetEntries(); ++i) {
+            vars.push_back(static_cast<TLeaf*>(leaves->At(i))->GetName());
+        }
+        check(vars == std::vector<std::string>({"a", "b", "c"}), "variables are the sorted union a:b:c");
+
+        Float_t a = 0, b = 0, c = 0;
+        nt->SetBranchAddress("a", &a);
+        nt->SetBranchAddress("b", &b);
+        nt->SetBranchAddress("c", &c);
+        const std::vector<std::vector<Float_t>> expected{
+            {1, 2, missing}, {3, 4, missing}, {5, missing, 6}, {missing, 7, missing}};
+        bool rows = nt->GetEntries() == static_cast<Long64_t>(expected.size());
+        for (Long64_t i = 0; rows && i < nt->GetEntries(); ++i) {
+            nt->GetEntry(i);
+            rows = a == expected[i][0] && b == expected[i][1] && c == expected[i][2];
+        }
+        check(rows, "rows in input order, missing variables filled with missing_value");
+        nt->ResetBranchAddresses();
+    }
+    in.Close();
+
+    for (const char* file : {"test_batch_job0.root", "test_batch_job1.root", "test_batch_job2.root",
+                             "test_batch_merged.root"}) {
+        std::remove(file);
+    }
+}
+
+int main() {
+    std::cout << "=====================================================" << std::endl;
+    std::cout << "  Batch Jobs Test (JobSplitter, OutputMerger)" << std::endl;
+    std::cout << "=====================================================" << std::endl;
+
+    test1_partition_balance();
+    test2_more_jobs_than_files();
+    test3_merge_ntuples();
+
+    std::cout << "\n=====================================================" << std::endl;
+    if (failures == 0) {
+        std::cout << "✅ ALL TESTS PASSED" << std::endl;
+    } else {
+        std::cout << "❌ " << failures << " CHECK(S) FAILED" << std::endl;
+    }
+    std::cout << "=====================================================" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -9,8 +9,8 @@
  * They should produce IDENTICAL results.
  */
 
-#include "../src/PParticle.h"
-#include "../src/BoostFrame.h"
+#include "../src/pparticle.h"
+#include "../src/boost_frame.h"
 #include "TLorentzVector.h"
 #include <iostream>
 #include <cmath>
@@ -20,10 +20,10 @@
  *   ./test_improved_manager
  */
 
-#include "../src/ImprovedManager.h"
-#include "../src/HistogramRegistry.h"
-#include "../src/HistogramFactory.h"
-#include "../src/HistogramBuilder.h"
+#include "../src/manager.h"
+#include "../src/histogram_registry.h"
+#include "../src/histogram_factory.h"
+#include "../src/histogram_builder.h"
 #include <iostream>
 #include <TRandom3.h>
 
@@ -36,7 +36,7 @@ void example1_basic_usage() {
     std::cout << "║  EXAMPLE 1: Basic Usage                                        ║\n";
     std::cout << "╚════════════════════════════════════════════════════════════════╝\n";
 
-    ImprovedManager manager;
+    Manager manager;
     manager.openFile("test_basic.root");
 
     // OLD WAY (from datamanager.cc):
@@ -74,7 +74,7 @@ void example2_histogram_arrays() {
     std::cout << "║  EXAMPLE 2: Histogram Arrays                                   ║\n";
     std::cout << "╚════════════════════════════════════════════════════════════════╝\n";
 
-    ImprovedManager manager;
+    Manager manager;
     manager.openFile("test_arrays.root");
 
     // OLD WAY (from datamanager.cc lines 32-39):
@@ -118,7 +118,7 @@ void example3_builder_pattern() {
     std::cout << "║  EXAMPLE 3: Builder Pattern                                    ║\n";
     std::cout << "╚════════════════════════════════════════════════════════════════╝\n";
 
-    ImprovedManager manager;
+    Manager manager;
     manager.openFile("test_builder.root");
 
     // Using builder for expressive, self-documenting code
@@ -180,7 +180,7 @@ void example4_folder_organization() {
     std::cout << "║  EXAMPLE 4: Folder Organization                                ║\n";
     std::cout << "╚════════════════════════════════════════════════════════════════╝\n";
 
-    ImprovedManager manager;
+    Manager manager;
     manager.openFile("test_folders.root");
 
     // OLD: All histograms in root directory (flat, hard to navigate)
@@ -225,7 +225,7 @@ void example5_ntuple_integration() {
     std::cout << "║  EXAMPLE 5: NTuple Integration                                 ║\n";
     std::cout << "╚════════════════════════════════════════════════════════════════╝\n";
 
-    ImprovedManager manager;
+    Manager manager;
     manager.openFile("test_ntuple.root");
 
     // Create histograms
@@ -315,7 +315,7 @@ h_theta[2][1]->Fill(45);
     std::cout << R"(
 // NO global pointers!
 
-ImprovedManager manager;
+Manager manager;
 manager.openFile("output.root");
 
 // Creation (much cleaner!)
@@ -358,7 +358,7 @@ void example7_type_safety() {
     std::cout << "║  EXAMPLE 7: Type Safety                                        ║\n";
     std::cout << "╚════════════════════════════════════════════════════════════════╝\n";
 
-    ImprovedManager manager;
+    Manager manager;
     manager.openFile("test_safety.root");
 
     manager.create1D("h_1d", "1D histogram", 100, 0, 100);
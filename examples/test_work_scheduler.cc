@@ -0,0 +1,239 @@
+/**
+ * @file test_work_scheduler.cc
+ * @brief Test of the WorkScheduler hand-out and of its checkpoint round-trip
+ *
+ * This test checks:
+ * 1. Chunked claims cover [start, end) exactly once
+ * 2. Steals split a range at a cluster start
+ * 3. finish(chunk, stopped_at) hands the rest of the chunk back
+ * 4. ranges() written to a state file and read back reproduces the remaining work
+ *
+ * Run:
+ *   make test-work-scheduler
+ */
+
+#include "../src/work_scheduler.h"
+#include "../src/checkpoint.h"
+#include <cstdio>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+using Range = CheckpointState::Range;
+
+static int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "  ✅ " : "  ❌ ") << what << std::endl;
+    if (!ok) ++failures;
+}
+
+/// Cluster starts every 'size' entries in [0, entries)
+std::vector<Long64_t> clusters(Long64_t entries, Long64_t size) {
+    std::vector<Long64_t> starts;
+    for (Long64_t e = 0; e < entries; e += size) starts.push_back(e);
+    return starts;
+}
+
+/// Count how often every entry of [0, entries) was processed
+struct Coverage {
+    std::vector<int> count;
+    explicit Coverage(Long64_t entries) : count(entries, 0) {}
+    void add(Long64_t first, Long64_t last) {
+        for (Long64_t e = first; e < last; ++e) ++count[e];
+    }
+    bool exactlyOnce() const {
+        for (int c : count) if (c != 1) return false;
+        return true;
+    }
+};
+
+/// Claim and finish chunks round-robin, worker w taking speed[w] chunks per round
+void drain(WorkScheduler& scheduler, const std::vector<int>& speed, Coverage& coverage,
+           std::vector<WorkScheduler::Chunk>* chunks = nullptr) {
+    std::vector<bool> done(speed.size(), false);
+    size_t active = speed.size();
+    while (active > 0) {
+        for (size_t w = 0; w < speed.size(); ++w) {
+            for (int k = 0; k < speed[w] && !done[w]; ++k) {
+                WorkScheduler::Chunk chunk;
+                if (!scheduler.claim(static_cast<int>(w), chunk)) {
+                    done[w] = true;
+                    --active;
+                    break;
+                }
+                coverage.add(chunk.first, chunk.last);
+                if (chunks) chunks->push_back(chunk);
+                scheduler.finish(chunk, chunk.last);
+            }
+        }
+    }
+}
+
+// ============================================================================
+// TEST 1: Chunked claims cover [start, end) exactly once
+// ============================================================================
+void test1_coverage() {
+    std::cout << "\n=== TEST 1: Claims cover every entry once ===" << std::endl;
+
+    const Long64_t entries = 1000;
+    std::vector<Long64_t> starts = clusters(entries, 25);   // 500 is a cluster start
+    std::set<Long64_t> boundaries(starts.begin(), starts.end());
+
+    for (bool steal : {false, true}) {
+        std::vector<Range> ranges{Range{0, 0, 500, 0}, Range{500, 500, 1000, 1}};
+        WorkScheduler scheduler(ranges, starts, 0, steal);
+        Coverage coverage(entries);
+        std::vector<WorkScheduler::Chunk> chunks;
+        drain(scheduler, {1, 4}, coverage, &chunks);
+
+        bool aligned = true;
+        for (const auto& c : chunks) {
+            aligned = aligned && boundaries.count(c.first) && (boundaries.count(c.last) || c.last == entries);
+        }
+        std::string mode = steal ? "steal" : "static";
+        check(coverage.exactlyOnce(), mode + ": every entry of [0, 1000) claimed exactly once");
+        check(aligned, mode + ": chunks start and end at cluster starts");
+        check(scheduler.unclaimed() == 0, mode + ": nothing left unclaimed");
+        check(steal == (scheduler.steals() > 0), mode + ": fast worker steals only when stealing is on");
+    }
+
+    // Without cluster boundaries chunks are chunk_events long
+    WorkScheduler plain({Range{0, 0, 95, 0}}, {}, 10, true);
+    Coverage coverage(95);
+    std::vector<WorkScheduler::Chunk> chunks;
+    drain(plain, {1}, coverage, &chunks);
+    check(coverage.exactlyOnce() && chunks.size() == 10 && chunks.back().last - chunks.back().first == 5,
+          "no clusters: 10-entry chunks, short last chunk");
+}
+
+// ============================================================================
+// TEST 2: Steals split at cluster starts
+// ============================================================================
+void test2_steal_split() {
+    std::cout << "\n=== TEST 2: Steals split at cluster starts ===" << std::endl;
+
+    // Worker 1 has no entries of its own and steals right away
+    std::vector<Long64_t> starts = clusters(1000, 70);
+    WorkScheduler scheduler({Range{0, 0, 1000, 0}, Range{1000, 1000, 1000, 1}}, starts, 0, true);
+
+    WorkScheduler::Chunk own;
+    check(scheduler.claim(0, own) && own.first == 0 && own.last == 70, "worker 0 claims its first cluster");
+
+    WorkScheduler::Chunk stolen;
+    bool claimed = scheduler.claim(1, stolen);
+    std::vector<Range> ranges = scheduler.ranges();
+    check(claimed && scheduler.steals() == 1, "idle worker 1 steals");
+    check(ranges.size() == 3, "the stolen tail becomes a new range");
+    check(std::binary_search(starts.begin(), starts.end(), ranges[2].first),
+          "the split point " + std::to_string(ranges[2].first) + " is a cluster start");
+    check(ranges[2].first >= 70 + (1000 - 70) / 2 && ranges[2].last == 1000 && ranges[2].worker == 1,
+          "the thief owns the back half of what was left");
+    check(ranges[0].last == ranges[2].first, "the victim's range ends where the tail begins");
+    check(stolen.first == ranges[2].first && stolen.range == 2, "the first stolen chunk starts the tail");
+
+    // A rest without a cluster start to split at is taken whole
+    WorkScheduler whole({Range{0, 0, 50, 0}, Range{50, 50, 50, 1}}, clusters(50, 100), 0, true);
+    WorkScheduler::Chunk all;
+    check(whole.claim(1, all) && all.first == 0 && all.last == 50, "an unsplittable range is stolen whole");
+}
+
+// ============================================================================
+// TEST 3: finish(chunk, stopped_at) returns the tail
+// ============================================================================
+void test3_finish_tail() {
+    std::cout << "\n=== TEST 3: Chunks stopped early hand back their tail ===" << std::endl;
+
+    WorkScheduler scheduler({Range{0, 0, 300, 0}}, clusters(300, 100), 0, false);
+    WorkScheduler::Chunk chunk;
+    scheduler.claim(0, chunk);
+    scheduler.finish(chunk, 40);
+
+    check(scheduler.ranges()[0].next == 40, "next records the entry the chunk stopped at");
+    check(scheduler.unclaimed() == 260, "the 60 unprocessed entries are unclaimed again");
+
+    WorkScheduler::Chunk again;
+    check(scheduler.claim(0, again) && again.first == 40 && again.last == 100,
+          "the next claim resumes at 40 and ends at the cluster start");
+
+    scheduler.finish(again, again.first);
+    check(scheduler.ranges()[0].next == 40 && scheduler.unclaimed() == 260,
+          "a chunk stopped before its first entry hands all of it back");
+}
+
+// ============================================================================
+// TEST 4: Checkpoint round-trip of ranges()
+// ============================================================================
+void test4_checkpoint_roundtrip() {
+    std::cout << "\n=== TEST 4: Checkpointed ranges reproduce the remaining work ===" << std::endl;
+
+    const Long64_t entries = 2000;
+    std::vector<Long64_t> starts = clusters(entries, 45);
+    CheckpointState state;
+    state.input_entries = entries;
+    state.start_event = 0;
+    state.end_event = entries;
+    state.ranges = {Range{0, 0, 700, 0}, Range{700, 700, 1400, 1}, Range{1400, 1400, 2000, 2}};
+    state.wagons.resize(1);
+    state.wagons[0].name = "default";
+    state.wagons[0].output = "output.root";
+
+    // Run a while with stealing, then stop every worker in the middle of a chunk
+    Coverage coverage(entries);
+    {
+        WorkScheduler scheduler(state.ranges, starts, 0, true);
+        std::vector<int> speed{1, 2, 6};
+        for (int round = 0; round < 8; ++round) {
+            for (int w = 0; w < 3; ++w) {
+                for (int k = 0; k < speed[w]; ++k) {
+                    WorkScheduler::Chunk chunk;
+                    if (!scheduler.claim(w, chunk)) break;
+                    Long64_t stopped_at = round == 7 && k == 0 ? chunk.first + 7 : chunk.last;
+                    coverage.add(chunk.first, stopped_at);
+                    scheduler.finish(chunk, stopped_at);
+                }
+            }
+        }
+        check(scheduler.steals() > 0, "the fast worker stole before the checkpoint");
+        state.ranges = scheduler.ranges();
+    }
+
+    const std::string file = "test_work_scheduler.state.json";
+    state.write(file);
+    CheckpointState resumed = CheckpointState::read(file);
+    std::remove(file.c_str());
+
+    bool same = resumed.ranges.size() == state.ranges.size();
+    for (size_t i = 0; same && i < state.ranges.size(); ++i) {
+        const Range& a = state.ranges[i];
+        const Range& b = resumed.ranges[i];
+        same = a.first == b.first && a.next == b.next && a.last == b.last && a.worker == b.worker;
+    }
+    check(same, "ranges read back equal the ranges written");
+
+    // The resumed run processes exactly what the first run left over
+    WorkScheduler scheduler(resumed.ranges, starts, 0, true);
+    drain(scheduler, {3, 1, 1}, coverage);
+    check(coverage.exactlyOnce(), "first run + resumed run process every entry exactly once");
+}
+
+int main() {
+    std::cout << "=====================================================" << std::endl;
+    std::cout << "  WorkScheduler Test" << std::endl;
+    std::cout << "=====================================================" << std::endl;
+
+    test1_coverage();
+    test2_steal_split();
+    test3_finish_tail();
+    test4_checkpoint_roundtrip();
+
+    std::cout << "\n=====================================================" << std::endl;
+    if (failures == 0) {
+        std::cout << "✅ ALL TESTS PASSED" << std::endl;
+    } else {
+        std::cout << "❌ " << failures << " CHECK(S) FAILED" << std::endl;
+    }
+    std::cout << "=====================================================" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -9,11 +9,46 @@
 // - src/setup_histograms.h: Histogram definitions
 // - src/setup_ntuples.h: Ntuple definitions
 // - src/setup_cuts.h: Cut definitions
+// - src/event_loop.h: Event loop, worker threads and checkpoints
+// - src/commands.h: Command line, --split, --merge and --schema
 //
 // Usage:
-//   ./ana [config.json]
+//   ./ana [config.json] [--resume]
 //   ./ana                    # Uses default config.json
 //   ./ana my_analysis.json   # Uses custom config file
+//   ./ana my_analysis.json --resume   # Continue from the last checkpoint
+//   ./ana my_analysis.json --split 20 [--by entries|files]   # Write batch jobs
+//   ./ana my_analysis.json --merge out.root out.job0.root ... # Merge job outputs
+//   ./ana my_analysis.json --schema [header.h] [--tree NAME]  # Input struct
+//
+// Parallel mode: set "execution": {"threads": N} in the config. Each worker
+// thread gets its own reader, Manager shard and CutManager and claims its
+// entries cluster by cluster (src/work_scheduler.h); with "scheduler":
+// "steal" a worker that runs out takes over the tail of the busiest range.
+// Results are merged in thread order at the end.
+//
+// Train mode: a "train" array in the config runs several variants of
+// processEvent() (cuts, raw vs corrected momenta) over ONE pass of the
+// input. Each wagon has its own Manager, CutManager and output file.
+//
+// Checkpoints: "checkpoint_events" / "checkpoint_minutes" in "execution"
+// periodically save histograms, cut flow, ntuple entries and the position
+// in the input (src/checkpoint.h). After a crash or preemption, --resume
+// continues from the last checkpoint instead of start_event.
+//
+// Batch jobs: --split partitions the files of the .list input into N jobs
+// (src/job_splitter.h), each with its own list, config and output names;
+// --merge adds their histograms and cut flows and appends their ntuples,
+// backfilling variables a job never saw with missing_value
+// (src/output_merger.h).
+//
+// Input structs: --schema writes a header with one typed member per scalar
+// leaf of the input tree (src/schema_generator.h, make schema); bind() of
+// the struct checks it against the tree the analysis opens.
+//
+// Skims: "output": {"entry_list": "skim.root"} stores the entries that
+// passed the cut flow (up to "entry_list_cut") as a TEntryList; a later
+// run with "input": {"entry_list": "skim.root"} reads only those entries.
 //
 // @author Witold Przygoda (witold.przygoda@uj.edu.pl)
 // @date 2025
@@ -28,15 +63,208 @@
 #include "src/setup_histograms.h"
 #include "src/setup_ntuples.h"
 #include "src/setup_cuts.h"
-#include "src/progressbar.h"
+#include "src/profiler.h"
+#include "src/event_cache.h"
+#include "src/event_loop.h"
+#include "src/commands.h"
 #include <iostream>
 #include <iomanip>
 #include <string>
 #include <cmath>
+#include <functional>
+#include <memory>
+#include <vector>
 
 // Use Physics namespace for mass constants
 using namespace Physics;
 
+// ============================================================================
+// INPUT VARIABLES - resolved once before the event loop
+// ============================================================================
+// Each required variable is a stable pointer into the reader's value buffer;
+// optional ones carry a presence flag cached per input file. This keeps
+// string lookups out of processEvent(). The required ones are validated
+// per input file: events of a file lacking one are skipped (and counted)
+// before processEvent() runs.
+//
+// EDIT THIS STRUCT and setupInputs() when reading new variables.
+// ============================================================================
+
+struct InputSlots {
+    // Proton kinematics
+    const Float_t* p_p = nullptr;
+    const Float_t* p_theta = nullptr;
+    const Float_t* p_phi = nullptr;
+    
+    // Pion kinematics
+    const Float_t* pip_p = nullptr;
+    const Float_t* pip_theta = nullptr;
+    const Float_t* pip_phi = nullptr;
+    
+    // Optional
+    OptionalSlot weight;
+    OptionalSlot eVertX;
+    OptionalSlot eVertY;
+    OptionalSlot eVertZ;
+    
+    // All required variables (and config "variables") exist in this file
+    InputSchema complete;
+};
+
+/**
+ * @brief Resolve all input variables used by processEvent()
+ * @param reader Open input reader
+ * @param use_corrected Read corrected momenta instead of raw ones
+ * @param extra Further variables every input file must have (config "variables")
+ *
+ * Variable names must exactly match your tree branch names. Throws if a
+ * required variable is missing from a single-file input; in a chain the
+ * files lacking one are skipped.
+ */
+InputSlots setupInputs(NTupleReader& reader, bool use_corrected,
+                       const std::vector<std::string>& extra = {}) {
+    InputSlots in;
+    
+    const char* p_p = use_corrected ? "p_p_corr_p" : "p_p";
+    const char* pip_p = use_corrected ? "pip_p_corr_pip" : "pip_p";
+    std::vector<std::string> required = {p_p, "p_theta", "p_phi", pip_p, "pip_theta", "pip_phi"};
+    required.insert(required.end(), extra.begin(), extra.end());
+    in.complete = reader.requireVariables(required);
+    
+    in.p_p = reader.slot(p_p);
+    in.p_theta = reader.slot("p_theta");
+    in.p_phi = reader.slot("p_phi");
+    
+    in.pip_p = reader.slot(pip_p);
+    in.pip_theta = reader.slot("pip_theta");
+    in.pip_phi = reader.slot("pip_phi");
+    
+    in.weight = reader.optionalSlot("weight");
+    in.eVertX = reader.optionalSlot("eVertX");
+    in.eVertY = reader.optionalSlot("eVertY");
+    in.eVertZ = reader.optionalSlot("eVertZ");
+    
+    return in;
+}
+
+// ============================================================================
+// DERIVED KINEMATICS - computed lazily, at most once per event
+// ============================================================================
+// Every particle, boost and angle used by processEvent() is declared here
+// with the code that computes it. processEvent() asks the EventCache for
+// values (ev.get(k.p_cms)); the first request in an event computes, later
+// requests (histograms, ntuples, other train wagons reading the same
+// inputs) reuse the result. Quantities behind a failed cut are never
+// computed at all.
+//
+// EDIT THIS STRUCT and setupKinematics() when adding derived quantities.
+// ============================================================================
+
+struct KinematicsKeys {
+    // LAB frame particles
+    CacheKey<PParticle> proton;
+    CacheKey<PParticle> pion;
+    CacheKey<PParticle> neutron;     // missing: beam - p - pi+
+    CacheKey<PParticle> deltaPP;     // p + pi+
+    CacheKey<PParticle> deltaP;      // missing: beam - p
+    CacheKey<PParticle> n_pip;
+    CacheKey<PParticle> pn;
+    
+    // CMS (beam frame)
+    CacheKey<PParticle> p_cms;
+    CacheKey<PParticle> pip_cms;
+    CacheKey<PParticle> n_cms;
+    CacheKey<PParticle> deltaPP_cms;
+    CacheKey<PParticle> deltaP_cms;
+    
+    // Opening angles (LAB, degrees)
+    CacheKey<double> oa_ppip;
+    CacheKey<double> oa_npip;
+    CacheKey<double> oa_pn;
+    
+    // PWA: p+pi+ rest frame
+    CacheKey<BoostFrame> ppip_frame;
+    CacheKey<PParticle> pip_in_ppip;
+    CacheKey<PParticle> n_in_ppip;
+    CacheKey<PParticle> proj_in_ppip;
+    CacheKey<double> cos_gj;         // Gottfried-Jackson angle
+};
+
+/**
+ * @brief Declare all derived quantities on an event cache
+ * @param ev Cache attached to the reader that fills 'in'
+ * @param in Input slots the particles are built from
+ *
+ * beam, projectile and frames must outlive the cache.
+ */
+KinematicsKeys setupKinematics(EventCache& ev, const InputSlots& in,
+                               const PParticle& beam, const PParticle& projectile,
+                               const EventFrames& frames) {
+    KinematicsKeys k;
+    
+    // Particles from the input slots (the only per-event input reads)
+    k.proton = ev.declare<PParticle>("proton", [in](EventCache&) {
+        return ParticleFactory::createProton(*in.p_p, *in.p_theta, *in.p_phi);
+    });
+    k.pion = ev.declare<PParticle>("pion", [in](EventCache&) {
+        return ParticleFactory::createPiPlus(*in.pip_p, *in.pip_theta, *in.pip_phi);
+    });
+    
+    // Composite and missing particles
+    k.neutron = ev.declare<PParticle>("neutron", [k, &beam](EventCache& c) {
+        return beam - c.get(k.proton) - c.get(k.pion);
+    });
+    k.deltaPP = ev.declare<PParticle>("deltaPP", [k](EventCache& c) {
+        return c.get(k.proton) + c.get(k.pion);
+    });
+    k.deltaP = ev.declare<PParticle>("deltaP", [k, &beam](EventCache& c) {
+        return beam - c.get(k.proton);
+    });
+    k.n_pip = ev.declare<PParticle>("n_pip", [k](EventCache& c) {
+        return c.get(k.neutron) + c.get(k.pion);
+    });
+    k.pn = ev.declare<PParticle>("pn", [k](EventCache& c) {
+        return c.get(k.proton) + c.get(k.neutron);
+    });
+    
+    // Boosts to CMS
+    const BoostFrame& beam_frame = frames.getFrame("beam");
+    auto to_cms = [&beam_frame](CacheKey<PParticle> lab) {
+        return [&beam_frame, lab](EventCache& c) { return beam_frame.boost(c.get(lab)); };
+    };
+    k.p_cms = ev.declare<PParticle>("p_cms", to_cms(k.proton));
+    k.pip_cms = ev.declare<PParticle>("pip_cms", to_cms(k.pion));
+    k.n_cms = ev.declare<PParticle>("n_cms", to_cms(k.neutron));
+    k.deltaPP_cms = ev.declare<PParticle>("deltaPP_cms", to_cms(k.deltaPP));
+    k.deltaP_cms = ev.declare<PParticle>("deltaP_cms", to_cms(k.deltaP));
+    
+    // Opening angles
+    auto opening = [](CacheKey<PParticle> a, CacheKey<PParticle> b) {
+        return [a, b](EventCache& c) { return c.get(a).openingAngle(c.get(b)); };
+    };
+    k.oa_ppip = ev.declare<double>("oa_ppip", opening(k.proton, k.pion));
+    k.oa_npip = ev.declare<double>("oa_npip", opening(k.neutron, k.pion));
+    k.oa_pn = ev.declare<double>("oa_pn", opening(k.proton, k.neutron));
+    
+    // PWA variables in the p+pi+ rest frame
+    k.ppip_frame = ev.declare<BoostFrame>("ppip_frame", [k](EventCache& c) {
+        return BoostFrame(c.get(k.deltaPP));
+    });
+    auto to_ppip = [k](CacheKey<PParticle> p) {
+        return [k, p](EventCache& c) { return c.get(k.ppip_frame).boost(c.get(p)); };
+    };
+    k.pip_in_ppip = ev.declare<PParticle>("pip_in_ppip", to_ppip(k.pion));
+    k.n_in_ppip = ev.declare<PParticle>("n_in_ppip", to_ppip(k.neutron));
+    k.proj_in_ppip = ev.declare<PParticle>("proj_in_ppip", [k, &projectile](EventCache& c) {
+        return c.get(k.ppip_frame).boost(projectile);
+    });
+    k.cos_gj = ev.declare<double>("cos_gj", [k](EventCache& c) {
+        return cos(c.get(k.pip_in_ppip).p4().angle(c.get(k.proj_in_ppip).p4()));
+    });
+    
+    return k;
+}
+
 // ============================================================================
 // PROCESS SINGLE EVENT - Physics Analysis
 // ============================================================================
@@ -44,60 +272,45 @@ using namespace Physics;
 // 
 // Structure:
 // 1. Read variables from ntuple
-// 2. Create particles
+// 2. Get particles (EventCache, see setupKinematics())
 // 3. Fill quality histograms
 // 4. Apply cuts
 // 5. Boost to CMS
 // 6. Fill physics histograms
+//
+// prof.lap(stage) marks where a profiled stage ends (no-op unless
+// "profiling" is enabled); time up to the lap is charged to that stage.
+// Cached kinematics are charged to the stage that first requests them.
 // ============================================================================
 
-void processEvent(NTupleReader& reader, Manager& mgr, CutManager& cuts,
-                 const PParticle& beam, const PParticle& projectile,
-                 EventFrames& frames, bool use_corrected) {
+void processEvent(const InputSlots& in, EventCache& ev, const KinematicsKeys& k,
+                 const HistogramHandles& h, const NtupleHandles& nt,
+                 CutManager& cuts, const CutHandles& c, Profiler& prof) {
     
     // ========================================================================
-    // 1. READ KINEMATIC VARIABLES FROM NTUPLE
+    // 1. READ EVENT VARIABLES FROM NTUPLE
     // ========================================================================
-    // These are the ONLY places where reader["..."] is needed.
-    // Variable names must exactly match your tree branch names.
-    
-    // Proton kinematics
-    double p_p = use_corrected ? reader["p_p_corr_p"] : reader["p_p"];
-    double p_theta = reader["p_theta"];
-    double p_phi = reader["p_phi"];
-    
-    // Pion kinematics
-    double pip_p = use_corrected ? reader["pip_p_corr_pip"] : reader["pip_p"];
-    double pip_theta = reader["pip_theta"];
-    double pip_phi = reader["pip_phi"];
+    // Kinematic inputs are read in setupKinematics(); the remaining
+    // per-event variables are read here.
     
     // Event weight (optional)
-    double weight = reader.hasVariable("weight") ? reader["weight"] : 1.0;
+    double weight = in.weight.valueOr(1.0);
     
     // Vertex (optional)
-    if (reader.hasVariable("eVertX")) {
-        mgr.fill("eVertX", reader["eVertX"]);
-        mgr.fill("eVertY", reader["eVertY"]);
-        mgr.fill("eVertZ", reader["eVertZ"]);
+    if (in.eVertX) {
+        h.eVertX.fill(in.eVertX.value());
+        h.eVertY.fill(in.eVertY.value());
+        h.eVertZ.fill(in.eVertZ.value());
     }
     
     // ========================================================================
-    // 2. CREATE PARTICLES
+    // 2. GET PARTICLES
     // ========================================================================
-    // From here on, use regular C++ variables - no more reader["..."]
-    
-    PParticle proton = ParticleFactory::createProton(p_p, p_theta, p_phi);
-    PParticle pion = ParticleFactory::createPiPlus(pip_p, pip_theta, pip_phi);
-    
-    // Missing mass technique for neutron
-    PParticle neutron = beam - proton - pion;
+    // References into the event cache, valid for this event
     
-    // Composite particles
-    PParticle deltaPP = proton + pion;      // Delta++
-    PParticle deltaP = beam - proton;        // Delta+ (missing)
-    PParticle p_pip = proton + pion;
-    PParticle n_pip = neutron + pion;
-    PParticle pn = proton + neutron;
+    const PParticle& proton = ev.get(k.proton);
+    const PParticle& pion = ev.get(k.pion);
+    const PParticle& neutron = ev.get(k.neutron);    // missing mass technique
     
     // ========================================================================
     // 3. QUALITY HISTOGRAMS (before cuts)
@@ -107,169 +320,314 @@ void processEvent(NTupleReader& reader, Manager& mgr, CutManager& cuts,
     double m_p = proton.massGeV();
     double m_pip = pion.massGeV();
     
-    mgr.fill("mass_n", m_n);
-    mgr.fill("mass_p", m_p);
-    mgr.fill("mass_pip", m_pip);
+    h.mass_n.fill(m_n);
+    h.mass_p.fill(m_p);
+    h.mass_pip.fill(m_pip);
     
     // ========================================================================
     // 4. APPLY CUTS
     // ========================================================================
     
-    // Neutron mass cut
-    if (cuts.hasRangeCut("neutron_mass")) {
-        if (!cuts.passRangeCut("neutron_mass", m_n)) return;
-    }
+    // Neutron mass cut (an undefined cut accepts the event)
+    if (!cuts.passRangeCut(c.neutron_mass, m_n)) return;
     
     // Fill after neutron cut
-    mgr.fill("mass_n_cut", m_n);
+    h.mass_n_cut.fill(m_n);
     
     // Delta++ mass cut
+    const PParticle& deltaPP = ev.get(k.deltaPP);   // = p + pi+
     double m_deltaPP = deltaPP.massGeV();
-    if (cuts.hasRangeCut("deltaPP_mass")) {
-        if (!cuts.passRangeCut("deltaPP_mass", m_deltaPP)) return;
-    }
+    if (!cuts.passRangeCut(c.deltaPP_mass, m_deltaPP)) return;
     
     // ========================================================================
     // 5. BOOST TO CMS
     // ========================================================================
     
-    const BoostFrame& beam_frame = frames.getFrame("beam");
+    const PParticle& deltaP = ev.get(k.deltaP);
+    const PParticle& n_pip = ev.get(k.n_pip);
+    const PParticle& pn = ev.get(k.pn);
+    
+    const PParticle& p_cms = ev.get(k.p_cms);
+    const PParticle& pip_cms = ev.get(k.pip_cms);
+    const PParticle& n_cms = ev.get(k.n_cms);
+    const PParticle& deltaPP_cms = ev.get(k.deltaPP_cms);
+    const PParticle& deltaP_cms = ev.get(k.deltaP_cms);
     
-    PParticle p_cms = beam_frame.boost(proton);
-    PParticle pip_cms = beam_frame.boost(pion);
-    PParticle n_cms = beam_frame.boost(neutron);
-    PParticle deltaPP_cms = beam_frame.boost(deltaPP);
-    PParticle deltaP_cms = beam_frame.boost(deltaP);
+    prof.lap(ProfileStage::Kinematics);
     
     // ========================================================================
     // 6. FILL HISTOGRAMS
     // ========================================================================
     
     // Composite masses
-    mgr.fill("mass_deltaPP", m_deltaPP);
-    mgr.fill("mass_deltaP", deltaP.massGeV());
-    mgr.fill("mass_ppip", p_pip.massGeV());
-    mgr.fill("mass_npip", n_pip.massGeV());
-    mgr.fill("mass_pn", pn.massGeV());
+    double m_deltaP = deltaP.massGeV();
+    double m_npip = n_pip.massGeV();
+    double m_pn = pn.massGeV();
+    h.mass_deltaPP.fill(m_deltaPP);
+    h.mass_deltaP.fill(m_deltaP);
+    h.mass_ppip.fill(m_deltaPP);
+    h.mass_npip.fill(m_npip);
+    h.mass_pn.fill(m_pn);
     
     // LAB frame kinematics
-    mgr.fill("p_p_lab", proton.momentum());
-    mgr.fill("pip_p_lab", pion.momentum());
-    mgr.fill("n_p_lab", neutron.momentum());
+    h.p_p_lab.fill(proton.momentum());
+    h.pip_p_lab.fill(pion.momentum());
+    h.n_p_lab.fill(neutron.momentum());
     
-    mgr.fill("p_theta_lab", proton.theta());
-    mgr.fill("pip_theta_lab", pion.theta());
-    mgr.fill("n_theta_lab", neutron.theta());
+    h.p_theta_lab.fill(proton.theta());
+    h.pip_theta_lab.fill(pion.theta());
+    h.n_theta_lab.fill(neutron.theta());
     
     // CMS kinematics
-    mgr.fill("cos_theta_deltaPP_cms", deltaPP_cms.cosTheta());
-    mgr.fill("cos_theta_deltaP_cms", deltaP_cms.cosTheta());
-    mgr.fill("cos_theta_p_cms", p_cms.cosTheta());
-    mgr.fill("cos_theta_pip_cms", pip_cms.cosTheta());
-    mgr.fill("cos_theta_n_cms", n_cms.cosTheta());
+    h.cos_theta_deltaPP_cms.fill(deltaPP_cms.cosTheta());
+    h.cos_theta_deltaP_cms.fill(deltaP_cms.cosTheta());
+    h.cos_theta_p_cms.fill(p_cms.cosTheta());
+    h.cos_theta_pip_cms.fill(pip_cms.cosTheta());
+    h.cos_theta_n_cms.fill(n_cms.cosTheta());
     
-    mgr.fill("p_p_cms", p_cms.momentum());
-    mgr.fill("pip_p_cms", pip_cms.momentum());
-    mgr.fill("n_p_cms", n_cms.momentum());
+    h.p_p_cms.fill(p_cms.momentum());
+    h.pip_p_cms.fill(pip_cms.momentum());
+    h.n_p_cms.fill(n_cms.momentum());
     
     // Opening angles
-    mgr.fill("oa_ppip", proton.openingAngle(pion));
-    mgr.fill("oa_npip", neutron.openingAngle(pion));
-    mgr.fill("oa_pn", proton.openingAngle(neutron));
+    h.oa_ppip.fill(ev.get(k.oa_ppip));
+    h.oa_npip.fill(ev.get(k.oa_npip));
+    h.oa_pn.fill(ev.get(k.oa_pn));
     
     // 2D correlations
-    double m2_ppip = p_pip.mass() * p_pip.mass() / 1e6;  // GeV^2
-    double m2_npip = n_pip.mass() * n_pip.mass() / 1e6;  // GeV^2
-    mgr.fill("dalitz_ppip_npip", m2_ppip, m2_npip);
+    double m2_ppip = deltaPP.mass() * deltaPP.mass() / 1e6;  // GeV^2
+    double m2_npip = n_pip.mass() * n_pip.mass() / 1e6;      // GeV^2
+    h.dalitz_ppip_npip.fill(m2_ppip, m2_npip);
     
-    mgr.fill("mass_vs_costh_deltaPP", m_deltaPP, deltaPP_cms.cosTheta());
-    mgr.fill("theta_p_vs_pip_lab", pion.theta(), proton.theta());
+    h.mass_vs_costh_deltaPP.fill(m_deltaPP, deltaPP_cms.cosTheta());
+    h.theta_p_vs_pip_lab.fill(pion.theta(), proton.theta());
+    
+    prof.lap(ProfileStage::HistogramFill);
     
     // ========================================================================
     // 7. PWA VARIABLES (in composite rest frames)
     // ========================================================================
+    // The p+pi+ rest frame and the boosts into it are cached as well
+    // (see setupKinematics())
     
-    // Create p+pi+ rest frame
-    BoostFrame ppip_frame(p_pip);
-    
-    PParticle pip_in_ppip = ppip_frame.boost(pion);
-    PParticle n_in_ppip = ppip_frame.boost(neutron);
-    PParticle proj_in_ppip = ppip_frame.boost(projectile);
+    double pip_helicity = ev.get(k.pip_in_ppip).cosTheta();
+    double n_helicity = ev.get(k.n_in_ppip).cosTheta();
+    double cos_gj = ev.get(k.cos_gj);
     
     // Helicity angle: pion angle relative to beam direction in ppip frame
-    mgr.fill("pwa_pip_helicity_ppip", pip_in_ppip.cosTheta());
-    mgr.fill("pwa_n_helicity_ppip", n_in_ppip.cosTheta());
+    h.pwa_pip_helicity_ppip.fill(pip_helicity);
+    h.pwa_n_helicity_ppip.fill(n_helicity);
     
     // Gottfried-Jackson: angle relative to beam in composite frame
-    double gj_angle = pip_in_ppip.vec().Angle(proj_in_ppip.vec().Vect());
-    mgr.fill("pwa_pip_gj_ppip", cos(gj_angle));
+    h.pwa_pip_gj_ppip.fill(cos_gj);
+    
+    prof.lap(ProfileStage::Kinematics);
     
     // ========================================================================
     // 8. FILL OUTPUT NTUPLES
     // ========================================================================
-    // Two ntuples demonstrate multiple TTree→TNtuple handling
+    // Two ntuples demonstrate multiple TTree→TNtuple handling.
+    // Declared variables are filled through slots (see setup_ntuples.h);
+    // nt_particles["new_var"] = ... still adds variables on the fly.
     
     // --- Ntuple 1: Basic particle observables ---
-    DynamicHNtuple& nt_particles = mgr.getDynamicNtuple("nt_particles");
+    const ParticleNtupleSlots& np = nt.particles;
+    DynamicHNtuple& nt_particles = *np.nt;
     
     // Proton observables (LAB)
-    nt_particles["p_p"] = proton.momentum();
-    nt_particles["p_theta"] = proton.theta();
-    nt_particles["p_phi"] = proton.phi();
-    nt_particles["p_mass"] = m_p;
+    nt_particles[np.p_p] = proton.momentum();
+    nt_particles[np.p_theta] = proton.theta();
+    nt_particles[np.p_phi] = proton.phi();
+    nt_particles[np.p_mass] = m_p;
     
     // Pion observables (LAB)
-    nt_particles["pip_p"] = pion.momentum();
-    nt_particles["pip_theta"] = pion.theta();
-    nt_particles["pip_phi"] = pion.phi();
-    nt_particles["pip_mass"] = m_pip;
+    nt_particles[np.pip_p] = pion.momentum();
+    nt_particles[np.pip_theta] = pion.theta();
+    nt_particles[np.pip_phi] = pion.phi();
+    nt_particles[np.pip_mass] = m_pip;
     
     // Neutron observables (missing mass)
-    nt_particles["n_p"] = neutron.momentum();
-    nt_particles["n_theta"] = neutron.theta();
-    nt_particles["n_phi"] = neutron.phi();
-    nt_particles["n_mass"] = m_n;
+    nt_particles[np.n_p] = neutron.momentum();
+    nt_particles[np.n_theta] = neutron.theta();
+    nt_particles[np.n_phi] = neutron.phi();
+    nt_particles[np.n_mass] = m_n;
     
     // Event weight
-    nt_particles["weight"] = weight;
+    nt_particles[np.weight] = weight;
     
     nt_particles.fill();
     
     // --- Ntuple 2: Compound observables ---
-    DynamicHNtuple& nt_compound = mgr.getDynamicNtuple("nt_compound");
+    const CompoundNtupleSlots& nc = nt.compound;
+    DynamicHNtuple& nt_compound = *nc.nt;
     
     // Composite masses
-    nt_compound["m_deltaPP"] = m_deltaPP;
-    nt_compound["m_deltaP"] = deltaP.massGeV();
-    nt_compound["m_ppip"] = p_pip.massGeV();
-    nt_compound["m_npip"] = n_pip.massGeV();
-    nt_compound["m_pn"] = pn.massGeV();
+    nt_compound[nc.m_deltaPP] = m_deltaPP;
+    nt_compound[nc.m_deltaP] = m_deltaP;
+    nt_compound[nc.m_ppip] = m_deltaPP;
+    nt_compound[nc.m_npip] = m_npip;
+    nt_compound[nc.m_pn] = m_pn;
     
     // CMS angles (composite particles)
-    nt_compound["cos_th_deltaPP_cms"] = deltaPP_cms.cosTheta();
-    nt_compound["cos_th_deltaP_cms"] = deltaP_cms.cosTheta();
-    nt_compound["cos_th_p_cms"] = p_cms.cosTheta();
-    nt_compound["cos_th_pip_cms"] = pip_cms.cosTheta();
-    nt_compound["cos_th_n_cms"] = n_cms.cosTheta();
+    nt_compound[nc.cos_th_deltaPP_cms] = deltaPP_cms.cosTheta();
+    nt_compound[nc.cos_th_deltaP_cms] = deltaP_cms.cosTheta();
+    nt_compound[nc.cos_th_p_cms] = p_cms.cosTheta();
+    nt_compound[nc.cos_th_pip_cms] = pip_cms.cosTheta();
+    nt_compound[nc.cos_th_n_cms] = n_cms.cosTheta();
     
-    // Opening angles
-    nt_compound["oa_ppip"] = proton.openingAngle(pion);
-    nt_compound["oa_npip"] = neutron.openingAngle(pion);
-    nt_compound["oa_pn"] = proton.openingAngle(neutron);
+    // Opening angles (cached, not recomputed)
+    nt_compound[nc.oa_ppip] = ev.get(k.oa_ppip);
+    nt_compound[nc.oa_npip] = ev.get(k.oa_npip);
+    nt_compound[nc.oa_pn] = ev.get(k.oa_pn);
     
     // PWA variables (helicity and Gottfried-Jackson angles)
-    nt_compound["pip_helicity"] = pip_in_ppip.cosTheta();
-    nt_compound["pip_gj"] = cos(gj_angle);
-    nt_compound["n_helicity"] = n_in_ppip.cosTheta();
+    nt_compound[nc.pip_helicity] = pip_helicity;
+    nt_compound[nc.pip_gj] = cos_gj;
+    nt_compound[nc.n_helicity] = n_helicity;
     
     // Dalitz plot variables (squared masses)
-    nt_compound["m2_ppip"] = m2_ppip;
-    nt_compound["m2_npip"] = m2_npip;
+    nt_compound[nc.m2_ppip] = m2_ppip;
+    nt_compound[nc.m2_npip] = m2_npip;
     
     // Event weight
-    nt_compound["weight"] = weight;
+    nt_compound[nc.weight] = weight;
     
     nt_compound.fill();
+    
+    prof.lap(ProfileStage::NtupleFill);
+}
+
+// ============================================================================
+// ANALYSIS WAGONS
+// ============================================================================
+// One wagon = one complete analysis (inputs, histograms, ntuples, cuts)
+// filling its own Manager. Without a "train" section there is exactly one
+// wagon writing to output.filename. All wagons bind their inputs on the
+// same reader, so the union of their branches is read once per event.
+// Wagons reading the same momenta (raw or corrected) share one
+// KinematicsCache, so their kinematics are computed once per event.
+// The event loop itself is in src/event_loop.h.
+// ============================================================================
+
+/**
+ * @brief Inputs and cached kinematics for one momentum selection
+ */
+struct KinematicsCache {
+    bool use_corrected = true;
+    InputSlots inputs;
+    EventCache ev;
+    KinematicsKeys keys;
+};
+
+/**
+ * @brief Frames and kinematics caches of one event-loop thread
+ *
+ * Shared by the wagons of the thread (caches are not thread-safe).
+ */
+struct ThreadKinematics {
+    EventFrames frames;
+    std::vector<std::unique_ptr<KinematicsCache>> caches;
+};
+
+/**
+ * @brief Cache for this momentum selection, created on first use
+ * @param required Further variables every input file must have
+ */
+KinematicsCache& kinematicsFor(ThreadKinematics& thread, NTupleReader& reader, bool use_corrected,
+                               const PParticle& beam, const PParticle& projectile,
+                               const std::vector<std::string>& required = {}) {
+    for (auto& cache : thread.caches) {
+        if (cache->use_corrected == use_corrected) return *cache;
+    }
+    auto cache = std::make_unique<KinematicsCache>();
+    cache->use_corrected = use_corrected;
+    cache->inputs = setupInputs(reader, use_corrected, required);
+    cache->ev.attach(reader);
+    cache->keys = setupKinematics(cache->ev, cache->inputs, beam, projectile, thread.frames);
+    thread.caches.push_back(std::move(cache));
+    return *thread.caches.back();
+}
+
+struct WagonState : AnalysisWagon {
+    std::shared_ptr<ThreadKinematics> thread;   // Owns kin
+    KinematicsCache* kin = nullptr;
+    HistogramHandles histos;
+    NtupleHandles ntuples;
+    CutHandles cut_ids;
+    
+    bool hasInputs() const override {
+        return static_cast<bool>(kin->inputs.complete);
+    }
+    
+    void process(Profiler& prof) override {
+        processEvent(kin->inputs, kin->ev, kin->keys, histos, ntuples, cuts, cut_ids, prof);
+    }
+};
+
+/**
+ * @brief Apply a wagon's cut overrides on top of setupCuts()
+ *
+ * Throws for cut names that setupCuts() does not define, so a typo in the
+ * config cannot silently leave the nominal cut in place.
+ */
+void applyWagonCuts(CutManager& cuts, const AnalysisConfig::WagonDef& def) {
+    for (const auto& p : def.range_cuts) {
+        RangeCut& cut = cuts.getRangeCut(p.first);
+        if (!std::isnan(p.second.first)) cut.min = p.second.first;
+        if (!std::isnan(p.second.second)) cut.max = p.second.second;
+    }
+    for (const auto& name : def.disabled_cuts) {
+        if (cuts.hasRangeCut(name)) {
+            cuts.setRangeCutActive(name, false);
+        } else if (cuts.hasTriggerCut(name)) {
+            cuts.setTriggerCutActive(name, false);
+        } else if (cuts.hasGraphicalCut(name)) {
+            cuts.setGraphicalCutActive(name, false);
+        } else {
+            throw std::runtime_error("Train wagon '" + def.name + "': cannot disable undefined cut '" +
+                                     name + "'");
+        }
+    }
+}
+
+/**
+ * @brief Set up one wagon on its kinematics and a Manager (or Manager shard)
+ */
+std::unique_ptr<WagonState> setupWagon(KinematicsCache& kin, Manager& mgr,
+                                       const AnalysisConfig::WagonDef& def,
+                                       const AnalysisConfig& config) {
+    auto w = std::make_unique<WagonState>();
+    w->name = def.name;
+    w->kin = &kin;
+    w->mgr = &mgr;
+    w->histos = setupHistograms(mgr);
+    w->ntuples = setupNtuples(mgr, config);
+    w->cut_ids = setupCuts(w->cuts);
+    applyWagonCuts(w->cuts, def);
+    return w;
+}
+
+/**
+ * @brief All wagons of one event-loop thread (the WagonBuilder of main())
+ * @param manager Opens the Manager of wagon k, or creates its worker shard
+ *
+ * Every thread gets its own copy of the frames and its own caches.
+ */
+Wagons setupWagons(NTupleReader& reader, const std::function<Manager&(size_t)>& manager,
+                   const std::vector<AnalysisConfig::WagonDef>& defs, const AnalysisConfig& config,
+                   const PParticle& beam, const PParticle& projectile, const EventFrames& frames) {
+    auto thread = std::make_shared<ThreadKinematics>();
+    thread->frames = frames;
+    const std::vector<std::string> required = config.getRequiredVariables();
+    Wagons wagons;
+    for (size_t k = 0; k < defs.size(); ++k) {
+        KinematicsCache& kin = kinematicsFor(*thread, reader, defs[k].use_corrected,
+                                             beam, projectile, required);
+        auto w = setupWagon(kin, manager(k), defs[k], config);
+        w->thread = thread;
+        wagons.push_back(std::move(w));
+    }
+    return wagons;
 }
 
 // ============================================================================
@@ -292,20 +650,39 @@ int main(int argc, char* argv[]) {
     // 1. LOAD CONFIGURATION
     // ========================================================================
     
-    std::string config_file = "config.json";
-    if (argc > 1) {
-        config_file = argv[1];
-    }
-    
+    CommandLine cmd = CommandLine::parse(argc, argv);
     AnalysisConfig config;
     try {
-        config.load(config_file);
+        if (cmd.bad_args) {
+            throw std::runtime_error("Invalid command line");
+        }
+        config.load(cmd.config_file);
     } catch (const std::exception& e) {
         std::cerr << "Error loading configuration: " << e.what() << "\n";
-        std::cerr << "Usage: " << argv[0] << " [config.json]\n";
+        CommandLine::printUsage(argv[0]);
         return 1;
     }
     
+    // Batch jobs and input struct (src/commands.h): no event loop
+    if (cmd.split_jobs > 0) {
+        try {
+            return runSplit(config, cmd.split_jobs, JobSplitter::parseBy(cmd.split_by), argv[0]);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return 1;
+        }
+    }
+    if (cmd.schema) {
+        return runSchema(config, cmd.schema_header, cmd.schema_tree);
+    }
+    if (cmd.merge) {
+        CutManager cuts;
+        setupCuts(cuts);
+        return runMerge(config, cmd.merge_files.front(),
+                        std::vector<std::string>(cmd.merge_files.begin() + 1, cmd.merge_files.end()),
+                        cuts);
+    }
+    
     config.print();
     
     // ========================================================================
@@ -328,130 +705,43 @@ int main(int argc, char* argv[]) {
     frames.setBeamFrame(projectile, target);
     
     // ========================================================================
-    // 3. OPEN INPUT DATA
+    // 3. ANALYSES (one per train wagon)
     // ========================================================================
     
-    NTupleReader reader;
+    // User decides which momentum to use in processEvent()
+    // Set this flag based on your analysis needs (train wagons set their own):
+    bool use_corrected = true;  // Change to false for raw momentum
     
+    std::vector<AnalysisConfig::WagonDef> wagon_defs;
     try {
-        std::string source = config.getInputSource();
-        std::string tree_name = config.getInputTreeName();
-        
-        if (config.isInputFileList()) {
-            reader.openFromList(source, tree_name);
-        } else if (config.isInputRootFile()) {
-            reader.open(source, tree_name);
-        } else {
-            throw std::runtime_error("Unknown input format. Use .root or .list file");
-        }
+        wagon_defs = config.getTrainWagons();
     } catch (const std::exception& e) {
-        std::cerr << "Error opening input: " << e.what() << "\n";
+        std::cerr << "Error in train configuration: " << e.what() << "\n";
         return 1;
     }
-    
-    // ========================================================================
-    // 4. OPEN OUTPUT FILE & SETUP HISTOGRAMS
-    // ========================================================================
-    
-    Manager manager;
-    manager.openFile(config.getOutputFilename(), config.getOutputOption());
-    
-    // Setup histograms (defined in src/setup_histograms.h)
-    setupHistograms(manager);
-    
-    // Setup ntuples (defined in src/setup_ntuples.h)
-    setupNtuples(manager, config);
-    
-    // ========================================================================
-    // 5. SETUP CUTS
-    // ========================================================================
-    
-    CutManager cuts;
-    // Setup cuts (defined in src/setup_cuts.h)
-    setupCuts(cuts);
-    
-    // ========================================================================
-    // 6. EVENT LOOP
-    // ========================================================================
-    
-    Long64_t total_entries = reader.entries();
-    Long64_t start_event = config.getStartEvent();
-    Long64_t max_events = config.getMaxEvents();
-    
-    // Calculate end event
-    Long64_t end_event = total_entries;
-    if (max_events > 0) {
-        end_event = std::min(start_event + max_events, total_entries);
-    }
-    
-    Long64_t events_to_process = end_event - start_event;
-    
-    // User decides which momentum to use in processEvent()
-    // Set this flag based on your analysis needs:
-    bool use_corrected = true;  // Change to false for raw momentum
-    
-    std::cout << "\n";
-    std::cout << "┌───────────────────────────────────────────────────────────────┐\n";
-    std::cout << "│  Press Ctrl+C at any time to stop and save partial results    │\n";
-    std::cout << "└───────────────────────────────────────────────────────────────┘\n";
-    std::cout << "\n";
-    std::cout << "Processing events " << start_event << " to " << end_event 
-              << " (" << events_to_process << " events)...\n";
-    std::cout << "\n";
-    
-    Long64_t processed = 0;
-    bool was_interrupted = false;
-    
-    // Progress bar with time estimation
-    ProgressBar progress(events_to_process);
-    
-    for (Long64_t i = start_event; i < end_event; ++i) {
-        // Check for Ctrl+C - graceful termination
-        if (SignalHandler::wasInterrupted()) {
-            was_interrupted = true;
-            break;
-        }
-        
-        reader.getEntry(i);
-        
-        ++processed;
-        
-        // Update progress bar (updates only on percent change)
-        progress.update(processed);
-        
-        // Process event
-        try {
-            processEvent(reader, manager, cuts, beam, projectile, frames, use_corrected);
-        } catch (const std::exception& e) {
-            // Skip events with missing variables
-            continue;
-        }
+    if (wagon_defs.empty()) {
+        AnalysisConfig::WagonDef single;
+        single.name = "analysis";
+        single.output = config.getOutputFilename();
+        single.use_corrected = use_corrected;
+        wagon_defs.push_back(single);
     }
     
-    // Finish progress bar (shows total elapsed time or interrupted status)
-    progress.finish(was_interrupted);
-    
-    std::cout << "\n";
-    if (was_interrupted) {
-        std::cout << "Processing interrupted by user (Ctrl+C).\n";
-    } else {
-        std::cout << "Processing complete!\n";
-    }
-    std::cout << "  Events processed: " << processed << "\n";
-    
     // ========================================================================
-    // 7. PRINT CUT FLOW
+    // 4. EVENT LOOP, CUT FLOW, SAVE (src/event_loop.h)
     // ========================================================================
     
-    cuts.printCutFlow();
-    
-    // ========================================================================
-    // 8. SAVE AND CLOSE
-    // ========================================================================
-    
-    std::cout << "\nSaving results to " << config.getOutputFilename() << "...\n";
-    manager.printSummary();
-    manager.closeFile();
+    // Each wagon: own output file, histograms (src/setup_histograms.h),
+    // ntuples (src/setup_ntuples.h) and cuts (src/setup_cuts.h); input
+    // slots and kinematics (setupInputs(), setupKinematics() above) on the
+    // reader of each thread
+    EventLoop loop(config, wagon_defs, argv[0], cmd.resume);
+    int status = loop.run([&](NTupleReader& reader, const std::function<Manager&(size_t)>& manager) {
+        return setupWagons(reader, manager, wagon_defs, config, beam, projectile, frames);
+    });
+    if (status != 0) {
+        return status;
+    }
     
     std::cout << "\n";
     std::cout << "╔══════════════════════════════════════════════════════════════════╗\n";
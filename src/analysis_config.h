@@ -9,6 +9,7 @@
  * - Cut definitions
  * - Beam parameters
  * - Analysis flags
+ * - Execution settings (worker threads)
  *
  * Uses a simple built-in JSON parser (no external dependencies).
  *
@@ -29,6 +30,8 @@
 #include <iomanip>
 #include <algorithm>
 #include <cctype>
+#include <thread>
+#include <cmath>
 
 // ============================================================================
 // Simple JSON Value (lightweight implementation)
@@ -42,6 +45,7 @@ public:
     JsonValue(bool b) : type_(BOOL), bool_val_(b) {}
     JsonValue(double n) : type_(NUMBER), num_val_(n) {}
     JsonValue(int n) : type_(NUMBER), num_val_(n) {}
+    JsonValue(long long n) : type_(NUMBER), num_val_(static_cast<double>(n)) {}
     JsonValue(const std::string& s) : type_(STRING), str_val_(s) {}
     JsonValue(const char* s) : type_(STRING), str_val_(s) {}
     
@@ -66,6 +70,11 @@ public:
         return type_ == NUMBER ? static_cast<int>(num_val_) : def;
     }
     
+    /// Entry numbers, sizes and counters (exact below 2^53)
+    long long asLong(long long def = 0) const {
+        return type_ == NUMBER ? static_cast<long long>(num_val_) : def;
+    }
+    
     std::string asString(const std::string& def = "") const {
         return type_ == STRING ? str_val_ : def;
     }
@@ -132,7 +141,80 @@ public:
         if (type_ == OBJECT) obj_val_[key] = v;
     }
     
+    /**
+     * @brief Serialize as JSON text (comments of the source are not kept)
+     * @param indent Indentation of this value's nesting level
+     */
+    std::string dump(int indent = 0) const {
+        std::ostringstream os;
+        write(os, indent);
+        return os.str();
+    }
+    
 private:
+    void write(std::ostream& os, int indent) const {
+        const std::string pad(indent + 4, ' ');
+        switch (type_) {
+            case NONE:   os << "null"; break;
+            case BOOL:   os << (bool_val_ ? "true" : "false"); break;
+            case NUMBER: {
+                // Integral values without exponent (event counts stay exact)
+                if (num_val_ == std::floor(num_val_) && std::fabs(num_val_) < 1e15) {
+                    os << static_cast<long long>(num_val_);
+                } else {
+                    os << std::setprecision(15) << num_val_;
+                }
+                break;
+            }
+            case STRING: writeString(os, str_val_); break;
+            case ARRAY:
+                if (arr_val_.empty()) { os << "[]"; break; }
+                os << "[\n";
+                for (size_t i = 0; i < arr_val_.size(); ++i) {
+                    os << pad;
+                    arr_val_[i].write(os, indent + 4);
+                    os << (i + 1 < arr_val_.size() ? ",\n" : "\n");
+                }
+                os << std::string(indent, ' ') << "]";
+                break;
+            case OBJECT: {
+                if (obj_val_.empty()) { os << "{}"; break; }
+                os << "{\n";
+                size_t i = 0;
+                for (const auto& p : obj_val_) {
+                    os << pad;
+                    writeString(os, p.first);
+                    os << ": ";
+                    p.second.write(os, indent + 4);
+                    os << (++i < obj_val_.size() ? ",\n" : "\n");
+                }
+                os << std::string(indent, ' ') << "}";
+                break;
+            }
+        }
+    }
+    
+    static void writeString(std::ostream& os, const std::string& s) {
+        os << '"';
+        for (char c : s) {
+            switch (c) {
+                case '"':  os << "\\\""; break;
+                case '\\': os << "\\\\"; break;
+                case '\n': os << "\\n"; break;
+                case '\t': os << "\\t"; break;
+                case '\r': os << "\\r"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        os << "\\u00" << "0123456789abcdef"[(c >> 4) & 0xf] << "0123456789abcdef"[c & 0xf];
+                    } else {
+                        os << c;
+                    }
+            }
+        }
+        os << '"';
+    }
+    
+
     Type type_;
     bool bool_val_ = false;
     double num_val_ = 0.0;
@@ -274,6 +356,15 @@ private:
                     case 'r': result += '\r'; break;
                     case '"': result += '"'; break;
                     case '\\': result += '\\'; break;
+                    case 'u':
+                        // Control characters written by JsonValue::dump() (\u00XX)
+                        if (pos + 4 < s.size() && s.compare(pos + 1, 2, "00") == 0) {
+                            result += static_cast<char>(std::stoi(s.substr(pos + 3, 2), nullptr, 16));
+                            pos += 4;
+                        } else {
+                            result += s[pos];
+                        }
+                        break;
                     default: result += s[pos];
                 }
             } else {
@@ -339,14 +430,22 @@ private:
  *   "input": {
  *     "file_list": "h68_10.list",
  *     "tree_name": "PPip_ID",
- *     "max_events": -1
+ *     "max_events": -1,
+ *     "entry_list": "skim_deltaPP.root"
  *   },
  *   "output": {
- *     "filename": "output.root"
+ *     "filename": "output.root",
+ *     "compression": "lz4",
+ *     "compression_level": 4,
+ *     "basket_kb": 256,
+ *     "implicit_mt": 4
  *   },
  *   "beam": {
  *     "kinetic_energy": 1580.0
  *   },
+ *   "execution": {
+ *     "threads": 8
+ *   },
  *   "cuts": {
  *     "neutron_mass": {"min": 0.899, "max": 0.986},
  *     "deltaPP_mass": {"min": 0.8, "max": 1.8}
@@ -356,7 +455,14 @@ private:
  *   },
  *   "graphical_cuts": {
  *     "proton_pid": {"file": "cuts/proton.root", "name": "proton_cut"}
- *   }
+ *   },
+ *   "train": [
+ *     {"name": "nominal", "output": "out_nominal.root"},
+ *     {"name": "raw", "output": "out_raw.root", "use_corrected": false},
+ *     {"name": "tight", "output": "out_tight.root",
+ *      "cuts": {"neutron_mass": {"min": 0.92, "max": 0.96}},
+ *      "disable_cuts": ["deltaPP_mass"]}
+ *   ]
  * }
  * @endcode
  */
@@ -387,6 +493,11 @@ public:
         validate();
     }
     
+    /// Parsed configuration (e.g. to derive the configs of batch jobs)
+    const JsonValue& json() const { return config_; }
+    
+    const std::string& getConfigFile() const { return config_file_; }
+    
     // ========================================================================
     // Input Configuration
     // ========================================================================
@@ -443,6 +554,14 @@ public:
         return config_["input"]["tree_name"].asString("PPip_ID");
     }
     
+    /**
+     * @brief Get storage format of the input
+     * @return "ttree" (default) or "rntuple" (tree_name is the RNTuple name)
+     */
+    std::string getInputFormat() const {
+        return config_["input"]["format"].asString("ttree");
+    }
+    
     /**
      * @brief Get starting event number
      * @return Starting event index (default 0)
@@ -455,6 +574,67 @@ public:
         return static_cast<Long64_t>(config_["input"]["max_events"].asDouble(-1));
     }
     
+    /**
+     * @brief Get events per read block for columnar input reading
+     * @return Block size (default: 0 = read entry by entry)
+     */
+    Long64_t getBlockSize() const {
+        return std::max<Long64_t>(static_cast<Long64_t>(config_["input"]["block_size"].asDouble(0)), 0);
+    }
+    
+    /**
+     * @brief Get local directory of the column cache (see ColumnCache)
+     * @return Directory, e.g. on local NVMe (default: "" = no column cache)
+     *
+     * Used in block mode only.
+     */
+    std::string getColumnCacheDir() const {
+        return config_["input"]["column_cache"].asString("");
+    }
+    
+    /**
+     * @brief Get size limit of the column cache directory
+     * @return Limit in MB (default: 0 = no limit)
+     */
+    int getColumnCacheMB() const {
+        return std::max(config_["input"]["column_cache_mb"].asInt(0), 0);
+    }
+    
+    /**
+     * @brief Get number of chain files to read ahead in the background
+     * @return Prefetch depth (default: 0 = no prefetch; single-threaded runs only)
+     */
+    int getPrefetchDepth() const {
+        return std::max(config_["input"]["prefetch_depth"].asInt(0), 0);
+    }
+    
+    /**
+     * @brief Get TTreeCache size for the input tree
+     * @return Cache size in MB (default: 0 = ROOT default cache)
+     */
+    int getCacheSizeMB() const {
+        return std::max(config_["input"]["cache_size_mb"].asInt(0), 0);
+    }
+    
+    /**
+     * @brief Get entry list (skim index) restricting the input entries
+     * @return ROOT file with a TEntryList (default: "" = all entries)
+     */
+    std::string getInputEntryList() const {
+        return config_["input"]["entry_list"].asString("");
+    }
+    
+    /**
+     * @brief Get dataset index file of a .list input (see DatasetIndex)
+     * @return Index path; "auto" in the config gives "<source>.index.json"
+     *         (default: "" = no index, every file is opened to count entries)
+     */
+    std::string getInputIndex() const {
+        std::string index = config_["input"]["index"].asString("");
+        if (index == "auto") return getInputSource() + ".index.json";
+        return isInputFileList() ? index : "";
+    }
+    
     // ========================================================================
     // Output Configuration
     // ========================================================================
@@ -475,6 +655,41 @@ public:
         return config_["output"]["keep_intermediate_tree"].asBool(false);
     }
     
+    /**
+     * @brief Get DynamicHNtuple storage mode
+     * @param ntuple Ntuple name: its entry in output.ntuple_modes wins over
+     *               output.ntuple_mode ("" = the global mode)
+     * @return "convert" (default), "memory", "tree" or "rntuple"
+     */
+    std::string getNtupleMode(const std::string& ntuple = "") const {
+        const JsonValue& modes = config_["output"]["ntuple_modes"];
+        if (!ntuple.empty() && modes.isObject() && modes.has(ntuple)) {
+            return modes[ntuple].asString("convert");
+        }
+        return config_["output"]["ntuple_mode"].asString("convert");
+    }
+    
+    /**
+     * @brief Check whether the global mode or any per-ntuple mode is 'mode'
+     */
+    bool usesNtupleMode(const std::string& mode) const {
+        if (getNtupleMode() == mode) return true;
+        const JsonValue& modes = config_["output"]["ntuple_modes"];
+        if (!modes.isObject()) return false;
+        for (const auto& name : modes.keys()) {
+            if (modes[name].asString("") == mode) return true;
+        }
+        return false;
+    }
+    
+    /**
+     * @brief Get memory-mode spill threshold per ntuple
+     * @return Size in MB (default: 0 = keep everything in memory)
+     */
+    int getSpillMB() const {
+        return std::max(config_["output"]["spill_mb"].asInt(0), 0);
+    }
+    
     /**
      * @brief Get missing value for DynamicHNtuple
      * @return Sentinel value for missing variables (default: -1.0)
@@ -483,6 +698,83 @@ public:
         return static_cast<Float_t>(config_["output"]["missing_value"].asDouble(-1.0));
     }
     
+    /**
+     * @brief Get output compression algorithm
+     * @return "default" (ROOT's), "none", "zlib", "lzma", "lz4" or "zstd"
+     */
+    std::string getCompression() const {
+        return config_["output"]["compression"].asString("default");
+    }
+    
+    /**
+     * @brief Get output compression level
+     * @return 1-9, or -1 for the algorithm's recommended level (default)
+     */
+    int getCompressionLevel() const {
+        return config_["output"]["compression_level"].asInt(-1);
+    }
+    
+    /**
+     * @brief Get ntuple branch buffer size
+     * @return Size in kB (default: 0 = ROOT default)
+     */
+    int getBasketKB() const {
+        return std::max(config_["output"]["basket_kb"].asInt(0), 0);
+    }
+    
+    /**
+     * @brief Get TTree auto-flush setting for ntuples
+     * @return > 0 entries, < 0 bytes per cluster (default: 0 = ROOT default)
+     */
+    Long64_t getAutoFlush() const {
+        return static_cast<Long64_t>(config_["output"]["auto_flush"].asDouble(0));
+    }
+    
+    /**
+     * @brief Get ROOT implicit multi-threading pool size
+     * @return Threads (default: 0 = off); negative means all hardware threads
+     */
+    int getImplicitMT() const {
+        int threads = config_["output"]["implicit_mt"].asInt(0);
+        if (threads < 0) {
+            threads = static_cast<int>(std::thread::hardware_concurrency());
+        }
+        return threads;
+    }
+    
+    /**
+     * @brief Get number of threads merging worker shards at close
+     * @return Threads (default: 0 = same as execution threads)
+     */
+    int getMergeThreads() const {
+        int threads = config_["output"]["merge_threads"].asInt(0);
+        return threads > 0 ? threads : getThreads();
+    }
+    
+    /**
+     * @brief Get number of fills buffered per histogram handle
+     * @return Values per 1D/2D handle passed to TH1::FillN at once (default: 0 = direct Fill)
+     */
+    int getFillBuffer() const {
+        return std::max(config_["output"]["fill_buffer"].asInt(0), 0);
+    }
+    
+    /**
+     * @brief Get file for the entry list of events passing the cut flow
+     * @return ROOT file for a TEntryList (default: "" = not written)
+     */
+    std::string getOutputEntryList() const {
+        return config_["output"]["entry_list"].asString("");
+    }
+    
+    /**
+     * @brief Get last cut an event must pass to enter the entry list
+     * @return Cut name (default: "" = the whole cut flow)
+     */
+    std::string getOutputEntryListCut() const {
+        return config_["output"]["entry_list_cut"].asString("");
+    }
+    
     // ========================================================================
     // Beam Configuration
     // ========================================================================
@@ -491,6 +783,95 @@ public:
         return config_["beam"]["kinetic_energy"].asDouble(1580.0);
     }
     
+    // ========================================================================
+    // Execution Configuration
+    // ========================================================================
+    
+    /**
+     * @brief Get number of event-loop worker threads
+     * @return Requested threads (default: 1 = serial); 0 means all hardware threads
+     */
+    int getThreads() const {
+        int threads = config_["execution"]["threads"].asInt(1);
+        if (threads <= 0) {
+            threads = static_cast<int>(std::thread::hardware_concurrency());
+        }
+        return std::max(threads, 1);
+    }
+    
+    /**
+     * @brief Get how entries are handed to worker threads
+     * @return "static" (default): one fixed range per worker, output
+     *         identical from run to run; "steal": chunks of whole clusters,
+     *         idle workers take over the tail of the busiest range (faster
+     *         on uneven inputs, but shard contents depend on thread timing)
+     */
+    std::string getScheduler() const {
+        return config_["execution"]["scheduler"].asString("static");
+    }
+    
+    /**
+     * @brief Get the minimum entries per scheduled chunk
+     * @return Entries (default: 0 = one cluster, or 10000 entries when the
+     *         cluster boundaries are not known)
+     */
+    Long64_t getChunkEvents() const {
+        return static_cast<Long64_t>(config_["execution"]["chunk_events"].asDouble(0));
+    }
+    
+    /**
+     * @brief Get how worker threads are pinned to CPUs
+     * @return "none" (default), "cores" (one CPU per worker) or "numa"
+     *         (workers spread over the NUMA nodes, each on its node's CPUs)
+     */
+    std::string getPinThreads() const {
+        return config_["execution"]["pin_threads"].asString("none");
+    }
+    
+    /**
+     * @brief Get whether the event-loop profiler is enabled
+     * @return true to print a per-stage timing report (default: false)
+     */
+    bool getProfiling() const {
+        return config_["execution"]["profiling"].asBool(false);
+    }
+    
+    /**
+     * @brief Get file for the JSON profiling report
+     * @return Filename (default: "" = no JSON report)
+     */
+    std::string getProfileOutput() const {
+        return config_["execution"]["profile_output"].asString("");
+    }
+    
+    /**
+     * @brief Get checkpoint interval in events
+     * @return Events between checkpoints (default: 0 = no event interval)
+     */
+    Long64_t getCheckpointEvents() const {
+        return static_cast<Long64_t>(config_["execution"]["checkpoint_events"].asDouble(0));
+    }
+    
+    /**
+     * @brief Get checkpoint interval in wall-clock minutes
+     * @return Minutes between checkpoints (default: 0 = no time interval)
+     */
+    double getCheckpointMinutes() const {
+        return config_["execution"]["checkpoint_minutes"].asDouble(0.0);
+    }
+    
+    /**
+     * @brief Get checkpoint state file (read by --resume)
+     * @return Filename (default: output filename with ".ckpt.json")
+     */
+    std::string getCheckpointFile() const {
+        std::string file = config_["execution"]["checkpoint_file"].asString("");
+        if (!file.empty()) return file;
+        std::string output = getOutputFilename();
+        size_t dot = output.rfind('.');
+        return (dot != std::string::npos ? output.substr(0, dot) : output) + ".ckpt.json";
+    }
+    
     // ========================================================================
     // Cut Configuration
     // ========================================================================
@@ -556,6 +937,74 @@ public:
         return gcuts;
     }
     
+    // ========================================================================
+    // Train Mode (several analyses over one input pass)
+    // ========================================================================
+    
+    /**
+     * @brief One analysis variant ("wagon") of the train
+     *
+     * Each wagon gets its own output file, Manager and CutManager. Cuts
+     * come from setupCuts(); 'range_cuts' replaces the windows of
+     * already defined range cuts (a bound left out, NaN here, keeps the
+     * setupCuts() value) and 'disabled_cuts' switches cuts off.
+     */
+    struct WagonDef {
+        std::string name;
+        std::string output;
+        bool use_corrected = true;
+        std::map<std::string, std::pair<double, double>> range_cuts;
+        std::vector<std::string> disabled_cuts;
+    };
+    
+    /**
+     * @brief Get train wagons
+     * @return Wagon definitions (empty = no "train" section, single analysis)
+     *
+     * Throws if a wagon has no output file or two wagons share one.
+     */
+    std::vector<WagonDef> getTrainWagons() const {
+        std::vector<WagonDef> wagons;
+        const JsonValue& train = config_["train"];
+        
+        for (size_t i = 0; i < train.size(); ++i) {
+            const JsonValue& w = train[i];
+            WagonDef def;
+            def.name = w["name"].asString("wagon" + std::to_string(i));
+            def.output = w["output"].asString();
+            def.use_corrected = w["use_corrected"].asBool(true);
+            
+            const JsonValue& cuts_obj = w["cuts"];
+            for (const auto& cut : cuts_obj.keys()) {
+                const JsonValue& window = cuts_obj[cut];
+                if (!window.has("min") && !window.has("max")) {
+                    throw std::runtime_error("AnalysisConfig: train wagon '" + def.name + "' cut '" +
+                                             cut + "' sets neither \"min\" nor \"max\"");
+                }
+                const double keep = std::nan("");
+                def.range_cuts[cut] = {window.has("min") ? window["min"].asDouble(0) : keep,
+                                       window.has("max") ? window["max"].asDouble(0) : keep};
+            }
+            const JsonValue& disabled = w["disable_cuts"];
+            for (size_t k = 0; k < disabled.size(); ++k) {
+                def.disabled_cuts.push_back(disabled[k].asString());
+            }
+            
+            if (def.output.empty()) {
+                throw std::runtime_error("AnalysisConfig: train wagon '" + def.name +
+                                         "' has no \"output\" file");
+            }
+            for (const auto& other : wagons) {
+                if (other.output == def.output) {
+                    throw std::runtime_error("AnalysisConfig: train wagons '" + other.name +
+                                             "' and '" + def.name + "' share output " + def.output);
+                }
+            }
+            wagons.push_back(def);
+        }
+        return wagons;
+    }
+    
     // ========================================================================
     // Variable Configuration (optional - which variables to read)
     // ========================================================================
@@ -632,16 +1081,99 @@ public:
         else if (isInputFileList()) source_info += " (file list)";
         os << "║   Source: " << std::left << std::setw(53) << source_info << "║\n";
         os << "║   Tree: " << std::left << std::setw(55) << getInputTreeName() << "║\n";
+        if (getInputFormat() != "ttree") {
+            os << "║   Format: " << std::left << std::setw(53) << getInputFormat() << "║\n";
+        }
         os << "║   Start event: " << std::left << std::setw(48) << getStartEvent() << "║\n";
         os << "║   Max events: " << std::left << std::setw(49) << getMaxEvents() << "║\n";
+        if (getBlockSize() > 0) {
+            os << "║   Block size: " << std::left << std::setw(49) << getBlockSize() << "║\n";
+        }
+        if (!getColumnCacheDir().empty()) {
+            std::string column_cache = getColumnCacheDir();
+            if (getColumnCacheMB() > 0) column_cache += " (max " + std::to_string(getColumnCacheMB()) + " MB)";
+            os << "║   Column cache: " << std::left << std::setw(47) << column_cache << "║\n";
+        }
+        if (getPrefetchDepth() > 0) {
+            os << "║   Prefetch depth: " << std::left << std::setw(45) << getPrefetchDepth() << "║\n";
+        }
+        if (getCacheSizeMB() > 0) {
+            std::ostringstream cache_str;
+            cache_str << getCacheSizeMB() << " MB";
+            os << "║   Read cache: " << std::left << std::setw(49) << cache_str.str() << "║\n";
+        }
+        if (!getInputEntryList().empty()) {
+            os << "║   Entry list: " << std::left << std::setw(49) << getInputEntryList() << "║\n";
+        }
+        if (!getInputIndex().empty()) {
+            os << "║   Index: " << std::left << std::setw(54) << getInputIndex() << "║\n";
+        }
         os << "║                                                                ║\n";
         os << "║ Output:                                                        ║\n";
-        os << "║   File: " << std::left << std::setw(55) << getOutputFilename() << "║\n";
+        size_t train_size = config_["train"].size();
+        if (train_size > 0) {
+            std::ostringstream train_str;
+            train_str << train_size << " wagons (one output file each)";
+            os << "║   Train: " << std::left << std::setw(54) << train_str.str() << "║\n";
+        } else {
+            os << "║   File: " << std::left << std::setw(55) << getOutputFilename() << "║\n";
+        }
+        os << "║   Ntuple mode: " << std::left << std::setw(48) << getNtupleMode() << "║\n";
+        const JsonValue& modes = config_["output"]["ntuple_modes"];
+        if (modes.isObject()) {
+            for (const auto& name : modes.keys()) {
+                os << "║     " << std::left << std::setw(59) << (name + ": " + modes[name].asString("")) << "║\n";
+            }
+        }
+        if (getCompression() != "default") {
+            std::ostringstream comp_str;
+            comp_str << getCompression();
+            if (getCompressionLevel() > 0) comp_str << " level " << getCompressionLevel();
+            os << "║   Compression: " << std::left << std::setw(48) << comp_str.str() << "║\n";
+        }
+        if (getBasketKB() > 0) {
+            std::ostringstream basket_str;
+            basket_str << getBasketKB() << " kB";
+            os << "║   Basket size: " << std::left << std::setw(48) << basket_str.str() << "║\n";
+        }
+        if (getFillBuffer() > 0) {
+            std::ostringstream buffer_str;
+            buffer_str << getFillBuffer() << " fills per histogram";
+            os << "║   Fill buffer: " << std::left << std::setw(48) << buffer_str.str() << "║\n";
+        }
+        if (getImplicitMT() > 0) {
+            os << "║   Implicit MT: " << std::left << std::setw(48) << getImplicitMT() << "║\n";
+        }
+        if (!getOutputEntryList().empty()) {
+            std::string cut = getOutputEntryListCut();
+            std::string skim_str = getOutputEntryList() + " (" + (cut.empty() ? "all cuts" : cut) + ")";
+            os << "║   Entry list: " << std::left << std::setw(49) << skim_str << "║\n";
+        }
         os << "║                                                                ║\n";
         os << "║ Beam:                                                          ║\n";
         std::ostringstream ke_str;
         ke_str << getBeamKineticEnergy() << " MeV";
         os << "║   Kinetic energy: " << std::left << std::setw(45) << ke_str.str() << "║\n";
+        os << "║                                                                ║\n";
+        os << "║ Execution:                                                     ║\n";
+        os << "║   Threads: " << std::left << std::setw(52) << getThreads() << "║\n";
+        if (getThreads() > 1) {
+            std::string sched_str = getScheduler();
+            if (getChunkEvents() > 0) sched_str += ", chunks of " + std::to_string(getChunkEvents()) + " events";
+            if (getPinThreads() != "none") sched_str += ", pinned: " + getPinThreads();
+            os << "║   Scheduler: " << std::left << std::setw(50) << sched_str << "║\n";
+        }
+        if (getProfiling()) {
+            os << "║   Profiling: " << std::left << std::setw(50) << "on" << "║\n";
+        }
+        if (getCheckpointEvents() > 0 || getCheckpointMinutes() > 0) {
+            std::ostringstream ckpt_str;
+            ckpt_str << "every ";
+            if (getCheckpointEvents() > 0) ckpt_str << getCheckpointEvents() << " events";
+            if (getCheckpointEvents() > 0 && getCheckpointMinutes() > 0) ckpt_str << " or ";
+            if (getCheckpointMinutes() > 0) ckpt_str << getCheckpointMinutes() << " min";
+            os << "║   Checkpoints: " << std::left << std::setw(48) << ckpt_str.str() << "║\n";
+        }
         os << "╚════════════════════════════════════════════════════════════════╝\n";
     }
 
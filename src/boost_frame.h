@@ -2,6 +2,7 @@
 #define BOOSTFRAME_H
 
 #include "pparticle.h"
+#include "particle_block.h"
 #include <vector>
 #include <memory>
 
@@ -46,7 +47,9 @@ public:
     explicit BoostFrame(const PParticle& reference,
                        MomentumType type = MomentumType::RECONSTRUCTED)
         : boost_vector_(-reference.boostVector(type)),
-          name_(reference.name() + "_frame") {}
+          name_(reference.name() + "_frame") {
+        cacheComponents();
+    }
 
     /**
      * @brief Construct boost frame from explicit boost vector
@@ -55,7 +58,9 @@ public:
      */
     explicit BoostFrame(const TVector3& beta_vector,
                        const std::string& name = "custom_frame")
-        : boost_vector_(beta_vector), name_(name) {}
+        : boost_vector_(beta_vector), name_(name) {
+        cacheComponents();
+    }
 
     /**
      * @brief Construct beam rest frame (z-axis boost only)
@@ -76,7 +81,7 @@ public:
      */
     PParticle boost(const PParticle& particle) const {
         PParticle boosted(particle);
-        boosted.boost(boost_vector_);
+        boosted.boost(bx_, by_, bz_);
         return boosted;
     }
 
@@ -85,7 +90,7 @@ public:
      * @param particle Particle to modify
      */
     void applyTo(PParticle& particle) const {
-        particle.boost(boost_vector_);
+        particle.boost(bx_, by_, bz_);
     }
 
     /**
@@ -108,10 +113,18 @@ public:
      */
     void applyTo(std::vector<PParticle>& particles) const {
         for (auto& p : particles) {
-            p.boost(boost_vector_);
+            p.boost(bx_, by_, bz_);
         }
     }
 
+    /**
+     * @brief Apply boost to a whole block of events in-place (vectorized)
+     * @param block ParticleBlock to modify
+     */
+    void applyTo(ParticleBlock& block) const {
+        block.boost(bx_, by_, bz_);
+    }
+
     // ========================================================================
     // Accessors
     // ========================================================================
@@ -125,7 +138,15 @@ public:
     }
 
 private:
+    /// Plain copies of the boost vector for the FourVector boost kernel
+    void cacheComponents() {
+        bx_ = boost_vector_.X();
+        by_ = boost_vector_.Y();
+        bz_ = boost_vector_.Z();
+    }
+
     TVector3 boost_vector_;  ///< Cached boost velocity
+    double bx_ = 0.0, by_ = 0.0, bz_ = 0.0;
     std::string name_;       ///< Frame identifier
 };
 
@@ -0,0 +1,255 @@
+/**
+ * @file candidate_arena.h
+ * @brief Per-event arena for track lists and their combinations
+ *
+ * Events with several tracks per species (pp -> pp pi+ pi-, dileptons)
+ * need every pair or triplet of candidates. Building these as std::vector
+ * per event calls the global allocator hundreds of times per event. The
+ * CandidateArena keeps all per-event lists in one monotonic buffer
+ * (std::pmr::monotonic_buffer_resource) that is released in one step when
+ * the NTupleReader loads the next entry, so steady-state events allocate
+ * nothing.
+ *
+ * Example usage:
+ *   ArraySlot p_p = reader.arraySlot("p_p"), ...;    // setup (once)
+ *   CandidateArena arena;
+ *   arena.attach(reader);
+ *
+ *   reader.getEntry(i);                              // event loop
+ *   ParticleList protons = arena.particles(Physics::MASS_PROTON, "p", p_p, p_theta, p_phi);
+ *   ParticleList pims = arena.particles(Physics::MASS_PION_MINUS, "pi-", pim_p, pim_theta, pim_phi);
+ *   for (const auto& c : arena.pairs(protons, pims)) {  // every (p_i, pi-_j)
+ *       h_mass.fill(c.sum.massGeV());
+ *   }
+ *   for (const auto& c : arena.pairs(protons, protons)) { ... }  // p_i p_j, i < j
+ *
+ * Lists and combinations are valid until the next event.
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef CANDIDATE_ARENA_H
+#define CANDIDATE_ARENA_H
+
+#include "ntuple_reader.h"
+#include "pparticle.h"
+#include <algorithm>
+#include <array>
+#include <memory_resource>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Combination: Sum of N Candidates and Where They Came From
+// ============================================================================
+
+using ParticleList = std::pmr::vector<PParticle>;
+
+/**
+ * @struct Combination
+ * @brief N candidates added up, with their positions in the source lists
+ */
+template <size_t N>
+struct Combination {
+    PParticle sum;                   ///< Sum of the members (name "p+pi-", ...)
+    std::array<Int_t, N> index;      ///< Position of member k in list k
+};
+
+template <size_t N>
+using CombinationList = std::pmr::vector<Combination<N>>;
+
+// ============================================================================
+// CandidateArena: Monotonic Per-Event Storage
+// ============================================================================
+/**
+ * @class CandidateArena
+ * @brief Track lists and combinations that live for one event
+ *
+ * Everything is allocated from a monotonic buffer. When an event needs
+ * more than the buffer, the excess comes from the heap once and the
+ * buffer is enlarged at the next reset(), so the arena settles at the
+ * largest event seen.
+ *
+ * Not thread-safe: use one arena per event-loop thread.
+ */
+class CandidateArena {
+public:
+    explicit CandidateArena(size_t initial_bytes = 64 * 1024)
+        : buffer_(std::max<size_t>(initial_bytes, 1024)) {
+        resource_.emplace(buffer_.data(), buffer_.size(), &upstream_);
+    }
+
+    // The resource points into buffer_; do not copy the arena
+    CandidateArena(const CandidateArena&) = delete;
+    CandidateArena& operator=(const CandidateArena&) = delete;
+
+    // ========================================================================
+    // Setup
+    // ========================================================================
+
+    /**
+     * @brief Reset automatically whenever the reader loads an entry
+     */
+    void attach(const NTupleReader& reader) {
+        reader_ = &reader;
+        reader_serial_ = reader.readSerial();
+    }
+
+    /**
+     * @brief Drop all lists of the current event (explicit new event)
+     */
+    void reset() {
+        resource_.reset();   // also returns what overflowed to the heap
+        if (upstream_.bytes > 0) {
+            buffer_.assign(buffer_.size() + upstream_.bytes, 0);
+            upstream_.bytes = 0;
+            ++grown_;
+        }
+        resource_.emplace(buffer_.data(), buffer_.size(), &upstream_);
+    }
+
+    // ========================================================================
+    // Per-Event Lists
+    // ========================================================================
+
+    /**
+     * @brief Empty list of any type in the arena
+     */
+    template <typename T>
+    std::pmr::vector<T> list() {
+        sync();
+        return std::pmr::vector<T>(&*resource_);
+    }
+
+    /**
+     * @brief One particle per array element (p, theta, phi as in ParticleFactory)
+     *
+     * Throws if the arrays differ in length.
+     */
+    ParticleList particles(double mass, const char* name,
+                           const ArraySlot& p, const ArraySlot& theta, const ArraySlot& phi,
+                           MomentumType type = MomentumType::RECONSTRUCTED) {
+        if (theta.size() != p.size() || phi.size() != p.size()) {
+            throw std::runtime_error(std::string("CandidateArena::particles() - '") + name +
+                                   "' arrays differ in length (p " + std::to_string(p.size()) +
+                                   ", theta " + std::to_string(theta.size()) +
+                                   ", phi " + std::to_string(phi.size()) + ")");
+        }
+        ParticleList out = list<PParticle>();
+        out.reserve(p.size());
+        for (size_t i = 0; i < p.size(); ++i) {
+            out.emplace_back(mass, name);
+            out.back().setFromSpherical(p[i], theta[i], phi[i], type);
+        }
+        return out;
+    }
+
+    // ========================================================================
+    // Combinatorics
+    // ========================================================================
+
+    /**
+     * @brief Every combination of one candidate from each list
+     *
+     * A list given more than once contributes distinct candidates in
+     * increasing index order (p_i p_j with i < j), so no track is used
+     * twice and each unordered set appears once.
+     */
+    template <size_t N>
+    CombinationList<N> combine(const std::array<const ParticleList*, N>& lists) {
+        static_assert(N >= 2, "CandidateArena::combine() needs at least two lists");
+        CombinationList<N> out = list<Combination<N>>();
+
+        // Reserve the upper bound: growing a vector in a monotonic buffer
+        // leaves every old copy behind
+        size_t bound = 1;
+        for (const ParticleList* l : lists) bound *= l->size();
+        if (bound == 0) return out;
+        out.reserve(bound);
+
+        std::array<Int_t, N> index{};
+        const ParticleList& first = *lists[0];
+        for (Int_t i = 0; i < static_cast<Int_t>(first.size()); ++i) {
+            index[0] = i;
+            extend(lists, 1, first[i], index, out);
+        }
+        return out;
+    }
+
+    CombinationList<2> pairs(const ParticleList& a, const ParticleList& b) {
+        return combine<2>({&a, &b});
+    }
+
+    CombinationList<3> triplets(const ParticleList& a, const ParticleList& b, const ParticleList& c) {
+        return combine<3>({&a, &b, &c});
+    }
+
+    // ========================================================================
+    // Statistics
+    // ========================================================================
+
+    /// Bytes available per event without touching the heap
+    size_t capacity() const { return buffer_.size(); }
+
+    /// Number of resets that had to enlarge the buffer
+    int timesGrown() const { return grown_; }
+
+private:
+    /**
+     * @brief Heap fallback of the monotonic resource, counting what it hands out
+     */
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        size_t bytes = 0;
+
+    private:
+        void* do_allocate(size_t bytes_needed, size_t alignment) override {
+            bytes += bytes_needed;
+            return std::pmr::new_delete_resource()->allocate(bytes_needed, alignment);
+        }
+        void do_deallocate(void* p, size_t bytes_used, size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, bytes_used, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    template <size_t N>
+    void extend(const std::array<const ParticleList*, N>& lists, size_t depth,
+                const PParticle& partial, std::array<Int_t, N>& index, CombinationList<N>& out) {
+        // Same list as an earlier member: continue after that member
+        Int_t start = 0;
+        for (size_t d = 0; d < depth; ++d) {
+            if (lists[d] == lists[depth]) start = index[d] + 1;
+        }
+        const ParticleList& current = *lists[depth];
+        for (Int_t i = start; i < static_cast<Int_t>(current.size()); ++i) {
+            index[depth] = i;
+            if (depth + 1 == N) {
+                out.push_back(Combination<N>{partial + current[i], index});
+            } else {
+                extend(lists, depth + 1, partial + current[i], index, out);
+            }
+        }
+    }
+
+    void sync() {
+        if (reader_ && reader_->readSerial() != reader_serial_) {
+            reader_serial_ = reader_->readSerial();
+            reset();
+        }
+    }
+
+    std::vector<unsigned char> buffer_;
+    CountingResource upstream_;
+    std::optional<std::pmr::monotonic_buffer_resource> resource_;
+    const NTupleReader* reader_ = nullptr;
+    Long64_t reader_serial_ = 0;
+    int grown_ = 0;
+};
+
+#endif // CANDIDATE_ARENA_H
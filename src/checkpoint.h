@@ -0,0 +1,429 @@
+/**
+ * @file checkpoint.h
+ * @brief Periodic checkpoints of the event loop and resume after a crash
+ *
+ * A batch job that is killed or preempted would otherwise have to start
+ * again from start_event. With checkpoints enabled the event loop stops at
+ * an event boundary every N events or M minutes and saves:
+ * - the histograms of every wagon, summed over worker shards (a ROOT
+ *   snapshot file next to the output)
+ * - the cut-flow counters
+ * - the DynamicHNtuple entries, sealed into segment files that are never
+ *   written again
+ * - the next entry of every entry range and the worker that owns it
+ *
+ * The JSON state file is written last and replaced atomically, so it
+ * always describes a complete checkpoint. `./ana config.json --resume`
+ * restores it and processes only the remaining entries. Histograms and
+ * cut flow then equal those of an uninterrupted run; ntuples contain the
+ * same rows (in memory mode with several threads, checkpointed rows come
+ * first).
+ *
+ * Usage Example:
+ * @code
+ *   CheckpointSchedule schedule(options, processed);
+ *   // event loop: stop at the event boundary once schedule.due(processed)
+ *   state.ranges[0].next = next_entry;
+ *   ++state.serial;
+ *   // per wagon: Manager::writeSnapshot(), addCuts(), addNtuples()
+ *   state.write(options.file);
+ *   schedule.reset(processed);
+ * @endcode
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <Rtypes.h>
+#include "analysis_config.h"
+#include "cut_manager.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// CheckpointOptions: When and Where
+// ============================================================================
+
+/**
+ * @struct CheckpointOptions
+ * @brief Checkpoint interval and state file (from "execution" in the config)
+ */
+struct CheckpointOptions {
+    Long64_t every_events = 0;     ///< Checkpoint after this many events (0 = off)
+    double every_minutes = 0.0;    ///< ... or after this much wall time (0 = off)
+    std::string file;              ///< JSON state file
+
+    bool enabled() const { return every_events > 0 || every_minutes > 0; }
+};
+
+// ============================================================================
+// CheckpointSchedule: Is a Checkpoint Due?
+// ============================================================================
+/**
+ * @class CheckpointSchedule
+ * @brief Event and wall-time trigger, cheap enough to ask once per event
+ *
+ * The clock is read at most once per kClockStride events. Not
+ * thread-safe: ask from one thread (the serial loop or the main thread
+ * supervising the workers).
+ */
+class CheckpointSchedule {
+public:
+    static constexpr Long64_t kClockStride = 1024;
+
+    CheckpointSchedule() = default;
+
+    CheckpointSchedule(const CheckpointOptions& options, Long64_t processed)
+        : every_events_(options.every_events), every_seconds_(options.every_minutes * 60.0) {
+        reset(processed);
+    }
+
+    bool enabled() const { return every_events_ > 0 || every_seconds_ > 0; }
+
+    /**
+     * @brief True once the next checkpoint is due
+     * @param processed Events processed so far (all threads)
+     */
+    bool due(Long64_t processed) {
+        if (every_events_ > 0 && processed >= next_events_) return true;
+        if (every_seconds_ > 0 && processed - clock_checked_ >= kClockStride) {
+            clock_checked_ = processed;
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - last_).count() >=
+                   every_seconds_;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Start the next interval (after a checkpoint was written)
+     */
+    void reset(Long64_t processed) {
+        next_events_ = processed + every_events_;
+        clock_checked_ = processed;
+        last_ = std::chrono::steady_clock::now();
+    }
+
+private:
+    Long64_t every_events_ = 0;
+    double every_seconds_ = 0.0;
+    Long64_t next_events_ = 0;
+    Long64_t clock_checked_ = 0;
+    std::chrono::steady_clock::time_point last_ = std::chrono::steady_clock::now();
+};
+
+// ============================================================================
+// CheckpointState: Everything Needed to Continue
+// ============================================================================
+/**
+ * @struct CheckpointState
+ * @brief Contents of the JSON state file
+ *
+ * Histogram contents and ntuple entries live in the files it names; the
+ * state itself holds the entry ranges and the cut counters.
+ */
+struct CheckpointState {
+    /// Entries [first, last) of one worker (one range in serial mode)
+    struct Range {
+        Long64_t first = 0;
+        Long64_t next = 0;    ///< First entry not processed yet
+        Long64_t last = 0;
+        int worker = 0;       ///< Owning worker (the shard whose segments cover it)
+    };
+
+    /// Segments of one ntuple as filled by one Manager
+    struct NtupleSegments {
+        std::string name;
+        int shard = -1;                    ///< -1 = the wagon's Manager, k = worker shard k
+        std::vector<std::string> files;    ///< DynamicHNtuple::checkpoint(), oldest first
+    };
+
+    struct Wagon {
+        std::string name;
+        std::string output;
+        std::string snapshot;              ///< Histogram snapshot (Manager::writeSnapshot())
+        Long64_t flow_events = 0;
+        Long64_t skipped_events = 0;
+        std::vector<CutManager::StepCounts> cuts;
+        std::vector<NtupleSegments> ntuples;
+
+        /// Segments filled by one Manager, as Manager::restoreNtuples() takes them
+        std::map<std::string, std::vector<std::string>> segments(int shard) const {
+            std::map<std::string, std::vector<std::string>> result;
+            for (const auto& nt : ntuples) {
+                if (nt.shard == shard) result[nt.name] = nt.files;
+            }
+            return result;
+        }
+    };
+
+    int serial = 0;                 ///< Number of checkpoints written
+    Long64_t input_entries = 0;     ///< Entries of the input when the job started
+    Long64_t start_event = 0;
+    Long64_t end_event = 0;
+    std::vector<Range> ranges;      ///< At least one per worker (more after work stealing)
+    std::vector<Wagon> wagons;
+
+    // ========================================================================
+    // Progress
+    // ========================================================================
+
+    Long64_t processed() const {
+        Long64_t done = 0;
+        for (const Range& r : ranges) done += r.next - r.first;
+        return done;
+    }
+
+    /// Number of workers the ranges belong to
+    int workers() const {
+        int n = 1;
+        for (const Range& r : ranges) n = std::max(n, r.worker + 1);
+        return n;
+    }
+
+    // ========================================================================
+    // Collecting a Checkpoint
+    // ========================================================================
+
+    /**
+     * @brief Add the counters of one CutManager (wagon or worker) to a wagon
+     */
+    static void addCuts(Wagon& wagon, const CutManager& cuts) {
+        for (const auto& c : cuts.statistics()) {
+            bool found = false;
+            for (auto& own : wagon.cuts) {
+                if (own.kind == c.kind && own.name == c.name) {
+                    own.tested += c.tested;
+                    own.passed += c.passed;
+                    own.flow_passed += c.flow_passed;
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) wagon.cuts.push_back(c);
+        }
+        wagon.flow_events += cuts.flowEvents();
+        wagon.skipped_events += cuts.skippedEvents();
+    }
+
+    /**
+     * @brief Record the segments returned by Manager::checkpointNtuples()
+     */
+    static void addNtuples(Wagon& wagon, int shard,
+                           const std::map<std::string, std::vector<std::string>>& segments) {
+        for (const auto& pair : segments) {
+            if (!pair.second.empty()) {
+                wagon.ntuples.push_back(NtupleSegments{pair.first, shard, pair.second});
+            }
+        }
+    }
+
+    /**
+     * @brief Histogram snapshot file of a wagon ("out.root" -> "out.ckpt3.root")
+     */
+    static std::string snapshotFile(const std::string& output, int serial) {
+        size_t dot = output.rfind('.');
+        std::string base = dot != std::string::npos ? output.substr(0, dot) : output;
+        return base + ".ckpt" + std::to_string(serial) + ".root";
+    }
+
+    // ========================================================================
+    // Resume Checks
+    // ========================================================================
+
+    /**
+     * @brief Throw unless this checkpoint belongs to the given job
+     */
+    void checkMatches(Long64_t entries, Long64_t start, Long64_t end,
+                      const std::vector<AnalysisConfig::WagonDef>& defs) const {
+        if (entries != input_entries) {
+            throw std::runtime_error("Checkpoint: input has " + std::to_string(entries) +
+                                     " entries, checkpoint was taken on " +
+                                     std::to_string(input_entries));
+        }
+        if (start != start_event || end != end_event) {
+            throw std::runtime_error("Checkpoint: event range " + std::to_string(start) + "-" +
+                                     std::to_string(end) + " differs from checkpointed " +
+                                     std::to_string(start_event) + "-" + std::to_string(end_event));
+        }
+        if (defs.size() != wagons.size()) {
+            throw std::runtime_error("Checkpoint: " + std::to_string(wagons.size()) +
+                                     " train wagons checkpointed, config has " +
+                                     std::to_string(defs.size()));
+        }
+        for (size_t k = 0; k < defs.size(); ++k) {
+            if (defs[k].name != wagons[k].name || defs[k].output != wagons[k].output) {
+                throw std::runtime_error("Checkpoint: wagon '" + defs[k].name + "' (" + defs[k].output +
+                                         ") does not match checkpointed '" + wagons[k].name + "'");
+            }
+        }
+    }
+
+    // ========================================================================
+    // File I/O
+    // ========================================================================
+
+    /**
+     * @brief Write the state file (via a temporary file and rename)
+     */
+    void write(const std::string& filename) const {
+        JsonValue json = JsonValue::object();
+        json.set("version", 1);
+        json.set("serial", serial);
+        json.set("input_entries", input_entries);
+        json.set("start_event", start_event);
+        json.set("end_event", end_event);
+        JsonValue json_ranges = JsonValue::array();
+        for (const Range& r : ranges) {
+            JsonValue range = JsonValue::object();
+            range.set("first", r.first);
+            range.set("next", r.next);
+            range.set("last", r.last);
+            range.set("worker", r.worker);
+            json_ranges.push_back(range);
+        }
+        json.set("ranges", json_ranges);
+        JsonValue json_wagons = JsonValue::array();
+        for (const Wagon& w : wagons) {
+            JsonValue wagon = JsonValue::object();
+            wagon.set("name", w.name);
+            wagon.set("output", w.output);
+            wagon.set("snapshot", w.snapshot);
+            wagon.set("flow_events", w.flow_events);
+            wagon.set("skipped_events", w.skipped_events);
+            JsonValue cuts = JsonValue::array();
+            for (const auto& c : w.cuts) {
+                JsonValue cut = JsonValue::object();
+                cut.set("kind", kindName(c.kind));
+                cut.set("name", c.name);
+                cut.set("tested", c.tested);
+                cut.set("passed", c.passed);
+                cut.set("flow_passed", c.flow_passed);
+                cuts.push_back(cut);
+            }
+            wagon.set("cuts", cuts);
+            JsonValue ntuples = JsonValue::array();
+            for (const auto& nt : w.ntuples) {
+                JsonValue ntuple = JsonValue::object();
+                ntuple.set("name", nt.name);
+                ntuple.set("shard", nt.shard);
+                JsonValue files = JsonValue::array();
+                for (const auto& f : nt.files) files.push_back(f);
+                ntuple.set("files", files);
+                ntuples.push_back(ntuple);
+            }
+            wagon.set("ntuples", ntuples);
+            json_wagons.push_back(wagon);
+        }
+        json.set("wagons", json_wagons);
+
+        std::string tmp = filename + ".tmp";
+        {
+            std::ofstream out(tmp);
+            if (!out) {
+                throw std::runtime_error("Checkpoint: Cannot write state file: " + tmp);
+            }
+            out << json.dump() << "\n";
+            if (!out) {
+                throw std::runtime_error("Checkpoint: Failed writing state file: " + tmp);
+            }
+        }
+        if (std::rename(tmp.c_str(), filename.c_str()) != 0) {
+            throw std::runtime_error("Checkpoint: Cannot replace state file: " + filename);
+        }
+    }
+
+    /**
+     * @brief Read a state file written by write()
+     */
+    static CheckpointState read(const std::string& filename) {
+        JsonValue json = JsonParser::parseFile(filename);
+        if (json["version"].asInt(0) != 1) {
+            throw std::runtime_error("Checkpoint: Unsupported state file: " + filename);
+        }
+
+        CheckpointState state;
+        state.serial = json["serial"].asInt(0);
+        state.input_entries = json["input_entries"].asLong();
+        state.start_event = json["start_event"].asLong();
+        state.end_event = json["end_event"].asLong();
+        for (const auto& r : json["ranges"].asArray()) {
+            if (!r.has("worker")) {
+                throw std::runtime_error("Checkpoint: Range without a worker in state file: " + filename);
+            }
+            state.ranges.push_back(Range{r["first"].asLong(), r["next"].asLong(), r["last"].asLong(),
+                                         r["worker"].asInt(0)});
+        }
+        for (const auto& w : json["wagons"].asArray()) {
+            Wagon wagon;
+            wagon.name = w["name"].asString();
+            wagon.output = w["output"].asString();
+            wagon.snapshot = w["snapshot"].asString();
+            wagon.flow_events = w["flow_events"].asLong();
+            wagon.skipped_events = w["skipped_events"].asLong();
+            for (const auto& c : w["cuts"].asArray()) {
+                wagon.cuts.push_back(CutManager::StepCounts{parseKind(c["kind"].asString()),
+                                                            c["name"].asString(), c["tested"].asLong(),
+                                                            c["passed"].asLong(), c["flow_passed"].asLong()});
+            }
+            for (const auto& nt : w["ntuples"].asArray()) {
+                NtupleSegments segments;
+                segments.name = nt["name"].asString();
+                segments.shard = nt["shard"].asInt(-1);
+                for (const auto& f : nt["files"].asArray()) {
+                    segments.files.push_back(f.asString());
+                }
+                wagon.ntuples.push_back(segments);
+            }
+            state.wagons.push_back(wagon);
+        }
+        if (state.ranges.empty() || state.wagons.empty()) {
+            throw std::runtime_error("Checkpoint: State file has no ranges or wagons: " + filename);
+        }
+        return state;
+    }
+
+    /**
+     * @brief Delete snapshots, ntuple segments and the state file itself
+     *
+     * Call once the output is complete.
+     */
+    void removeFiles(const std::string& filename) const {
+        std::vector<std::string> files;
+        for (const Wagon& w : wagons) {
+            if (!w.snapshot.empty()) files.push_back(w.snapshot);
+            for (const auto& nt : w.ntuples) {
+                files.insert(files.end(), nt.files.begin(), nt.files.end());
+            }
+        }
+        files.push_back(filename);
+        for (const auto& file : files) {
+            std::remove(file.c_str());
+        }
+    }
+
+private:
+    static const char* kindName(CutKind kind) {
+        switch (kind) {
+            case CutKind::Trigger:   return "trigger";
+            case CutKind::Graphical: return "graphical";
+            default:                 return "range";
+        }
+    }
+
+    static CutKind parseKind(const std::string& name) {
+        if (name == "trigger") return CutKind::Trigger;
+        if (name == "graphical") return CutKind::Graphical;
+        return CutKind::Range;
+    }
+};
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,282 @@
+/**
+ * @file column_buffer.h
+ * @brief Column-wise event buffer with optional spill to disk
+ *
+ * Backing store of DynamicHNtuple in "memory" mode. Values are kept per
+ * variable (one std::vector<Float_t> per column) in chunks. Columns can be
+ * added at any time; the rows already in the current chunk are backfilled
+ * with the missing value, older chunks simply do not contain the column.
+ *
+ * When a chunk grows beyond the spill limit it is appended to a raw binary
+ * spill file and its memory is released. At the end all chunks (memory and
+ * spilled) are replayed row by row in any requested column order.
+ *
+ * Spill file layout, per chunk:
+ *   Long64_t rows | UInt_t ncols | ncols x (UInt_t len, char name[len])
+ *   | ncols x rows Float_t (column-major)
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef COLUMN_BUFFER_H
+#define COLUMN_BUFFER_H
+
+#include <Rtypes.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdio>
+
+// ============================================================================
+// ColumnBuffer: chunked column storage
+// ============================================================================
+
+class ColumnBuffer {
+public:
+    /**
+     * @brief Construct buffer
+     * @param missing_value Value for columns not set in a row
+     * @param spill_bytes Spill current chunk above this size (0 = never spill)
+     * @param spill_filename File for spilled chunks (created on first spill)
+     */
+    ColumnBuffer(Float_t missing_value, size_t spill_bytes, const std::string& spill_filename)
+        : missing_value_(missing_value), spill_bytes_(spill_bytes),
+          spill_filename_(spill_filename) {}
+
+    // Disable copy
+    ColumnBuffer(const ColumnBuffer&) = delete;
+    ColumnBuffer& operator=(const ColumnBuffer&) = delete;
+
+    // ========================================================================
+    // Filling
+    // ========================================================================
+
+    /**
+     * @brief Add a column, backfilling the current chunk with missing_value
+     * @return Column index (used by appendRow order)
+     */
+    size_t addColumn(const std::string& name) {
+        current_.names.push_back(name);
+        current_.columns.emplace_back(static_cast<size_t>(current_.rows), missing_value_);
+        return current_.names.size() - 1;
+    }
+
+    /**
+     * @brief Append one row
+     * @param values One value pointer per column, in addColumn() order
+     */
+    void appendRow(const std::vector<Float_t*>& values) {
+        for (size_t i = 0; i < values.size(); ++i) {
+            current_.columns[i].push_back(*values[i]);
+        }
+        ++current_.rows;
+        ++total_rows_;
+
+        if (spill_bytes_ > 0 &&
+            static_cast<size_t>(current_.rows) * current_.columns.size() * sizeof(Float_t) >= spill_bytes_) {
+            spill();
+        }
+    }
+
+    /**
+     * @brief Take over all rows of another buffer (appended after own rows)
+     */
+    void merge(ColumnBuffer& other) {
+        seal();
+        other.seal();
+        for (auto& chunk : other.chunks_) {
+            chunks_.push_back(std::move(chunk));
+        }
+        other.chunks_.clear();
+        spill_files_.insert(spill_files_.end(), other.spill_files_.begin(), other.spill_files_.end());
+        other.spill_files_.clear();
+        total_rows_ += other.total_rows_;
+        other.total_rows_ = 0;
+    }
+
+    // ========================================================================
+    // Reading
+    // ========================================================================
+
+    /**
+     * @brief Replay all rows in the given column order
+     * @param order Column names of the output row
+     * @param callback Called with a pointer to order.size() values per row
+     *
+     * Columns a chunk does not contain are set to missing_value.
+     */
+    template <typename Callback>
+    void forEachRow(const std::vector<std::string>& order, Callback callback) {
+        seal();
+
+        std::vector<Float_t> row(order.size());
+        std::vector<const Float_t*> sources(order.size());
+
+        for (auto& chunk : chunks_) {
+            Chunk loaded;
+            if (chunk.spilled) loaded = readChunk(chunk);
+            const Chunk& data = chunk.spilled ? loaded : chunk;
+
+            std::map<std::string, size_t> index;
+            for (size_t c = 0; c < data.names.size(); ++c) {
+                index[data.names[c]] = c;
+            }
+            for (size_t j = 0; j < order.size(); ++j) {
+                auto it = index.find(order[j]);
+                sources[j] = (it != index.end()) ? data.columns[it->second].data() : nullptr;
+            }
+
+            for (Long64_t r = 0; r < data.rows; ++r) {
+                for (size_t j = 0; j < order.size(); ++j) {
+                    row[j] = sources[j] ? sources[j][r] : missing_value_;
+                }
+                callback(row.data());
+            }
+        }
+    }
+
+    Long64_t rows() const { return total_rows_; }
+
+    /// Spill files owned by this buffer (own and merged)
+    const std::vector<std::string>& spillFiles() const { return spill_files_; }
+
+    /**
+     * @brief Release memory and delete all spill files
+     */
+    void clear() {
+        chunks_.clear();
+        current_ = Chunk();
+        for (const auto& filename : spill_files_) {
+            std::remove(filename.c_str());
+        }
+        spill_files_.clear();
+        total_rows_ = 0;
+    }
+
+    /**
+     * @brief Drop all rows (and spill files) but keep the columns
+     */
+    void clearRows() {
+        std::vector<std::string> names = current_.names;
+        clear();
+        current_.names = names;
+        current_.columns.resize(names.size());
+    }
+
+private:
+    struct Chunk {
+        std::vector<std::string> names;
+        std::vector<std::vector<Float_t>> columns;
+        Long64_t rows = 0;
+
+        // Spilled chunks keep only their location
+        bool spilled = false;
+        std::string file;
+        std::streamoff offset = 0;
+    };
+
+    /**
+     * @brief Move the current chunk to the sealed list (kept in memory)
+     */
+    void seal() {
+        if (current_.rows == 0) return;
+        Chunk next;
+        next.names = current_.names;
+        next.columns.resize(next.names.size());
+        chunks_.push_back(std::move(current_));
+        current_ = std::move(next);
+    }
+
+    /**
+     * @brief Append the current chunk to the spill file and free its memory
+     */
+    void spill() {
+        std::ofstream out(spill_filename_, std::ios::binary | std::ios::app);
+        if (!out) {
+            throw std::runtime_error("ColumnBuffer: Cannot open spill file: " + spill_filename_);
+        }
+        if (std::find(spill_files_.begin(), spill_files_.end(), spill_filename_) == spill_files_.end()) {
+            spill_files_.push_back(spill_filename_);
+        }
+
+        out.seekp(0, std::ios::end);
+        Chunk marker;
+        marker.names = current_.names;
+        marker.rows = current_.rows;
+        marker.spilled = true;
+        marker.file = spill_filename_;
+        marker.offset = out.tellp();
+
+        UInt_t ncols = static_cast<UInt_t>(current_.names.size());
+        out.write(reinterpret_cast<const char*>(&current_.rows), sizeof(Long64_t));
+        out.write(reinterpret_cast<const char*>(&ncols), sizeof(UInt_t));
+        for (const auto& name : current_.names) {
+            UInt_t len = static_cast<UInt_t>(name.size());
+            out.write(reinterpret_cast<const char*>(&len), sizeof(UInt_t));
+            out.write(name.data(), len);
+        }
+        for (const auto& column : current_.columns) {
+            out.write(reinterpret_cast<const char*>(column.data()),
+                      static_cast<std::streamsize>(column.size() * sizeof(Float_t)));
+        }
+        if (!out) {
+            throw std::runtime_error("ColumnBuffer: Write to spill file failed: " + spill_filename_);
+        }
+
+        chunks_.push_back(std::move(marker));
+
+        // Start a fresh chunk with the same columns
+        for (auto& column : current_.columns) {
+            std::vector<Float_t>().swap(column);
+        }
+        current_.rows = 0;
+    }
+
+    /**
+     * @brief Load a spilled chunk back into memory
+     */
+    Chunk readChunk(const Chunk& marker) const {
+        std::ifstream in(marker.file, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("ColumnBuffer: Cannot reopen spill file: " + marker.file);
+        }
+        in.seekg(marker.offset);
+
+        Chunk chunk;
+        UInt_t ncols = 0;
+        in.read(reinterpret_cast<char*>(&chunk.rows), sizeof(Long64_t));
+        in.read(reinterpret_cast<char*>(&ncols), sizeof(UInt_t));
+        chunk.names.resize(ncols);
+        for (auto& name : chunk.names) {
+            UInt_t len = 0;
+            in.read(reinterpret_cast<char*>(&len), sizeof(UInt_t));
+            name.resize(len);
+            in.read(&name[0], len);
+        }
+        chunk.columns.resize(ncols);
+        for (auto& column : chunk.columns) {
+            column.resize(static_cast<size_t>(chunk.rows));
+            in.read(reinterpret_cast<char*>(column.data()),
+                    static_cast<std::streamsize>(column.size() * sizeof(Float_t)));
+        }
+        if (!in) {
+            throw std::runtime_error("ColumnBuffer: Corrupt spill file: " + marker.file);
+        }
+        return chunk;
+    }
+
+    Float_t missing_value_;
+    size_t spill_bytes_;
+    std::string spill_filename_;
+
+    Chunk current_;
+    std::vector<Chunk> chunks_;             // Sealed chunks, in row order
+    std::vector<std::string> spill_files_;
+    Long64_t total_rows_ = 0;
+};
+
+#endif // COLUMN_BUFFER_H
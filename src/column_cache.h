@@ -0,0 +1,387 @@
+/**
+ * @file column_cache.h
+ * @brief Local, memory-mapped copy of the bound input columns
+ *
+ * Iterating many times over the same input re-reads and decompresses the
+ * same ROOT baskets on every pass. The column cache keeps the bound
+ * Float_t variables as uncompressed column files on a local disk, one per
+ * variable, written once; later passes mmap them, and block mode hands out
+ * pointers straight into the mapping (no copy, served from the page
+ * cache).
+ *
+ * One cache entry per input and variable set:
+ *
+ *   <dir>/PPip_ID_3f9c1a2b7d4e8f60/index.json    tree, key, entries per file, columns
+ *   <dir>/PPip_ID_3f9c1a2b7d4e8f60/c0.f32        column 0: entries x Float_t
+ *   <dir>/PPip_ID_3f9c1a2b7d4e8f60/c1.f32        ...
+ *
+ * The key covers the tree name, every input file (name, entries, size and
+ * modification time) and the sorted variable names, so a changed file
+ * list, a rewritten file or another set of bound variables builds a new
+ * entry. Entries not used for longest are removed when the directory
+ * would exceed its size limit.
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef COLUMN_CACHE_H
+#define COLUMN_CACHE_H
+
+#include "analysis_config.h"
+#include "entry_list.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// MappedColumn: One Column File, Mapped Read-Only
+// ============================================================================
+/**
+ * @class MappedColumn
+ * @brief RAII mmap of a file of Float_t values
+ */
+class MappedColumn {
+public:
+    explicit MappedColumn(const std::string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("MappedColumn: Cannot open " + filename);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("MappedColumn: Cannot stat " + filename);
+        }
+        bytes_ = static_cast<size_t>(st.st_size);
+        if (bytes_ > 0) {
+            data_ = ::mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);   // The mapping keeps the file
+        if (data_ == MAP_FAILED) {
+            data_ = nullptr;
+            throw std::runtime_error("MappedColumn: Cannot map " + filename);
+        }
+        if (data_) ::madvise(data_, bytes_, MADV_SEQUENTIAL);
+    }
+
+    ~MappedColumn() {
+        if (data_) ::munmap(data_, bytes_);
+    }
+
+    MappedColumn(const MappedColumn&) = delete;
+    MappedColumn& operator=(const MappedColumn&) = delete;
+
+    /// Page-aligned values
+    const Float_t* data() const { return static_cast<const Float_t*>(data_); }
+    Long64_t entries() const { return static_cast<Long64_t>(bytes_ / sizeof(Float_t)); }
+
+private:
+    void* data_ = nullptr;
+    size_t bytes_ = 0;
+};
+
+// ============================================================================
+// ColumnCache: Build, Validate and Map a Cache Entry
+// ============================================================================
+/**
+ * @class ColumnCache
+ * @brief Cache entry of one input and variable set in a cache directory
+ *
+ * Usage Example (what NTupleReader::setColumnCache() does):
+ * @code
+ *   ColumnCache cache("/nvme/fat_cache", 20000LL * 1024 * 1024);
+ *   if (!cache.open("PPip_ID", reader.inputFiles(), names)) {
+ *       if (cache.beginWrite()) {
+ *           // for every block: cache.append(k, column, n) for each column k
+ *           cache.commit();    // publishes and maps the entry
+ *       }
+ *   }
+ *   const Float_t* p_p = cache.column(0);   // all entries of the input
+ * @endcode
+ *
+ * An entry is written to a temporary directory and renamed into place, so
+ * readers never see a partial one and concurrent jobs building the same
+ * entry do not collide. Not thread-safe; every reader maps on its own.
+ */
+class ColumnCache {
+public:
+    /**
+     * @param dir Cache directory (created if missing)
+     * @param max_bytes Size limit of the whole directory (0 = no limit)
+     */
+    ColumnCache(const std::string& dir, Long64_t max_bytes) : dir_(dir), max_bytes_(max_bytes) {}
+
+    /**
+     * @brief Map the entry of this input and variable set if it is valid
+     * @param columns Variable names, in the order column(k) refers to
+     * @return false if there is none (call beginWrite() to build it)
+     */
+    bool open(const std::string& treename, const std::vector<InputSegment>& files,
+              const std::vector<std::string>& columns) {
+        treename_ = treename;
+        files_ = files;
+        columns_ = columns;
+        entries_ = 0;
+        for (const auto& f : files_) entries_ += f.entries;
+        key_ = makeKey(treename, files, columns);
+        path_ = dir_ + "/" + entryName(treename, key_);
+        mapped_.clear();
+        return mapEntry();
+    }
+
+    /**
+     * @brief Start building the entry opened last
+     * @return false if it does not fit the size limit (nothing is cached)
+     *
+     * Makes room by removing the entries used longest ago.
+     */
+    bool beginWrite() {
+        Long64_t needed = entries_ * static_cast<Long64_t>(columns_.size() * sizeof(Float_t));
+        if (!makeRoom(needed)) {
+            std::cerr << "Warning: ColumnCache - " << needed / (1024 * 1024) << " MB for "
+                      << columns_.size() << " columns exceeds the limit of "
+                      << max_bytes_ / (1024 * 1024) << " MB, reading from ROOT\n";
+            return false;
+        }
+
+        // open() found no valid entry: whatever is at path_ is stale
+        std::error_code ec;
+        std::filesystem::remove_all(path_, ec);
+        tmp_path_ = path_ + ".tmp" + std::to_string(::getpid());
+        std::filesystem::remove_all(tmp_path_, ec);
+        std::filesystem::create_directories(tmp_path_, ec);
+        if (ec) {
+            throw std::runtime_error("ColumnCache: Cannot create " + tmp_path_ + ": " + ec.message());
+        }
+        writers_.clear();
+        for (size_t k = 0; k < columns_.size(); ++k) {
+            writers_.push_back(std::make_unique<std::ofstream>(columnFile(tmp_path_, k), std::ios::binary));
+            if (!*writers_.back()) {
+                throw std::runtime_error("ColumnCache: Cannot write " + columnFile(tmp_path_, k));
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Append the next values of column k (blocks in entry order)
+     */
+    void append(size_t k, const Float_t* values, Long64_t n) {
+        writers_[k]->write(reinterpret_cast<const char*>(values), n * static_cast<Long64_t>(sizeof(Float_t)));
+    }
+
+    /**
+     * @brief Finish the entry: write its index, publish it and map it
+     */
+    void commit() {
+        for (size_t k = 0; k < writers_.size(); ++k) {
+            writers_[k]->close();
+            if (!*writers_[k]) {
+                abort();
+                throw std::runtime_error("ColumnCache: Failed writing " + columnFile(tmp_path_, k));
+            }
+        }
+        writers_.clear();
+
+        JsonValue index = JsonValue::object();
+        index.set("version", 1);
+        index.set("tree", treename_);
+        index.set("key", key_);
+        index.set("entries", static_cast<double>(entries_));
+        JsonValue files = JsonValue::array();
+        for (const auto& f : files_) {
+            JsonValue file = JsonValue::object();
+            file.set("file", f.file);
+            file.set("entries", static_cast<double>(f.entries));
+            files.push_back(file);
+        }
+        index.set("files", files);
+        JsonValue columns = JsonValue::array();
+        for (const auto& c : columns_) columns.push_back(c);
+        index.set("columns", columns);
+        {
+            std::ofstream out(tmp_path_ + "/index.json");
+            out << index.dump() << "\n";
+            if (!out) {
+                abort();
+                throw std::runtime_error("ColumnCache: Cannot write " + tmp_path_ + "/index.json");
+            }
+        }
+
+        // Another job may have published the same entry meanwhile: keep it
+        std::error_code ec;
+        std::filesystem::rename(tmp_path_, path_, ec);
+        if (ec) abort();
+        if (!mapEntry()) {
+            throw std::runtime_error("ColumnCache: Entry " + path_ + " unreadable after writing");
+        }
+    }
+
+    /**
+     * @brief Drop a partly written entry
+     */
+    void abort() {
+        writers_.clear();
+        std::error_code ec;
+        if (!tmp_path_.empty()) std::filesystem::remove_all(tmp_path_, ec);
+    }
+
+    /// True once an entry is mapped
+    bool mapped() const { return !mapped_.empty(); }
+
+    /// All entries of column k (chain numbering), valid while the cache lives
+    const Float_t* column(size_t k) const { return mapped_[k]->data(); }
+
+    Long64_t entries() const { return entries_; }
+    Long64_t bytes() const { return entries_ * static_cast<Long64_t>(columns_.size() * sizeof(Float_t)); }
+    const std::string& path() const { return path_; }
+
+    /**
+     * @brief Key of an input and variable set (order of columns ignored)
+     */
+    static std::string makeKey(const std::string& treename, const std::vector<InputSegment>& files,
+                               const std::vector<std::string>& columns) {
+        std::string key = treename;
+        for (const auto& f : files) {
+            key += "|" + f.file + ":" + std::to_string(f.entries) + ":" + fileStamp(f.file);
+        }
+        std::vector<std::string> sorted = columns;
+        std::sort(sorted.begin(), sorted.end());
+        for (const auto& c : sorted) key += "|" + c;
+        return key;
+    }
+
+private:
+    /// Directory name: tree plus 64-bit FNV-1a hash of the key
+    static std::string entryName(const std::string& treename, const std::string& key) {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : key) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        char hex[17];
+        std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+        std::string tree;
+        for (char c : treename) tree += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+        return tree + "_" + hex;
+    }
+
+    static std::string columnFile(const std::string& path, size_t k) {
+        return path + "/c" + std::to_string(k) + ".f32";
+    }
+
+    /// "size:mtime" of a local file ("-" for URLs, checked by name and entries only)
+    static std::string fileStamp(const std::string& file) {
+        if (file.find("://") != std::string::npos) return "-";
+        std::error_code ec;
+        auto size = std::filesystem::file_size(file, ec);
+        if (ec) return "-";
+        auto mtime = std::filesystem::last_write_time(file, ec);
+        if (ec) return "-";
+        return std::to_string(size) + ":" +
+               std::to_string(std::chrono::duration_cast<std::chrono::seconds>(mtime.time_since_epoch()).count());
+    }
+
+    /**
+     * @brief Map the columns of path_ after checking key and sizes
+     */
+    bool mapEntry() {
+        mapped_.clear();
+        std::string index_file = path_ + "/index.json";
+        std::error_code ec;
+        if (!std::filesystem::exists(index_file, ec)) return false;
+
+        try {
+            JsonValue index = JsonParser::parseFile(index_file);
+            if (index["version"].asInt(0) != 1 || index["key"].asString("") != key_) {
+                return false;
+            }
+            // Column order of this entry may differ from the requested one
+            std::vector<std::string> stored;
+            for (const auto& c : index["columns"].asArray()) stored.push_back(c.asString());
+            for (const auto& c : columns_) {
+                size_t k = std::find(stored.begin(), stored.end(), c) - stored.begin();
+                if (k == stored.size()) return false;
+                mapped_.push_back(std::make_unique<MappedColumn>(columnFile(path_, k)));
+                if (mapped_.back()->entries() != entries_) {
+                    std::cerr << "Warning: ColumnCache - " << path_ << " is incomplete, rebuilding\n";
+                    mapped_.clear();
+                    return false;
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: ColumnCache - " << path_ << " unreadable (" << e.what() << "), rebuilding\n";
+            mapped_.clear();
+            return false;
+        }
+
+        // Last use decides eviction
+        std::filesystem::last_write_time(index_file, std::filesystem::file_time_type::clock::now(), ec);
+        return true;
+    }
+
+    /**
+     * @brief Remove least recently used entries until 'needed' bytes fit
+     */
+    bool makeRoom(Long64_t needed) {
+        if (max_bytes_ <= 0) return true;
+        if (needed > max_bytes_) return false;
+
+        struct Entry {
+            std::filesystem::path path;
+            std::filesystem::file_time_type used;
+            Long64_t bytes = 0;
+        };
+        std::vector<Entry> entries;
+        Long64_t total = 0;
+        std::error_code ec;
+        for (const auto& dir : std::filesystem::directory_iterator(dir_, ec)) {
+            Entry e;
+            e.path = dir.path();
+            e.used = std::filesystem::last_write_time(e.path / "index.json", ec);
+            if (ec) continue;   // Not an entry (or one being written)
+            for (const auto& f : std::filesystem::directory_iterator(e.path, ec)) {
+                e.bytes += static_cast<Long64_t>(f.file_size(ec));
+            }
+            total += e.bytes;
+            entries.push_back(e);
+        }
+        std::sort(entries.begin(), entries.end(),
+                  [](const Entry& a, const Entry& b) { return a.used < b.used; });
+        for (const auto& e : entries) {
+            if (total + needed <= max_bytes_) break;
+            std::cout << "ColumnCache: Removing " << e.path.string() << " (least recently used)\n";
+            std::filesystem::remove_all(e.path, ec);
+            total -= e.bytes;
+        }
+        return total + needed <= max_bytes_;
+    }
+
+    std::string dir_;
+    Long64_t max_bytes_;
+    std::string treename_;
+    std::vector<InputSegment> files_;
+    std::vector<std::string> columns_;
+    Long64_t entries_ = 0;
+    std::string key_;
+    std::string path_;
+    std::string tmp_path_;
+    std::vector<std::unique_ptr<std::ofstream>> writers_;
+    std::vector<std::unique_ptr<MappedColumn>> mapped_;
+};
+
+#endif // COLUMN_CACHE_H
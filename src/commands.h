@@ -0,0 +1,190 @@
+/**
+ * @file commands.h
+ * @brief Command line of the analysis program and its commands without an event loop
+ *
+ *   ./ana [config.json] [--resume]                         event loop (EventLoop)
+ *   ./ana [config.json] --split N [--by entries|files]     runSplit()
+ *   ./ana [config.json] --merge merged.root job0.root ...  runMerge()
+ *   ./ana [config.json] --schema [header.h] [--tree NAME]  runSchema()
+ *
+ * --split writes one list file and one config per job; --merge combines
+ * the outputs of the same wagon from all jobs and prints the merged cut
+ * flow; --schema writes the input struct of the configured tree.
+ *
+ * Example usage:
+ * @code
+ *   CommandLine cmd = CommandLine::parse(argc, argv);
+ *   if (cmd.split_jobs > 0) return runSplit(config, cmd.split_jobs, JobSplitter::parseBy(cmd.split_by), argv[0]);
+ * @endcode
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+#include "analysis_config.h"
+#include "ntuple_reader.h"
+#include "cut_manager.h"
+#include "manager.h"
+#include "job_splitter.h"
+#include "output_merger.h"
+#include "schema_generator.h"
+#include <TFile.h>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// CommandLine: Options of the Analysis Program
+// ============================================================================
+/**
+ * @struct CommandLine
+ * @brief Parsed arguments; bad_args is set instead of throwing
+ */
+struct CommandLine {
+    std::string config_file = "config.json";
+    bool resume = false;
+    int split_jobs = 0;
+    std::string split_by = "entries";
+    bool merge = false;
+    std::vector<std::string> merge_files;   // Output first, then the inputs
+    bool schema = false;
+    std::string schema_header;              // "" = SchemaGenerator::defaultHeader()
+    std::string schema_tree;                // "" = input.tree_name
+    bool bad_args = false;
+
+    static CommandLine parse(int argc, char* argv[]) {
+        CommandLine cmd;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--resume") {
+                cmd.resume = true;
+            } else if (arg == "--split" && i + 1 < argc) {
+                cmd.split_jobs = std::atoi(argv[++i]);
+                cmd.bad_args = cmd.bad_args || cmd.split_jobs < 1;
+            } else if (arg == "--by" && i + 1 < argc) {
+                cmd.split_by = argv[++i];
+            } else if (arg == "--schema") {
+                cmd.schema = true;
+                if (i + 1 < argc && std::string(argv[i + 1]).compare(0, 2, "--") != 0) {
+                    cmd.schema_header = argv[++i];
+                }
+            } else if (arg == "--tree" && i + 1 < argc) {
+                cmd.schema_tree = argv[++i];
+            } else if (arg == "--merge") {
+                cmd.merge = true;
+                cmd.merge_files.assign(argv + i + 1, argv + argc);
+                cmd.bad_args = cmd.bad_args || cmd.merge_files.size() < 2;
+                break;
+            } else if (arg.compare(0, 2, "--") == 0) {
+                cmd.bad_args = true;
+            } else {
+                cmd.config_file = arg;
+            }
+        }
+        return cmd;
+    }
+
+    static void printUsage(const char* program, std::ostream& os = std::cerr) {
+        os << "Usage: " << program << " [config.json] [--resume]\n"
+           << "       " << program << " [config.json] --split N [--by entries|files]\n"
+           << "       " << program << " [config.json] --merge merged.root job0.root job1.root ...\n"
+           << "       " << program << " [config.json] --schema [header.h] [--tree NAME]\n";
+    }
+};
+
+// ============================================================================
+// Batch Jobs: --split and --merge
+// ============================================================================
+
+/**
+ * @brief Write the job lists and configs for the .list input of config
+ */
+inline int runSplit(const AnalysisConfig& config, int n_jobs, JobSplitter::By by,
+                    const std::string& program) {
+    try {
+        // Balancing by entries opens every file once to count its entries
+        // (unless the dataset index knows them)
+        std::vector<InputSegment> files;
+        if (by == JobSplitter::By::Entries) {
+            NTupleReader reader;
+            reader.setFormat(NTupleReader::parseFormat(config.getInputFormat()));
+            reader.openFromList(config.getInputSource(), config.getInputTreeName(), config.getInputIndex());
+            files = reader.inputFiles();
+        } else {
+            for (const auto& file : NTupleReader::readFileList(config.getInputSource())) {
+                files.push_back(InputSegment{file, 0, 0});
+            }
+        }
+
+        std::vector<JobSpec> jobs = JobSplitter::write(config, files, n_jobs, by);
+        std::vector<std::string> outputs;
+        for (const auto& def : config.getTrainWagons()) outputs.push_back(def.output);
+        if (outputs.empty()) outputs.push_back(config.getOutputFilename());
+        JobSplitter::printJobs(jobs, program, config.getConfigFile(), outputs);
+    } catch (const std::exception& e) {
+        std::cerr << "Error splitting into jobs: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Merge job outputs into one file and print its cut flow
+ * @param cuts Cuts of the analysis (setupCuts()), for the cut-flow names
+ */
+inline int runMerge(const AnalysisConfig& config, const std::string& output,
+                    const std::vector<std::string>& inputs, CutManager& cuts) {
+    try {
+        OutputMerger merger(config.getMissingValue());
+        merger.setCompression(OutputOptions::parseCompression(config.getCompression(),
+                                                              config.getCompressionLevel()));
+        std::cout << "\nMerging " << inputs.size() << " files into " << output << "...\n";
+        merger.merge(output, inputs);
+        merger.printSummary();
+
+        TFile merged(output.c_str(), "READ");
+        if (cuts.addCutFlow(&merged)) {
+            cuts.printCutFlow();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error merging outputs: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// ============================================================================
+// Input Struct: --schema
+// ============================================================================
+
+/**
+ * @brief Write the input struct of the configured tree (or tree_name)
+ */
+inline int runSchema(const AnalysisConfig& config, const std::string& header,
+                     const std::string& tree_name) {
+    try {
+        std::string source = config.getInputSource();
+        std::string tree = tree_name.empty() ? config.getInputTreeName() : tree_name;
+        NTupleReader reader;
+        reader.setFormat(NTupleReader::parseFormat(config.getInputFormat()));
+        if (config.isInputFileList()) {
+            reader.openFromList(source, tree, config.getInputIndex());
+        } else {
+            reader.open(source, tree);
+        }
+
+        SchemaGenerator schema(reader);
+        schema.write(header.empty() ? SchemaGenerator::defaultHeader(tree) : header, source);
+        schema.printSummary();
+    } catch (const std::exception& e) {
+        std::cerr << "Error generating input struct: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+#endif // COMMANDS_H
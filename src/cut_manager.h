@@ -4,15 +4,18 @@
  *
  * Provides a centralized system for managing all types of cuts:
  * - 1D cuts (mass windows, momentum ranges, etc.)
- * - 2D graphical cuts (TCutG)
+ * - 2D graphical cuts (TCutG, rasterized for O(1) evaluation)
  * - Trigger/flag selections
  * - Event quality cuts
  *
  * Supports:
  * - Named cut access
- * - Cut statistics tracking
+ * - Compiled cut-flow handles (RangeCutId, ...) for per-event evaluation
+ * - Cut statistics tracking (independent and sequential)
  * - JSON configuration (via AnalysisConfig)
  * - Cut flow analysis
+ * - Cut-flow counters stored in the output file (summed when batch-job
+ *   outputs are merged)
  *
  * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
  * @date 2025
@@ -23,6 +26,8 @@
 
 #include <string>
 #include <map>
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <functional>
@@ -32,6 +37,8 @@
 #include <TFile.h>
 #include <TCutG.h>
 #include <TKey.h>
+#include <TH1D.h>
+#include "polygon_raster.h"
 
 // ============================================================================
 // Cut Types
@@ -48,26 +55,18 @@ struct RangeCut {
     double max;
     bool active = true;
     
-    // Statistics
-    mutable Long64_t tested = 0;
-    mutable Long64_t passed = 0;
-    
     RangeCut() : min(0), max(0) {}
     RangeCut(const std::string& n, double lo, double hi, const std::string& desc = "")
         : name(n), description(desc), min(lo), max(hi) {}
     
-    bool pass(double value) const {
-        ++tested;
-        bool result = (value >= min && value <= max);
-        if (result) ++passed;
-        return result || !active;
+    /// Raw cut decision, ignoring 'active' (branch-free)
+    bool test(double value) const {
+        return (value >= min) & (value <= max);
     }
     
-    double efficiency() const {
-        return tested > 0 ? static_cast<double>(passed) / tested : 0.0;
+    bool pass(double value) const {
+        return test(value) | !active;
     }
-    
-    void reset() { tested = passed = 0; }
 };
 
 /**
@@ -81,85 +80,132 @@ struct TriggerCut {
     bool require_all = false;  // AND vs OR logic
     bool active = true;
     
-    mutable Long64_t tested = 0;
-    mutable Long64_t passed = 0;
-    
     TriggerCut() : mask(0) {}
     TriggerCut(const std::string& n, int m, bool all = false, const std::string& desc = "")
         : name(n), description(desc), mask(m), require_all(all) {}
     
-    bool pass(int trigger) const {
-        ++tested;
-        bool result;
-        if (require_all) {
-            result = (trigger & mask) == mask;
-        } else {
-            result = (trigger & mask) != 0;
-        }
-        if (result) ++passed;
-        return result || !active;
+    /// Raw cut decision, ignoring 'active' (branch-free)
+    bool test(int trigger) const {
+        int bits = trigger & mask;
+        return (require_all & (bits == mask)) | (!require_all & (bits != 0));
     }
     
-    double efficiency() const {
-        return tested > 0 ? static_cast<double>(passed) / tested : 0.0;
+    bool pass(int trigger) const {
+        return test(trigger) | !active;
     }
-    
-    void reset() { tested = passed = 0; }
 };
 
 /**
  * @struct GraphicalCut
  * @brief 2D graphical cut wrapper (TCutG)
+ *
+ * The polygon is rasterized when the cut is created, so test() is a bitmap
+ * lookup with an exact fallback near the boundary; results are identical
+ * to TCutG::IsInside. Call rebuild() after editing the TCutG points.
  */
 struct GraphicalCut {
     std::string name;
     std::string description;
     std::unique_ptr<TCutG> cut;
+    PolygonRaster raster;
     bool active = true;
     
-    mutable Long64_t tested = 0;
-    mutable Long64_t passed = 0;
-    
     GraphicalCut() = default;
     GraphicalCut(const std::string& n, TCutG* c, const std::string& desc = "")
-        : name(n), description(desc), cut(c) {}
+        : name(n), description(desc), cut(c) {
+        rebuild();
+    }
+    
+    GraphicalCut(GraphicalCut&&) noexcept = default;
+    GraphicalCut& operator=(GraphicalCut&&) noexcept = default;
+    
+    /**
+     * @brief Recompute the raster from the current TCutG points
+     * @param resolution Raster cells per axis
+     */
+    void rebuild(int resolution = PolygonRaster::kDefaultResolution) {
+        if (cut) {
+            raster.build(cut->GetN(), cut->GetX(), cut->GetY(), resolution);
+        } else {
+            raster = PolygonRaster();
+        }
+    }
     
-    // Move constructor
-    GraphicalCut(GraphicalCut&& other) noexcept
-        : name(std::move(other.name)), description(std::move(other.description)),
-          cut(std::move(other.cut)), active(other.active),
-          tested(other.tested), passed(other.passed) {}
+    /// Raw cut decision, ignoring 'active' (a missing TCutG accepts everything)
+    bool test(double x, double y) const {
+        return !cut || raster.contains(x, y);
+    }
     
-    // Move assignment
-    GraphicalCut& operator=(GraphicalCut&& other) noexcept {
-        name = std::move(other.name);
-        description = std::move(other.description);
-        cut = std::move(other.cut);
-        active = other.active;
-        tested = other.tested;
-        passed = other.passed;
-        return *this;
+    /// Batch raw decisions: out[i] = test(x[i], y[i]) as 0/1
+    void test(const double* x, const double* y, size_t n, uint8_t* out) const {
+        if (!cut) {
+            std::fill(out, out + n, uint8_t(1));
+            return;
+        }
+        raster.contains(x, y, n, out);
     }
     
     bool pass(double x, double y) const {
-        if (!cut) return true;
-        ++tested;
-        bool result = cut->IsInside(x, y);
-        if (result) ++passed;
-        return result || !active;
+        return test(x, y) | !active;
     }
+};
+
+// ============================================================================
+// Cut Flow Handles
+// ============================================================================
+
+enum class CutKind { Range, Trigger, Graphical };
+
+/**
+ * @struct CutHandle
+ * @brief Position of a cut in the compiled cut flow
+ *
+ * Returned by the define, load and add methods and by rangeCutId() & co.
+ * Resolve once at setup; evaluating through a handle costs an array index
+ * instead of a std::map string lookup. The kind is part of the type, so a
+ * trigger handle cannot be passed where a range cut is expected.
+ *
+ * A default-constructed (invalid) handle means "cut not defined": the
+ * handle-based pass*Cut() overloads accept the event without counting it.
+ */
+template <CutKind K>
+struct CutHandle {
+    int step = -1;
     
-    double efficiency() const {
-        return tested > 0 ? static_cast<double>(passed) / tested : 0.0;
-    }
+    CutHandle() = default;
+    explicit CutHandle(int s) : step(s) {}
     
-    void reset() { tested = passed = 0; }
+    bool valid() const { return step >= 0; }
+    explicit operator bool() const { return valid(); }
 };
 
+using RangeCutId = CutHandle<CutKind::Range>;
+using TriggerCutId = CutHandle<CutKind::Trigger>;
+using GraphicalCutId = CutHandle<CutKind::Graphical>;
+
 // ============================================================================
 // CutManager: Central cut management
 // ============================================================================
 
+/**
+ * @class CutManager
+ * @brief Named cut definitions compiled into an ordered cut flow
+ *
+ * Every defined cut becomes one step of the cut flow, in definition order.
+ * Statistics live in the CutManager itself (one per worker thread), so
+ * evaluation never writes shared memory; merge() combines workers at the end.
+ *
+ * Besides the independent per-cut efficiencies, the manager keeps a
+ * sequential cut flow: step k counts events that passed steps 0..k in
+ * order within the same event. Call beginEvent() once per event and
+ * evaluate the cuts in definition order (early return on rejection):
+ * @code
+ *   RangeCutId mass_cut = cuts.rangeCutId("neutron_mass");  // setup
+ *   ...
+ *   cuts.beginEvent();                                      // per event
+ *   if (!cuts.passRangeCut(mass_cut, m_n)) return;
+ * @endcode
+ */
 class CutManager {
 public:
     // ========================================================================
@@ -168,30 +214,57 @@ public:
     
     CutManager() = default;
     
+    // Steps point into the cut maps: moving keeps the nodes, copying would not
+    CutManager(CutManager&&) = default;
+    CutManager& operator=(CutManager&&) = default;
+    CutManager(const CutManager&) = delete;
+    CutManager& operator=(const CutManager&) = delete;
+    
     // ========================================================================
     // 1D Range Cuts
     // ========================================================================
     
     /**
      * @brief Define a 1D range cut
+     * @return Handle for lookup-free evaluation (may be ignored)
      */
-    void defineRangeCut(const std::string& name, double min, double max,
-                       const std::string& description = "") {
+    RangeCutId defineRangeCut(const std::string& name, double min, double max,
+                              const std::string& description = "") {
         if (range_cuts_.find(name) != range_cuts_.end()) {
             std::cerr << "Warning: Overwriting existing cut '" << name << "'\n";
         }
-        range_cuts_[name] = RangeCut(name, min, max, description);
+        RangeCut& cut = range_cuts_[name];
+        cut = RangeCut(name, min, max, description);
+        return RangeCutId(addStep(CutKind::Range, name, &cut));
+    }
+    
+    /**
+     * @brief Handle of a range cut, invalid if the cut is not defined
+     */
+    RangeCutId rangeCutId(const std::string& name) const {
+        return RangeCutId(findStep(CutKind::Range, name));
+    }
+    
+    /**
+     * @brief Test value against range cut (hot path, no name lookup)
+     *
+     * An invalid handle (cut not defined) accepts the event.
+     */
+    bool passRangeCut(RangeCutId id, double value) {
+        if (!id) return true;
+        const RangeCut& c = *static_cast<const RangeCut*>(steps_[id.step].cut);
+        return record(id.step, c.test(value), c.active);
     }
     
     /**
      * @brief Test value against named range cut
      */
-    bool passRangeCut(const std::string& name, double value) const {
-        auto it = range_cuts_.find(name);
-        if (it == range_cuts_.end()) {
+    bool passRangeCut(const std::string& name, double value) {
+        RangeCutId id = rangeCutId(name);
+        if (!id) {
             throw std::runtime_error("CutManager::passRangeCut() - Cut '" + name + "' not defined!");
         }
-        return it->second.pass(value);
+        return passRangeCut(id, value);
     }
     
     /**
@@ -214,20 +287,35 @@ public:
      * @param mask Bit mask for trigger selection
      * @param require_all If true, require ALL bits set; if false, require ANY
      */
-    void defineTriggerCut(const std::string& name, int mask, bool require_all = false,
-                         const std::string& description = "") {
-        trigger_cuts_[name] = TriggerCut(name, mask, require_all, description);
+    TriggerCutId defineTriggerCut(const std::string& name, int mask, bool require_all = false,
+                                  const std::string& description = "") {
+        TriggerCut& cut = trigger_cuts_[name];
+        cut = TriggerCut(name, mask, require_all, description);
+        return TriggerCutId(addStep(CutKind::Trigger, name, &cut));
+    }
+    
+    TriggerCutId triggerCutId(const std::string& name) const {
+        return TriggerCutId(findStep(CutKind::Trigger, name));
+    }
+    
+    /**
+     * @brief Test trigger value (hot path, no name lookup)
+     */
+    bool passTriggerCut(TriggerCutId id, int trigger) {
+        if (!id) return true;
+        const TriggerCut& c = *static_cast<const TriggerCut*>(steps_[id.step].cut);
+        return record(id.step, c.test(trigger), c.active);
     }
     
     /**
      * @brief Test trigger value
      */
-    bool passTriggerCut(const std::string& name, int trigger) const {
-        auto it = trigger_cuts_.find(name);
-        if (it == trigger_cuts_.end()) {
+    bool passTriggerCut(const std::string& name, int trigger) {
+        TriggerCutId id = triggerCutId(name);
+        if (!id) {
             throw std::runtime_error("CutManager::passTriggerCut() - Cut '" + name + "' not defined!");
         }
-        return it->second.pass(trigger);
+        return passTriggerCut(id, trigger);
     }
     
     // ========================================================================
@@ -240,8 +328,8 @@ public:
      * @param filename ROOT file containing TCutG
      * @param cutname Name of TCutG in file (if different from 'name')
      */
-    void loadGraphicalCut(const std::string& name, const std::string& filename,
-                         const std::string& cutname = "", const std::string& description = "") {
+    GraphicalCutId loadGraphicalCut(const std::string& name, const std::string& filename,
+                                    const std::string& cutname = "", const std::string& description = "") {
         TFile* f = TFile::Open(filename.c_str(), "READ");
         if (!f || f->IsZombie()) {
             throw std::runtime_error("CutManager::loadGraphicalCut() - Cannot open file: " + filename);
@@ -260,32 +348,69 @@ public:
         cut_clone->SetName(name.c_str());
         f->Close();
         
-        graphical_cuts_[name] = GraphicalCut(name, cut_clone, description);
+        GraphicalCutId id = storeGraphicalCut(name, cut_clone, description);
         std::cout << "CutManager: Loaded graphical cut '" << name << "' from " << filename << "\n";
+        return id;
     }
     
     /**
      * @brief Add graphical cut directly
      */
-    void addGraphicalCut(const std::string& name, TCutG* cut,
-                        const std::string& description = "") {
+    GraphicalCutId addGraphicalCut(const std::string& name, TCutG* cut,
+                                   const std::string& description = "") {
         if (!cut) {
             throw std::runtime_error("CutManager::addGraphicalCut() - null cut provided!");
         }
         TCutG* owned = dynamic_cast<TCutG*>(cut->Clone());
         owned->SetName(name.c_str());
-        graphical_cuts_[name] = GraphicalCut(name, owned, description);
+        return storeGraphicalCut(name, owned, description);
+    }
+    
+    GraphicalCutId graphicalCutId(const std::string& name) const {
+        return GraphicalCutId(findStep(CutKind::Graphical, name));
+    }
+    
+    /**
+     * @brief Test point against graphical cut (hot path, no name lookup)
+     */
+    bool passGraphicalCut(GraphicalCutId id, double x, double y) {
+        if (!id) return true;
+        const GraphicalCut& c = *static_cast<const GraphicalCut*>(steps_[id.step].cut);
+        return record(id.step, c.test(x, y), c.active);
+    }
+    
+    /**
+     * @brief Test many points against a graphical cut (e.g. all tracks)
+     * @param out out[i] = 1 if point i passes (inactive cut: all 1)
+     *
+     * Counts every point in the independent statistics; batch calls do not
+     * advance the sequential cut flow.
+     */
+    void passGraphicalCut(GraphicalCutId id, const double* x, const double* y,
+                          size_t n, uint8_t* out) {
+        if (!id) {
+            std::fill(out, out + n, uint8_t(1));
+            return;
+        }
+        const GraphicalCut& c = *static_cast<const GraphicalCut*>(steps_[id.step].cut);
+        c.test(x, y, n, out);
+        
+        Long64_t passed = 0;
+        for (size_t i = 0; i < n; ++i) passed += out[i];
+        stats_[id.step].tested += static_cast<Long64_t>(n);
+        stats_[id.step].passed += passed;
+        if (!c.active) std::fill(out, out + n, uint8_t(1));
     }
     
     /**
      * @brief Test point against graphical cut
      */
-    bool passGraphicalCut(const std::string& name, double x, double y) const {
-        auto it = graphical_cuts_.find(name);
-        if (it == graphical_cuts_.end()) {
+    bool passGraphicalCut(const std::string& name, double x, double y) {
+        GraphicalCutId id = graphicalCutId(name);
+        if (!id) {
             throw std::runtime_error("CutManager::passGraphicalCut() - Cut '" + name + "' not defined!");
         }
-        return it->second.pass(x, y);
+        return passGraphicalCut(id, x, y);
     }
     
     /**
@@ -327,17 +452,169 @@ public:
     // Statistics
     // ========================================================================
     
+    /**
+     * @brief Start a new event in the sequential cut flow
+     *
+     * Must be called once per event before the first cut is evaluated;
+     * without it only the independent statistics are meaningful.
+     */
+    void beginEvent() {
+        ++flow_events_;
+        next_step_ = 0;
+    }
+    
+    /**
+     * @brief Count an event that was not analysed (instead of beginEvent())
+     *
+     * For events of input files that lack a required variable; they are
+     * reported next to the cut flow, not in it.
+     */
+    void skipEvent() {
+        ++skipped_events_;
+    }
+    
     /**
      * @brief Reset all cut statistics
      */
     void resetStatistics() {
-        for (auto& p : range_cuts_) p.second.reset();
-        for (auto& p : trigger_cuts_) p.second.reset();
-        for (auto& p : graphical_cuts_) p.second.reset();
+        for (auto& st : stats_) st = CutStats();
+        flow_events_ = 0;
+        skipped_events_ = 0;
+        next_step_ = 0;
+    }
+    
+    /**
+     * @brief Add cut statistics of another CutManager (e.g. a worker thread)
+     *
+     * Cuts are matched by kind and name; cuts not defined here are ignored.
+     * Sequential counts assume both managers define the cuts in the same
+     * order (true for workers set up by the same setupCuts()).
+     */
+    void merge(const CutManager& other) {
+        for (size_t k = 0; k < other.steps_.size(); ++k) {
+            int step = findStep(other.steps_[k].kind, other.steps_[k].name);
+            if (step < 0) continue;
+            stats_[step].tested += other.stats_[k].tested;
+            stats_[step].passed += other.stats_[k].passed;
+            stats_[step].flow_passed += other.stats_[k].flow_passed;
+        }
+        flow_events_ += other.flow_events_;
+        skipped_events_ += other.skipped_events_;
+    }
+    
+    /**
+     * @brief Counters of one cut-flow step (see statistics())
+     */
+    struct StepCounts {
+        CutKind kind;
+        std::string name;
+        Long64_t tested = 0;
+        Long64_t passed = 0;
+        Long64_t flow_passed = 0;
+    };
+    
+    /**
+     * @brief All counters in cut-flow order (e.g. for a checkpoint)
+     */
+    std::vector<StepCounts> statistics() const {
+        std::vector<StepCounts> counts;
+        for (size_t k = 0; k < steps_.size(); ++k) {
+            counts.push_back(StepCounts{steps_[k].kind, steps_[k].name, stats_[k].tested,
+                                        stats_[k].passed, stats_[k].flow_passed});
+        }
+        return counts;
+    }
+    
+    /**
+     * @brief Add saved counters, matched by kind and name like merge()
+     */
+    void addStatistics(const std::vector<StepCounts>& counts, Long64_t flow_events,
+                       Long64_t skipped_events = 0) {
+        for (const StepCounts& c : counts) {
+            int step = findStep(c.kind, c.name);
+            if (step < 0) continue;
+            stats_[step].tested += c.tested;
+            stats_[step].passed += c.passed;
+            stats_[step].flow_passed += c.flow_passed;
+        }
+        flow_events_ += flow_events;
+        skipped_events_ += skipped_events;
+    }
+    
+    /// Output directory of writeCutFlow()
+    static constexpr const char* kCutFlowDir = "cut_flow";
+    
+    /**
+     * @brief Store the counters as histograms in dir/cut_flow
+     *
+     * "tested", "passed" and "flow_passed" have one bin per step,
+     * labelled with the cut name; "events" holds flowEvents() and
+     * "skipped" skippedEvents(). Plain
+     * TH1D, so merging job outputs (hadd or OutputMerger) sums them.
+     */
+    void writeCutFlow(TDirectory* dir) const {
+        if (!dir || steps_.empty()) return;
+        TDirectory* out = dir->mkdir(kCutFlowDir);
+        if (!out) {
+            throw std::runtime_error("CutManager::writeCutFlow() - Cannot create directory in output");
+        }
+        
+        int n = static_cast<int>(steps_.size());
+        TH1D tested("tested", "Cut flow: events tested per cut", n, 0, n);
+        TH1D passed("passed", "Cut flow: events passing each cut", n, 0, n);
+        TH1D flow("flow_passed", "Cut flow: events passing each cut and all before it", n, 0, n);
+        TH1D events("events", "Cut flow: events", 1, 0, 1);
+        TH1D skipped("skipped", "Cut flow: events skipped (input lacks required variables)", 1, 0, 1);
+        for (TH1D* h : {&tested, &passed, &flow, &events, &skipped}) h->SetDirectory(nullptr);
+        
+        for (int k = 0; k < n; ++k) {
+            for (TH1D* h : {&tested, &passed, &flow}) {
+                h->GetXaxis()->SetBinLabel(k + 1, steps_[k].name.c_str());
+            }
+            tested.SetBinContent(k + 1, static_cast<double>(stats_[k].tested));
+            passed.SetBinContent(k + 1, static_cast<double>(stats_[k].passed));
+            flow.SetBinContent(k + 1, static_cast<double>(stats_[k].flow_passed));
+        }
+        events.SetBinContent(1, static_cast<double>(flow_events_));
+        skipped.SetBinContent(1, static_cast<double>(skipped_events_));
+        
+        for (TH1D* h : {&tested, &passed, &flow, &events, &skipped}) out->WriteTObject(h, h->GetName());
+    }
+    
+    /**
+     * @brief Add counters stored by writeCutFlow() (e.g. a merged output)
+     * @return false if dir has no cut_flow directory
+     *
+     * Steps are matched by cut name; unknown names are ignored.
+     */
+    bool addCutFlow(TDirectory* dir) {
+        TDirectory* in = dir ? dir->GetDirectory(kCutFlowDir) : nullptr;
+        if (!in) return false;
+        TH1* tested = dynamic_cast<TH1*>(in->Get("tested"));
+        TH1* passed = dynamic_cast<TH1*>(in->Get("passed"));
+        TH1* flow = dynamic_cast<TH1*>(in->Get("flow_passed"));
+        TH1* events = dynamic_cast<TH1*>(in->Get("events"));
+        if (!tested || !passed || !flow || !events) return false;
+        
+        for (int bin = 1; bin <= tested->GetNbinsX(); ++bin) {
+            int step = flowStep(tested->GetXaxis()->GetBinLabel(bin));
+            if (step < 0) continue;
+            stats_[step].tested += static_cast<Long64_t>(tested->GetBinContent(bin));
+            stats_[step].passed += static_cast<Long64_t>(passed->GetBinContent(bin));
+            stats_[step].flow_passed += static_cast<Long64_t>(flow->GetBinContent(bin));
+        }
+        flow_events_ += static_cast<Long64_t>(events->GetBinContent(1));
+        if (TH1* skipped = dynamic_cast<TH1*>(in->Get("skipped"))) {
+            skipped_events_ += static_cast<Long64_t>(skipped->GetBinContent(1));
+        }
+        return true;
     }
     
     /**
      * @brief Print cut flow summary
+     *
+     * Independent efficiencies (passed/tested per cut) in cut-flow order,
+     * followed by the sequential flow when beginEvent() was used.
      */
     void printCutFlow(std::ostream& os = std::cout) const {
         os << "\n";
@@ -347,34 +624,42 @@ public:
         os << "║ Cut Name                   │ Tested   │ Passed   │ Efficiency  ║\n";
         os << "╠────────────────────────────┼──────────┼──────────┼─────────────╣\n";
         
-        // Range cuts
-        for (const auto& p : range_cuts_) {
-            const auto& c = p.second;
-            os << "║ " << std::left << std::setw(26) << c.name 
-               << " │ " << std::right << std::setw(8) << c.tested
-               << " │ " << std::setw(8) << c.passed
+        for (size_t k = 0; k < steps_.size(); ++k) {
+            const CutStats& st = stats_[k];
+            os << "║ " << std::left << std::setw(26) << steps_[k].name 
+               << " │ " << std::right << std::setw(8) << st.tested
+               << " │ " << std::setw(8) << st.passed
                << " │ " << std::setw(9) << std::fixed << std::setprecision(2) 
-               << (c.efficiency() * 100) << "%  ║\n";
+               << (ratio(st.passed, st.tested) * 100) << "%  ║\n";
         }
         
-        // Trigger cuts
-        for (const auto& p : trigger_cuts_) {
-            const auto& c = p.second;
-            os << "║ " << std::left << std::setw(26) << c.name 
-               << " │ " << std::right << std::setw(8) << c.tested
-               << " │ " << std::setw(8) << c.passed
-               << " │ " << std::setw(9) << std::fixed << std::setprecision(2) 
-               << (c.efficiency() * 100) << "%  ║\n";
+        if (flow_events_ > 0 && !steps_.empty()) {
+            os << "╠════════════════════════════════════════════════════════════════╣\n";
+            os << "║                      SEQUENTIAL CUT FLOW                       ║\n";
+            os << "╠════════════════════════════════════════════════════════════════╣\n";
+            os << "║ " << std::left << std::setw(62)
+               << ("Events: " + std::to_string(flow_events_)) << " ║\n";
+            os << "║ Step │ Cut Name               │ Passed   │ Step eff. │ Total   ║\n";
+            os << "╠──────┼────────────────────────┼──────────┼───────────┼─────────╣\n";
+            
+            Long64_t previous = flow_events_;
+            for (size_t k = 0; k < steps_.size(); ++k) {
+                Long64_t passed = stats_[k].flow_passed;
+                os << "║ " << std::right << std::setw(4) << k
+                   << " │ " << std::left << std::setw(22) << steps_[k].name
+                   << " │ " << std::right << std::setw(8) << passed
+                   << " │ " << std::setw(8) << std::fixed << std::setprecision(2)
+                   << (ratio(passed, previous) * 100) << "%"
+                   << " │ " << std::setw(6) << (ratio(passed, flow_events_) * 100) << "% ║\n";
+                previous = passed;
+            }
         }
         
-        // Graphical cuts
-        for (const auto& p : graphical_cuts_) {
-            const auto& c = p.second;
-            os << "║ " << std::left << std::setw(26) << c.name 
-               << " │ " << std::right << std::setw(8) << c.tested
-               << " │ " << std::setw(8) << c.passed
-               << " │ " << std::setw(9) << std::fixed << std::setprecision(2) 
-               << (c.efficiency() * 100) << "%  ║\n";
+        if (skipped_events_ > 0) {
+            os << "╠════════════════════════════════════════════════════════════════╣\n";
+            os << "║ " << std::left << std::setw(62)
+               << ("Skipped (input lacks required variables): " + std::to_string(skipped_events_))
+               << " ║\n";
         }
         
         os << "╚════════════════════════════════════════════════════════════════╝\n";
@@ -437,11 +722,105 @@ public:
         for (const auto& p : range_cuts_) names.push_back(p.first);
         return names;
     }
+    
+    /// Number of steps in the cut flow (all defined cuts)
+    size_t flowSteps() const { return steps_.size(); }
+    
+    /// Events started with beginEvent()
+    Long64_t flowEvents() const { return flow_events_; }
+    
+    /// Events counted with skipEvent()
+    Long64_t skippedEvents() const { return skipped_events_; }
+    
+    /**
+     * @brief Steps the current event has passed in the sequential flow
+     *
+     * The event passed step k (and all before it) if flowDepth() > k.
+     */
+    int flowDepth() const { return next_step_; }
+    
+    /**
+     * @brief Position of a cut in the cut flow (any kind), -1 if undefined
+     */
+    int flowStep(const std::string& name) const {
+        for (size_t k = 0; k < steps_.size(); ++k) {
+            if (steps_[k].name == name) return static_cast<int>(k);
+        }
+        return -1;
+    }
 
 private:
+    /// One compiled cut-flow step; 'cut' points at the map node of its kind
+    struct FlowStep {
+        CutKind kind;
+        std::string name;
+        const void* cut;
+    };
+    
+    /// Per-step counters, one cache line each so workers never share a line
+    struct alignas(64) CutStats {
+        Long64_t tested = 0;
+        Long64_t passed = 0;        // raw cut decision, independent of other cuts
+        Long64_t flow_passed = 0;   // passed this and every earlier step
+    };
+    
+    int findStep(CutKind kind, const std::string& name) const {
+        for (size_t k = 0; k < steps_.size(); ++k) {
+            if (steps_[k].kind == kind && steps_[k].name == name) return static_cast<int>(k);
+        }
+        return -1;
+    }
+    
+    /// Register a cut as the next flow step (redefinition keeps its step)
+    int addStep(CutKind kind, const std::string& name, const void* cut) {
+        int step = findStep(kind, name);
+        if (step >= 0) {
+            steps_[step].cut = cut;
+            return step;
+        }
+        steps_.push_back(FlowStep{kind, name, cut});
+        stats_.emplace_back();
+        return static_cast<int>(steps_.size()) - 1;
+    }
+    
+    GraphicalCutId storeGraphicalCut(const std::string& name, TCutG* cut,
+                                     const std::string& description) {
+        GraphicalCut& stored = graphical_cuts_[name];
+        stored = GraphicalCut(name, cut, description);
+        return GraphicalCutId(addStep(CutKind::Graphical, name, &stored));
+    }
+    
+    /**
+     * @brief Count one evaluation of a step (branch-free)
+     *
+     * The step extends the sequential flow only when it is the next one
+     * expected in this event and the event survives it.
+     */
+    bool record(int step, bool result, bool active) {
+        CutStats& st = stats_[step];
+        bool decision = result | !active;
+        bool in_flow = (step == next_step_) & decision;
+        st.tested += 1;
+        st.passed += result;
+        st.flow_passed += in_flow;
+        next_step_ += in_flow;
+        return decision;
+    }
+    
+    static double ratio(Long64_t num, Long64_t den) {
+        return den > 0 ? static_cast<double>(num) / den : 0.0;
+    }
+    
     std::map<std::string, RangeCut> range_cuts_;
     std::map<std::string, TriggerCut> trigger_cuts_;
     std::map<std::string, GraphicalCut> graphical_cuts_;
+    
+    // Compiled cut flow (definition order) and its statistics
+    std::vector<FlowStep> steps_;
+    std::vector<CutStats> stats_;
+    Long64_t flow_events_ = 0;
+    Long64_t skipped_events_ = 0;
+    int next_step_ = 0;
 };
 
 // ============================================================================
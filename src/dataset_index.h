@@ -0,0 +1,308 @@
+/**
+ * @file dataset_index.h
+ * @brief Sidecar index of a file list: entries, branches and clusters per file
+ *
+ * Counting the entries of a TChain opens every file of the list, which on
+ * NFS or spinning disks takes minutes for a few hundred files before the
+ * first event is read. The index keeps what opening a file tells - tree
+ * entries, branch names, cluster boundaries - together with the file's
+ * size and modification time. Later runs build the chain with
+ * TChain::Add(file, entries), so a file is opened only when the event loop
+ * reaches it; only new or changed files are scanned again.
+ *
+ * Stored as JSON, by default next to the list ("input.index": "auto":
+ * h68_10.list -> h68_10.list.index.json). Several processes may update
+ * one index (--split jobs): save() merges with what is on disk under a
+ * lock file, so every job's new records are kept.
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef DATASET_INDEX_H
+#define DATASET_INDEX_H
+
+#include "analysis_config.h"
+#include <TFile.h>
+#include <TTree.h>
+#include <TLeaf.h>
+#include <TObjArray.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// DatasetFileInfo: What Opening One Input File Tells
+// ============================================================================
+/**
+ * @struct DatasetFileInfo
+ * @brief Index record of one input file
+ */
+struct DatasetFileInfo {
+    std::string file;
+    Long64_t size = -1;                 ///< Bytes (-1 = not a local file)
+    Long64_t mtime = -1;                ///< Modification time, seconds (-1 = not a local file)
+    Long64_t entries = 0;
+    std::vector<std::string> branches;  ///< Leaf names of the tree
+    std::vector<Long64_t> clusters;     ///< First (local) entry of every cluster
+};
+
+// ============================================================================
+// DatasetIndex: Per-File Metadata of a File List, Kept Up to Date
+// ============================================================================
+/**
+ * @class DatasetIndex
+ * @brief Entries and layout of the files of a list without opening them
+ *
+ * Usage Example:
+ * @code
+ *   DatasetIndex index = DatasetIndex::load("h68_10.list.index.json");
+ *   index.update(files, "PPip_ID");      // scans new/changed files only
+ *   index.save("h68_10.list.index.json");
+ *   for (const auto& f : index.files()) chain.Add(f.file.c_str(), f.entries);
+ * @endcode
+ *
+ * A local file is trusted while its size and modification time match.
+ * Remote files (root://, http://) cannot be checked that cheaply and are
+ * trusted once indexed; delete the index after changing them.
+ */
+class DatasetIndex {
+public:
+    /**
+     * @brief Read an index (empty index if the file does not exist or is unreadable)
+     */
+    static DatasetIndex load(const std::string& filename) {
+        DatasetIndex index;
+        std::error_code ec;
+        if (!std::filesystem::exists(filename, ec)) return index;
+
+        try {
+            JsonValue json = JsonParser::parseFile(filename);
+            if (json["version"].asInt(0) != 1) {
+                std::cerr << "Warning: " << filename << " - unknown index version, rebuilding\n";
+                return index;
+            }
+            index.treename_ = json["tree"].asString("");
+            for (const auto& f : json["files"].asArray()) {
+                DatasetFileInfo info;
+                info.file = f["file"].asString();
+                info.size = f["size"].asLong(-1);
+                info.mtime = f["mtime"].asLong(-1);
+                info.entries = f["entries"].asLong(-1);
+                for (const auto& b : f["branches"].asArray()) info.branches.push_back(b.asString());
+                for (const auto& c : f["clusters"].asArray()) info.clusters.push_back(c.asLong(-1));
+                index.known_[info.file] = info;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: " << filename << " - unreadable index (" << e.what() << "), rebuilding\n";
+            index.known_.clear();
+        }
+        return index;
+    }
+
+    /**
+     * @brief Bring the index up to the given files, in list order
+     * @return Number of files that had to be opened
+     *
+     * Records of files not in the list are kept, so batch jobs reading
+     * parts of the list can share one index. Files that cannot be opened
+     * or lack the tree are left out of files() with a warning (and tried
+     * again next time).
+     */
+    int update(const std::vector<std::string>& files, const std::string& treename) {
+        if (treename != treename_) {
+            known_.clear();
+            updated_.clear();
+            treename_ = treename;
+        }
+
+        files_.clear();
+        int scanned = 0;
+        for (const auto& file : files) {
+            DatasetFileInfo stat = statFile(file);
+            auto it = known_.find(file);
+            bool valid = it != known_.end() && it->second.size == stat.size &&
+                         it->second.mtime == stat.mtime;
+
+            if (!valid) {
+                ++scanned;
+                if (!scanFile(file, treename, stat)) {
+                    known_.erase(file);
+                    updated_[file] = false;
+                    continue;
+                }
+                known_[file] = stat;
+                updated_[file] = true;
+            }
+            files_.push_back(known_[file]);
+        }
+        changed_ = changed_ || scanned > 0;
+        return scanned;
+    }
+
+    /**
+     * @brief Write all known files (atomically: temporary file, then rename)
+     *
+     * Skipped when nothing changed since load(). Other processes may have
+     * saved the index meanwhile: under an exclusive lock on
+     * filename + ".lock" the index is read again, the files this process
+     * scanned are merged into it, and the result replaces the file.
+     */
+    void save(const std::string& filename) const {
+        if (!changed_) return;
+
+        // Held until the rename; released when the descriptor is closed
+        std::string lock_file = filename + ".lock";
+        int lock_fd = ::open(lock_file.c_str(), O_CREAT | O_RDWR, 0644);
+        if (lock_fd < 0 || ::flock(lock_fd, LOCK_EX) != 0) {
+            if (lock_fd >= 0) ::close(lock_fd);
+            throw std::runtime_error("DatasetIndex: Cannot lock " + lock_file);
+        }
+        try {
+            write(filename, merged(filename));
+        } catch (...) {
+            ::close(lock_fd);
+            throw;
+        }
+        ::close(lock_fd);
+    }
+
+    /// Indexed files of the last update(), in list order
+    const std::vector<DatasetFileInfo>& files() const { return files_; }
+
+    const std::string& treeName() const { return treename_; }
+
+    Long64_t totalEntries() const {
+        Long64_t total = 0;
+        for (const auto& f : files_) total += f.entries;
+        return total;
+    }
+
+private:
+    /**
+     * @brief Records on disk now, with this process's scans applied
+     */
+    std::map<std::string, DatasetFileInfo> merged(const std::string& filename) const {
+        DatasetIndex disk = load(filename);
+        if (disk.treename_ != treename_) return known_;
+
+        std::map<std::string, DatasetFileInfo> records = disk.known_;
+        for (const auto& pair : known_) {
+            if (!records.count(pair.first)) records[pair.first] = pair.second;
+        }
+        for (const auto& pair : updated_) {
+            if (pair.second) {
+                records[pair.first] = known_.at(pair.first);
+            } else {
+                records.erase(pair.first);
+            }
+        }
+        return records;
+    }
+
+    /**
+     * @brief Write records to a temporary file of this process, then rename
+     */
+    void write(const std::string& filename, const std::map<std::string, DatasetFileInfo>& records) const {
+        JsonValue index = JsonValue::object();
+        index.set("version", 1);
+        index.set("tree", treename_);
+        JsonValue files = JsonValue::array();
+        for (const auto& pair : records) {
+            const DatasetFileInfo& f = pair.second;
+            JsonValue file = JsonValue::object();
+            file.set("file", f.file);
+            file.set("size", f.size);
+            file.set("mtime", f.mtime);
+            file.set("entries", f.entries);
+            JsonValue branches = JsonValue::array();
+            for (const auto& b : f.branches) branches.push_back(b);
+            file.set("branches", branches);
+            JsonValue clusters = JsonValue::array();
+            for (Long64_t c : f.clusters) clusters.push_back(c);
+            file.set("clusters", clusters);
+            files.push_back(file);
+        }
+        index.set("files", files);
+
+        std::string tmp = filename + ".tmp" + std::to_string(::getpid());
+        {
+            std::ofstream out(tmp);
+            if (!out) {
+                throw std::runtime_error("DatasetIndex: Cannot write " + tmp);
+            }
+            out << index.dump() << "\n";
+            if (!out) {
+                throw std::runtime_error("DatasetIndex: Failed writing " + tmp);
+            }
+        }
+        if (std::rename(tmp.c_str(), filename.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            throw std::runtime_error("DatasetIndex: Cannot replace " + filename);
+        }
+    }
+
+    /**
+     * @brief Size and modification time of a local file (-1 for URLs)
+     */
+    static DatasetFileInfo statFile(const std::string& file) {
+        DatasetFileInfo info;
+        info.file = file;
+        if (file.find("://") != std::string::npos) return info;
+
+        std::error_code ec;
+        auto size = std::filesystem::file_size(file, ec);
+        if (ec) return info;
+        auto mtime = std::filesystem::last_write_time(file, ec);
+        if (ec) return info;
+        info.size = static_cast<Long64_t>(size);
+        info.mtime = std::chrono::duration_cast<std::chrono::seconds>(mtime.time_since_epoch()).count();
+        return info;
+    }
+
+    /**
+     * @brief Open a file and record entries, branches and cluster starts
+     */
+    static bool scanFile(const std::string& file, const std::string& treename, DatasetFileInfo& info) {
+        std::unique_ptr<TFile> f(TFile::Open(file.c_str(), "READ"));
+        if (!f || f->IsZombie()) {
+            std::cerr << "Warning: Cannot open " << file << " (not indexed)\n";
+            return false;
+        }
+        TTree* tree = dynamic_cast<TTree*>(f->Get(treename.c_str()));
+        if (!tree) {
+            std::cerr << "Warning: No tree '" << treename << "' in " << file << " (not indexed)\n";
+            return false;
+        }
+
+        info.entries = tree->GetEntries();
+        TObjArray* leaves = tree->GetListOfLeaves();
+        for (int i = 0; leaves && i < leaves->GetEntries(); ++i) {
+            info.branches.push_back(leaves->At(i)->GetName());
+        }
+        TTree::TClusterIterator clusters = tree->GetClusterIterator(0);
+        Long64_t start;
+        while ((start = clusters()) < info.entries) {
+            info.clusters.push_back(start);
+        }
+        return true;
+    }
+
+    std::string treename_;
+    std::map<std::string, DatasetFileInfo> known_;   // By file name: loaded and scanned
+    std::vector<DatasetFileInfo> files_;             // List order, from update()
+    std::map<std::string, bool> updated_;            // Scanned here: true = record, false = drop
+    bool changed_ = false;
+};
+
+#endif // DATASET_INDEX_H
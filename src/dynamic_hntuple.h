@@ -11,7 +11,25 @@
  * - Intermediate TTree storage (handles dynamic schema)
  * - Final conversion to flat TNtuple (alphabetically ordered)
  * - Missing values filled with configurable sentinel (default: -1)
+ * - Late-discovered variables backfilled with the sentinel
+ * - Optional pre-declared schema: slot-indexed, contiguous value buffer
  * - Progress indicator during conversion
+ * - Worker shards (one per thread) merged in order before conversion
+ * - Configurable basket size and auto-flush (setTreeOptions()); the
+ *   intermediate file uses the output file's compression
+ * - Checkpoints: entries filled so far are sealed into segment files
+ *   that a resumed job takes over (checkpoint(), restoreSegments())
+ *
+ * Storage modes (Mode):
+ * - Convert: intermediate TTree file, copied into the TNtuple at the end
+ * - Memory:  columns buffered in memory (optionally spilled to a raw file
+ *            above spill_mb), TNtuple written once - no second ROOT pass
+ * - Tree:    TTree written directly to the output file, no TNtuple
+ *            (branches in discovery order, worker shards buffer in memory)
+ * - RNTuple: RNTuple written directly to the output file while filling,
+ *            worker shards through their own fill contexts of one
+ *            RNTupleParallelWriter (rntuple_backend.h); variables are
+ *            fixed at the first fill(), so declare() them
  *
  * Usage:
  * @code
@@ -29,6 +47,16 @@
  *   nt.finalize();  // Converts TTree -> TNtuple
  * @endcode
  *
+ * Fast path - declare the known variables once, fill through slots:
+ * @code
+ *   nt.declare({"event", "mass"});
+ *   DynamicHNtuple::Slot s_mass = nt.slot("mass");
+ *
+ *   nt[s_mass] = calculated_mass;   // plain array store
+ *   nt["hit_3"] = hit_value;        // dynamic variables still work
+ *   nt.fill();
+ * @endcode
+ *
  * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
  * @date 2025
  */
@@ -40,6 +68,7 @@
 #include <TTree.h>
 #include <TNtuple.h>
 #include <TBranch.h>
+#include <TObjArray.h>
 #include <string>
 #include <map>
 #include <set>
@@ -53,12 +82,53 @@
 #include <chrono>
 #include <fstream>
 
+#include "column_buffer.h"
+#include "rntuple_backend.h"
+
 // ============================================================================
 // DynamicHNtuple: Unlimited variable discovery with TTree→TNtuple conversion
 // ============================================================================
 
 class DynamicHNtuple {
 public:
+    /**
+     * @brief Index of a pre-declared variable (see declare())
+     */
+    struct Slot {
+        UInt_t index = 0;
+    };
+    
+    /**
+     * @brief Where events are stored until finalize()
+     */
+    enum class Mode {
+        Convert,  ///< Intermediate TTree file -> TNtuple (default)
+        Memory,   ///< Column buffer (+ spill file) -> TNtuple
+        Tree,     ///< TTree directly in the output file
+        RNTuple   ///< RNTuple directly in the output file, parallel fills
+    };
+    
+    /**
+     * @brief Parse mode name from configuration ("convert", "memory", "tree", "rntuple")
+     */
+    static Mode parseMode(const std::string& name) {
+        if (name == "convert") return Mode::Convert;
+        if (name == "memory") return Mode::Memory;
+        if (name == "tree") return Mode::Tree;
+        if (name == "rntuple") return Mode::RNTuple;
+        throw std::runtime_error("DynamicHNtuple: Unknown ntuple mode '" + name +
+                               "' (use convert, memory, tree or rntuple)");
+    }
+    
+    static const char* modeName(Mode mode) {
+        switch (mode) {
+            case Mode::Memory:  return "memory";
+            case Mode::Tree:    return "tree";
+            case Mode::RNTuple: return "rntuple";
+            default:           return "convert";
+        }
+    }
+    
     // ========================================================================
     // Constructor / Destructor
     // ========================================================================
@@ -70,46 +140,86 @@ public:
      * @param output_file Pointer to final output ROOT file
      * @param missing_value Value to use for missing variables (default: -1)
      * @param keep_intermediate Keep intermediate TTree file (default: false)
+     * @param shard_index Worker shard index (-1 for the main ntuple)
+     * @param mode Storage mode (see Mode)
+     * @param spill_mb Memory mode: spill buffered columns above this size (0 = never)
      */
     DynamicHNtuple(const std::string& name, const std::string& title,
                    TFile* output_file,
                    Float_t missing_value = -1.0f,
-                   bool keep_intermediate = false)
+                   bool keep_intermediate = false,
+                   int shard_index = -1,
+                   Mode mode = Mode::Convert,
+                   size_t spill_mb = 0)
         : name_(name), title_(title), output_file_(output_file),
-          missing_value_(missing_value), keep_intermediate_(keep_intermediate)
+          missing_value_(missing_value), keep_intermediate_(keep_intermediate),
+          mode_(mode)
     {
         if (!output_file_) {
             throw std::runtime_error("DynamicHNtuple: output_file cannot be null!");
         }
         
-        // Create intermediate file with unique name per ntuple
+        // Auxiliary files get a unique name per ntuple
         // Format: output_name_tree.root (e.g., output_ppip_nt_particles_tree.root)
+        // Worker shards add their index: output_ppip_nt_particles_w3_tree.root
         std::string out_path = output_file_->GetName();
+        std::string suffix = "_" + name_;
+        if (shard_index >= 0) {
+            suffix += "_w" + std::to_string(shard_index);
+        }
         size_t dot_pos = out_path.rfind('.');
-        if (dot_pos != std::string::npos) {
-            intermediate_filename_ = out_path.substr(0, dot_pos) + "_" + name_ + "_tree.root";
-        } else {
-            intermediate_filename_ = out_path + "_" + name_ + "_tree.root";
+        base_ = (dot_pos != std::string::npos ? out_path.substr(0, dot_pos) : out_path) + suffix;
+        
+        // Shards cannot write into the shared output file: buffer instead
+        if (mode_ == Mode::Tree && shard_index >= 0) {
+            mode_ = Mode::Memory;
+            replay_to_tree_ = true;
         }
         
-        // Open intermediate file
-        intermediate_file_ = std::make_unique<TFile>(intermediate_filename_.c_str(), "RECREATE");
-        if (!intermediate_file_ || intermediate_file_->IsZombie()) {
-            throw std::runtime_error("DynamicHNtuple: Cannot create intermediate file: " + intermediate_filename_);
+        if (mode_ == Mode::Memory) {
+            buffer_ = std::make_unique<ColumnBuffer>(missing_value_, spill_mb * 1024 * 1024,
+                                                     base_ + "_spill.bin");
+            std::cout << "DynamicHNtuple: Created '" << name_ << "' with in-memory column storage";
+            if (spill_mb > 0) std::cout << " (spill above " << spill_mb << " MB)";
+            std::cout << "\n";
+            return;
         }
         
-        // Create TTree
-        tree_ = new TTree((name_ + "_tree").c_str(), title_.c_str());
-        tree_->SetDirectory(intermediate_file_.get());
+        // Shards fill the main ntuple's writer (shareRNTuple())
+        if (mode_ == Mode::RNTuple) {
+            if (shard_index < 0) {
+                sink_ = std::make_shared<RNTupleSink>(name_, output_file_,
+                                                      output_file_->GetCompressionSettings());
+                std::cout << "DynamicHNtuple: Created '" << name_ << "' as RNTuple in "
+                          << output_file_->GetName() << "\n";
+            }
+            return;
+        }
+        
+        if (mode_ == Mode::Tree) {
+            output_file_->cd();
+            tree_ = new TTree(name_.c_str(), title_.c_str());
+            tree_->SetDirectory(output_file_);
+            std::cout << "DynamicHNtuple: Created '" << name_ << "' as TTree in "
+                      << output_file_->GetName() << "\n";
+            return;
+        }
+        
+        intermediate_filename_ = base_ + "_tree.root";
+        openIntermediateTree();
         
         std::cout << "DynamicHNtuple: Created '" << name_ << "' with intermediate storage: " 
                   << intermediate_filename_ << "\n";
     }
     
     ~DynamicHNtuple() {
-        // Clean up branch value storage
-        for (auto& pair : branch_values_) {
-            delete pair.second;
+        // A fill context is bound to the values below
+        rntuple_fill_.reset();
+        
+        // Clean up storage of dynamically added variables
+        // (declared variables live in schema_values_)
+        for (Float_t* value : dynamic_values_) {
+            delete value;
         }
     }
     
@@ -117,6 +227,43 @@ public:
     DynamicHNtuple(const DynamicHNtuple&) = delete;
     DynamicHNtuple& operator=(const DynamicHNtuple&) = delete;
     
+    // ========================================================================
+    // Output Tuning
+    // ========================================================================
+    
+    /**
+     * @brief Set branch buffer size and auto-flush of all trees written
+     * @param basket_size Bytes per branch buffer (0 = ROOT default, 32000)
+     * @param auto_flush TTree::SetAutoFlush() value (0 = ROOT default)
+     *
+     * Applies to the intermediate/output TTree and to the final TNtuple.
+     * Larger baskets mean fewer, better compressed writes of wide ntuples.
+     */
+    void setTreeOptions(Int_t basket_size, Long64_t auto_flush) {
+        basket_size_ = basket_size > 0 ? basket_size : kDefaultBasketSize;
+        auto_flush_ = auto_flush;
+        if (tree_) {
+            applyTreeOptions(tree_);
+            if (!branch_values_.empty()) {
+                tree_->SetBasketSize("*", basket_size_);
+            }
+        }
+    }
+    
+    /**
+     * @brief RNTuple mode: fill the writer of the main ntuple (worker shards)
+     *
+     * Each shard gets its own fill context at its first fill(), so worker
+     * threads write clusters concurrently; merge() only closes the context.
+     */
+    void shareRNTuple(DynamicHNtuple& main) {
+        if (mode_ != Mode::RNTuple || main.mode_ != Mode::RNTuple || !main.sink_) {
+            throw std::runtime_error("DynamicHNtuple::shareRNTuple() - '" + name_ +
+                                   "': both ntuples must be in rntuple mode");
+        }
+        sink_ = main.sink_;
+    }
+    
     // ========================================================================
     // Variable Access - Add ANY variable at ANY time
     // ========================================================================
@@ -137,17 +284,71 @@ public:
             return *(it->second);
         }
         
-        // New variable - create branch dynamically
+        // New variable - create branch/column dynamically
         Float_t* value_ptr = new Float_t(missing_value_);
-        branch_values_[key] = value_ptr;
-        discovered_vars_.insert(key);
-        
-        // Create branch in TTree
-        tree_->Branch(key.c_str(), value_ptr, (key + "/F").c_str());
+        dynamic_values_.push_back(value_ptr);
+        addVariable(key, value_ptr);
         
         return *value_ptr;
     }
     
+    // ========================================================================
+    // Pre-declared Schema - slot-indexed fast path
+    // ========================================================================
+    
+    /**
+     * @brief Declare variables up front
+     * @param names Variable names (order defines the slot indices)
+     *
+     * All declared values live in one contiguous, cache-line aligned
+     * Float_t array that the branches (or columns) point into; fill()
+     * resets it with a single std::fill. Call once, before any other
+     * variable is created. operator[](name) keeps working for these names
+     * and for any variable added later.
+     */
+    void declare(const std::vector<std::string>& names) {
+        if (finalized_ || !branch_values_.empty() || fill_count_ > 0) {
+            throw std::runtime_error("DynamicHNtuple::declare() - '" + name_ +
+                                   "': declare() must come before any variable or fill()!");
+        }
+        
+        size_t blocks = (names.size() + kFloatsPerBlock - 1) / kFloatsPerBlock;
+        schema_blocks_.assign(blocks, SchemaBlock());
+        schema_values_ = reinterpret_cast<Float_t*>(schema_blocks_.data());
+        schema_size_ = names.size();
+        std::fill(schema_values_, schema_values_ + schema_size_, missing_value_);
+        
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (branch_values_.count(names[i])) {
+                throw std::runtime_error("DynamicHNtuple::declare() - Duplicate variable '" +
+                                       names[i] + "' in '" + name_ + "'");
+            }
+            schema_index_[names[i]] = static_cast<UInt_t>(i);
+            addVariable(names[i], schema_values_ + i);
+        }
+    }
+    
+    /**
+     * @brief Look up the slot of a declared variable (call at setup, not per event)
+     */
+    Slot slot(const std::string& key) const {
+        auto it = schema_index_.find(key);
+        if (it == schema_index_.end()) {
+            throw std::runtime_error("DynamicHNtuple::slot() - Variable '" + key +
+                                   "' not declared in '" + name_ + "'");
+        }
+        return Slot{it->second};
+    }
+    
+    /**
+     * @brief Access declared variable by slot (no lookup)
+     */
+    Float_t& operator[](Slot s) {
+        return schema_values_[s.index];
+    }
+    
+    size_t declaredCount() const { return schema_size_; }
+    
     /**
      * @brief Const access (for reading)
      */
@@ -173,15 +374,189 @@ public:
             throw std::runtime_error("DynamicHNtuple: Cannot fill() after finalize()!");
         }
         
-        tree_->Fill();
+        if (buffer_) {
+            buffer_->appendRow(column_values_);
+        } else if (mode_ == Mode::RNTuple) {
+            if (!rntuple_fill_) startRNTuple();
+            rntuple_fill_->fill();
+        } else {
+            tree_->Fill();
+        }
         fill_count_++;
         
         // Reset all values to missing for next event
-        for (auto& pair : branch_values_) {
-            *(pair.second) = missing_value_;
+        std::fill(schema_values_, schema_values_ + schema_size_, missing_value_);
+        for (Float_t* value : dynamic_values_) {
+            *value = missing_value_;
+        }
+    }
+    
+    // ========================================================================
+    // Merge - Take over the entries of a worker shard
+    // ========================================================================
+    
+    /**
+     * @brief Merge a worker shard into this ntuple
+     * 
+     * The shard's intermediate TTree is written and closed; its entries are
+     * appended after the entries of this ntuple (and of previously merged
+     * shards) during finalize(). Variables discovered only by the shard are
+     * added to the final TNtuple and filled with missing_value elsewhere.
+     * Merge shards in a fixed order to get a reproducible output.
+     * In memory mode the shard's columns are taken over; in tree mode the
+     * shard's buffered rows are filled into this tree. Checkpoint segments
+     * of the shard come before its other entries. In rntuple mode the shard
+     * has written its entries already; its fill context is closed.
+     */
+    void merge(DynamicHNtuple& shard) {
+        if (finalized_ || shard.finalized_) {
+            throw std::runtime_error("DynamicHNtuple::merge() - Cannot merge finalized ntuple '" +
+                                   shard.name_ + "'!");
+        }
+        
+        if (mode_ == Mode::RNTuple || shard.mode_ == Mode::RNTuple) {
+            if (!sink_ || shard.sink_ != sink_) {
+                throw std::runtime_error("DynamicHNtuple::merge() - Storage mode mismatch for '" +
+                                       shard.name_ + "'!");
+            }
+            shard.rntuple_fill_.reset();
+            discovered_vars_.insert(shard.discovered_vars_.begin(), shard.discovered_vars_.end());
+            fill_count_ += shard.fill_count_;
+            shard.finalized_ = true;
+            return;
+        }
+        
+        if (shard.replay_to_tree_ && mode_ == Mode::Tree) {
+            std::vector<std::string> order(shard.discovered_vars_.begin(), shard.discovered_vars_.end());
+            std::vector<Float_t*> targets;
+            for (const auto& var : order) {
+                targets.push_back(&(*this)[var]);
+            }
+            shard.buffer_->forEachRow(order, [&](const Float_t* row) {
+                for (size_t j = 0; j < targets.size(); ++j) {
+                    *targets[j] = row[j];
+                }
+                fill();
+            });
+            shard.buffer_->clear();
+            shard.finalized_ = true;
+            return;
+        }
+        
+        if (buffer_ && shard.buffer_) {
+            buffer_->merge(*shard.buffer_);
+            shard_files_.insert(shard_files_.end(), shard.segments_.begin(), shard.segments_.end());
+            checkpointed_.insert(shard.checkpointed_.begin(), shard.checkpointed_.end());
+            discovered_vars_.insert(shard.discovered_vars_.begin(), shard.discovered_vars_.end());
+            fill_count_ += shard.fill_count_;
+            shard.finalized_ = true;
+            return;
+        }
+        
+        if (!shard.intermediate_file_ || !intermediate_file_) {
+            throw std::runtime_error("DynamicHNtuple::merge() - Storage mode mismatch for '" +
+                                   shard.name_ + "'!");
+        }
+        
+        shard.intermediate_file_->cd();
+        shard.tree_->Write();
+        shard.intermediate_file_->Close();
+        shard.intermediate_file_.reset();
+        shard.tree_ = nullptr;
+        
+        shard_files_.insert(shard_files_.end(), shard.segments_.begin(), shard.segments_.end());
+        shard_files_.push_back(shard.intermediate_filename_);
+        shard_files_.insert(shard_files_.end(), shard.shard_files_.begin(), shard.shard_files_.end());
+        checkpointed_.insert(shard.checkpointed_.begin(), shard.checkpointed_.end());
+        discovered_vars_.insert(shard.discovered_vars_.begin(), shard.discovered_vars_.end());
+        fill_count_ += shard.fill_count_;
+        
+        // Shard no longer owns its intermediate file
+        shard.shard_files_.clear();
+        shard.finalized_ = true;
+    }
+    
+    // ========================================================================
+    // Checkpoint - Seal the entries filled so far
+    // ========================================================================
+    
+    /**
+     * @brief Move all entries stored so far into a closed segment file
+     * @param serial Checkpoint number (part of the segment file name)
+     * @return All segments of this ntuple, oldest first
+     *
+     * A segment is never written again, so a job resumed from this
+     * checkpoint takes the segments over and loses only what was filled
+     * after it. finalize() reads segments before the current storage but
+     * does not delete them: whoever owns the checkpoint removes them once
+     * the output is complete. Not available in tree and rntuple mode.
+     */
+    const std::vector<std::string>& checkpoint(int serial) {
+        if (finalized_) {
+            throw std::runtime_error("DynamicHNtuple::checkpoint() - '" + name_ + "' is finalized!");
+        }
+        if (mode_ == Mode::Tree || replay_to_tree_ || mode_ == Mode::RNTuple) {
+            throw std::runtime_error("DynamicHNtuple::checkpoint() - '" + name_ + "': " + modeName(mode_) +
+                                   " mode cannot be checkpointed (use convert or memory)!");
+        }
+        
+        std::string segment = base_ + "_ckpt" + std::to_string(serial) + "_tree.root";
+        if (buffer_) {
+            if (buffer_->rows() == 0) return segments_;
+            writeSegment(segment);
+            buffer_->clearRows();
+        } else {
+            if (tree_->GetEntries() == 0) return segments_;
+            intermediate_file_->cd();
+            tree_->Write();
+            intermediate_file_->Close();
+            intermediate_file_.reset();
+            tree_ = nullptr;
+            if (std::rename(intermediate_filename_.c_str(), segment.c_str()) != 0) {
+                throw std::runtime_error("DynamicHNtuple::checkpoint() - Cannot move " +
+                                       intermediate_filename_ + " to " + segment);
+            }
+            openIntermediateTree();
         }
+        segments_.push_back(segment);
+        checkpointed_.insert(segment);
+        return segments_;
     }
     
+    /**
+     * @brief Take over the segments of a checkpoint (resumed job)
+     * @param segments Files returned by checkpoint(), oldest first
+     *
+     * Their entries count as filled and their variables as discovered.
+     * Call after declare() and before the first fill().
+     */
+    void restoreSegments(const std::vector<std::string>& segments) {
+        if (finalized_) {
+            throw std::runtime_error("DynamicHNtuple::restoreSegments() - '" + name_ + "' is finalized!");
+        }
+        for (const auto& segment : segments) {
+            TFile file(segment.c_str(), "READ");
+            TTree* tree = file.IsZombie() ? nullptr
+                                          : dynamic_cast<TTree*>(file.Get((name_ + "_tree").c_str()));
+            if (!tree) {
+                throw std::runtime_error("DynamicHNtuple::restoreSegments() - Cannot read '" + name_ +
+                                       "' from " + segment);
+            }
+            TObjArray* branches = tree->GetListOfBranches();
+            for (Int_t b = 0; b < branches->GetEntriesFast(); ++b) {
+                discovered_vars_.insert(branches->At(b)->GetName());
+            }
+            fill_count_ += tree->GetEntries();
+            file.Close();
+            
+            segments_.push_back(segment);
+            checkpointed_.insert(segment);
+        }
+    }
+    
+    /// Checkpoint segments of this ntuple, oldest first
+    const std::vector<std::string>& getSegments() const { return segments_; }
+    
     // ========================================================================
     // Finalize - Convert TTree to TNtuple
     // ========================================================================
@@ -190,10 +565,12 @@ public:
      * @brief Finalize: Convert intermediate TTree to flat TNtuple
      * 
      * This must be called before closing the output file.
-     * Converts all data from TTree to TNtuple format with:
+     * Converts all data from TTree (or column buffer) to TNtuple format with:
      * - All discovered variables (alphabetically ordered)
      * - Missing values filled with configured sentinel
      * - Progress indicator during conversion
+     * In tree mode the TTree is just written to the output file, in
+     * rntuple mode the RNTuple is committed (merge() the shards first).
      */
     void finalize() {
         if (finalized_) {
@@ -201,6 +578,34 @@ public:
             return;
         }
         
+        if (mode_ == Mode::RNTuple) {
+            rntuple_fill_.reset();
+            if (!sink_) {
+                throw std::runtime_error("DynamicHNtuple::finalize() - Shard '" + name_ +
+                                       "' is written by its main ntuple (merge() it)");
+            }
+            // Nothing filled: still write the (empty) RNTuple with its fields
+            if (!sink_->started() && !branch_values_.empty()) {
+                sink_->context(branch_values_, missing_value_);
+            }
+            output_file_->cd();
+            sink_->close();
+            finalized_ = true;
+            std::cout << "✓ RNTuple '" << name_ << "' written with " << sink_->fields().size()
+                      << " variables, " << fill_count_ << " entries\n";
+            return;
+        }
+        
+        if (mode_ == Mode::Tree) {
+            output_file_->cd();
+            tree_->Write();
+            bytes_written_ = tree_->GetZipBytes();
+            finalized_ = true;
+            std::cout << "✓ TTree '" << name_ << "' written with " << discovered_vars_.size()
+                      << " variables, " << fill_count_ << " entries\n";
+            return;
+        }
+        
         // Handle case with no variables or no entries
         if (discovered_vars_.empty() || fill_count_ == 0) {
             std::cout << "DynamicHNtuple '" << name_ << "': ";
@@ -222,7 +627,8 @@ public:
                     if (i < sorted_vars.size() - 1) varlist += ":";
                 }
                 output_file_->cd();
-                auto ntuple = std::make_unique<TNtuple>(name_.c_str(), title_.c_str(), varlist.c_str());
+                auto ntuple = std::make_unique<TNtuple>(name_.c_str(), title_.c_str(), varlist.c_str(),
+                                                        basket_size_);
                 ntuple->Write();
                 std::cout << "✓ Created empty TNtuple '" << name_ << "' with " << sorted_vars.size() << " variables\n";
             }
@@ -233,7 +639,11 @@ public:
         
         std::cout << "\n";
         std::cout << "╔════════════════════════════════════════════════════════════════╗\n";
-        std::cout << "║         Converting TTree → TNtuple                             ║\n";
+        if (buffer_) {
+            std::cout << "║         Writing columns → TNtuple                              ║\n";
+        } else {
+            std::cout << "║         Converting TTree → TNtuple                             ║\n";
+        }
         std::cout << "╠════════════════════════════════════════════════════════════════╣\n";
         std::cout << "║ NTuple:     " << std::left << std::setw(51) << name_ << " ║\n";
         std::cout << "║ Variables:  " << std::left << std::setw(51) << discovered_vars_.size() << " ║\n";
@@ -256,38 +666,15 @@ public:
         }
         std::cout << "\n";
         
-        // Write and close intermediate tree
-        intermediate_file_->cd();
-        tree_->Write();
-        
-        // Reopen for reading
-        intermediate_file_->Close();
-        intermediate_file_ = std::make_unique<TFile>(intermediate_filename_.c_str(), "READ");
-        TTree* read_tree = dynamic_cast<TTree*>(intermediate_file_->Get((name_ + "_tree").c_str()));
-        
-        if (!read_tree) {
-            throw std::runtime_error("DynamicHNtuple: Failed to reopen intermediate TTree!");
-        }
-        
-        // Set up branch addresses for reading
-        std::map<std::string, Float_t> read_values;
-        for (const auto& var : sorted_vars) {
-            read_values[var] = missing_value_;
-            TBranch* branch = read_tree->GetBranch(var.c_str());
-            if (branch) {
-                read_tree->SetBranchAddress(var.c_str(), &read_values[var]);
-            }
-        }
-        
         // Create final TNtuple in output file
         output_file_->cd();
-        auto ntuple = std::make_unique<TNtuple>(name_.c_str(), title_.c_str(), varlist.c_str());
-        
-        // Prepare float array for filling
-        std::vector<Float_t> values(sorted_vars.size());
+        auto ntuple = std::make_unique<TNtuple>(name_.c_str(), title_.c_str(), varlist.c_str(),
+                                                basket_size_);
+        applyTreeOptions(ntuple.get());
         
         // Convert with progress indicator
-        Long64_t total = read_tree->GetEntries();
+        Long64_t total = fill_count_;
+        Long64_t done = 0;
         Long64_t last_percent = -1;
         
         std::cout << "Converting: ";
@@ -295,48 +682,56 @@ public:
         
         auto start_time = std::chrono::steady_clock::now();
         
-        for (Long64_t i = 0; i < total; ++i) {
-            // Reset to missing value before reading
-            for (auto& pair : read_values) {
-                pair.second = missing_value_;
-            }
+        // Checkpoint segments first, then the own tree, then merged worker
+        // shards in merge order (memory mode: shard segments, then columns)
+        std::vector<std::string> sources(segments_.begin(), segments_.end());
+        if (!buffer_) {
+            // Write and close intermediate tree
+            intermediate_file_->cd();
+            tree_->Write();
+            intermediate_file_->Close();
+            intermediate_file_.reset();
+            sources.push_back(intermediate_filename_);
+        }
+        sources.insert(sources.end(), shard_files_.begin(), shard_files_.end());
+        
+        // Read branches directly into the TNtuple row; variables a source
+        // lacks keep missing_value for all of its entries
+        std::vector<Float_t> values(sorted_vars.size());
+        
+        for (const auto& source : sources) {
+            // Reopen for reading
+            TFile read_file(source.c_str(), "READ");
+            TTree* read_tree = dynamic_cast<TTree*>(read_file.Get((name_ + "_tree").c_str()));
             
-            read_tree->GetEntry(i);
+            if (!read_tree) {
+                throw std::runtime_error("DynamicHNtuple: Failed to reopen intermediate TTree from " + source);
+            }
             
-            // Copy values in order
             for (size_t j = 0; j < sorted_vars.size(); ++j) {
-                values[j] = read_values[sorted_vars[j]];
+                values[j] = missing_value_;
+                if (read_tree->GetBranch(sorted_vars[j].c_str())) {
+                    read_tree->SetBranchAddress(sorted_vars[j].c_str(), &values[j]);
+                }
             }
             
-            ntuple->Fill(values.data());
-            
-            // Progress indicator
-            Long64_t percent = (i + 1) * 100 / total;
-            if (percent != last_percent) {
-                last_percent = percent;
-                
-                // Calculate ETA
-                auto now = std::chrono::steady_clock::now();
-                auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - start_time).count();
-                
-                int bar_width = 40;
-                int filled = static_cast<int>(percent * bar_width / 100);
-                
-                std::cout << "\r[";
-                for (int b = 0; b < bar_width; ++b) {
-                    if (b < filled) std::cout << "█";
-                    else std::cout << "░";
-                }
-                std::cout << "] " << std::setw(3) << percent << "%";
-                
-                if (percent > 0 && percent < 100) {
-                    Long64_t eta = elapsed * (100 - percent) / percent;
-                    std::cout << "  ETA: " << std::setw(2) << eta / 60 << ":" 
-                              << std::setw(2) << std::setfill('0') << eta % 60 
-                              << std::setfill(' ');
-                }
-                std::cout.flush();
+            Long64_t source_entries = read_tree->GetEntries();
+            for (Long64_t i = 0; i < source_entries; ++i) {
+                read_tree->GetEntry(i);
+                ntuple->Fill(values.data());
+                printProgress(++done, total, last_percent, start_time);
             }
+            
+            read_tree->ResetBranchAddresses();
+            read_file.Close();
+        }
+        
+        if (buffer_) {
+            // Memory mode: rows come straight from the columns, in TNtuple order
+            buffer_->forEachRow(sorted_vars, [&](const Float_t* row) {
+                ntuple->Fill(row);
+                printProgress(++done, total, last_percent, start_time);
+            });
         }
         
         auto end_time = std::chrono::steady_clock::now();
@@ -351,18 +746,15 @@ public:
         // Write ntuple to output file
         output_file_->cd();
         ntuple->Write();
+        bytes_written_ = ntuple->GetZipBytes();
         
-        // Close intermediate file
-        intermediate_file_->Close();
-        intermediate_file_.reset();
-        
-        // Clean up intermediate file
+        // Clean up intermediate files (own and merged shards)
         cleanupIntermediateFile();
         
         finalized_ = true;
         
         std::cout << "✓ TNtuple '" << name_ << "' created with " << sorted_vars.size() 
-                  << " variables, " << total << " entries\n";
+                  << " variables, " << done << " entries\n";
     }
     
     // ========================================================================
@@ -374,6 +766,9 @@ public:
     
     bool isFinalized() const { return finalized_; }
     Long64_t getFillCount() const { return fill_count_; }
+    
+    /// Compressed bytes of the final TNtuple/TTree (known after finalize())
+    Long64_t getBytesWritten() const { return bytes_written_; }
     size_t getVariableCount() const { return discovered_vars_.size(); }
     
     std::vector<std::string> getVariableNames() const {
@@ -384,30 +779,52 @@ public:
         return discovered_vars_.find(name) != discovered_vars_.end();
     }
     
+    Mode getMode() const { return mode_; }
+    
     /**
      * @brief Clean up intermediate file
      */
     void cleanupIntermediateFile() {
+        rntuple_fill_.reset();
+        
+        // Memory mode: drop buffered columns and spill files
+        if (buffer_) {
+            buffer_->clear();
+        }
+        
         // Close intermediate file if still open
         if (intermediate_file_) {
             intermediate_file_->Close();
             intermediate_file_.reset();
         }
         
-        // Delete file unless keeping
-        if (!keep_intermediate_) {
-            if (std::remove(intermediate_filename_.c_str()) == 0) {
-                std::cout << "✓ Removed intermediate file: " << intermediate_filename_ << "\n";
-            } else {
-                // File might not exist or already deleted - that's OK
-                // Only warn if file exists but couldn't be deleted
-                std::ifstream test(intermediate_filename_);
-                if (test.good()) {
-                    std::cerr << "Warning: Could not remove intermediate file: " << intermediate_filename_ << "\n";
+        // Delete files unless keeping (own file plus merged shard files);
+        // checkpoint segments stay for a possible resume
+        std::vector<std::string> files;
+        if (!intermediate_filename_.empty()) {
+            files.push_back(intermediate_filename_);
+        }
+        for (const auto& filename : shard_files_) {
+            if (checkpointed_.count(filename) == 0) {
+                files.push_back(filename);
+            }
+        }
+        
+        for (const auto& filename : files) {
+            if (!keep_intermediate_) {
+                if (std::remove(filename.c_str()) == 0) {
+                    std::cout << "✓ Removed intermediate file: " << filename << "\n";
+                } else {
+                    // File might not exist or already deleted - that's OK
+                    // Only warn if file exists but couldn't be deleted
+                    std::ifstream test(filename);
+                    if (test.good()) {
+                        std::cerr << "Warning: Could not remove intermediate file: " << filename << "\n";
+                    }
                 }
+            } else {
+                std::cout << "✓ Kept intermediate file: " << filename << "\n";
             }
-        } else {
-            std::cout << "✓ Kept intermediate file: " << intermediate_filename_ << "\n";
         }
     }
     
@@ -417,7 +834,11 @@ public:
     void printStructure(std::ostream& os = std::cout) const {
         os << "DynamicHNtuple '" << name_ << "':\n";
         os << "  Status: " << (finalized_ ? "FINALIZED" : "COLLECTING") << "\n";
+        os << "  Mode: " << modeName(mode_) << (replay_to_tree_ ? " (shard of tree)" : "") << "\n";
         os << "  Fill count: " << fill_count_ << "\n";
+        if (!checkpointed_.empty()) {
+            os << "  Checkpoint segments: " << checkpointed_.size() << "\n";
+        }
         os << "  Variables (" << discovered_vars_.size() << "):\n";
         int idx = 0;
         for (const auto& var : discovered_vars_) {
@@ -426,6 +847,131 @@ public:
     }
 
 private:
+    /**
+     * @brief Register a new variable and create its branch or column
+     * @param value_ptr Storage the branch/column reads from at fill()
+     */
+    void addVariable(const std::string& key, Float_t* value_ptr) {
+        if (rntuple_fill_) {
+            throw std::runtime_error("DynamicHNtuple: Variable '" + key + "' of '" + name_ +
+                                   "' first set after fill(); rntuple mode needs every variable "
+                                   "declare()d (or set) before the first fill()");
+        }
+        branch_values_[key] = value_ptr;
+        discovered_vars_.insert(key);
+        
+        if (mode_ == Mode::RNTuple) return;
+        
+        if (buffer_) {
+            buffer_->addColumn(key);
+            column_values_.push_back(value_ptr);
+            return;
+        }
+        
+        // Create branch in TTree; earlier entries get missing_value
+        TBranch* branch = tree_->Branch(key.c_str(), value_ptr, (key + "/F").c_str(), basket_size_);
+        Long64_t filled = tree_->GetEntries();
+        for (Long64_t i = 0; i < filled; ++i) {
+            branch->BackFill();
+        }
+    }
+    
+    /**
+     * @brief (Re)create the intermediate file and TTree, with a branch for
+     *        every variable known so far
+     */
+    void openIntermediateTree() {
+        // Compressed like the output file (e.g. fast lz4)
+        intermediate_file_ = std::make_unique<TFile>(intermediate_filename_.c_str(), "RECREATE");
+        if (!intermediate_file_ || intermediate_file_->IsZombie()) {
+            throw std::runtime_error("DynamicHNtuple: Cannot create intermediate file: " + intermediate_filename_);
+        }
+        intermediate_file_->SetCompressionSettings(output_file_->GetCompressionSettings());
+        
+        tree_ = new TTree((name_ + "_tree").c_str(), title_.c_str());
+        tree_->SetDirectory(intermediate_file_.get());
+        applyTreeOptions(tree_);
+        for (const auto& pair : branch_values_) {
+            tree_->Branch(pair.first.c_str(), pair.second, (pair.first + "/F").c_str(), basket_size_);
+        }
+    }
+    
+    /**
+     * @brief Memory mode: write the buffered rows as an intermediate-format TTree
+     */
+    void writeSegment(const std::string& filename) {
+        TFile file(filename.c_str(), "RECREATE");
+        if (file.IsZombie()) {
+            throw std::runtime_error("DynamicHNtuple: Cannot create checkpoint segment: " + filename);
+        }
+        file.SetCompressionSettings(output_file_->GetCompressionSettings());
+        
+        std::vector<std::string> order(discovered_vars_.begin(), discovered_vars_.end());
+        std::vector<Float_t> values(order.size());
+        TTree* tree = new TTree((name_ + "_tree").c_str(), title_.c_str());  // Owned by file
+        tree->SetDirectory(&file);
+        applyTreeOptions(tree);
+        for (size_t j = 0; j < order.size(); ++j) {
+            tree->Branch(order[j].c_str(), &values[j], (order[j] + "/F").c_str(), basket_size_);
+        }
+        buffer_->forEachRow(order, [&](const Float_t* row) {
+            std::copy(row, row + values.size(), values.begin());
+            tree->Fill();
+        });
+        file.cd();
+        tree->Write();
+        file.Close();
+    }
+    
+    /**
+     * @brief RNTuple mode: fill context over the variables known now
+     */
+    void startRNTuple() {
+        if (!sink_) {
+            throw std::runtime_error("DynamicHNtuple::fill() - Shard '" + name_ +
+                                   "' has no RNTuple writer (shareRNTuple())");
+        }
+        rntuple_fill_ = sink_->context(branch_values_, missing_value_);
+    }
+    
+    void applyTreeOptions(TTree* tree) const {
+        if (auto_flush_ != 0) {
+            tree->SetAutoFlush(auto_flush_);
+        }
+    }
+    
+    /**
+     * @brief Redraw the conversion progress bar (only on percent change)
+     */
+    static void printProgress(Long64_t done, Long64_t total, Long64_t& last_percent,
+                              std::chrono::steady_clock::time_point start_time) {
+        Long64_t percent = done * 100 / total;
+        if (percent == last_percent) return;
+        last_percent = percent;
+        
+        // Calculate ETA
+        auto now = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - start_time).count();
+        
+        int bar_width = 40;
+        int filled = static_cast<int>(percent * bar_width / 100);
+        
+        std::cout << "\r[";
+        for (int b = 0; b < bar_width; ++b) {
+            if (b < filled) std::cout << "█";
+            else std::cout << "░";
+        }
+        std::cout << "] " << std::setw(3) << percent << "%";
+        
+        if (percent > 0 && percent < 100) {
+            Long64_t eta = elapsed * (100 - percent) / percent;
+            std::cout << "  ETA: " << std::setw(2) << eta / 60 << ":" 
+                      << std::setw(2) << std::setfill('0') << eta % 60 
+                      << std::setfill(' ');
+        }
+        std::cout.flush();
+    }
+    
     std::string name_;
     std::string title_;
     TFile* output_file_;  // Final output file (not owned)
@@ -433,14 +979,42 @@ private:
     std::string intermediate_filename_;
     std::unique_ptr<TFile> intermediate_file_;
     TTree* tree_ = nullptr;  // Owned by intermediate_file_
+    std::string base_;  // Output path + ntuple (+ shard) suffix, for auxiliary files
+    std::vector<std::string> shard_files_;  // Intermediate files of merged shards
+    std::vector<std::string> segments_;     // Own checkpoint segments, oldest first
+    std::set<std::string> checkpointed_;    // All segments incl. merged (never deleted here)
+    
+    std::unique_ptr<ColumnBuffer> buffer_;  // Memory mode storage
+    std::vector<Float_t*> column_values_;   // Memory mode: value per buffer column
+    
+    std::shared_ptr<RNTupleSink> sink_;               // RNTuple mode: shared with the shards
+    std::unique_ptr<RNTupleSink::Context> rntuple_fill_;  // This ntuple's fill context
     
     std::map<std::string, Float_t*> branch_values_;  // Current event values
+    std::vector<Float_t*> dynamic_values_;           // Owned values of dynamic variables
+    
+    // Pre-declared schema: one aligned array, slot = index
+    static constexpr size_t kFloatsPerBlock = 16;
+    struct alignas(64) SchemaBlock {
+        Float_t values[kFloatsPerBlock];
+    };
+    std::vector<SchemaBlock> schema_blocks_;
+    Float_t* schema_values_ = nullptr;
+    size_t schema_size_ = 0;
+    std::map<std::string, UInt_t> schema_index_;
     std::set<std::string> discovered_vars_;          // All discovered variable names (sorted)
     
+    static constexpr Int_t kDefaultBasketSize = 32000;
+    Int_t basket_size_ = kDefaultBasketSize;
+    Long64_t auto_flush_ = 0;
+    
     Float_t missing_value_ = -1.0f;
     bool keep_intermediate_ = false;
+    Mode mode_ = Mode::Convert;
+    bool replay_to_tree_ = false;  // Tree-mode shard buffering in memory
     bool finalized_ = false;
     Long64_t fill_count_ = 0;
+    Long64_t bytes_written_ = 0;
 };
 
 #endif // DYNAMIC_HNTUPLE_H
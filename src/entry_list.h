@@ -0,0 +1,283 @@
+/**
+ * @file entry_list.h
+ * @brief Skim index: the input entries that passed a cut-flow stage
+ *
+ * A run records the entries whose sequential cut flow got past a chosen
+ * step and stores them as a ROOT TEntryList with one sub-list per input
+ * file. Later runs give that file as "input.entry_list" and the
+ * NTupleReader iterates only those entries. The file is a plain
+ * TEntryList, so it can also be used with TTree::SetEntryList() in ROOT.
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef ENTRY_LIST_H
+#define ENTRY_LIST_H
+
+#include <TFile.h>
+#include <TEntryList.h>
+#include <TKey.h>
+#include <TList.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+
+// ============================================================================
+// InputSegment: one file of the input and its place in the global numbering
+// ============================================================================
+/**
+ * @struct InputSegment
+ * @brief Input file with the global entry number of its first entry
+ */
+struct InputSegment {
+    std::string file;
+    Long64_t first = 0;      // Global (chain) entry of local entry 0
+    Long64_t entries = 0;
+};
+
+// ============================================================================
+// EntryList: sorted global entries, stored per file as a TEntryList
+// ============================================================================
+/**
+ * @class EntryList
+ * @brief Ascending list of global input entries (chain numbering)
+ *
+ * Usage Example:
+ * @code
+ *   // Writing run: record the entries that passed the chosen step
+ *   EntryList skim;
+ *   if (cuts.flowDepth() > step) skim.record(reader.currentEntry());
+ *   skim.write("skim.root", reader.inputFiles(), reader.getTreeName(), "passed deltaPP_mass");
+ *
+ *   // Reprocessing run: iterate only those entries
+ *   reader.setEntryList(EntryList::read("skim.root", reader.inputFiles(), reader.getTreeName()));
+ *   for (Long64_t i = 0; i < reader.entries(); ++i) reader.getEntry(i);
+ * @endcode
+ *
+ * On disk the entries are local to their file, so a list stays valid
+ * when the input is re-listed in another order or with other files; only
+ * the files named in the list must still have the same content.
+ */
+class EntryList {
+public:
+    /// Name of the TEntryList written by write() (read() accepts any)
+    static constexpr const char* kListName = "fat_entry_list";
+
+    EntryList() = default;
+
+    /**
+     * @brief Take a list of global entries (sorted and made unique)
+     */
+    explicit EntryList(std::vector<Long64_t> entries) : entries_(std::move(entries)) {
+        std::sort(entries_.begin(), entries_.end());
+        entries_.erase(std::unique(entries_.begin(), entries_.end()), entries_.end());
+    }
+
+    // ========================================================================
+    // Recording
+    // ========================================================================
+
+    /**
+     * @brief Add an entry; entries must come in ascending order
+     */
+    void record(Long64_t entry) {
+        if (!entries_.empty() && entry <= entries_.back()) {
+            throw std::runtime_error("EntryList::record() - Entry " + std::to_string(entry) +
+                                   " is not after " + std::to_string(entries_.back()));
+        }
+        entries_.push_back(entry);
+    }
+
+    /**
+     * @brief Append the entries of a list that follows this one (e.g. the
+     *        next worker's range)
+     */
+    void append(const EntryList& other) {
+        if (other.entries_.empty()) return;
+        if (!entries_.empty() && other.entries_.front() <= entries_.back()) {
+            throw std::runtime_error("EntryList::append() - Lists overlap or are out of order");
+        }
+        entries_.insert(entries_.end(), other.entries_.begin(), other.entries_.end());
+    }
+
+    void clear() { entries_.clear(); }
+
+    const std::vector<Long64_t>& entries() const { return entries_; }
+    Long64_t size() const { return static_cast<Long64_t>(entries_.size()); }
+    bool empty() const { return entries_.empty(); }
+
+    // ========================================================================
+    // TEntryList Conversion
+    // ========================================================================
+
+    /**
+     * @brief Build a TEntryList with one sub-list per input file
+     * @param inputs Files of the input in chain order
+     * @param treename Tree the entries belong to
+     */
+    std::unique_ptr<TEntryList> toTEntryList(const std::vector<InputSegment>& inputs,
+                                             const std::string& treename,
+                                             const std::string& title = "") const {
+        // Owned here, not by gDirectory: a file open at the time (an output
+        // or shard file) would otherwise write the list and delete it on Close()
+        auto list = std::make_unique<TEntryList>(kListName, title.c_str());
+        list->SetDirectory(nullptr);
+        auto entry = entries_.begin();
+        for (const InputSegment& input : inputs) {
+            if (entry == entries_.end()) break;
+            Long64_t end = input.first + input.entries;
+            if (*entry >= end) continue;
+
+            TEntryList sub("", "", treename.c_str(), input.file.c_str());
+            sub.SetDirectory(nullptr);
+            for (; entry != entries_.end() && *entry < end; ++entry) {
+                sub.Enter(*entry - input.first);
+            }
+            list->Add(&sub);
+        }
+        if (entry != entries_.end()) {
+            throw std::runtime_error("EntryList::toTEntryList() - Entry " + std::to_string(*entry) +
+                                   " is beyond the input (" + std::to_string(totalEntries(inputs)) +
+                                   " entries)");
+        }
+        return list;
+    }
+
+    /**
+     * @brief Global entries of a TEntryList for the given input
+     * @param origin Where the list came from (for messages)
+     *
+     * File names are compared as absolute paths (TEntryList stores local
+     * files that way). Sub-lists of other trees or of files not in the
+     * input are skipped with a warning. A list without sub-lists (one
+     * tree) belongs to the input file of its name, or to a single-file
+     * input.
+     */
+    static EntryList fromTEntryList(TEntryList& list, const std::vector<InputSegment>& inputs,
+                                    const std::string& treename, const std::string& origin) {
+        std::vector<TEntryList*> subs;
+        TList* lists = list.GetLists();
+        if (lists) {
+            TIter next(lists);
+            while (TObject* obj = next()) {
+                if (auto* sub = dynamic_cast<TEntryList*>(obj)) subs.push_back(sub);
+            }
+        } else {
+            subs.push_back(&list);
+        }
+
+        std::vector<Long64_t> entries;
+        int skipped = 0;
+        for (TEntryList* sub : subs) {
+            std::string tree = sub->GetTreeName();
+            if (!tree.empty() && tree != treename) {
+                ++skipped;
+                continue;
+            }
+            const InputSegment* input = findInput(inputs, sub->GetFileName());
+            if (!input && !lists && inputs.size() == 1) input = &inputs.front();
+            if (!input) {
+                ++skipped;
+                continue;
+            }
+
+            Long64_t n = sub->GetN();
+            for (Long64_t i = 0; i < n; ++i) {
+                Long64_t local = sub->GetEntry(i);
+                if (local < 0 || local >= input->entries) {
+                    throw std::runtime_error("EntryList: " + origin + " - entry " + std::to_string(local) +
+                                           " does not exist in " + input->file + " (" +
+                                           std::to_string(input->entries) +
+                                           " entries); the list was made for other data");
+                }
+                entries.push_back(input->first + local);
+            }
+        }
+
+        if (skipped > 0) {
+            std::cerr << "Warning: " << origin << " - " << skipped << " of " << subs.size()
+                      << " sub-lists are for trees/files not in this input (skipped)\n";
+        }
+        return EntryList(std::move(entries));
+    }
+
+    // ========================================================================
+    // File I/O
+    // ========================================================================
+
+    /**
+     * @brief Write the list to a ROOT file (replaces the file)
+     */
+    void write(const std::string& filename, const std::vector<InputSegment>& inputs,
+               const std::string& treename, const std::string& title) const {
+        std::unique_ptr<TEntryList> list = toTEntryList(inputs, treename, title);
+        TFile file(filename.c_str(), "RECREATE");
+        if (file.IsZombie()) {
+            throw std::runtime_error("EntryList::write() - Cannot create " + filename);
+        }
+        file.WriteTObject(list.get(), kListName);
+        file.Close();
+    }
+
+    /**
+     * @brief Read the first TEntryList of a ROOT file for the given input
+     *
+     * Prefers the list named kListName, so files with several lists work
+     * when written by FAT; lists made in ROOT (tree->Draw(">>elist", cut,
+     * "entrylist")) are accepted as well.
+     */
+    static EntryList read(const std::string& filename, const std::vector<InputSegment>& inputs,
+                          const std::string& treename) {
+        TFile file(filename.c_str(), "READ");
+        if (file.IsZombie()) {
+            throw std::runtime_error("EntryList::read() - Cannot open " + filename);
+        }
+
+        TEntryList* list = dynamic_cast<TEntryList*>(file.Get(kListName));
+        if (!list && file.GetListOfKeys()) {
+            TIter next(file.GetListOfKeys());
+            while (TKey* key = static_cast<TKey*>(next())) {
+                if (std::string(key->GetClassName()) == "TEntryList") {
+                    list = dynamic_cast<TEntryList*>(key->ReadObj());
+                    break;
+                }
+            }
+        }
+        if (!list) {
+            throw std::runtime_error("EntryList::read() - No TEntryList in " + filename);
+        }
+        return fromTEntryList(*list, inputs, treename, filename);
+    }
+
+private:
+    static const InputSegment* findInput(const std::vector<InputSegment>& inputs,
+                                         const std::string& file) {
+        if (file.empty()) return nullptr;
+        std::string path = absolutePath(file);
+        for (const InputSegment& input : inputs) {
+            if (input.file == file || absolutePath(input.file) == path) return &input;
+        }
+        return nullptr;
+    }
+
+    /// Local paths made absolute; URLs (root://, http://) unchanged
+    static std::string absolutePath(const std::string& file) {
+        if (file.find("://") != std::string::npos) return file;
+        std::error_code ec;
+        std::filesystem::path path = std::filesystem::absolute(file, ec);
+        return ec ? file : path.lexically_normal().string();
+    }
+
+    static Long64_t totalEntries(const std::vector<InputSegment>& inputs) {
+        return inputs.empty() ? 0 : inputs.back().first + inputs.back().entries;
+    }
+
+    std::vector<Long64_t> entries_;
+};
+
+#endif // ENTRY_LIST_H
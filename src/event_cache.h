@@ -0,0 +1,207 @@
+/**
+ * @file event_cache.h
+ * @brief Per-event memo cache for derived kinematics
+ *
+ * Derived quantities (composite particles, boosts, rest frames, angles) are
+ * declared once with the function that computes them. Within one event
+ * each is computed on first request and then served from the cache, no
+ * matter how many histograms, ntuples or train wagons ask for it. The
+ * cache is invalidated when the attached NTupleReader loads a new entry.
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef EVENT_CACHE_H
+#define EVENT_CACHE_H
+
+#include "ntuple_reader.h"
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// CacheKey: Typed Handle to a Cached Quantity
+// ============================================================================
+/**
+ * @struct CacheKey
+ * @brief Index of a declared quantity; the value type is part of the key
+ */
+template <typename T>
+struct CacheKey {
+    int index = -1;
+
+    CacheKey() = default;
+    explicit CacheKey(int i) : index(i) {}
+
+    bool valid() const { return index >= 0; }
+    explicit operator bool() const { return valid(); }
+};
+
+// ============================================================================
+// EventCache: Lazily Evaluated, Memoized Observables
+// ============================================================================
+/**
+ * @class EventCache
+ * @brief Memo cache of derived quantities, valid for one event
+ *
+ * Compute functions receive the cache and may request other quantities,
+ * so dependencies (frame -> boosted particle -> angle) are resolved in
+ * the order they are needed. Invalidation is O(1): a generation counter
+ * moves on and stale entries are recomputed on their next request.
+ *
+ * Usage Example:
+ * @code
+ *   EventCache ev;
+ *   ev.attach(reader);   // invalidate on every reader.getEntry()
+ *   auto proton = ev.declare<PParticle>("proton", [=](EventCache&) {
+ *       return ParticleFactory::createProton(*in.p_p, *in.p_theta, *in.p_phi);
+ *   });
+ *   auto p_cms = ev.declare<PParticle>("p_cms", [=, &frames](EventCache& c) {
+ *       return frames.getFrame("beam").boost(c.get(proton));
+ *   });
+ *   ...
+ *   reader.getEntry(i);
+ *   double cos_th = ev.get(p_cms).cosTheta();   // computes proton, then p_cms
+ *   double p = ev.get(p_cms).momentum();        // cached
+ * @endcode
+ *
+ * Not thread-safe: use one cache per event-loop thread.
+ */
+class EventCache {
+public:
+    EventCache() = default;
+
+    // Entries capture references to their inputs; do not copy the cache
+    EventCache(const EventCache&) = delete;
+    EventCache& operator=(const EventCache&) = delete;
+
+    // ========================================================================
+    // Setup
+    // ========================================================================
+
+    /**
+     * @brief Invalidate automatically whenever the reader loads an entry
+     */
+    void attach(const NTupleReader& reader) {
+        reader_ = &reader;
+        reader_serial_ = reader.readSerial();
+    }
+
+    /**
+     * @brief Declare a quantity and how to compute it
+     * @param name Unique name (for key() lookup and error messages)
+     * @param compute Called at most once per event, on first request
+     * @return Key for per-event access
+     */
+    template <typename T>
+    CacheKey<T> declare(const std::string& name, std::function<T(EventCache&)> compute) {
+        if (index_.find(name) != index_.end()) {
+            throw std::runtime_error("EventCache::declare() - '" + name + "' already declared!");
+        }
+        auto entry = std::make_unique<Entry<T>>();
+        entry->name = name;
+        entry->compute = std::move(compute);
+        index_[name] = static_cast<int>(entries_.size());
+        entries_.push_back(std::move(entry));
+        return CacheKey<T>(static_cast<int>(entries_.size()) - 1);
+    }
+
+    /**
+     * @brief Key of a declared quantity (setup only; checks the type)
+     */
+    template <typename T>
+    CacheKey<T> key(const std::string& name) const {
+        auto it = index_.find(name);
+        if (it == index_.end()) {
+            throw std::runtime_error("EventCache::key() - '" + name + "' not declared!");
+        }
+        if (!dynamic_cast<const Entry<T>*>(entries_[it->second].get())) {
+            throw std::runtime_error("EventCache::key() - '" + name + "' has a different type!");
+        }
+        return CacheKey<T>(it->second);
+    }
+
+    // ========================================================================
+    // Per-Event Access
+    // ========================================================================
+
+    /**
+     * @brief Value for the current event (computed on first request)
+     *
+     * The reference stays valid until the next event.
+     */
+    template <typename T>
+    const T& get(CacheKey<T> key) {
+        syncWithReader();
+        Entry<T>& entry = static_cast<Entry<T>&>(*entries_[key.index]);
+        if (entry.generation != generation_) {
+            if (entry.computing) {
+                throw std::runtime_error("EventCache::get() - '" + entry.name +
+                                         "' depends on itself!");
+            }
+            entry.computing = true;
+            try {
+                entry.value.emplace(entry.compute(*this));
+            } catch (...) {
+                entry.computing = false;
+                throw;
+            }
+            entry.computing = false;
+            entry.generation = generation_;
+            ++computed_;
+        }
+        ++requests_;
+        return *entry.value;
+    }
+
+    /**
+     * @brief Drop all cached values (explicit new event without a reader)
+     */
+    void invalidate() { ++generation_; }
+
+    // ========================================================================
+    // Statistics
+    // ========================================================================
+
+    size_t size() const { return entries_.size(); }
+
+    /// Total get() calls and how many of them had to compute
+    Long64_t requests() const { return requests_; }
+    Long64_t computed() const { return computed_; }
+
+private:
+    struct EntryBase {
+        std::string name;
+        unsigned long long generation = 0;   // generation_ starts at 1
+        bool computing = false;
+        virtual ~EntryBase() = default;
+    };
+
+    template <typename T>
+    struct Entry : EntryBase {
+        std::optional<T> value;
+        std::function<T(EventCache&)> compute;
+    };
+
+    void syncWithReader() {
+        if (reader_ && reader_->readSerial() != reader_serial_) {
+            reader_serial_ = reader_->readSerial();
+            ++generation_;
+        }
+    }
+
+    std::vector<std::unique_ptr<EntryBase>> entries_;
+    std::map<std::string, int> index_;
+    const NTupleReader* reader_ = nullptr;
+    Long64_t reader_serial_ = 0;
+    unsigned long long generation_ = 1;
+    Long64_t requests_ = 0;
+    Long64_t computed_ = 0;
+};
+
+#endif // EVENT_CACHE_H
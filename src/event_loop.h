@@ -0,0 +1,980 @@
+/**
+ * @file event_loop.h
+ * @brief Event loop over entry ranges, serial or on worker threads
+ *
+ * The physics lives in main.cc (processEvent(), setupWagon()); everything
+ * that moves entries through it lives here. The loop sees an analysis as
+ * a set of AnalysisWagon objects per thread: each has its Manager (or
+ * Manager shard), its CutManager and one process() call per event.
+ *
+ *   EventLoop         a whole run: input, output files, entry ranges,
+ *                     workers, checkpoints, cut flows and saving
+ *   runEventRange()   reads entries [first, last) once and runs every wagon
+ *   EventWorker       reader, wagons and profiler of one worker thread
+ *   runWorkers()      starts the workers on the WorkScheduler, pauses them
+ *                     for checkpoints, and returns when the entries are done
+ *   mergeWorkers()    adds worker cut flows, skims and profiles to the
+ *                     main thread's wagons (histogram and ntuple shards are
+ *                     merged by their Manager)
+ *
+ * Example usage:
+ * @code
+ *   EventLoop loop(config, wagon_defs, argv[0], resume);
+ *   return loop.run([&](NTupleReader& reader, const std::function<Manager&(size_t)>& manager) {
+ *       return setupWagons(reader, manager, ...);   // main.cc
+ *   });
+ * @endcode
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <Rtypes.h>
+#include "manager.h"
+#include "ntuple_reader.h"
+#include "cut_manager.h"
+#include "progressbar.h"
+#include "profiler.h"
+#include "checkpoint.h"
+#include "work_scheduler.h"
+#include "thread_affinity.h"
+#include "entry_list.h"
+#include "analysis_config.h"
+#include <TROOT.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// AnalysisWagon: One Analysis as the Event Loop Sees It
+// ============================================================================
+/**
+ * @class AnalysisWagon
+ * @brief Per-thread state of one analysis filling one Manager
+ *
+ * main.cc derives its wagon (input slots, kinematics, handles) from this
+ * class. Without a "train" section there is exactly one wagon per thread.
+ */
+class AnalysisWagon {
+public:
+    virtual ~AnalysisWagon() = default;
+
+    /// False if the file of the current entry lacks an input of this wagon
+    virtual bool hasInputs() const = 0;
+
+    /// Analyse the current entry (cuts.beginEvent() already called)
+    virtual void process(Profiler& prof) = 0;
+
+    std::string name;
+    Manager* mgr = nullptr;          ///< Manager or Manager shard of this thread
+    CutManager cuts;
+
+    // Entry list of events that passed cut-flow step skim_step (or none)
+    EntryList* skim = nullptr;
+    int skim_step = -1;
+};
+
+using Wagons = std::vector<std::unique_ptr<AnalysisWagon>>;
+
+/**
+ * @brief Creates all wagons of one thread on its reader
+ *
+ * manager(k) opens the Manager of wagon k (main thread) or creates its
+ * shard (worker); call it right before booking wagon k, so the wagon's
+ * histograms and trees are created in its own output file.
+ */
+using WagonBuilder = std::function<Wagons(NTupleReader& reader,
+                                          const std::function<Manager&(size_t)>& manager)>;
+
+// ============================================================================
+// Event Loop Over a Range of Entries
+// ============================================================================
+
+/**
+ * @brief Optional stop conditions of runEventRange() besides Ctrl+C
+ */
+struct RangeControl {
+    const std::atomic<bool>* pause = nullptr;   // Set by the main thread (workers)
+    CheckpointSchedule* schedule = nullptr;     // Serial mode: stop when a checkpoint is due
+    Long64_t stopped_at = 0;                    // Out: first entry not processed
+
+    bool stopRequested(Long64_t processed) {
+        return (pause && pause->load(std::memory_order_relaxed)) ||
+               (schedule && schedule->due(processed));
+    }
+};
+
+/**
+ * @brief Move a worker range boundary to the nearest cluster start
+ * @param lo Exclusive lower bound (start of this worker's range)
+ * @param hi Inclusive upper bound (leaves entries for the later workers)
+ *
+ * Workers meeting at a cluster start never both decompress its baskets.
+ * The boundary stays put when no cluster start lies in (lo, hi].
+ */
+inline Long64_t alignToCluster(Long64_t entry, Long64_t lo, Long64_t hi,
+                               const std::vector<Long64_t>& starts) {
+    auto it = std::lower_bound(starts.begin(), starts.end(), entry);
+    Long64_t best = entry;
+    Long64_t best_distance = -1;
+    for (auto c = (it == starts.begin() ? it : it - 1); c != starts.end() && c <= it; ++c) {
+        Long64_t distance = std::abs(*c - entry);
+        if (*c > lo && *c <= hi && (best_distance < 0 || distance < best_distance)) {
+            best = *c;
+            best_distance = distance;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Read entries [first, last) once and run every wagon on each
+ *
+ * Used directly in serial mode and once per chunk in every worker thread.
+ * A RangeControl can stop the loop early at an event boundary (for a
+ * checkpoint); stopped_at is then the next entry.
+ *
+ * @return true if the loop was stopped by Ctrl+C
+ */
+inline bool runEventRange(NTupleReader& reader, Wagons& wagons, Profiler& prof,
+                          Long64_t first, Long64_t last,
+                          std::atomic<Long64_t>& processed, ProgressBar* progress,
+                          RangeControl* control = nullptr) {
+    for (Long64_t i = first; i < last; ++i) {
+        // Check for Ctrl+C - graceful termination
+        if (SignalHandler::wasInterrupted()) {
+            if (control) control->stopped_at = i;
+            return true;
+        }
+
+        // Stop here for a checkpoint
+        if (control && control->stopRequested(processed.load(std::memory_order_relaxed))) {
+            control->stopped_at = i;
+            return false;
+        }
+
+        prof.mark();
+        reader.getEntry(i);
+        prof.lap(ProfileStage::Read);
+
+        Long64_t done = ++processed;
+
+        // Update progress bar (updates only on percent change)
+        if (progress) {
+            progress->update(done);
+        }
+
+        // Process event in every wagon (getEntry() invalidated the caches);
+        // wagons whose inputs this file lacks count the event as skipped
+        for (auto& w : wagons) {
+            if (!w->hasInputs()) {
+                w->cuts.skipEvent();
+                continue;
+            }
+            w->cuts.beginEvent();
+            w->process(prof);
+            if (w->skim && w->cuts.flowDepth() > w->skim_step) {
+                w->skim->record(reader.currentEntry());
+            }
+        }
+
+        // Events rejected by cuts end here
+        prof.lap(ProfileStage::Kinematics);
+    }
+    if (control) control->stopped_at = last;
+    return false;
+}
+
+// ============================================================================
+// Parallel Workers
+// ============================================================================
+
+/**
+ * @struct EventWorker
+ * @brief Everything one worker thread touches
+ *
+ * A private reader over the same input and, per wagon, a Manager shard
+ * (own histograms/ntuple buffers) with private cut statistics. Entries
+ * come in chunks from the WorkScheduler.
+ */
+struct EventWorker {
+    int index = 0;                          // Scheduler worker and shard number
+    NTupleReader reader;
+    Wagons wagons;
+    Profiler profiler;
+    bool skimming = false;
+    std::map<size_t, EntryList> skims;      // Per scheduler range (ascending within each)
+    WorkScheduler::Chunk chunk;             // Last chunk claimed
+    bool interrupted = false;
+    std::string error;
+};
+
+using EventWorkers = std::vector<std::unique_ptr<EventWorker>>;
+
+/**
+ * @brief Run the workers until no entries are left to claim
+ * @param checkpoint_due Polled by the main thread while workers run
+ * @param write_checkpoint Called once the workers stopped for a checkpoint
+ *
+ * For a checkpoint all workers stop at event boundaries, hand back the
+ * rest of their chunks and are started again after it is written. Returns
+ * early if a worker was interrupted (Ctrl+C) or failed.
+ */
+inline void runWorkers(EventWorkers& workers, WorkScheduler& scheduler,
+                       const ThreadAffinity& affinity, ProgressCounters& counters,
+                       ProgressBar& progress, const std::function<bool()>& checkpoint_due,
+                       const std::function<void()>& write_checkpoint) {
+    std::atomic<bool> pause{false};
+    while (scheduler.unclaimed() > 0) {
+        pause = false;
+        std::atomic<int> finished{0};
+        std::vector<std::thread> threads;
+        for (auto& worker : workers) {
+            EventWorker* w = worker.get();
+            threads.emplace_back([w, &scheduler, &affinity, &counters, &finished, &pause]() {
+                affinity.pin(w->index);
+                RangeControl control;
+                control.pause = &pause;
+                try {
+                    WorkScheduler::Chunk chunk;
+                    while (!pause.load() && scheduler.claim(w->index, chunk)) {
+                        w->chunk = chunk;
+                        if (w->skimming) w->wagons.front()->skim = &w->skims[chunk.range];
+                        w->interrupted = runEventRange(w->reader, w->wagons, w->profiler,
+                                                       chunk.first, chunk.last,
+                                                       counters[w->index], nullptr, &control);
+                        scheduler.finish(chunk, control.stopped_at);
+                        if (control.stopped_at < chunk.last) break;
+                    }
+                } catch (const std::exception& e) {
+                    w->error = e.what();
+                }
+                ++finished;
+            });
+        }
+
+        // Main thread only reports progress (and requests checkpoints)
+        // while workers run
+        bool paused = false;
+        while (finished.load() < static_cast<int>(workers.size())) {
+            progress.update(counters);
+            if (!paused && checkpoint_due()) {
+                pause = true;
+                paused = true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        bool stopped = false;
+        for (const auto& worker : workers) {
+            stopped = stopped || worker->interrupted || !worker->error.empty();
+        }
+        if (!paused || stopped) break;
+        write_checkpoint();
+    }
+}
+
+/**
+ * @brief Add the workers' results to the main thread's wagons
+ *
+ * Cut statistics and profiles in worker order, skim entry lists in entry
+ * order (by the first entry of their scheduler range). Worker errors are
+ * reported here.
+ */
+inline void mergeWorkers(const EventWorkers& workers, const WorkScheduler& scheduler,
+                         Wagons& wagons, EntryList& skim, Profiler& profiler,
+                         std::vector<SchemaIssue>& schema_issues) {
+    std::vector<CheckpointState::Range> ranges = scheduler.ranges();
+    std::map<Long64_t, const EntryList*> skims;
+    for (const auto& worker : workers) {
+        for (size_t k = 0; k < wagons.size(); ++k) {
+            wagons[k]->cuts.merge(worker->wagons[k]->cuts);
+        }
+        for (const auto& pair : worker->skims) {
+            if (!pair.second.empty()) skims[ranges[pair.first].first] = &pair.second;
+        }
+        profiler.merge(worker->profiler);
+        NTupleReader::mergeSchemaIssues(schema_issues, worker->reader.schemaIssues());
+        if (!worker->error.empty()) {
+            std::cerr << "\nWorker error (entries " << worker->chunk.first << "-" << worker->chunk.last
+                      << "): " << worker->error << "\n";
+        }
+    }
+    for (const auto& pair : skims) {
+        skim.append(*pair.second);
+    }
+}
+
+// ============================================================================
+// EventLoop: One Analysis Run from Input to Output Files
+// ============================================================================
+/**
+ * @class EventLoop
+ * @brief Opens the input and outputs, runs the loop, checkpoints and saves
+ *
+ * The event loop is stopped (no thread fills anything) while a checkpoint
+ * is written or restored. In parallel mode histograms are snapshot summed
+ * over the shards, cut counters summed over the workers, and every shard
+ * seals its own ntuple segments; a resumed job keeps the same workers and
+ * the ranges each owns (stolen tails included), so each shard gets its
+ * segments back.
+ *
+ * Every setup step reports its own error; run() then returns 1.
+ */
+class EventLoop {
+public:
+    /**
+     * @param defs One definition per wagon (the single analysis if no train)
+     * @param program argv[0], for the --resume hint
+     * @param resume Continue from the last checkpoint
+     */
+    EventLoop(const AnalysisConfig& config, std::vector<AnalysisConfig::WagonDef> defs,
+              const std::string& program, bool resume)
+        : config_(config), defs_(std::move(defs)), program_(program), resume_(resume),
+          profiler_(config.getProfiling()) {}
+
+    /**
+     * @brief Run the analysis
+     * @param build Creates the wagons of one thread (main thread and workers)
+     * @return Exit code for main(): 0, or 1 if a setup step failed
+     */
+    int run(const WagonBuilder& build) {
+        if (!prepare() || !openInput() || !setupOutputs(build) || !planRanges()) return 1;
+
+        processed_ = resumed_events_;
+        progress_ = std::make_unique<ProgressBar>(events_to_process_);
+        progress_->resumeFrom(resumed_events_);
+
+        // Optional per-stage timing (reported after the cut flow)
+        profiler_.start();
+
+        schema_issues_ = reader_.schemaIssues();   // Setup checked the first file
+        if (n_threads_ > 1 && !startWorkers(build)) return 1;
+
+        if (resume_) {
+            try {
+                restoreCheckpoint();
+            } catch (const std::exception& e) {
+                std::cerr << "Error restoring checkpoint: " << e.what() << "\n";
+                return 1;
+            }
+        }
+        schedule_ = CheckpointSchedule(checkpoint_options_, resumed_events_);
+
+        if (n_threads_ == 1) {
+            runSerial();
+        } else {
+            runParallel();
+        }
+        finish();
+        return 0;
+    }
+
+private:
+    // ------------------------------------------------------------------------
+    // Setup
+    // ------------------------------------------------------------------------
+
+    /// Checkpoint state, threads, scheduler and pinning
+    bool prepare() {
+        // Checkpoints (periodic snapshots) and --resume from the last one
+        checkpoint_options_.every_events = config_.getCheckpointEvents();
+        checkpoint_options_.every_minutes = config_.getCheckpointMinutes();
+        checkpoint_options_.file = config_.getCheckpointFile();
+        checkpointing_ = checkpoint_options_.enabled();
+
+        if (resume_) {
+            try {
+                checkpoint_ = CheckpointState::read(checkpoint_options_.file);
+            } catch (const std::exception& e) {
+                std::cerr << "Error reading checkpoint: " << e.what() << "\n";
+                return false;
+            }
+            std::cout << "\nResuming from checkpoint " << checkpoint_.serial << " in "
+                      << checkpoint_options_.file << " (" << checkpoint_.processed()
+                      << " events done)\n";
+        }
+
+        // A resumed job keeps the workers of its checkpoint
+        n_threads_ = resume_ ? checkpoint_.workers() : config_.getThreads();
+
+        // ROOT must be told about worker threads before they touch any ROOT object
+        if (n_threads_ > 1) {
+            ROOT::EnableThreadSafety();
+        }
+
+        // Implicit MT: ROOT compresses TTree baskets on its own thread pool
+        if (config_.getImplicitMT() > 0) {
+            ROOT::EnableImplicitMT(config_.getImplicitMT());
+        }
+
+        // How workers get their entries and where they run
+        scheduler_mode_ = config_.getScheduler();
+        if (scheduler_mode_ != "steal" && scheduler_mode_ != "static") {
+            std::cerr << "Error: execution.scheduler '" << scheduler_mode_ << "' is not steal or static\n";
+            return false;
+        }
+        try {
+            pin_mode_ = ThreadAffinity::parseMode(config_.getPinThreads());
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    /// Input file or chain, optionally restricted to an entry list
+    bool openInput() {
+        try {
+            std::string source = config_.getInputSource();
+            std::string tree_name = config_.getInputTreeName();
+            reader_.setFormat(NTupleReader::parseFormat(config_.getInputFormat()));
+
+            if (config_.isInputFileList()) {
+                reader_.openFromList(source, tree_name, config_.getInputIndex());
+            } else if (config_.isInputRootFile()) {
+                reader_.open(source, tree_name);
+            } else {
+                throw std::runtime_error("Unknown input format. Use .root or .list file");
+            }
+
+            // Skim index of an earlier run: read only the listed entries
+            std::string entry_list = config_.getInputEntryList();
+            if (!entry_list.empty()) {
+                reader_.setEntryList(EntryList::read(entry_list, reader_.inputFiles(), tree_name));
+                std::cout << "NTupleReader: Entry list " << entry_list << " selects "
+                          << reader_.entries() << " of " << reader_.treeEntries() << " entries\n";
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error opening input: " << e.what() << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    /// One output file and Manager per wagon; the main thread's wagons
+    bool setupOutputs(const WagonBuilder& build) {
+        try {
+            output_options_.compression = OutputOptions::parseCompression(config_.getCompression(),
+                                                                          config_.getCompressionLevel());
+            output_options_.basket_size = config_.getBasketKB() * 1024;
+            output_options_.auto_flush = config_.getAutoFlush();
+            output_options_.merge_threads = config_.getMergeThreads();
+            output_options_.fill_buffer = config_.getFillBuffer();
+
+            wagons_ = build(reader_, [this](size_t k) -> Manager& {
+                const AnalysisConfig::WagonDef& def = defs_[k];
+                if (defs_.size() > 1) {
+                    std::cout << "\nTrain wagon '" << def.name << "' -> " << def.output << "\n";
+                }
+                managers_.push_back(std::make_unique<Manager>());
+                managers_.back()->setOutputOptions(output_options_);
+                managers_.back()->openFile(def.output, config_.getOutputOption());
+                return *managers_.back();
+            });
+        } catch (const std::exception& e) {
+            std::cerr << "Error setting up analysis: " << e.what() << "\n";
+            return false;
+        }
+
+        // Entry list of the events passing the (first wagon's) cut flow up to
+        // entry_list_cut; the last step when no cut is named
+        skim_file_ = config_.getOutputEntryList();
+        skim_cut_ = config_.getOutputEntryListCut();
+        if (!skim_file_.empty()) {
+            const CutManager& cuts = wagons_.front()->cuts;
+            skim_step_ = skim_cut_.empty() ? static_cast<int>(cuts.flowSteps()) - 1 : cuts.flowStep(skim_cut_);
+            if (!skim_cut_.empty() && skim_step_ < 0) {
+                std::cerr << "Error: output.entry_list_cut '" << skim_cut_ << "' is not a defined cut\n";
+                return false;
+            }
+            wagons_.front()->skim = &skim_;
+            wagons_.front()->skim_step = skim_step_;
+        }
+
+        // Checkpoints need ntuple storage that can be sealed: fail now, not hours in
+        if (checkpointing_ || resume_) {
+            bool sealable = !config_.usesNtupleMode("tree") && !config_.usesNtupleMode("rntuple");
+            for (const auto& manager : managers_) {
+                sealable = sealable && manager->ntupleCount() == 0;
+            }
+            if (!sealable) {
+                std::cerr << "Error: checkpoints need DynamicHNtuples in convert or memory mode\n";
+                return false;
+            }
+            if (!skim_file_.empty()) {
+                std::cerr << "Error: output.entry_list cannot be combined with checkpoints\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Reading options, and the entry ranges of the workers
+    bool planRanges() {
+        total_entries_ = reader_.entries();
+        start_event_ = config_.getStartEvent();
+        Long64_t max_events = config_.getMaxEvents();
+
+        // Calculate end event
+        end_event_ = total_entries_;
+        if (max_events > 0) {
+            end_event_ = std::min(start_event_ + max_events, total_entries_);
+        }
+
+        events_to_process_ = end_event_ - start_event_;
+
+        // Optional columnar reading: bound branches only, one block at a time
+        block_size_ = config_.getBlockSize();
+        if (block_size_ > 0) {
+            reader_.setBlockMode(block_size_);
+        }
+
+        // Optional local copy of the bound columns, mapped by later passes
+        column_cache_ = config_.getColumnCacheDir();
+        column_cache_bytes_ = static_cast<Long64_t>(config_.getColumnCacheMB()) * 1024 * 1024;
+        if (!column_cache_.empty()) {
+            if (block_size_ <= 0) {
+                std::cerr << "Warning: input.column_cache needs input.block_size > 0, ignored\n";
+            } else {
+                try {
+                    reader_.setColumnCache(column_cache_, column_cache_bytes_);
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: " << e.what() << "\n";
+                    return false;
+                }
+            }
+        }
+
+        // Optional read cache and read-ahead of the next chain files
+        cache_bytes_ = static_cast<Long64_t>(config_.getCacheSizeMB()) * 1024 * 1024;
+        // Read-ahead in serial mode only: every worker would warm whole files
+        // of its own range, and N such streams make one disk seek between them
+        prefetch_depth_ = n_threads_ > 1 ? 0 : config_.getPrefetchDepth();
+        if (n_threads_ > 1 && config_.getPrefetchDepth() > 0) {
+            std::cout << "Note: input.prefetch_depth is ignored with " << n_threads_ << " threads\n";
+        }
+        if (cache_bytes_ > 0) {
+            reader_.setReadCache(cache_bytes_);
+        }
+        reader_.enablePrefetch(prefetch_depth_);
+
+        std::cout << "\n";
+        std::cout << "┌───────────────────────────────────────────────────────────────┐\n";
+        std::cout << "│  Press Ctrl+C at any time to stop and save partial results    │\n";
+        std::cout << "└───────────────────────────────────────────────────────────────┘\n";
+        std::cout << "\n";
+        std::cout << "Processing events " << start_event_ << " to " << end_event_
+                  << " (" << events_to_process_ << " events)...\n";
+        std::cout << "\n";
+
+        // Work stealing splits at cluster starts; without a dataset index they
+        // are read from the trees (entry numbers, so not with an entry list)
+        if (n_threads_ > 1 && scheduler_mode_ == "steal" && !reader_.hasEntryList()) {
+            reader_.loadClusterStarts();
+        }
+
+        // Fresh job: one range of entries per worker; resumed job: the
+        // checkpointed ranges, which must belong to this input and config
+        if (resume_) {
+            try {
+                checkpoint_.checkMatches(total_entries_, start_event_, end_event_, defs_);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << "\n";
+                return false;
+            }
+        } else {
+            // Never start more workers than there are events
+            if (events_to_process_ < n_threads_) {
+                n_threads_ = static_cast<int>(std::max<Long64_t>(events_to_process_, 1));
+            }
+
+            checkpoint_.input_entries = total_entries_;
+            checkpoint_.start_event = start_event_;
+            checkpoint_.end_event = end_event_;
+            // Equal shares; with known clusters the boundaries move to the
+            // nearest cluster start (entry numbers, so not with an entry list)
+            Long64_t block = events_to_process_ / n_threads_;
+            Long64_t remainder = events_to_process_ % n_threads_;
+            const std::vector<Long64_t>& clusters = clusterStarts();
+            Long64_t next = start_event_;
+            for (int t = 0; t < n_threads_; ++t) {
+                Long64_t last = start_event_ + (t + 1) * block + std::min<Long64_t>(t + 1, remainder);
+                if (t + 1 < n_threads_) {
+                    Long64_t hi = end_event_ - (n_threads_ - t - 1);
+                    last = alignToCluster(std::clamp(last, next + 1, hi), next, hi, clusters);
+                }
+                checkpoint_.ranges.push_back(CheckpointState::Range{next, next, last, t});
+                next = last;
+            }
+            for (const auto& def : defs_) {
+                CheckpointState::Wagon saved;
+                saved.name = def.name;
+                saved.output = def.output;
+                checkpoint_.wagons.push_back(saved);
+            }
+        }
+        resumed_events_ = checkpoint_.processed();
+        return true;
+    }
+
+    /// Cluster starts of the input in entry numbers (none with an entry list)
+    const std::vector<Long64_t>& clusterStarts() const {
+        static const std::vector<Long64_t> none;
+        return reader_.hasEntryList() ? none : reader_.clusterStarts();
+    }
+
+    /// Parallel mode: one shard per worker, entries in chunks of the scheduler
+    bool startWorkers(const WagonBuilder& build) {
+        counters_ = std::make_unique<ProgressCounters>(static_cast<size_t>(n_threads_));
+        affinity_ = std::make_unique<ThreadAffinity>(pin_mode_, n_threads_);
+        scheduler_ = std::make_unique<WorkScheduler>(checkpoint_.ranges, clusterStarts(),
+                                                     config_.getChunkEvents(), scheduler_mode_ == "steal");
+        std::cout << "Running with " << n_threads_ << " worker threads ("
+                  << (scheduler_->stealing() ? "work stealing" : "static ranges") << ", chunks of ";
+        if (clusterStarts().empty()) {
+            std::cout << scheduler_->chunkEvents() << " entries)\n";
+        } else if (config_.getChunkEvents() > 0) {
+            std::cout << "at least " << scheduler_->chunkEvents() << " entries to a cluster start)\n";
+        } else {
+            std::cout << "one cluster)\n";
+        }
+        for (int t = 0; affinity_->enabled() && t < n_threads_; ++t) {
+            std::cout << "  Worker " << t << " pinned to " << affinity_->describe(t) << "\n";
+        }
+
+        try {
+            for (int t = 0; t < n_threads_; ++t) {
+                auto worker = std::make_unique<EventWorker>();
+                worker->index = t;
+
+                worker->reader.openLike(reader_);
+                worker->wagons = build(worker->reader, [this](size_t k) -> Manager& {
+                    return managers_[k]->createShard();
+                });
+                if (!skim_file_.empty()) {
+                    worker->skimming = true;
+                    worker->wagons.front()->skim_step = skim_step_;
+                }
+                if (block_size_ > 0) {
+                    worker->reader.setBlockMode(block_size_);
+                }
+                if (reader_.hasColumnCache()) {
+                    worker->reader.setColumnCache(column_cache_, column_cache_bytes_);
+                }
+                if (cache_bytes_ > 0) {
+                    worker->reader.setReadCache(cache_bytes_);
+                }
+                worker->profiler = Profiler(config_.getProfiling());
+
+                workers_.push_back(std::move(worker));
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error setting up worker threads: " << e.what() << "\n";
+            return false;
+        }
+        std::cout << "\n";
+        return true;
+    }
+
+    // ------------------------------------------------------------------------
+    // Event Loop
+    // ------------------------------------------------------------------------
+
+    void runSerial() {
+        RangeControl control;
+        control.schedule = checkpointing_ ? &schedule_ : nullptr;
+        CheckpointState::Range& range = checkpoint_.ranges[0];
+        try {
+            while (true) {
+                was_interrupted_ = runEventRange(reader_, wagons_, profiler_, range.next, range.last,
+                                                 processed_, progress_.get(), &control);
+                range.next = control.stopped_at;
+                if (was_interrupted_ || range.next >= range.last) break;
+                writeCheckpoint();
+            }
+        } catch (const std::exception& e) {
+            // Results so far are still saved, like a failed worker's
+            std::cerr << "\nEvent loop error: " << e.what() << "\n";
+            worker_failed_ = true;
+        }
+
+        // Keep the position reached so --resume continues from here
+        if (was_interrupted_ && checkpointing_ && !worker_failed_) {
+            writeCheckpoint();
+        }
+    }
+
+    void runParallel() {
+        ProgressCounters& counters = *counters_;
+        runWorkers(workers_, *scheduler_, *affinity_, counters, *progress_,
+                   [&]() { return checkpointing_ && schedule_.due(resumed_events_ + counters.total()); },
+                   [&]() {
+                       processed_ = resumed_events_ + counters.total();
+                       writeCheckpoint();
+                   });
+        processed_ = resumed_events_ + counters.total();
+
+        for (const auto& worker : workers_) {
+            was_interrupted_ = was_interrupted_ || worker->interrupted;
+            worker_failed_ = worker_failed_ || !worker->error.empty();
+        }
+        if (was_interrupted_ && checkpointing_ && !worker_failed_) {
+            writeCheckpoint();
+        }
+
+        mergeWorkers(workers_, *scheduler_, wagons_, skim_, profiler_, schema_issues_);
+    }
+
+    // ------------------------------------------------------------------------
+    // Checkpoints
+    // ------------------------------------------------------------------------
+
+    /// Checkpoint at the current position of every range (event loop
+    /// stopped); a failed checkpoint leaves the previous one in place
+    void writeCheckpoint() {
+        if (scheduler_) {
+            checkpoint_.ranges = scheduler_->ranges();
+        }
+        try {
+            saveCheckpoint();
+        } catch (const std::exception& e) {
+            std::cerr << "\nWarning: checkpoint failed: " << e.what() << "\n";
+        }
+        schedule_.reset(processed_.load());
+    }
+
+    /**
+     * @brief Write a checkpoint of all wagons
+     *
+     * checkpoint_.ranges must already hold the next entry of every range.
+     */
+    void saveCheckpoint() {
+        CheckpointState& state = checkpoint_;
+        ++state.serial;
+        std::vector<std::string> old_snapshots;
+        for (size_t k = 0; k < wagons_.size(); ++k) {
+            CheckpointState::Wagon& saved = state.wagons[k];
+            old_snapshots.push_back(saved.snapshot);
+            saved.snapshot = CheckpointState::snapshotFile(saved.output, state.serial);
+            managers_[k]->writeSnapshot(saved.snapshot);
+
+            saved.cuts.clear();
+            saved.flow_events = 0;
+            saved.skipped_events = 0;
+            saved.ntuples.clear();
+            CheckpointState::addCuts(saved, wagons_[k]->cuts);
+            if (workers_.empty()) {
+                CheckpointState::addNtuples(saved, -1, managers_[k]->checkpointNtuples(state.serial));
+            }
+            for (size_t t = 0; t < workers_.size(); ++t) {
+                const AnalysisWagon& w = *workers_[t]->wagons[k];
+                CheckpointState::addCuts(saved, w.cuts);
+                CheckpointState::addNtuples(saved, static_cast<int>(t),
+                                            w.mgr->checkpointNtuples(state.serial));
+            }
+        }
+
+        // The new state refers only to the new snapshots
+        state.write(checkpoint_options_.file);
+        for (const auto& file : old_snapshots) {
+            if (!file.empty()) std::remove(file.c_str());
+        }
+        std::cout << "\n✓ Checkpoint " << state.serial << " written after " << state.processed()
+                  << " events (" << checkpoint_options_.file << ")\n";
+    }
+
+    /// Restore histograms, cut counters and ntuple segments (before the loop)
+    void restoreCheckpoint() {
+        for (size_t k = 0; k < wagons_.size(); ++k) {
+            const CheckpointState::Wagon& saved = checkpoint_.wagons[k];
+            managers_[k]->restoreSnapshot(saved.snapshot);
+            wagons_[k]->cuts.addStatistics(saved.cuts, saved.flow_events, saved.skipped_events);
+            if (workers_.empty()) {
+                managers_[k]->restoreNtuples(saved.segments(-1));
+            }
+            for (size_t t = 0; t < workers_.size(); ++t) {
+                workers_[t]->wagons[k]->mgr->restoreNtuples(saved.segments(static_cast<int>(t)));
+            }
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // Results
+    // ------------------------------------------------------------------------
+
+    /// Summary, cut flows, output files, entry list and profiling report
+    void finish() {
+        // Finish progress bar (shows total elapsed time or interrupted status)
+        progress_->finish(was_interrupted_);
+        profiler_.stop(processed_.load() - resumed_events_);
+        NTupleReader::mergeSchemaIssues(schema_issues_, reader_.schemaIssues());
+        NTupleReader::printSchemaIssues(schema_issues_);
+
+        std::cout << "\n";
+        if (was_interrupted_) {
+            std::cout << "Processing interrupted by user (Ctrl+C).\n";
+        } else {
+            std::cout << "Processing complete!\n";
+        }
+        std::cout << "  Events processed: " << processed_.load() << "\n";
+        if (resume_) {
+            std::cout << "  (" << processed_.load() - resumed_events_ << " in this run, "
+                      << resumed_events_ << " restored from checkpoint " << checkpoint_.serial << ")\n";
+        }
+        if (scheduler_ && scheduler_->steals() > 0) {
+            std::cout << "  Work stealing: " << scheduler_->steals() << " range tails taken over by idle workers\n";
+        }
+
+        // Cut flow of every wagon
+        const bool train = wagons_.size() > 1;
+        for (const auto& w : wagons_) {
+            if (train) {
+                std::cout << "\nTrain wagon '" << w->name << "':";
+            }
+            w->cuts.printCutFlow();
+        }
+
+        // Save and close; profiler labels get the wagon name in train mode
+        // ("raw/nt_particles")
+        std::map<std::string, Long64_t> histogram_entries;
+        for (size_t k = 0; k < wagons_.size(); ++k) {
+            Manager& manager = *managers_[k];
+            std::cout << "\nSaving results to " << defs_[k].output << "...\n";
+            manager.printSummary();
+            if (profiler_.enabled()) {
+                for (const auto& p : manager.histogramEntries()) {
+                    histogram_entries[train ? wagons_[k]->name + "/" + p.first : p.first] = p.second;
+                }
+            }
+            Profiler::Scope finalize_scope(profiler_, ProfileStage::Finalize);
+            wagons_[k]->cuts.writeCutFlow(manager.getFile());
+            manager.closeFile();
+        }
+        profiler_.setHistogramEntries(histogram_entries);
+
+        writeSkim();
+
+        // A complete output makes the checkpoint obsolete (the ntuples have
+        // read its segments); an incomplete one can still be resumed
+        if (checkpointing_ || resume_) {
+            if (!was_interrupted_ && !worker_failed_) {
+                checkpoint_.removeFiles(checkpoint_options_.file);
+            } else {
+                std::cout << "\nCheckpoint kept: continue with " << program_ << " "
+                          << config_.getConfigFile() << " --resume\n";
+            }
+        }
+
+        // Profiling report (optional)
+        if (profiler_.enabled()) {
+            for (size_t k = 0; k < wagons_.size(); ++k) {
+                Manager& manager = *managers_[k];
+                for (const auto& name : manager.listDynamicNtuples()) {
+                    const DynamicHNtuple& nt = manager.getDynamicNtuple(name);
+                    profiler_.addNtuple(train ? wagons_[k]->name + "/" + name : name,
+                                        nt.getFillCount(), nt.getBytesWritten());
+                }
+            }
+            profiler_.print();
+
+            std::string profile_output = config_.getProfileOutput();
+            if (!profile_output.empty()) {
+                try {
+                    profiler_.writeJSON(profile_output);
+                } catch (const std::exception& e) {
+                    std::cerr << "Warning: " << e.what() << "\n";
+                }
+            }
+        }
+    }
+
+    /// Entry list of the pass; one of a partial pass would silently drop
+    /// events on reruns
+    void writeSkim() {
+        if (skim_file_.empty()) return;
+        if (was_interrupted_ || worker_failed_) {
+            std::cout << "\nEntry list not written (incomplete pass): " << skim_file_ << "\n";
+            return;
+        }
+        std::string title = "FAT: passed " + (skim_cut_.empty() ? std::string("all cuts") : skim_cut_) +
+                            " in entries " + std::to_string(start_event_) + "-" +
+                            std::to_string(end_event_) + " of " + config_.getInputSource();
+        try {
+            skim_.write(skim_file_, reader_.inputFiles(), reader_.getTreeName(), title);
+            std::cout << "\n✓ Entry list: " << skim_.size() << " of " << events_to_process_
+                      << " events passed " << (skim_cut_.empty() ? "all cuts" : skim_cut_)
+                      << " -> " << skim_file_ << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << "\nWarning: " << e.what() << "\n";
+        }
+    }
+
+    const AnalysisConfig& config_;
+    std::vector<AnalysisConfig::WagonDef> defs_;
+    std::string program_;
+    bool resume_ = false;
+
+    // Checkpoints and threads
+    CheckpointOptions checkpoint_options_;
+    bool checkpointing_ = false;
+    CheckpointState checkpoint_;
+    CheckpointSchedule schedule_;
+    int n_threads_ = 1;
+    std::string scheduler_mode_;
+    ThreadAffinity::Mode pin_mode_ = ThreadAffinity::Mode::None;
+
+    // Input and reading options (copied to every worker reader)
+    NTupleReader reader_;
+    Long64_t total_entries_ = 0;
+    Long64_t start_event_ = 0;
+    Long64_t end_event_ = 0;
+    Long64_t events_to_process_ = 0;
+    Long64_t block_size_ = 0;
+    std::string column_cache_;
+    Long64_t column_cache_bytes_ = 0;
+    Long64_t cache_bytes_ = 0;
+    int prefetch_depth_ = 0;
+
+    // Outputs and the main thread's wagons
+    OutputOptions output_options_;
+    std::vector<std::unique_ptr<Manager>> managers_;
+    Wagons wagons_;
+    std::string skim_file_;
+    std::string skim_cut_;
+    EntryList skim_;
+    int skim_step_ = -1;
+
+    // Progress and results of this run
+    Long64_t resumed_events_ = 0;
+    std::atomic<Long64_t> processed_{0};
+    bool was_interrupted_ = false;
+    bool worker_failed_ = false;
+    std::unique_ptr<ProgressBar> progress_;
+    Profiler profiler_;
+    std::vector<SchemaIssue> schema_issues_;
+
+    // Parallel mode
+    EventWorkers workers_;
+    std::unique_ptr<WorkScheduler> scheduler_;
+    std::unique_ptr<ProgressCounters> counters_;
+    std::unique_ptr<ThreadAffinity> affinity_;
+};
+
+#endif // EVENT_LOOP_H
@@ -0,0 +1,173 @@
+/**
+ * @file four_vector.h
+ * @brief Plain value-type four-vector used as the PParticle kernel
+ *
+ * TLorentzVector is a TObject with a TVector3 member (itself a TObject),
+ * so every temporary carries two vtable pointers and ROOT bookkeeping.
+ * FourVector holds only the four doubles, which keeps the per-event
+ * particle arithmetic (sums, boosts, masses) in registers. Conversion to
+ * TLorentzVector is available for code that needs ROOT objects.
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef FOUR_VECTOR_H
+#define FOUR_VECTOR_H
+
+#include "TLorentzVector.h"
+#include "TVector3.h"
+#include <cmath>
+
+// ============================================================================
+// FourVector: Plain Value-Type Four-Momentum
+// ============================================================================
+/**
+ * @struct FourVector
+ * @brief Trivially copyable (px, py, pz, E) kernel used inside PParticle
+ *
+ * No TObject base, no vtable, no heap: 32 bytes that the compiler keeps in
+ * registers. Formulas follow TLorentzVector/TVector3 exactly (same sign
+ * conventions, same edge cases), so results agree with ROOT to rounding.
+ *
+ * Usage Example:
+ * @code
+ *   FourVector p = FourVector::fromSpherical(1580, 45.0, 30.0, Physics::MASS_PROTON);
+ *   FourVector ppip = p + pip;
+ *   ppip.boost(0, 0, -0.5);
+ *   double m = ppip.m();
+ *   TLorentzVector root_vec = ppip.toTLorentzVector();  // when ROOT is needed
+ * @endcode
+ */
+struct FourVector {
+    double px = 0.0;
+    double py = 0.0;
+    double pz = 0.0;
+    double e = 0.0;
+
+    constexpr FourVector() = default;
+    constexpr FourVector(double px_, double py_, double pz_, double e_)
+        : px(px_), py(py_), pz(pz_), e(e_) {}
+
+    // ========================================================================
+    // Construction
+    // ========================================================================
+
+    /**
+     * @brief Four-vector from 3-momentum and rest mass (TLorentzVector::SetVectM)
+     */
+    static FourVector fromVectM(double px, double py, double pz, double mass) {
+        return FourVector(px, py, pz, std::sqrt(px*px + py*py + pz*pz + mass*mass));
+    }
+
+    /**
+     * @brief Four-vector from spherical momentum (angles in degrees)
+     */
+    static FourVector fromSpherical(double p, double theta_deg, double phi_deg, double mass) {
+        constexpr double d2r = 1.74532925199432955e-02;
+        double sin_theta = std::sin(theta_deg * d2r);
+        return fromVectM(p * sin_theta * std::cos(phi_deg * d2r),
+                         p * sin_theta * std::sin(phi_deg * d2r),
+                         p * std::cos(theta_deg * d2r),
+                         mass);
+    }
+
+    static FourVector fromTLorentzVector(const TLorentzVector& v) {
+        return FourVector(v.Px(), v.Py(), v.Pz(), v.E());
+    }
+
+    TLorentzVector toTLorentzVector() const {
+        return TLorentzVector(px, py, pz, e);
+    }
+
+    // ========================================================================
+    // Arithmetic
+    // ========================================================================
+
+    constexpr FourVector operator+(const FourVector& o) const {
+        return FourVector(px + o.px, py + o.py, pz + o.pz, e + o.e);
+    }
+
+    constexpr FourVector operator-(const FourVector& o) const {
+        return FourVector(px - o.px, py - o.py, pz - o.pz, e - o.e);
+    }
+
+    FourVector& operator+=(const FourVector& o) {
+        px += o.px; py += o.py; pz += o.pz; e += o.e;
+        return *this;
+    }
+
+    FourVector& operator-=(const FourVector& o) {
+        px -= o.px; py -= o.py; pz -= o.pz; e -= o.e;
+        return *this;
+    }
+
+    // ========================================================================
+    // Kinematics (ROOT conventions, angles in radians)
+    // ========================================================================
+
+    constexpr double p2() const { return px*px + py*py + pz*pz; }
+    constexpr double m2() const { return e*e - p2(); }
+    constexpr double perp2() const { return px*px + py*py; }
+
+    double p() const { return std::sqrt(p2()); }
+    double perp() const { return std::sqrt(perp2()); }
+
+    /// Invariant mass; negative for space-like vectors (as TLorentzVector::M)
+    double m() const {
+        double mm = m2();
+        return mm < 0.0 ? -std::sqrt(-mm) : std::sqrt(mm);
+    }
+
+    double theta() const {
+        return (px == 0.0 && py == 0.0 && pz == 0.0) ? 0.0 : std::atan2(perp(), pz);
+    }
+
+    double phi() const {
+        return (px == 0.0 && py == 0.0) ? 0.0 : std::atan2(py, px);
+    }
+
+    double cosTheta() const {
+        double ptot = p();
+        return ptot == 0.0 ? 1.0 : pz / ptot;
+    }
+
+    double rapidity() const { return 0.5 * std::log((e + pz) / (e - pz)); }
+    double beta() const { return p() / e; }
+
+    /// Velocity of this system (TLorentzVector::BoostVector)
+    TVector3 boostVector() const { return TVector3(px / e, py / e, pz / e); }
+
+    /**
+     * @brief Angle between the 3-momenta (TVector3::Angle)
+     * @return Angle in radians, 0 if either momentum vanishes
+     */
+    double angle(const FourVector& o) const {
+        double ptot2 = p2() * o.p2();
+        if (ptot2 <= 0.0) return 0.0;
+        double arg = (px*o.px + py*o.py + pz*o.pz) / std::sqrt(ptot2);
+        if (arg > 1.0) arg = 1.0;
+        if (arg < -1.0) arg = -1.0;
+        return std::acos(arg);
+    }
+
+    // ========================================================================
+    // Lorentz Boost (TLorentzVector::Boost)
+    // ========================================================================
+
+    void boost(double bx, double by, double bz) {
+        double b2 = bx*bx + by*by + bz*bz;
+        double gamma = 1.0 / std::sqrt(1.0 - b2);
+        double bp = bx*px + by*py + bz*pz;
+        double gamma2 = b2 > 0 ? (gamma - 1.0) / b2 : 0.0;
+
+        px += gamma2*bp*bx + gamma*bx*e;
+        py += gamma2*bp*by + gamma*by*e;
+        pz += gamma2*bp*bz + gamma*bz*e;
+        e = gamma*(e + bp);
+    }
+
+    void boost(const TVector3& b) { boost(b.X(), b.Y(), b.Z()); }
+};
+
+#endif // FOUR_VECTOR_H
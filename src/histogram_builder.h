@@ -16,6 +16,13 @@
  *                   .tag("angular")
  *                   .build1D();
  *
+ * Memory-lean storage (see sparse_histogram.h), registered with a handle:
+ *   H2Handle h = HistogramBuilder()
+ *                    .name("h_dalitz")
+ *                    .bins(1000, 0, 4).binsY(1000, 0, 4)
+ *                    .storage(HistogramStorage::Sparse)   // or Int32, Double
+ *                    .buildAndRegister2D(registry);
+ *
  * Benefits:
  * - Named parameters (no need to remember parameter order)
  * - Optional parameters with sensible defaults
@@ -36,7 +43,15 @@
 #include <TH1F.h>
 #include <TH2F.h>
 #include <TH3F.h>
+#include <TH1I.h>
+#include <TH2I.h>
+#include <TH3I.h>
+#include <TH1D.h>
+#include <TH2D.h>
+#include <TH3D.h>
 #include "histogram_registry.h"
+#include "histogram_handle.h"
+#include "sparse_histogram.h"
 
 // ============================================================================
 // HistogramBuilder: Fluent interface for histogram creation
@@ -159,6 +174,21 @@ public:
         return *this;
     }
 
+    // ------------------------------------------------------------------------
+    // Storage
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Select the storage backend (default: Dense, i.e. TH1F/TH2F/TH3F)
+     *
+     * Sparse, Int32 and Double are honoured by buildAndRegister*() and
+     * build*As(); build1D()/build2D()/build3D() always return float types.
+     */
+    HistogramBuilder& storage(HistogramStorage s) {
+        storage_ = s;
+        return *this;
+    }
+
     // ------------------------------------------------------------------------
     // Build methods
     // ------------------------------------------------------------------------
@@ -211,12 +241,58 @@ public:
         );
     }
 
+    /**
+     * @brief Build a dense histogram with the selected storage type
+     *
+     * Dense -> TH*F, Int32 -> TH*I, Double -> TH*D. Sparse histograms are
+     * not TH1 objects: use buildSparse() or buildAndRegister*().
+     */
+    std::unique_ptr<TH1> build1DAs() {
+        validate1D();
+        return makeDense<TH1F, TH1I, TH1D>(nbinsx_, xlow_, xup_);
+    }
+
+    std::unique_ptr<TH1> build2DAs() {
+        validate2D();
+        return makeDense<TH2F, TH2I, TH2D>(nbinsx_, xlow_, xup_, nbinsy_, ylow_, yup_);
+    }
+
+    std::unique_ptr<TH1> build3DAs() {
+        validate3D();
+        return makeDense<TH3F, TH3I, TH3D>(nbinsx_, xlow_, xup_, nbinsy_, ylow_, yup_,
+                                           nbinsz_, zlow_, zup_);
+    }
+
+    /**
+     * @brief Build a sparse histogram of the given dimension (1-3)
+     */
+    std::unique_ptr<SparseHistogram> buildSparse(int dimension) {
+        std::string title = has_title_ ? title_ : name_;
+        switch (dimension) {
+            case 1:
+                validate1D();
+                return std::make_unique<SparseHistogram>(name_, title, nbinsx_, xlow_, xup_);
+            case 2:
+                validate2D();
+                return std::make_unique<SparseHistogram>(name_, title, nbinsx_, xlow_, xup_,
+                                                         nbinsy_, ylow_, yup_);
+            case 3:
+                validate3D();
+                return std::make_unique<SparseHistogram>(name_, title, nbinsx_, xlow_, xup_,
+                                                         nbinsy_, ylow_, yup_,
+                                                         nbinsz_, zlow_, zup_);
+            default:
+                throw std::runtime_error("HistogramBuilder: buildSparse() dimension must be 1, 2 or 3");
+        }
+    }
+
     // ------------------------------------------------------------------------
     // Build and register in one step
     // ------------------------------------------------------------------------
 
     /**
-     * @brief Build 1D histogram and add to registry
+     * @brief Build 1D histogram with the selected storage and add to registry
+     * @return Handle for hash-free filling (may be ignored)
      *
      * Example:
      *   HistogramBuilder()
@@ -226,30 +302,36 @@ public:
      *       .buildAndRegister1D(registry);
      */
     template<typename Registry>
-    void buildAndRegister1D(Registry& registry) {
-        auto hist = build1D();
-        HistogramMetadata meta = buildMetadata();
-        registry.add(std::move(hist), meta);
+    H1Handle buildAndRegister1D(Registry& registry) {
+        if (storage_ == HistogramStorage::Sparse) {
+            return H1Handle(registry.addSparse(buildSparse(1), buildMetadata()));
+        }
+        registry.add(build1DAs(), buildMetadata());
+        return H1Handle(registry.get(name_), registry.fillBuffer(name_));
     }
 
     /**
-     * @brief Build 2D histogram and add to registry
+     * @brief Build 2D histogram with the selected storage and add to registry
      */
     template<typename Registry>
-    void buildAndRegister2D(Registry& registry) {
-        auto hist = build2D();
-        HistogramMetadata meta = buildMetadata();
-        registry.add(std::move(hist), meta);
+    H2Handle buildAndRegister2D(Registry& registry) {
+        if (storage_ == HistogramStorage::Sparse) {
+            return H2Handle(registry.addSparse(buildSparse(2), buildMetadata()));
+        }
+        registry.add(build2DAs(), buildMetadata());
+        return H2Handle(registry.template getAs<TH2>(name_), registry.fillBuffer(name_));
     }
 
     /**
-     * @brief Build 3D histogram and add to registry
+     * @brief Build 3D histogram with the selected storage and add to registry
      */
     template<typename Registry>
-    void buildAndRegister3D(Registry& registry) {
-        auto hist = build3D();
-        HistogramMetadata meta = buildMetadata();
-        registry.add(std::move(hist), meta);
+    H3Handle buildAndRegister3D(Registry& registry) {
+        if (storage_ == HistogramStorage::Sparse) {
+            return H3Handle(registry.addSparse(buildSparse(3), buildMetadata()));
+        }
+        registry.add(build3DAs(), buildMetadata());
+        return H3Handle(registry.template getAs<TH3>(name_));
     }
 
     // ------------------------------------------------------------------------
@@ -283,6 +365,7 @@ public:
         has_binning_ = false;
         has_binning_y_ = false;
         has_binning_z_ = false;
+        storage_ = HistogramStorage::Dense;
 
         nbinsx_ = 100;
         xlow_ = 0.0;
@@ -299,6 +382,23 @@ public:
 
 private:
 
+    /// Dense histogram of type F (float), I (int32) or D (double) per storage_
+    template<typename F, typename I, typename D, typename... Binning>
+    std::unique_ptr<TH1> makeDense(Binning... binning) const {
+        const char* title_cstr = has_title_ ? title_.c_str() : name_.c_str();
+        switch (storage_) {
+            case HistogramStorage::Int32:
+                return std::make_unique<I>(name_.c_str(), title_cstr, binning...);
+            case HistogramStorage::Double:
+                return std::make_unique<D>(name_.c_str(), title_cstr, binning...);
+            case HistogramStorage::Dense:
+                return std::make_unique<F>(name_.c_str(), title_cstr, binning...);
+            default:
+                throw std::runtime_error("HistogramBuilder: '" + name_ +
+                                       "' has sparse storage, use buildSparse()");
+        }
+    }
+
     // ------------------------------------------------------------------------
     // Validation
     // ------------------------------------------------------------------------
@@ -357,6 +457,9 @@ private:
     std::string folder_;
     std::string description_;
     std::vector<std::string> tags_;
+
+    // Storage backend
+    HistogramStorage storage_ = HistogramStorage::Dense;
 };
 
 // ============================================================================
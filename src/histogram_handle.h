@@ -0,0 +1,227 @@
+/**
+ * @file histogram_handle.h
+ * @brief Lightweight typed handles for hash-free histogram filling
+ *
+ * A handle is a plain pointer wrapper resolved once at setup time.
+ * Filling through a handle is a direct TH1::Fill call - no name lookup,
+ * no dynamic_cast - so it is the preferred way to fill in the event loop.
+ *
+ * Example usage:
+ *   H1Handle h_mass = manager.handle1D("mass_n");   // setup (once)
+ *   H2Handle h_dalitz = manager.create2D(...);      // create returns handle
+ *
+ *   h_mass.fill(m_n);                               // event loop
+ *   h_dalitz.fill(m2_ppip, m2_npip);
+ *
+ * Handles do not own the histogram. They stay valid as long as the
+ * Manager/HistogramRegistry that created them, until closeFile() hands
+ * the histograms over to the ROOT file.
+ *
+ * A handle to a sparse histogram (HistogramStorage::Sparse) fills the
+ * SparseHistogram instead; get() is then nullptr and sparse() is set.
+ *
+ * With buffered filling ("output.fill_buffer": N) 1D and 2D handles of
+ * dense histograms collect their values in a FillBuffer and hand N of them
+ * to TH1::FillN / TH2::FillN at once. The registry flushes the buffers
+ * before histograms are read, merged or written; get() of a buffered
+ * handle lags behind until flush().
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef HISTOGRAM_HANDLE_H
+#define HISTOGRAM_HANDLE_H
+
+#include <TH1.h>
+#include <TH2.h>
+#include <TH3.h>
+#include "sparse_histogram.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+// ============================================================================
+// FillBuffer: pending fills of one dense 1D or 2D histogram
+// ============================================================================
+
+/**
+ * @class FillBuffer
+ * @brief Fixed-size (x[, y], w) buffer emptied with one FillN call
+ *
+ * Owned by the HistogramRegistry of the histogram (one per histogram,
+ * shared by all its handles). Worker shards have their own registries,
+ * so a buffer is only ever used by one thread.
+ */
+class FillBuffer {
+public:
+    FillBuffer(TH1* hist, size_t capacity)
+        : hist_(hist),
+          dimension_(hist->GetDimension()),
+          capacity_(std::max<size_t>(capacity, 1)),
+          x_(capacity_),
+          y_(dimension_ == 2 ? capacity_ : 0),
+          w_(capacity_) {}
+
+    void add(double x, double w) {
+        x_[n_] = x;
+        w_[n_] = w;
+        if (++n_ == capacity_) flush();
+    }
+
+    void add(double x, double y, double w) {
+        x_[n_] = x;
+        y_[n_] = y;
+        w_[n_] = w;
+        if (++n_ == capacity_) flush();
+    }
+
+    /**
+     * @brief Fill all pending values into the histogram
+     */
+    void flush() {
+        if (n_ == 0) return;
+        if (!hist_) {
+            n_ = 0;
+            throw std::runtime_error("FillBuffer::flush() - Histogram was already written to its file");
+        }
+        Int_t n = static_cast<Int_t>(n_);
+        n_ = 0;
+        if (dimension_ == 2) {
+            static_cast<TH2*>(hist_)->FillN(n, x_.data(), y_.data(), w_.data(), 1);
+        } else {
+            hist_->FillN(n, x_.data(), w_.data(), 1);
+        }
+    }
+
+    /**
+     * @brief Cut the link to a histogram handed over to ROOT (after flush())
+     *
+     * Handles keep pointing at the buffer; a later flush() throws instead
+     * of filling a histogram its file may already have deleted.
+     */
+    void detach() { hist_ = nullptr; }
+
+    TH1* histogram() const { return hist_; }
+    size_t pending() const { return n_; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    TH1* hist_;
+    int dimension_;
+    size_t capacity_;
+    size_t n_ = 0;
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<double> w_;
+};
+
+// ============================================================================
+// H1Handle: 1D histogram handle
+// ============================================================================
+
+class H1Handle {
+public:
+    H1Handle() = default;
+    explicit H1Handle(TH1* hist, FillBuffer* buffer = nullptr) : hist_(hist), buffer_(buffer) {}
+    explicit H1Handle(SparseHistogram* sparse) : sparse_(sparse) {}
+
+    void fill(double x) const {
+        if (buffer_) buffer_->add(x, 1.0);
+        else if (hist_) hist_->Fill(x);
+        else sparse_->fill(x);
+    }
+
+    void fillWeighted(double x, double w) const {
+        if (buffer_) buffer_->add(x, w);
+        else if (hist_) hist_->Fill(x, w);
+        else sparse_->fillWeighted(x, w);
+    }
+
+    /// Fill pending buffered values (no-op for unbuffered handles)
+    void flush() const {
+        if (buffer_) buffer_->flush();
+    }
+
+    TH1* get() const { return hist_; }
+    SparseHistogram* sparse() const { return sparse_; }
+    bool buffered() const { return buffer_ != nullptr; }
+    bool valid() const { return hist_ != nullptr || sparse_ != nullptr; }
+    explicit operator bool() const { return valid(); }
+
+private:
+    TH1* hist_ = nullptr;
+    SparseHistogram* sparse_ = nullptr;
+    FillBuffer* buffer_ = nullptr;
+};
+
+// ============================================================================
+// H2Handle: 2D histogram handle
+// ============================================================================
+
+class H2Handle {
+public:
+    H2Handle() = default;
+    explicit H2Handle(TH2* hist, FillBuffer* buffer = nullptr) : hist_(hist), buffer_(buffer) {}
+    explicit H2Handle(SparseHistogram* sparse) : sparse_(sparse) {}
+
+    void fill(double x, double y) const {
+        if (buffer_) buffer_->add(x, y, 1.0);
+        else if (hist_) hist_->Fill(x, y);
+        else sparse_->fill(x, y);
+    }
+
+    void fillWeighted(double x, double y, double w) const {
+        if (buffer_) buffer_->add(x, y, w);
+        else if (hist_) hist_->Fill(x, y, w);
+        else sparse_->fillWeighted(x, y, w);
+    }
+
+    /// Fill pending buffered values (no-op for unbuffered handles)
+    void flush() const {
+        if (buffer_) buffer_->flush();
+    }
+
+    TH2* get() const { return hist_; }
+    SparseHistogram* sparse() const { return sparse_; }
+    bool buffered() const { return buffer_ != nullptr; }
+    bool valid() const { return hist_ != nullptr || sparse_ != nullptr; }
+    explicit operator bool() const { return valid(); }
+
+private:
+    TH2* hist_ = nullptr;
+    SparseHistogram* sparse_ = nullptr;
+    FillBuffer* buffer_ = nullptr;
+};
+
+// ============================================================================
+// H3Handle: 3D histogram handle
+// ============================================================================
+
+class H3Handle {
+public:
+    H3Handle() = default;
+    explicit H3Handle(TH3* hist) : hist_(hist) {}
+    explicit H3Handle(SparseHistogram* sparse) : sparse_(sparse) {}
+
+    void fill(double x, double y, double z) const {
+        if (hist_) hist_->Fill(x, y, z);
+        else sparse_->fill(x, y, z);
+    }
+
+    void fillWeighted(double x, double y, double z, double w) const {
+        if (hist_) hist_->Fill(x, y, z, w);
+        else sparse_->fillWeighted(x, y, z, w);
+    }
+
+    TH3* get() const { return hist_; }
+    SparseHistogram* sparse() const { return sparse_; }
+    bool valid() const { return hist_ != nullptr || sparse_ != nullptr; }
+    explicit operator bool() const { return valid(); }
+
+private:
+    TH3* hist_ = nullptr;
+    SparseHistogram* sparse_ = nullptr;
+};
+
+#endif // HISTOGRAM_HANDLE_H
@@ -12,6 +12,10 @@
  * - Support for HNtuple objects
  * - Automatic ROOT file organization (folders)
  * - Query capabilities (list by folder, search by tag)
+ * - Parallel merge of worker-shard registries (one histogram per task)
+ * - Sparse histograms (SparseHistogram), converted to TH1D/TH2D/TH3D on write
+ * - Snapshots for checkpoints (writeSnapshot(), addSnapshot())
+ * - Buffered filling through handles (setFillBuffer(), FillBuffer)
  *
  * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
  * @date 2025
@@ -26,12 +30,19 @@
 #include <memory>
 #include <stdexcept>
 #include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <TH1.h>
 #include <TH2.h>
 #include <TH3.h>
 #include <TFile.h>
 #include <TDirectory.h>
 #include "hntuple.h"
+#include "sparse_histogram.h"
+#include "histogram_handle.h"
 
 // ============================================================================
 // HistogramMetadata: Store information about each histogram
@@ -87,11 +98,17 @@ public:
         const std::string& name = meta.name;
 
         // Check for duplicates
-        if (histograms_.find(name) != histograms_.end()) {
+        if (has(name)) {
             throw std::runtime_error("HistogramRegistry::add() - Histogram '" +
                                    name + "' already exists!");
         }
 
+        // Worker shards keep their histograms out of gDirectory so that
+        // closing any ROOT file cannot delete them behind our back
+        if (detached_) {
+            hist->SetDirectory(nullptr);
+        }
+
         // Store histogram and metadata
         histograms_[name] = std::move(hist);
         metadata_[name] = meta;
@@ -115,6 +132,24 @@ public:
         add(std::move(hist), meta);
     }
 
+    // ------------------------------------------------------------------------
+    // Add sparse histogram (stored by occupied bin, dense only on write)
+    // ------------------------------------------------------------------------
+    SparseHistogram* addSparse(std::unique_ptr<SparseHistogram> hist, const HistogramMetadata& meta) {
+        if (!hist) {
+            throw std::runtime_error("HistogramRegistry::addSparse() - Cannot add null histogram!");
+        }
+        if (has(meta.name)) {
+            throw std::runtime_error("HistogramRegistry::addSparse() - Histogram '" +
+                                   meta.name + "' already exists!");
+        }
+
+        SparseHistogram* raw = hist.get();
+        sparse_[meta.name] = std::move(hist);
+        metadata_[meta.name] = meta;
+        return raw;
+    }
+
     // ------------------------------------------------------------------------
     // Add HNtuple to registry
     // ------------------------------------------------------------------------
@@ -149,9 +184,9 @@ public:
     TH1* get(const std::string& name) {
         auto it = histograms_.find(name);
         if (it == histograms_.end()) {
-            throw std::runtime_error("HistogramRegistry::get() - Histogram '" +
-                                   name + "' not found!");
+            throwNotFound("get", name);
         }
+        flushFillBuffer(name);
         return it->second.get();
     }
 
@@ -161,12 +196,95 @@ public:
     const TH1* get(const std::string& name) const {
         auto it = histograms_.find(name);
         if (it == histograms_.end()) {
-            throw std::runtime_error("HistogramRegistry::get() - Histogram '" +
-                                   name + "' not found!");
+            throwNotFound("get", name);
         }
+        flushFillBuffer(name);
         return it->second.get();
     }
 
+    // ------------------------------------------------------------------------
+    // Buffered filling (handles hand values to TH1::FillN in blocks)
+    // ------------------------------------------------------------------------
+    /**
+     * @brief Buffer size of handles resolved from now on (0 = fill directly)
+     */
+    void setFillBuffer(size_t capacity) {
+        fill_buffer_ = capacity;
+    }
+
+    size_t getFillBuffer() const {
+        return fill_buffer_;
+    }
+
+    /**
+     * @brief Shared fill buffer of a dense 1D or 2D histogram
+     * @return nullptr when buffering is off, or for sparse and 3D histograms
+     */
+    FillBuffer* fillBuffer(const std::string& name) {
+        if (fill_buffer_ == 0) return nullptr;
+        auto it = histograms_.find(name);
+        if (it == histograms_.end() || !it->second || it->second->GetDimension() > 2) {
+            return nullptr;
+        }
+        std::unique_ptr<FillBuffer>& buffer = buffers_[name];
+        if (!buffer) {
+            buffer = std::make_unique<FillBuffer>(it->second.get(), fill_buffer_);
+        }
+        return buffer.get();
+    }
+
+    /**
+     * @brief Fill all pending buffered values into their histograms
+     *
+     * Pending values are part of the histograms' content, so reading
+     * methods (get(), entries(), merge(), writeSnapshot()) flush first.
+     */
+    void flushFillBuffers() const {
+        for (const auto& pair : buffers_) {
+            pair.second->flush();
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // Get dense histogram (nullptr if 'name' is not stored dense or was
+    // already written; throws if it is not a T)
+    // ------------------------------------------------------------------------
+    template<typename T = TH1>
+    T* findDense(const std::string& name) {
+        auto it = histograms_.find(name);
+        if (it == histograms_.end() || !it->second) return nullptr;
+        flushFillBuffer(name);
+        T* typed = dynamic_cast<T*>(it->second.get());
+        if (!typed) {
+            throw std::runtime_error("HistogramRegistry::findDense() - Histogram '" +
+                                   name + "' is not of requested type!");
+        }
+        return typed;
+    }
+
+    // ------------------------------------------------------------------------
+    // Get sparse histogram (nullptr if 'name' is not stored sparse)
+    // ------------------------------------------------------------------------
+    SparseHistogram* findSparse(const std::string& name) {
+        auto it = sparse_.find(name);
+        return it == sparse_.end() ? nullptr : it->second.get();
+    }
+
+    const SparseHistogram* findSparse(const std::string& name) const {
+        auto it = sparse_.find(name);
+        return it == sparse_.end() ? nullptr : it->second.get();
+    }
+
+    // ------------------------------------------------------------------------
+    // Number of entries, whatever the storage
+    // ------------------------------------------------------------------------
+    Long64_t entries(const std::string& name) const {
+        if (const SparseHistogram* sparse = findSparse(name)) {
+            return sparse->getEntries();
+        }
+        return static_cast<Long64_t>(get(name)->GetEntries());
+    }
+
     // ------------------------------------------------------------------------
     // Get histogram with type checking (more convenient)
     // ------------------------------------------------------------------------
@@ -197,7 +315,7 @@ public:
     // Check if histogram exists
     // ------------------------------------------------------------------------
     bool has(const std::string& name) const {
-        return histograms_.find(name) != histograms_.end();
+        return histograms_.find(name) != histograms_.end() || sparse_.find(name) != sparse_.end();
     }
 
     // ------------------------------------------------------------------------
@@ -212,8 +330,8 @@ public:
     // ------------------------------------------------------------------------
     std::vector<std::string> listAll() const {
         std::vector<std::string> names;
-        names.reserve(histograms_.size());
-        for (const auto& pair : histograms_) {
+        names.reserve(metadata_.size());
+        for (const auto& pair : metadata_) {
             names.push_back(pair.first);
         }
         return names;
@@ -257,6 +375,201 @@ public:
         return it->second;
     }
 
+    // ------------------------------------------------------------------------
+    // Merge contents of another registry (TH1::Add, histogram by histogram)
+    // ------------------------------------------------------------------------
+    /**
+     * @brief Add all histograms of another registry into this one
+     *
+     * Both registries must hold the same set of histograms with identical
+     * binning (e.g. a worker shard set up by the same setupHistograms()).
+     * Histograms are added in name order, so the result does not depend
+     * on thread scheduling.
+     */
+    void merge(const HistogramRegistry& other) {
+        merge(std::vector<const HistogramRegistry*>{&other}, 1);
+    }
+
+    /**
+     * @brief Add several registries into this one, histograms in parallel
+     *
+     * Each histogram is one task: its sources are added in the order of
+     * 'others', so the result is identical to calling merge() on each of
+     * them in turn. Distinct histograms share no state, so TH1::Add runs
+     * concurrently without locking.
+     *
+     * @param others Registries to add (e.g. worker shards in creation order)
+     * @param threads Number of merge threads (<= 1: serial)
+     */
+    void merge(const std::vector<const HistogramRegistry*>& others, int threads) {
+        flushFillBuffers();
+        for (const HistogramRegistry* other : others) {
+            other->flushFillBuffers();
+        }
+
+        // Validate up front so that nothing is added on error
+        for (const HistogramRegistry* other : others) {
+            for (const auto& pair : other->histograms_) {
+                auto it = histograms_.find(pair.first);
+                if (it == histograms_.end() || !it->second) {
+                    throw std::runtime_error("HistogramRegistry::merge() - Histogram '" +
+                                           pair.first + "' not found in target registry!");
+                }
+            }
+            for (const auto& pair : other->sparse_) {
+                if (sparse_.find(pair.first) == sparse_.end()) {
+                    throw std::runtime_error("HistogramRegistry::merge() - Sparse histogram '" +
+                                           pair.first + "' not found in target registry!");
+                }
+            }
+        }
+
+        // One task per target histogram with its sources in merge order
+        struct MergeTask {
+            TH1* dense = nullptr;
+            std::vector<const TH1*> dense_sources;
+            SparseHistogram* sparse = nullptr;
+            std::vector<const SparseHistogram*> sparse_sources;
+        };
+        std::vector<MergeTask> tasks;
+        for (auto& pair : histograms_) {
+            MergeTask task;
+            task.dense = pair.second.get();
+            for (const HistogramRegistry* other : others) {
+                auto it = other->histograms_.find(pair.first);
+                if (it != other->histograms_.end() && it->second) {
+                    task.dense_sources.push_back(it->second.get());
+                }
+            }
+            if (!task.dense_sources.empty()) {
+                tasks.push_back(std::move(task));
+            }
+        }
+        for (auto& pair : sparse_) {
+            MergeTask task;
+            task.sparse = pair.second.get();
+            for (const HistogramRegistry* other : others) {
+                if (const SparseHistogram* source = other->findSparse(pair.first)) {
+                    task.sparse_sources.push_back(source);
+                }
+            }
+            if (!task.sparse_sources.empty()) {
+                tasks.push_back(std::move(task));
+            }
+        }
+
+        // Histograms differ in size: hand them out one at a time
+        std::atomic<size_t> next{0};
+        auto run = [&tasks, &next]() {
+            for (size_t i = next++; i < tasks.size(); i = next++) {
+                for (const TH1* source : tasks[i].dense_sources) {
+                    tasks[i].dense->Add(source);
+                }
+                for (const SparseHistogram* source : tasks[i].sparse_sources) {
+                    tasks[i].sparse->merge(*source);
+                }
+            }
+        };
+
+        size_t n_threads = std::min(static_cast<size_t>(std::max(threads, 1)), tasks.size());
+        if (n_threads <= 1) {
+            run();
+            return;
+        }
+        std::vector<std::thread> pool;
+        for (size_t t = 0; t < n_threads; ++t) {
+            pool.emplace_back(run);
+        }
+        for (auto& thread : pool) {
+            thread.join();
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // Snapshots (checkpoint / resume)
+    // ------------------------------------------------------------------------
+    /**
+     * @brief Write every histogram, summed with other registries, to a directory
+     *
+     * Histograms are stored flat under their names; sparse ones as a
+     * TTree of their occupied bins (SparseHistogram::writeCells()), so a
+     * checkpoint costs no more memory than the sparse storage itself.
+     * Nothing in this registry is modified.
+     *
+     * @param dir Destination (e.g. a checkpoint file)
+     * @param others Registries to add (e.g. worker shards)
+     */
+    void writeSnapshot(TDirectory* dir, const std::vector<const HistogramRegistry*>& others) const {
+        flushFillBuffers();
+        for (const HistogramRegistry* other : others) {
+            other->flushFillBuffers();
+        }
+        for (const auto& pair : histograms_) {
+            if (!pair.second) continue;
+            std::unique_ptr<TH1> sum(static_cast<TH1*>(pair.second->Clone(pair.first.c_str())));
+            sum->SetDirectory(nullptr);
+            for (const HistogramRegistry* other : others) {
+                auto it = other->histograms_.find(pair.first);
+                if (it != other->histograms_.end() && it->second) {
+                    sum->Add(it->second.get());
+                }
+            }
+            dir->WriteTObject(sum.get(), pair.first.c_str());
+        }
+        for (const auto& pair : sparse_) {
+            SparseHistogram sum = *pair.second;
+            for (const HistogramRegistry* other : others) {
+                if (const SparseHistogram* source = other->findSparse(pair.first)) {
+                    sum.merge(*source);
+                }
+            }
+            sum.writeCells(dir, pair.first);
+        }
+    }
+
+    /**
+     * @brief Add the histograms of a snapshot written by writeSnapshot()
+     *
+     * Throws if the snapshot lacks a histogram of this registry, e.g.
+     * because setupHistograms() changed since the checkpoint. Sparse
+     * histograms also accept the dense TH1 of older snapshots.
+     */
+    void addSnapshot(TDirectory* dir) {
+        for (const auto& pair : metadata_) {
+            const std::string& name = pair.first;
+            SparseHistogram* sparse = findSparse(name);
+            std::unique_ptr<TObject> object(dir->Get(name.c_str()));
+            if (sparse) {
+                if (TTree* cells = dynamic_cast<TTree*>(object.get())) {
+                    sparse->addCells(*cells);
+                    continue;
+                }
+            }
+            TH1* saved = dynamic_cast<TH1*>(object.get());
+            if (!saved) {
+                throw std::runtime_error("HistogramRegistry::addSnapshot() - Histogram '" + name +
+                                       "' not found in snapshot!");
+            }
+            saved->SetDirectory(nullptr);
+            if (sparse) {
+                sparse->add(*saved);
+            } else {
+                get(name)->Add(saved);
+            }
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // Detach newly added histograms from gDirectory (for worker shards)
+    // ------------------------------------------------------------------------
+    void setDetached(bool detached) {
+        detached_ = detached;
+    }
+
+    bool isDetached() const {
+        return detached_;
+    }
+
     // ------------------------------------------------------------------------
     // Write all histograms to file (organized by folders)
     // ------------------------------------------------------------------------
@@ -265,6 +578,13 @@ public:
             throw std::runtime_error("HistogramRegistry::writeToFile() - File is not open!");
         }
 
+        // Histograms go to ROOT below. Handles still point at the buffers,
+        // so they are kept, emptied and detached from their histograms
+        flushFillBuffers();
+        for (auto& pair : buffers_) {
+            pair.second->detach();
+        }
+
         // Group histograms by folder
         std::map<std::string, std::vector<std::string>> folder_contents;
 
@@ -275,9 +595,7 @@ public:
             if (folder.empty()) {
                 // Write to root directory
                 file->cd();
-                histograms_[name]->Write();
-                // Release ownership - ROOT now owns this histogram
-                histograms_[name].release();
+                writeHistogram(name);
             } else {
                 folder_contents[folder].push_back(name);
             }
@@ -294,9 +612,7 @@ public:
 
             // Write all histograms in this folder
             for (const auto& name : hist_names) {
-                histograms_[name]->Write();
-                // Release ownership - ROOT now owns this histogram
-                histograms_[name].release();
+                writeHistogram(name);
             }
         }
 
@@ -329,8 +645,21 @@ public:
         os << "║  HistogramRegistry Summary                                     ║\n";
         os << "╠════════════════════════════════════════════════════════════════╣\n";
         // Dynamic padding for Total histograms
-        os << "║ Total histograms: " << histograms_.size() 
-           << std::string(45 - std::to_string(histograms_.size()).length(), ' ') << "║\n";
+        os << "║ Total histograms: " << metadata_.size() 
+           << std::string(45 - std::to_string(metadata_.size()).length(), ' ') << "║\n";
+        if (!sparse_.empty()) {
+            size_t bytes = 0;
+            for (const auto& pair : sparse_) bytes += pair.second->memoryBytes();
+            std::ostringstream sparse_str;
+            sparse_str << sparse_.size() << " (" << std::fixed << std::setprecision(1)
+                       << bytes / (1024.0 * 1024.0) << " MB)";
+            os << "║   sparse:         " << std::left << std::setw(45) << sparse_str.str() << "║\n";
+        }
+        if (!buffers_.empty()) {
+            std::ostringstream buffer_str;
+            buffer_str << buffers_.size() << " (" << fill_buffer_ << " fills each)";
+            os << "║   buffered:       " << std::left << std::setw(45) << buffer_str.str() << "║\n";
+        }
         // Dynamic padding for Total ntuples
         os << "║ Total ntuples:    " << ntuples_.size() 
            << std::string(45 - std::to_string(ntuples_.size()).length(), ' ') << "║\n";
@@ -357,15 +686,18 @@ public:
     // ------------------------------------------------------------------------
     // Get statistics
     // ------------------------------------------------------------------------
-    size_t size() const { return histograms_.size(); }
+    size_t size() const { return metadata_.size(); }
+    size_t sparseCount() const { return sparse_.size(); }
     size_t ntupleCount() const { return ntuples_.size(); }
-    bool empty() const { return histograms_.empty() && ntuples_.empty(); }
+    bool empty() const { return metadata_.empty() && ntuples_.empty(); }
 
     // ------------------------------------------------------------------------
     // Clear all histograms (useful for testing)
     // ------------------------------------------------------------------------
     void clear() {
+        buffers_.clear();
         histograms_.clear();
+        sparse_.clear();
         metadata_.clear();
         ntuples_.clear();
         ntuple_metadata_.clear();
@@ -379,12 +711,55 @@ private:
         std::string description;
     };
 
-    // Storage
+    // Storage (metadata_ covers dense and sparse histograms)
     std::map<std::string, std::unique_ptr<TH1>> histograms_;
+    std::map<std::string, std::unique_ptr<SparseHistogram>> sparse_;
     std::map<std::string, HistogramMetadata> metadata_;
     std::map<std::string, std::unique_ptr<HNtuple>> ntuples_;
     std::map<std::string, NtupleMetadata> ntuple_metadata_;
 
+    // Histograms not attached to any TDirectory (worker shards)
+    bool detached_ = false;
+
+    // Fill buffers of dense histograms, by name (setFillBuffer(); 0 = off)
+    std::map<std::string, std::unique_ptr<FillBuffer>> buffers_;
+    size_t fill_buffer_ = 0;
+
+    void flushFillBuffer(const std::string& name) const {
+        if (buffers_.empty()) return;
+        auto it = buffers_.find(name);
+        if (it != buffers_.end()) {
+            it->second->flush();
+        }
+    }
+
+    [[noreturn]] void throwNotFound(const char* method, const std::string& name) const {
+        if (sparse_.find(name) != sparse_.end()) {
+            throw std::runtime_error(std::string("HistogramRegistry::") + method + "() - Histogram '" +
+                                   name + "' is stored sparse, use findSparse() or a handle!");
+        }
+        throw std::runtime_error(std::string("HistogramRegistry::") + method + "() - Histogram '" +
+                               name + "' not found!");
+    }
+
+    /**
+     * @brief Write one histogram to the current directory and give it up
+     *
+     * Dense histograms are handed over to ROOT; sparse ones are converted
+     * to a dense copy that is deleted right after writing.
+     */
+    void writeHistogram(const std::string& name) {
+        auto sparse = sparse_.find(name);
+        if (sparse != sparse_.end()) {
+            sparse->second->toHistogram()->Write();
+            sparse_.erase(sparse);
+            return;
+        }
+        histograms_[name]->Write();
+        // Release ownership - ROOT now owns this histogram
+        histograms_[name].release();
+    }
+
     // Helper: Create folder hierarchy in ROOT file
     TDirectory* createFolderHierarchy(TFile* file, const std::string& path) const {
         TDirectory* current = file;
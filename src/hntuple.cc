@@ -63,22 +63,19 @@ void HNtuple::setMap(const std::string& varList, Bool_t& kPair)
       }
       else
       {
-         // create a new pair ntuple variable - value
+         // create a new pair ntuple variable - position
          vKeyOrder.insert(make_pair(sName, i++));
-         if (kPair == kFALSE)
-            vKeyValue.insert(make_pair(sName, 0.));
          sName.clear();
       }
    }
-   // create the last new pair ntuple variable - value
+   // create the last new pair ntuple variable - position
    vKeyOrder.insert(make_pair(sName, i++));
-   if (kPair == kFALSE)
-      vKeyValue.insert(make_pair(sName, 0.));
    sName.clear();
 
-   // create Float_t array based on variables string and number of ':' separators
+   // create Float_t array based on variables string and number of ':' separators;
+   // from now on values live in this array, in ntuple order
    varArrayN = 1 + count_if(varList.begin(), varList.end(), [](char c){ return c == ':'; });
-   varArray.resize(varArrayN);
+   varArray.assign(varArrayN, 0.0f);
    kPair = kTRUE;
 }
 
@@ -113,53 +110,90 @@ Float_t& HNtuple::operator[](const std::string& key)
 {
    if (isNtuple)
    {
-      auto mIter = vKeyValue.find(key);
-      if (mIter != vKeyValue.end())
+      // FROZEN: the value sits in the fill array at the variable's position
+      auto mIter = vKeyOrder.find(key);
+      if (mIter != vKeyOrder.end())
       {
-         return mIter->second;
+         return varArray[mIter->second];
       }
-      // FROZEN: Build informative error message
-      std::ostringstream oss;
-      oss << "\n╔════════════════════════════════════════════════════════════════╗\n";
-      oss << "║  HNtuple ERROR: Cannot add new variable after freeze          ║\n";
-      oss << "╠════════════════════════════════════════════════════════════════╣\n";
-      oss << "║ Attempted to add: \"" << key << "\"\n";
-      oss << "║ NTuple name:      \"" << cname << "\"\n";
-      oss << "║ Fill count:       " << fillCount << " (frozen after fill #1)\n";
-      oss << "║\n";
-      oss << "║ The NTuple structure is FROZEN after the first fill() call.\n";
-      oss << "║ All variables must be defined BEFORE the first fill().\n";
-      oss << "║\n";
-      oss << "║ Current NTuple structure (" << varArrayN << " variables):\n";
-      oss << "║ ┌────────────────────────────────────────────────────────────┐\n";
+      throw std::runtime_error(frozenError(key));
+   }
 
-      std::vector<std::pair<std::string, Int_t>> sorted_vars(vKeyOrder.begin(), vKeyOrder.end());
-      std::sort(sorted_vars.begin(), sorted_vars.end(),
-                [](const auto& a, const auto& b) { return a.second < b.second; });
+return vKeyValue[key]; 
+}
 
-      for (const auto& var : sorted_vars) {
-         oss << "║ │ [" << var.second << "] " << var.first << "\n";
-      }
-      oss << "║ └────────────────────────────────────────────────────────────┘\n";
-      oss << "║\n";
-      oss << "║ SOLUTION:\n";
-      oss << "║   Add 'r[\"" << key << "\"] = value;' BEFORE the first fill() call,\n";
-      oss << "║   or check for typos in the variable name.\n";
-      oss << "╚════════════════════════════════════════════════════════════════╝\n";
-
-      throw std::runtime_error(oss.str());
+// ---------------------------------------------------------------------------------
+Float_t* HNtuple::address(const std::string& key)
+{
+// Resolve once, write *ptr per event: fill() then costs one TNtuple::Fill
+// and a reset of the contiguous value array
+
+   if (!isNtuple)
+   {
+      throw std::runtime_error("HNtuple ERROR: address(\"" + key + "\") of ntuple \"" + std::string(cname) +
+                               "\" requested before its structure is frozen.\n"
+                               "Positions are known after the first fill(); use r[\"" + key + "\"] until then.");
    }
+   auto mIter = vKeyOrder.find(key);
+   if (mIter == vKeyOrder.end())
+   {
+      throw std::runtime_error(frozenError(key));
+   }
+   return &varArray[mIter->second];
+}
 
-return vKeyValue[key]; 
+// ---------------------------------------------------------------------------------
+std::string HNtuple::frozenError(const std::string& key) const
+{
+   // FROZEN: Build informative error message
+   std::ostringstream oss;
+   oss << "\n╔════════════════════════════════════════════════════════════════╗\n";
+   oss << "║  HNtuple ERROR: Cannot add new variable after freeze          ║\n";
+   oss << "╠════════════════════════════════════════════════════════════════╣\n";
+   oss << "║ Attempted to add: \"" << key << "\"\n";
+   oss << "║ NTuple name:      \"" << cname << "\"\n";
+   oss << "║ Fill count:       " << fillCount << " (frozen after fill #1)\n";
+   oss << "║\n";
+   oss << "║ The NTuple structure is FROZEN after the first fill() call.\n";
+   oss << "║ All variables must be defined BEFORE the first fill().\n";
+   oss << "║\n";
+   oss << "║ Current NTuple structure (" << varArrayN << " variables):\n";
+   oss << "║ ┌────────────────────────────────────────────────────────────┐\n";
+
+   std::vector<std::pair<std::string, Int_t>> sorted_vars(vKeyOrder.begin(), vKeyOrder.end());
+   std::sort(sorted_vars.begin(), sorted_vars.end(),
+             [](const auto& a, const auto& b) { return a.second < b.second; });
+
+   for (const auto& var : sorted_vars) {
+      oss << "║ │ [" << var.second << "] " << var.first << "\n";
+   }
+   oss << "║ └────────────────────────────────────────────────────────────┘\n";
+   oss << "║\n";
+   oss << "║ SOLUTION:\n";
+   oss << "║   Add 'r[\"" << key << "\"] = value;' BEFORE the first fill() call,\n";
+   oss << "║   or check for typos in the variable name.\n";
+   oss << "╚════════════════════════════════════════════════════════════════╝\n";
+   return oss.str();
 }
 
 // ---------------------------------------------------------------------------------
 const Float_t &HNtuple::operator[](const std::string &key) const
 {
-   const auto mcIter = vKeyValue.find(key);
-   if (mcIter != vKeyValue.end())
+   if (isNtuple)
    {
-      return mcIter->second;
+      const auto moIter = vKeyOrder.find(key);
+      if (moIter != vKeyOrder.end())
+      {
+         return varArray[moIter->second];
+      }
+   }
+   else
+   {
+      const auto mcIter = vKeyValue.find(key);
+      if (mcIter != vKeyValue.end())
+      {
+         return mcIter->second;
+      }
    }
 
    // Variable not found - build informative error
@@ -185,13 +219,12 @@ Int_t HNtuple::fill()
 
    if (isNtuple==kTRUE)
    {
-      // Already frozen - just fill with current values
-      std::fill(varArray.begin(), varArray.end(), 0.0);
-      for (auto& pair : vKeyValue) {
-         varArray[vKeyOrder[pair.first]] = pair.second;
-         // reset of map array
-         pair.second = 0.0;
-      }
+      // Already frozen - operator[] wrote straight into varArray:
+      // fill from it, then reset it in one contiguous pass
+      fillCount++;
+      Int_t bytes = ptrNt->Fill(varArray.data());
+      std::fill(varArray.begin(), varArray.end(), 0.0f);
+      return bytes;
    }
    else
    {
@@ -262,20 +295,20 @@ Int_t HNtuple::fill()
       std::cout << "║ This structure is now FROZEN. No new variables can be added.   ║\n";
       std::cout << "╚════════════════════════════════════════════════════════════════╝\n";
 
-      //-------- Fill first entry
-      std::fill(varArray.begin(), varArray.end(), 0.0f);
-      for (auto& pair : vKeyValue) {
+      //-------- Move the staged values to their positions; the map is not used any more
+      for (const auto& pair : vKeyValue) {
          varArray[vKeyOrder[pair.first]] = pair.second;
-         // reset of map array
-         pair.second = 0.;
       }
+      vKeyValue.clear();
    }
 
    // Increment fill counter
    fillCount++;
 
-   // filling the ROOT ntuple
-   return ptrNt->Fill(varArray.data());
+   // filling the ROOT ntuple, then reset of the value array
+   Int_t bytes = ptrNt->Fill(varArray.data());
+   std::fill(varArray.begin(), varArray.end(), 0.0f);
+   return bytes;
 }
 
 // ---------------------------------------------------------------------------------
@@ -321,10 +354,7 @@ void HNtuple::printStructure(std::ostream& os) const
       for (const auto& var : sorted_vars) {
          os << "║ │ [" << var.second << "] " << var.first;
          if (isNtuple) {
-            auto it = vKeyValue.find(var.first);
-            if (it != vKeyValue.end()) {
-               os << " = " << it->second;
-            }
+            os << " = " << varArray[var.second];
          }
          os << "\n";
       }
@@ -45,6 +45,7 @@ public:
    Int_t Write(const char* name = 0, Int_t option = 0, Int_t bufsize = 0); // virtual function for a polymorphic NTulple Write call
    Float_t& operator[](const std::string& key); // the way of assigning values for variables
    const Float_t& operator[](const std::string& key) const; // the way of variable value reading
+   Float_t* address(const std::string& key); // stable pointer to a variable of the frozen ntuple (no lookup per event)
    Int_t fill(); // fills tuple, if not defined, constructs it first
    void SetDirectory(TDirectory* dir); 
    const char* getName() const { return cname; }
@@ -67,6 +68,7 @@ protected:
 
    HNtuple& operator=(const HNtuple& src) const; 
    void setMap(const std::string& varList, Bool_t& kPair); // creates a map from variable string
+   std::string frozenError(const std::string& key) const; // diagnostics for a variable added after freeze
 
    std::string cname_str; //! Stored name
    std::string ctitle_str; //! Stored title
@@ -78,8 +80,8 @@ protected:
    Bool_t isNtuple {kFALSE}; //! kTRUE if ntuple is defined
    Int_t varArrayN {0}; //! number of ntuple variables
    Long64_t fillCount {0}; //! number of times fill() has been called
-   std::vector<Float_t> varArray; //! table of values for ntuple to be filled with
-   std::map<std::string, Float_t> vKeyValue; //! pair of a variable name and a value
+   std::vector<Float_t> varArray; //! values in ntuple order; after freeze operator[] writes here directly
+   std::map<std::string, Float_t> vKeyValue; //! pair of a variable name and a value (before freeze only)
    std::map<std::string, Int_t> vKeyOrder; //! pair of a variable name and its position in ntuple
 
 ClassDef(HNtuple, 0)
@@ -0,0 +1,260 @@
+/**
+ * @file job_splitter.h
+ * @brief Split a file-list analysis into batch jobs with derived configs
+ *
+ * The files of the input list are partitioned into N contiguous groups,
+ * balanced by entries (or by file count). Every job gets its own list
+ * file and a config derived from the original one, in which all output
+ * names carry the job number:
+ *
+ *   h68_10.list, config.json, output_ppip.root
+ *     -> h68_10.job0.list, config.job0.json, output_ppip.job0.root
+ *
+ * The jobs run with the unchanged ./ana on any batch system; their
+ * outputs are combined afterwards with the OutputMerger (./ana --merge).
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef JOB_SPLITTER_H
+#define JOB_SPLITTER_H
+
+#include "analysis_config.h"
+#include "entry_list.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// JobSpec: One Batch Job
+// ============================================================================
+/**
+ * @struct JobSpec
+ * @brief Files, derived config and outputs of one job
+ */
+struct JobSpec {
+    int index = 0;
+    std::vector<std::string> files;
+    Long64_t entries = 0;              ///< Sum over files (0 when split by files)
+    std::string list_file;
+    std::string config_file;
+    std::vector<std::string> outputs;  ///< One per train wagon (or output.filename)
+};
+
+// ============================================================================
+// JobSplitter: Partition the Input, Write List and Config Files
+// ============================================================================
+/**
+ * @class JobSplitter
+ * @brief Derives N job configs from one analysis config
+ *
+ * Usage Example:
+ * @code
+ *   NTupleReader reader;
+ *   reader.openFromList(config.getInputSource(), config.getInputTreeName(), config.getInputIndex());
+ *   auto jobs = JobSplitter::write(config, reader.inputFiles(), 20, JobSplitter::By::Entries);
+ * @endcode
+ *
+ * Files are never split: a job reads whole files from the list, in list
+ * order, so the jobs' outputs merged in job order hold the events in the
+ * order of a single run.
+ */
+class JobSplitter {
+public:
+    enum class By { Entries, Files };
+
+    static By parseBy(const std::string& name) {
+        if (name == "entries") return By::Entries;
+        if (name == "files") return By::Files;
+        throw std::runtime_error("JobSplitter: Unknown split mode '" + name + "' (use entries or files)");
+    }
+
+    /**
+     * @brief Partition files into at most n contiguous, non-empty groups
+     * @param files Input files in list order (entries used for By::Entries)
+     *
+     * Each group ends at the file that brings it closest to its share
+     * (k+1)/n of the total.
+     */
+    static std::vector<std::vector<InputSegment>> partition(const std::vector<InputSegment>& files,
+                                                            int n, By by) {
+        if (n < 1) {
+            throw std::runtime_error("JobSplitter::partition() - Number of jobs must be >= 1");
+        }
+        if (files.empty()) {
+            throw std::runtime_error("JobSplitter::partition() - No input files");
+        }
+        size_t jobs = std::min(static_cast<size_t>(n), files.size());
+
+        auto weight = [by](const InputSegment& f) {
+            return by == By::Entries ? static_cast<double>(f.entries) : 1.0;
+        };
+        double total = 0;
+        for (const auto& f : files) total += weight(f);
+
+        std::vector<std::vector<InputSegment>> groups(jobs);
+        size_t i = 0;
+        double done = 0;
+        for (size_t k = 0; k < jobs; ++k) {
+            double target = total * (k + 1) / jobs;
+            size_t jobs_after = jobs - k - 1;
+            while (i < files.size() && files.size() - i > jobs_after &&
+                   (groups[k].empty() || k + 1 == jobs || done + weight(files[i]) / 2 <= target)) {
+                done += weight(files[i]);
+                groups[k].push_back(files[i++]);
+            }
+        }
+        return groups;
+    }
+
+    /**
+     * @brief Name for job k derived from a file name ("out.root" -> "out.job3.root")
+     */
+    static std::string jobName(const std::string& path, int index) {
+        size_t slash = path.find_last_of('/');
+        size_t dot = path.rfind('.');
+        std::string tag = ".job" + std::to_string(index);
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+            return path + tag;
+        }
+        return path.substr(0, dot) + tag + path.substr(dot);
+    }
+
+    /**
+     * @brief Config of job k: its list file and job-numbered output names
+     *
+     * Renamed: output.filename, every train wagon's output,
+     * output.entry_list, execution.checkpoint_file and
+     * execution.profile_output (when set). input.entry_list stays: a skim
+     * of the full list serves every job. So does the dataset index of the
+     * full list (index_file, "" = none), which covers the job lists too.
+     */
+    static JsonValue jobConfig(const JsonValue& config, const std::string& list_file, int index,
+                               const std::string& index_file = "") {
+        JsonValue job = config;
+
+        JsonValue input = config["input"];
+        input.set("source", list_file);
+        if (!index_file.empty()) input.set("index", index_file);
+        job.set("input", input);
+
+        JsonValue output = config["output"];
+        output.set("filename", jobName(config["output"]["filename"].asString("output.root"), index));
+        renameIfSet(output, "entry_list", index);
+        job.set("output", output);
+
+        if (config.has("train")) {
+            JsonValue train = JsonValue::array();
+            for (const auto& wagon : config["train"].asArray()) {
+                JsonValue w = wagon;
+                renameIfSet(w, "output", index);
+                train.push_back(w);
+            }
+            job.set("train", train);
+        }
+
+        if (config.has("execution")) {
+            JsonValue execution = config["execution"];
+            renameIfSet(execution, "checkpoint_file", index);
+            renameIfSet(execution, "profile_output", index);
+            job.set("execution", execution);
+        }
+        return job;
+    }
+
+    /**
+     * @brief Write list and config files of all jobs
+     * @param files Input files with entries (NTupleReader::inputFiles())
+     * @return The jobs, in input order
+     */
+    static std::vector<JobSpec> write(const AnalysisConfig& config, const std::vector<InputSegment>& files,
+                                      int n, By by) {
+        if (!config.isInputFileList()) {
+            throw std::runtime_error("JobSplitter: Splitting needs a .list input, got " +
+                                     config.getInputSource());
+        }
+        if (config.getStartEvent() != 0 || config.getMaxEvents() > 0) {
+            throw std::runtime_error("JobSplitter: Jobs read whole files; remove start_event/max_events");
+        }
+
+        std::vector<AnalysisConfig::WagonDef> wagons = config.getTrainWagons();
+        std::vector<std::string> outputs;
+        for (const auto& w : wagons) outputs.push_back(w.output);
+        if (outputs.empty()) outputs.push_back(config.getOutputFilename());
+
+        auto groups = partition(files, n, by);
+        std::vector<JobSpec> jobs;
+        for (size_t k = 0; k < groups.size(); ++k) {
+            JobSpec job;
+            job.index = static_cast<int>(k);
+            job.list_file = jobName(config.getInputSource(), job.index);
+            job.config_file = jobName(config.getConfigFile(), job.index);
+            for (const auto& f : groups[k]) {
+                job.files.push_back(f.file);
+                job.entries += f.entries;
+            }
+            for (const auto& out : outputs) job.outputs.push_back(jobName(out, job.index));
+
+            std::ofstream list(job.list_file);
+            list << "# FAT job " << k << " of " << groups.size() << " (split from "
+                 << config.getInputSource() << ")\n";
+            for (const auto& f : job.files) list << f << "\n";
+            if (!list) {
+                throw std::runtime_error("JobSplitter: Cannot write " + job.list_file);
+            }
+
+            std::ofstream cfg(job.config_file);
+            cfg << "// FAT job " << k << " of " << groups.size() << " (split from "
+                << config.getConfigFile() << ")\n";
+            cfg << jobConfig(config.json(), job.list_file, job.index, config.getInputIndex()).dump() << "\n";
+            if (!cfg) {
+                throw std::runtime_error("JobSplitter: Cannot write " + job.config_file);
+            }
+            jobs.push_back(job);
+        }
+        return jobs;
+    }
+
+    /**
+     * @brief Print the jobs and the commands that run and merge them
+     */
+    static void printJobs(const std::vector<JobSpec>& jobs, const std::string& program,
+                          const std::string& config_file, const std::vector<std::string>& outputs,
+                          std::ostream& os = std::cout) {
+        os << "\n";
+        os << "╔════════════════════════════════════════════════════════════════╗\n";
+        os << "║                          BATCH JOBS                            ║\n";
+        os << "╠════════════════════════════════════════════════════════════════╣\n";
+        os << "║ Job  │ Files │ Entries      │ Config                           ║\n";
+        os << "╠──────┼───────┼──────────────┼──────────────────────────────────╣\n";
+        for (const auto& job : jobs) {
+            os << "║ " << std::right << std::setw(4) << job.index
+               << " │ " << std::setw(5) << job.files.size()
+               << " │ " << std::setw(12) << job.entries
+               << " │ " << std::left << std::setw(32) << job.config_file << " ║\n";
+        }
+        os << "╚════════════════════════════════════════════════════════════════╝\n";
+
+        os << "\nRun each job:\n";
+        os << "  " << program << " " << jobName(config_file, 0) << "   # ... up to job "
+           << jobs.size() - 1 << "\n";
+        os << "Then merge (once per output file):\n";
+        for (size_t w = 0; w < outputs.size(); ++w) {
+            os << "  " << program << " " << config_file << " --merge " << outputs[w];
+            for (const auto& job : jobs) os << " " << job.outputs[w];
+            os << "\n";
+        }
+    }
+
+private:
+    static void renameIfSet(JsonValue& object, const std::string& key, int index) {
+        std::string value = object[key].asString("");
+        if (!value.empty()) object.set(key, jobName(value, index));
+    }
+};
+
+#endif // JOB_SPLITTER_H
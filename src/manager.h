@@ -9,6 +9,14 @@
  * - Provides type-safe access
  * - Supports metadata and folder organization
  * - Fixes memory leaks from original implementation
+ * - Worker shards for multi-threaded event loops (merged at closeFile())
+ * - Typed handles for hash-free filling in the event loop
+ * - Output compression, ntuple basket sizing and parallel shard merging
+ *   (OutputOptions)
+ * - Per-histogram storage: dense float, int32, double or sparse
+ *   (HistogramStorage, sparse_histogram.h)
+ * - Checkpoints: histogram snapshots and sealed ntuple segments that a
+ *   resumed job restores (checkpoint.h)
  *
  * This class is designed to be backward-compatible with existing code while
  * providing a migration path to the new architecture.
@@ -22,7 +30,11 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+#include <map>
+#include <algorithm>
 #include <stdexcept>
+#include <Compression.h>
 #include <TFile.h>
 #include <TH1.h>
 #include <TH2.h>
@@ -30,9 +42,70 @@
 #include "hntuple.h"
 #include "dynamic_hntuple.h"
 #include "histogram_registry.h"
+#include "histogram_handle.h"
 #include "histogram_factory.h"
 #include "histogram_builder.h"
 
+// ============================================================================
+// OutputOptions: How the output file is written
+// ============================================================================
+
+/**
+ * @struct OutputOptions
+ * @brief Compression, TTree buffering and merge settings of a Manager
+ *
+ * Defaults leave everything to ROOT. Typical choices: "lz4" for fast
+ * turnaround while iterating on an analysis, "zstd" or "lzma" for files
+ * that are archived.
+ */
+struct OutputOptions {
+    int compression = -1;       ///< ROOT setting 100 * algorithm + level (-1 = ROOT default)
+    Int_t basket_size = 0;      ///< Ntuple branch buffer in bytes (0 = ROOT default, 32000)
+    Long64_t auto_flush = 0;    ///< TTree::SetAutoFlush(): > 0 entries, < 0 bytes (0 = ROOT default)
+    int merge_threads = 1;      ///< Threads adding worker-shard histograms at closeFile()
+    int fill_buffer = 0;        ///< Fills buffered per 1D/2D handle before TH1::FillN (0 = direct Fill)
+
+    /**
+     * @brief ROOT compression setting from an algorithm name and level
+     * @param algorithm "default", "none", "zlib", "lzma", "lz4" or "zstd"
+     * @param level 1-9, or < 0 for the algorithm's recommended level
+     * @return Setting for TFile::SetCompressionSettings (-1 for "default")
+     */
+    static int parseCompression(const std::string& algorithm, int level = -1) {
+        using Algo = ROOT::RCompressionSetting::EAlgorithm;
+        if (algorithm.empty() || algorithm == "default") return -1;
+        if (algorithm == "none") return 0;
+
+        Algo::EValues algo;
+        int recommended;
+        if (algorithm == "zlib")      { algo = Algo::kZLIB; recommended = 1; }
+        else if (algorithm == "lzma") { algo = Algo::kLZMA; recommended = 7; }
+        else if (algorithm == "lz4")  { algo = Algo::kLZ4;  recommended = 4; }
+        else if (algorithm == "zstd") { algo = Algo::kZSTD; recommended = 5; }
+        else {
+            throw std::runtime_error("OutputOptions: Unknown compression algorithm '" + algorithm +
+                                   "' (use default, none, zlib, lzma, lz4 or zstd)");
+        }
+        if (level > 9) {
+            throw std::runtime_error("OutputOptions: Compression level must be 1-9, got " +
+                                   std::to_string(level));
+        }
+        return ROOT::CompressionSettings(algo, level < 1 ? recommended : level);
+    }
+
+    /**
+     * @brief Readable form of a compression setting ("lz4 level 4")
+     */
+    static std::string describeCompression(int setting) {
+        if (setting < 0) return "ROOT default";
+        if (setting % 100 == 0) return "none";
+        static const char* names[] = {"global", "zlib", "lzma", "old zlib", "lz4", "zstd"};
+        int algo = setting / 100;
+        std::string name = (algo >= 0 && algo <= 5) ? names[algo] : "algorithm " + std::to_string(algo);
+        return name + " level " + std::to_string(setting % 100);
+    }
+};
+
 // ============================================================================
 // Manager: Modern histogram/ntuple manager
 // ============================================================================
@@ -49,6 +122,20 @@ public:
     // Destructor (RAII - automatic cleanup)
     // ------------------------------------------------------------------------
     ~Manager() {
+        // Unmerged worker shards only drop their intermediate files;
+        // the output file belongs to the parent
+        if (parent_) {
+            for (auto& pair : dynamic_ntuples_) {
+                if (!pair.second->isFinalized()) {
+                    pair.second->cleanupIntermediateFile();
+                }
+            }
+            return;
+        }
+        
+        // Shards must go before the output file they point to is closed
+        shards_.clear();
+        
         // Finalize any dynamic ntuples before closing
         for (auto& pair : dynamic_ntuples_) {
             if (!pair.second->isFinalized()) {
@@ -89,18 +176,53 @@ public:
         if (!file_->IsOpen()) {
             throw std::runtime_error("Manager::openFile() - Failed to open file: " + filename);
         }
+        if (options_.compression >= 0) {
+            file_->SetCompressionSettings(options_.compression);
+        }
+
+        std::cout << "Manager: Opened file '" << filename << "' with option '" << option << "'";
+        if (options_.compression >= 0) {
+            std::cout << " (" << OutputOptions::describeCompression(options_.compression) << ")";
+        }
+        std::cout << "\n";
+    }
+
+    /**
+     * @brief Set compression, basket sizing, merge threads and fill buffering
+     *
+     * Call before openFile() and before creating ntuples and handles. Worker shards
+     * use the options of their parent.
+     */
+    void setOutputOptions(const OutputOptions& options) {
+        if (parent_) {
+            throw std::runtime_error("Manager::setOutputOptions() - Worker shards use the parent's options!");
+        }
+        options_ = options;
+        registry_.setFillBuffer(static_cast<size_t>(std::max(options_.fill_buffer, 0)));
+        if (file_ && file_->IsOpen() && options_.compression >= 0) {
+            file_->SetCompressionSettings(options_.compression);
+        }
+    }
 
-        std::cout << "Manager: Opened file '" << filename << "' with option '" << option << "'\n";
+    const OutputOptions& getOutputOptions() const {
+        return parent_ ? parent_->options_ : options_;
     }
 
     /**
      * @brief Close output file (writes all histograms automatically)
      */
     void closeFile() {
+        if (parent_) {
+            throw std::runtime_error("Manager::closeFile() - Worker shards are merged by their parent!");
+        }
         if (!file_ || !file_->IsOpen()) {
             throw std::runtime_error("Manager::closeFile() - No file is open!");
         }
 
+        // Merge worker shards in creation order (deterministic output as
+        // long as every shard gets the same entries, i.e. static schedule)
+        mergeShards();
+
         // Finalize all dynamic ntuples (TTree → TNtuple conversion)
         for (auto& pair : dynamic_ntuples_) {
             if (!pair.second->isFinalized()) {
@@ -122,6 +244,123 @@ public:
         return file_.get();
     }
 
+    // ------------------------------------------------------------------------
+    // Worker shards (multi-threaded event loop)
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Create a worker shard for one event-loop thread
+     *
+     * A shard is an independent Manager with its own histograms and
+     * DynamicHNtuple buffers, writing nothing to the output file itself.
+     * Run the same setup functions on it as on the parent, fill it from a
+     * single thread, and closeFile() on the parent merges all shards
+     * (TH1::Add for histograms, entry append for ntuples) in creation order.
+     *
+     * Example:
+     *   Manager& shard = manager.createShard();
+     *   setupHistograms(shard);
+     *   setupNtuples(shard, config);
+     *   // ... fill shard in worker thread ...
+     *   manager.closeFile();  // merges shard
+     */
+    Manager& createShard() {
+        if (parent_) {
+            throw std::runtime_error("Manager::createShard() - Cannot create a shard of a shard!");
+        }
+        if (!file_ || !file_->IsOpen()) {
+            throw std::runtime_error("Manager::createShard() - No file open! Call openFile() first.");
+        }
+
+        auto shard = std::unique_ptr<Manager>(new Manager());
+        shard->parent_ = this;
+        shard->shard_index_ = static_cast<int>(shards_.size());
+        shard->registry_.setDetached(true);
+        shard->registry_.setFillBuffer(registry_.getFillBuffer());
+
+        shards_.push_back(std::move(shard));
+        return *shards_.back();
+    }
+
+    /**
+     * @brief Number of worker shards not yet merged
+     */
+    size_t shardCount() const {
+        return shards_.size();
+    }
+
+    /**
+     * @brief Check if this Manager is a worker shard
+     */
+    bool isShard() const {
+        return parent_ != nullptr;
+    }
+
+    // ------------------------------------------------------------------------
+    // Checkpoints (see checkpoint.h)
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Write all histograms, summed over worker shards, to a snapshot file
+     *
+     * Only while no thread fills this Manager or its shards. HNtuple
+     * contents cannot be snapshot; use DynamicHNtuple with checkpoints.
+     */
+    void writeSnapshot(const std::string& filename) const {
+        if (parent_) {
+            throw std::runtime_error("Manager::writeSnapshot() - Worker shards are saved by their parent!");
+        }
+        if (registry_.ntupleCount() > 0) {
+            throw std::runtime_error("Manager::writeSnapshot() - HNtuple ntuples cannot be checkpointed "
+                                   "(use createDynamicNtuple())!");
+        }
+
+        TFile file(filename.c_str(), "RECREATE");
+        if (file.IsZombie()) {
+            throw std::runtime_error("Manager::writeSnapshot() - Cannot create " + filename);
+        }
+        std::vector<const HistogramRegistry*> registries;
+        for (const auto& shard : shards_) {
+            registries.push_back(&shard->registry_);
+        }
+        registry_.writeSnapshot(&file, registries);
+        file.Close();
+    }
+
+    /**
+     * @brief Add the histograms of a snapshot (resumed job, before filling)
+     */
+    void restoreSnapshot(const std::string& filename) {
+        TFile file(filename.c_str(), "READ");
+        if (file.IsZombie()) {
+            throw std::runtime_error("Manager::restoreSnapshot() - Cannot open " + filename);
+        }
+        registry_.addSnapshot(&file);
+        file.Close();
+    }
+
+    /**
+     * @brief Seal the dynamic ntuples of this Manager (not its shards)
+     * @param serial Checkpoint number
+     * @return Segment files per ntuple name (DynamicHNtuple::checkpoint())
+     */
+    std::map<std::string, std::vector<std::string>> checkpointNtuples(int serial) {
+        std::map<std::string, std::vector<std::string>> segments;
+        for (auto& pair : dynamic_ntuples_) {
+            segments[pair.first] = pair.second->checkpoint(serial);
+        }
+        return segments;
+    }
+
+    /**
+     * @brief Hand checkpoint segments back to the dynamic ntuples
+     */
+    void restoreNtuples(const std::map<std::string, std::vector<std::string>>& segments) {
+        for (const auto& pair : segments) {
+            getDynamicNtuple(pair.first).restoreSegments(pair.second);
+        }
+    }
+
     // ------------------------------------------------------------------------
     // Access to registry
     // ------------------------------------------------------------------------
@@ -143,19 +382,28 @@ public:
 
     /**
      * @brief Create and register 1D histogram
+     * @param storage Dense (TH1F, default), Int32, Double or Sparse
+     * @return Handle for hash-free filling (may be ignored)
      *
      * Example:
      *   manager.create1D("h_theta", "Theta", 100, 0, 180, "angular");
      */
-    void create1D(const std::string& name,
-                  const std::string& title,
-                  int nbins, double xlow, double xup,
-                  const std::string& folder = "",
-                  const std::string& description = "")
+    H1Handle create1D(const std::string& name,
+                      const std::string& title,
+                      int nbins, double xlow, double xup,
+                      const std::string& folder = "",
+                      const std::string& description = "",
+                      HistogramStorage storage = HistogramStorage::Dense)
     {
+        if (storage != HistogramStorage::Dense) {
+            return builderFor(name, title, folder, description, storage)
+                .bins(nbins, xlow, xup)
+                .buildAndRegister1D(registry_);
+        }
         HistogramFactory::createAndRegister1D(
             registry_, name, title, nbins, xlow, xup, folder, description
         );
+        return handle1D(name);
     }
 
     /**
@@ -170,8 +418,17 @@ public:
                        int array_size,
                        int nbins, double xlow, double xup,
                        const std::string& folder = "",
-                       const std::string& description = "")
+                       const std::string& description = "",
+                       HistogramStorage storage = HistogramStorage::Dense)
     {
+        if (storage != HistogramStorage::Dense) {
+            for (int i = 0; i < array_size; ++i) {
+                create1D(basename + "_" + std::to_string(i),
+                         base_title + " [" + std::to_string(i) + "]",
+                         nbins, xlow, xup, folder, description, storage);
+            }
+            return;
+        }
         HistogramFactory::createAndRegister1DArray(
             registry_, basename, base_title, array_size, nbins, xlow, xup, folder, description
         );
@@ -179,21 +436,33 @@ public:
 
     /**
      * @brief Create and register 2D histogram
+     * @return Handle for hash-free filling (may be ignored)
      */
-    void create2D(const std::string& name,
-                  const std::string& title,
-                  int nbinsx, double xlow, double xup,
-                  int nbinsy, double ylow, double yup,
-                  const std::string& folder = "",
-                  const std::string& description = "")
+    H2Handle create2D(const std::string& name,
+                      const std::string& title,
+                      int nbinsx, double xlow, double xup,
+                      int nbinsy, double ylow, double yup,
+                      const std::string& folder = "",
+                      const std::string& description = "",
+                      HistogramStorage storage = HistogramStorage::Dense)
     {
+        if (storage != HistogramStorage::Dense) {
+            return builderFor(name, title, folder, description, storage)
+                .bins(nbinsx, xlow, xup)
+                .binsY(nbinsy, ylow, yup)
+                .buildAndRegister2D(registry_);
+        }
         HistogramFactory::createAndRegister2D(
             registry_, name, title, nbinsx, xlow, xup, nbinsy, ylow, yup, folder, description
         );
+        return handle2D(name);
     }
 
     /**
      * @brief Create and register 2D histogram array
+     *
+     * Large, mostly empty arrays are good candidates for Sparse storage:
+     * memory (per worker shard) then scales with the occupied bins.
      */
     void create2DArray(const std::string& basename,
                        const std::string& base_title,
@@ -201,8 +470,17 @@ public:
                        int nbinsx, double xlow, double xup,
                        int nbinsy, double ylow, double yup,
                        const std::string& folder = "",
-                       const std::string& description = "")
+                       const std::string& description = "",
+                       HistogramStorage storage = HistogramStorage::Dense)
     {
+        if (storage != HistogramStorage::Dense) {
+            for (int i = 0; i < array_size; ++i) {
+                create2D(basename + "_" + std::to_string(i),
+                         base_title + " [" + std::to_string(i) + "]",
+                         nbinsx, xlow, xup, nbinsy, ylow, yup, folder, description, storage);
+            }
+            return;
+        }
         HistogramFactory::createAndRegister2DArray(
             registry_, basename, base_title, array_size,
             nbinsx, xlow, xup, nbinsy, ylow, yup, folder, description
@@ -218,16 +496,26 @@ public:
      *
      * Example:
      *   manager.createNtuple("events", "Event data", "ntuples");
+     *
+     * @param bufsize Branch buffer in bytes (0: OutputOptions::basket_size,
+     *                or 32000 if that is not set)
      */
     void createNtuple(const std::string& name,
                      const std::string& title = "",
                      const std::string& folder = "",
-                     Int_t bufsize = 32000)
+                     Int_t bufsize = 0)
     {
+        if (parent_) {
+            throw std::runtime_error("Manager::createNtuple() - HNtuple is not supported in worker shards, "
+                                   "use createDynamicNtuple()!");
+        }
         if (!file_ || !file_->IsOpen()) {
             throw std::runtime_error("Manager::createNtuple() - No file open! Call openFile() first.");
         }
 
+        if (bufsize <= 0) {
+            bufsize = options_.basket_size > 0 ? options_.basket_size : 32000;
+        }
         auto ntuple = std::make_unique<HNtuple>(name.c_str(), title.c_str(), bufsize);
         ntuple->setFile(file_.get());
 
@@ -258,14 +546,19 @@ public:
      * @param title Title/description
      * @param missing_value Value for variables not set in an event (default: -1)
      * @param keep_intermediate Keep intermediate TTree file (default: false)
+     * @param mode Storage mode: convert (default), memory, tree or rntuple
+     * @param spill_mb Memory mode: spill buffered columns above this size (0 = never)
      * @return Reference to DynamicHNtuple for direct access
      */
     DynamicHNtuple& createDynamicNtuple(const std::string& name,
                                         const std::string& title = "",
                                         Float_t missing_value = -1.0f,
-                                        bool keep_intermediate = false)
+                                        bool keep_intermediate = false,
+                                        DynamicHNtuple::Mode mode = DynamicHNtuple::Mode::Convert,
+                                        size_t spill_mb = 0)
     {
-        if (!file_ || !file_->IsOpen()) {
+        TFile* output = outputFile();
+        if (!output || !output->IsOpen()) {
             throw std::runtime_error("Manager::createDynamicNtuple() - No file open! Call openFile() first.");
         }
 
@@ -277,10 +570,19 @@ public:
         auto ntuple = std::make_unique<DynamicHNtuple>(
             name, 
             title.empty() ? name : title,
-            file_.get(),
+            output,
             missing_value,
-            keep_intermediate
+            keep_intermediate,
+            shard_index_,
+            mode,
+            spill_mb
         );
+        const OutputOptions& options = getOutputOptions();
+        ntuple->setTreeOptions(options.basket_size, options.auto_flush);
+        // RNTuple shards write through the parent's writer (create the parent's first)
+        if (parent_ && mode == DynamicHNtuple::Mode::RNTuple) {
+            ntuple->shareRNTuple(parent_->getDynamicNtuple(name));
+        }
 
         dynamic_ntuples_[name] = std::move(ntuple);
         return *dynamic_ntuples_[name];
@@ -347,9 +649,53 @@ public:
         return registry_.getNtuple(name);
     }
 
+    // ------------------------------------------------------------------------
+    // Handles (resolve once at setup, fill without name lookup)
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Get handle to a 1D histogram
+     *
+     * Example:
+     *   H1Handle h = manager.handle1D("mass_n");
+     *   h.fill(m_n);   // in event loop: direct pointer call
+     */
+    H1Handle handle1D(const std::string& name) {
+        if (SparseHistogram* sparse = registry_.findSparse(name)) {
+            return H1Handle(checkDimension(sparse, 1, "handle1D"));
+        }
+        TH1* hist = registry_.get(name);
+        if (hist->GetDimension() != 1) {
+            throw std::runtime_error("Manager::handle1D() - Histogram '" + name + "' is not 1D!");
+        }
+        return H1Handle(hist, registry_.fillBuffer(name));
+    }
+
+    /**
+     * @brief Get handle to a 2D histogram
+     */
+    H2Handle handle2D(const std::string& name) {
+        if (SparseHistogram* sparse = registry_.findSparse(name)) {
+            return H2Handle(checkDimension(sparse, 2, "handle2D"));
+        }
+        return H2Handle(registry_.getAs<TH2>(name), registry_.fillBuffer(name));
+    }
+
+    /**
+     * @brief Get handle to a 3D histogram
+     */
+    H3Handle handle3D(const std::string& name) {
+        if (SparseHistogram* sparse = registry_.findSparse(name)) {
+            return H3Handle(checkDimension(sparse, 3, "handle3D"));
+        }
+        return H3Handle(registry_.getAs<TH3>(name));
+    }
+
     // ------------------------------------------------------------------------
     // Fill helpers (shorthand for common operations)
     // ------------------------------------------------------------------------
+    // Each call looks the histogram up by name. Fine for setup code and
+    // rare fills; prefer handles (handle1D() etc.) inside the event loop.
 
     /**
      * @brief Fill 1D histogram (shorthand)
@@ -358,21 +704,39 @@ public:
      *   manager.fill("h_theta", 45.0);
      */
     void fill(const std::string& name, double value) {
-        getHistogram(name)->Fill(value);
+        if (TH1* hist = registry_.findDense(name)) {
+            hist->Fill(value);
+        } else if (SparseHistogram* sparse = registry_.findSparse(name)) {
+            sparse->fill(value);
+        } else {
+            getHistogram(name);   // throws "not found"
+        }
     }
 
     /**
      * @brief Fill 2D histogram (shorthand)
      */
     void fill(const std::string& name, double x, double y) {
-        getHistogramAs<TH2>(name)->Fill(x, y);
+        if (TH2* hist = registry_.findDense<TH2>(name)) {
+            hist->Fill(x, y);
+        } else if (SparseHistogram* sparse = registry_.findSparse(name)) {
+            sparse->fill(x, y);
+        } else {
+            getHistogram(name);
+        }
     }
 
     /**
      * @brief Fill 3D histogram (shorthand)
      */
     void fill(const std::string& name, double x, double y, double z) {
-        getHistogramAs<TH3>(name)->Fill(x, y, z);
+        if (TH3* hist = registry_.findDense<TH3>(name)) {
+            hist->Fill(x, y, z);
+        } else if (SparseHistogram* sparse = registry_.findSparse(name)) {
+            sparse->fill(x, y, z);
+        } else {
+            getHistogram(name);
+        }
     }
 
     // ------------------------------------------------------------------------
@@ -407,6 +771,35 @@ public:
         return dynamic_ntuples_.size();
     }
 
+    /**
+     * @brief Entries of every histogram, summed over worker shards
+     *
+     * Call before closeFile() (histograms are handed to the file there).
+     */
+    std::map<std::string, Long64_t> histogramEntries() const {
+        std::map<std::string, Long64_t> entries;
+        for (const auto& name : registry_.listAll()) {
+            entries[name] += registry_.entries(name);
+        }
+        for (const auto& shard : shards_) {
+            for (const auto& pair : shard->histogramEntries()) {
+                entries[pair.first] += pair.second;
+            }
+        }
+        return entries;
+    }
+
+    /**
+     * @brief Names of all dynamic ntuples
+     */
+    std::vector<std::string> listDynamicNtuples() const {
+        std::vector<std::string> names;
+        for (const auto& pair : dynamic_ntuples_) {
+            names.push_back(pair.first);
+        }
+        return names;
+    }
+
     /**
      * @brief Check if histogram exists
      */
@@ -440,14 +833,76 @@ public:
     }
 
 private:
+    // ------------------------------------------------------------------------
+    // Storage helpers
+    // ------------------------------------------------------------------------
+
+    static HistogramBuilder builderFor(const std::string& name, const std::string& title,
+                                       const std::string& folder, const std::string& description,
+                                       HistogramStorage storage) {
+        HistogramBuilder builder;
+        builder.name(name).folder(folder).storage(storage);
+        if (!title.empty()) builder.title(title);
+        // Same default as HistogramRegistry::add(): description = title
+        builder.description(description.empty() ? (title.empty() ? name : title) : description);
+        return builder;
+    }
+
+    static SparseHistogram* checkDimension(SparseHistogram* sparse, int dimension, const char* method) {
+        if (sparse->getDimension() != dimension) {
+            throw std::runtime_error(std::string("Manager::") + method + "() - Histogram '" +
+                                   sparse->getName() + "' is not " + std::to_string(dimension) + "D!");
+        }
+        return sparse;
+    }
+
+    // ------------------------------------------------------------------------
+    // Shard helpers
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Output file (the parent's file for worker shards)
+     */
+    TFile* outputFile() {
+        return parent_ ? parent_->file_.get() : file_.get();
+    }
+
+    /**
+     * @brief Merge and destroy all worker shards, in creation order
+     *
+     * Histograms are merged on OutputOptions::merge_threads threads (each
+     * histogram still adds its shards in creation order); ntuples are
+     * appended serially since they share the output file.
+     */
+    void mergeShards() {
+        std::vector<const HistogramRegistry*> registries;
+        for (const auto& shard : shards_) {
+            registries.push_back(&shard->registry_);
+        }
+        registry_.merge(registries, options_.merge_threads);
+
+        for (auto& shard : shards_) {
+            for (auto& pair : shard->dynamic_ntuples_) {
+                getDynamicNtuple(pair.first).merge(*pair.second);
+            }
+        }
+        shards_.clear();
+    }
+
     // ROOT file for output
     std::unique_ptr<TFile> file_;
+    OutputOptions options_;
 
     // Centralized histogram/ntuple storage
     HistogramRegistry registry_;
 
     // Dynamic ntuples (managed separately due to finalization needs)
     std::map<std::string, std::unique_ptr<DynamicHNtuple>> dynamic_ntuples_;
+
+    // Worker shards (owned by the parent, merged at closeFile())
+    Manager* parent_ = nullptr;
+    int shard_index_ = -1;
+    std::vector<std::unique_ptr<Manager>> shards_;
 };
 
 #endif // MANAGER_H
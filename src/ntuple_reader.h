@@ -5,8 +5,26 @@
  * Provides flexible reading of ROOT TTrees/TNtuples with:
  * - Lazy branch binding (bind on first access)
  * - Named variable access via operator[]
- * - Support for TChain (multiple files)
- * - Automatic type handling for Float_t branches
+ * - Index-free slot access (stable pointers resolved once before the loop)
+ * - Array branches (Float_t[n] with a counter leaf, or vector<float>) as
+ *   per-event views for multi-candidate events
+ * - Optional variables with presence cached per file of a chain
+ * - Required-variable validation per file: files lacking them are
+ *   reported and skipped by the caller, no per-event exceptions
+ * - Block (columnar) reading with ROOT bulk I/O and unbound branches disabled
+ * - Local column cache: bound variables written once as uncompressed
+ *   column files, mmapped by later passes
+ * - TTreeCache on bound branches and read-ahead of the next chain files
+ * - Support for TChain (multiple files), optionally built from a cached
+ *   dataset index without opening every file
+ * - Entry lists (skims): iterate only the entries that passed a selection
+ * - Automatic type handling for Float_t branches; other scalar types
+ *   (Double_t, Int_t, Short_t, ...) bound in their native type via get<T>()
+ * - Generated input structs (./ana --schema) bound member by member,
+ *   checked against the tree in one go
+ * - Cheap re-opening of the same input for worker threads
+ * - RNTuple input ("input.format": "rntuple") behind the same API for
+ *   Float_t variables (rntuple_backend.h)
  *
  * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
  * @date 2025
@@ -18,14 +36,183 @@
 #include <TFile.h>
 #include <TTree.h>
 #include <TChain.h>
+#include <TChainElement.h>
+#include <TTreeCache.h>
 #include <TLeaf.h>
+#include <TBranch.h>
+#include <TBufferFile.h>
+#include <TMath.h>
+#include <RVersion.h>
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,20,0)
+#include <TBulkBranchRead.h>
+#endif
 #include <string>
 #include <map>
 #include <vector>
 #include <memory>
 #include <stdexcept>
 #include <iostream>
+#include <iomanip>
 #include <fstream>
+#include <algorithm>
+#include <type_traits>
+
+#include "file_prefetcher.h"
+#include "entry_list.h"
+#include "dataset_index.h"
+#include "column_cache.h"
+#include "rntuple_backend.h"
+
+// ============================================================================
+// OptionalSlot: handle to a variable that may be missing in some input files
+// ============================================================================
+/**
+ * @class OptionalSlot
+ * @brief Stable view of an optional variable and its presence flag
+ *
+ * Obtained once from NTupleReader::optionalSlot(). The presence flag is
+ * refreshed by the reader whenever a chain moves to the next file, so
+ * checking it per event costs a single load - no leaf lookup.
+ */
+class OptionalSlot {
+public:
+    OptionalSlot() = default;
+    OptionalSlot(const Float_t* value, const char* present)
+        : value_(value), present_(present) {}
+    
+    /// True if the variable exists in the file of the current entry
+    bool present() const { return present_ && *present_; }
+    
+    /// Current value (0 when not present)
+    Float_t value() const { return *value_; }
+    
+    /// Current value, or 'fallback' when the variable is not present
+    Float_t valueOr(Float_t fallback) const { return present() ? *value_ : fallback; }
+    
+    explicit operator bool() const { return present(); }
+
+private:
+    const Float_t* value_ = nullptr;
+    const char* present_ = nullptr;
+};
+
+// ============================================================================
+// InputSchema: handle to a set of variables the analysis cannot do without
+// ============================================================================
+/**
+ * @class InputSchema
+ * @brief Stable view of "the current file has all required variables"
+ *
+ * Obtained once from NTupleReader::requireVariables(). Like OptionalSlot,
+ * the flag is refreshed when a chain moves to the next file, so events
+ * of an incomplete file are skipped with one load per event instead of
+ * failing (and throwing) inside the analysis.
+ */
+class InputSchema {
+public:
+    InputSchema() = default;
+    explicit InputSchema(const char* complete) : complete_(complete) {}
+    
+    /// True if the file of the current entry has every required variable
+    bool complete() const { return !complete_ || *complete_; }
+    
+    explicit operator bool() const { return complete(); }
+
+private:
+    const char* complete_ = nullptr;
+};
+
+/**
+ * @struct SchemaIssue
+ * @brief Input file that lacks required variables
+ */
+struct SchemaIssue {
+    std::string file;
+    std::vector<std::string> missing;
+};
+
+// ============================================================================
+// ArraySlot: handle to a variable-length array branch
+// ============================================================================
+/**
+ * @struct ArrayView
+ * @brief Values of an array branch in the current entry
+ */
+struct ArrayView {
+    const Float_t* data = nullptr;
+    size_t size = 0;
+};
+
+/**
+ * @class ArraySlot
+ * @brief Stable view of an array branch (tracks of one species per event)
+ *
+ * Obtained once from NTupleReader::arraySlot(); data and length follow
+ * every getEntry(). Values are valid until the next getEntry().
+ */
+class ArraySlot {
+public:
+    ArraySlot() = default;
+    explicit ArraySlot(const ArrayView* view) : view_(view) {}
+    
+    size_t size() const { return view_ ? view_->size : 0; }
+    bool empty() const { return size() == 0; }
+    const Float_t* data() const { return view_ ? view_->data : nullptr; }
+    Float_t operator[](size_t i) const { return view_->data[i]; }
+    
+    const Float_t* begin() const { return data(); }
+    const Float_t* end() const { return data() + size(); }
+    
+    bool valid() const { return view_ != nullptr; }
+    explicit operator bool() const { return valid(); }
+
+private:
+    const ArrayView* view_ = nullptr;
+};
+
+// ============================================================================
+// NativeType: ROOT leaf type of the scalar types read without conversion
+// ============================================================================
+/**
+ * @struct NativeType
+ * @brief Leaf type name (TLeaf::GetTypeName) a C++ type is bound to
+ *
+ * Only these types are accepted by NTupleReader::get<T>() and
+ * typedSlot<T>(); others fail to compile.
+ */
+template <typename T> struct NativeType;
+template <> struct NativeType<Double_t>  { static constexpr const char* name = "Double_t"; };
+template <> struct NativeType<Float_t>   { static constexpr const char* name = "Float_t"; };
+template <> struct NativeType<Long64_t>  { static constexpr const char* name = "Long64_t"; };
+template <> struct NativeType<ULong64_t> { static constexpr const char* name = "ULong64_t"; };
+template <> struct NativeType<Int_t>     { static constexpr const char* name = "Int_t"; };
+template <> struct NativeType<UInt_t>    { static constexpr const char* name = "UInt_t"; };
+template <> struct NativeType<Short_t>   { static constexpr const char* name = "Short_t"; };
+template <> struct NativeType<UShort_t>  { static constexpr const char* name = "UShort_t"; };
+template <> struct NativeType<Char_t>    { static constexpr const char* name = "Char_t"; };
+template <> struct NativeType<UChar_t>   { static constexpr const char* name = "UChar_t"; };
+template <> struct NativeType<Bool_t>    { static constexpr const char* name = "Bool_t"; };
+
+// ============================================================================
+// StructField: Member of a Generated Input Struct
+// ============================================================================
+/**
+ * @struct StructField
+ * @brief Branch name and leaf type of one member (constexpr metadata)
+ */
+struct StructField {
+    const char* name;      ///< Leaf name in the tree
+    const char* type;      ///< Leaf type name (NativeType<T>::name)
+};
+
+/**
+ * @struct StructBinding
+ * @brief A member of a generated struct and where ROOT reads it into
+ */
+struct StructBinding {
+    StructField field;
+    void* address;
+};
 
 // ============================================================================
 // NTupleReader: Reflection-based input ntuple reader
@@ -48,6 +235,65 @@
  *       // ...
  *   }
  * @endcode
+ *
+ * Fast path for event loops - resolve names once, then dereference:
+ * @code
+ *   const Float_t* p_p = reader.slot("p_p");
+ *   OptionalSlot weight = reader.optionalSlot("weight");
+ *
+ *   for (Long64_t i = 0; i < reader.entries(); ++i) {
+ *       reader.getEntry(i);
+ *       double p = *p_p;
+ *       double w = weight.valueOr(1.0);
+ *   }
+ * @endcode
+ *
+ * All bound values live in one contiguous buffer sized to the number of
+ * leaves of the tree, so slot pointers never move while the input is open.
+ *
+ * Block mode - read N events per branch at once, same slots afterwards:
+ * @code
+ *   reader.setBlockMode(4096);           // after binding the variables
+ *   for (Long64_t i = 0; i < reader.entries(); ++i) {
+ *       reader.getEntry(i);              // served from the loaded block
+ *       double p = *p_p;
+ *   }
+ *   // Or process whole columns: reader.loadBlock(i); reader.blockColumn("p_p")
+ * @endcode
+ *
+ * Other scalar types - bound in their on-disk type, no conversion:
+ * @code
+ *   const Int_t* trigger = reader.typedSlot<Int_t>("trigger");
+ *   const Double_t* e_true = reader.typedSlot<Double_t>("e_true");
+ *   reader.getEntry(i);
+ *   cuts.passTriggerCut(trigger_id, *trigger);
+ *   double e = reader.get<Double_t>("e_true");   // same value, with a name lookup
+ * @endcode
+ *
+ * Array branches - all tracks of a species per event:
+ * @code
+ *   ArraySlot p_p = reader.arraySlot("p_p");     // Float_t p_p[n_p] or vector<float>
+ *   for (Long64_t i = 0; i < reader.entries(); ++i) {
+ *       reader.getEntry(i);
+ *       for (size_t k = 0; k < p_p.size(); ++k) use(p_p[k]);
+ *   }
+ * @endcode
+ *
+ * RNTuple input - same names, slots and loop, in RNTuple's columnar format:
+ * @code
+ *   reader.setFormat(NTupleReader::Format::RNTuple);   // before opening
+ *   reader.openChain({"file1.root", "file2.root"}, "PPip_ID");
+ * @endcode
+ * Float_t (float) fields only; typed, array and struct binding, block mode
+ * and the column cache need TTree input.
+ *
+ * Entry list - the same loop visits only the listed entries:
+ * @code
+ *   reader.setEntryList(EntryList::read("skim.root", reader.inputFiles(), "PPip_ID"));
+ *   for (Long64_t i = 0; i < reader.entries(); ++i) {
+ *       reader.getEntry(i);              // i-th listed entry
+ *   }
+ * @endcode
  */
 class NTupleReader {
 public:
@@ -58,7 +304,8 @@ public:
     NTupleReader() = default;
     
     ~NTupleReader() {
-        // Smart pointers handle cleanup
+        // Smart pointers handle cleanup; the tree must not keep the entry list
+        releaseEntryList();
     }
     
     // Disable copy
@@ -75,6 +322,12 @@ public:
      * @param treename Name of TTree/TNtuple to read
      */
     void open(const std::string& filename, const std::string& treename) {
+        if (format_ == Format::RNTuple) {
+            openRNTuple(std::vector<std::string>{filename}, treename);
+            return;
+        }
+        releaseEntryList();
+        rntuple_.reset();
         file_ = std::make_unique<TFile>(filename.c_str(), "READ");
         if (!file_ || file_->IsZombie()) {
             throw std::runtime_error("NTupleReader::open() - Cannot open file: " + filename);
@@ -87,7 +340,9 @@ public:
         }
         
         treename_ = treename;
+        filename_ = filename;
         is_chain_ = false;
+        allocateSlots();
         std::cout << "NTupleReader: Opened '" << treename << "' from " << filename 
                   << " (" << tree_->GetEntries() << " entries)\n";
     }
@@ -98,6 +353,12 @@ public:
      * @param treename Name of TTree/TNtuple to read
      */
     void openChain(const std::vector<std::string>& filenames, const std::string& treename) {
+        if (format_ == Format::RNTuple) {
+            openRNTuple(filenames, treename);
+            return;
+        }
+        releaseEntryList();
+        rntuple_.reset();
         chain_ = std::make_unique<TChain>(treename.c_str());
         
         for (const auto& fname : filenames) {
@@ -107,16 +368,34 @@ public:
             }
         }
         
-        if (chain_->GetEntries() == 0) {
-            throw std::runtime_error("NTupleReader::openChain() - Chain is empty!");
+        finishChain(treename, filenames.size(), {});
+    }
+    
+    /**
+     * @brief Open a chain of indexed files without counting their entries
+     * @param index Index updated for the files (DatasetIndex::update())
+     *
+     * Every file is added with its known entries, so TChain opens a file
+     * only when an entry of it is loaded. Empty files are left out.
+     */
+    void openChain(const DatasetIndex& index, const std::string& treename) {
+        if (format_ == Format::RNTuple) {
+            throw std::runtime_error("NTupleReader::openChain() - The dataset index describes TTrees; "
+                                   "open RNTuple input from the file list");
         }
+        releaseEntryList();
+        rntuple_.reset();
+        chain_ = std::make_unique<TChain>(treename.c_str());
         
-        tree_ = chain_.get();
-        treename_ = treename;
-        is_chain_ = true;
-        
-        std::cout << "NTupleReader: Opened chain '" << treename << "' with " 
-                  << filenames.size() << " files (" << tree_->GetEntries() << " entries)\n";
+        std::vector<Long64_t> clusters;
+        Long64_t first = 0;
+        for (const DatasetFileInfo& f : index.files()) {
+            if (f.entries <= 0) continue;
+            chain_->Add(f.file.c_str(), f.entries);
+            for (Long64_t start : f.clusters) clusters.push_back(first + start);
+            first += f.entries;
+        }
+        finishChain(treename, index.files().size(), std::move(clusters));
     }
     
     /**
@@ -124,12 +403,42 @@ public:
      * @param listfile Path to file containing list of ROOT files
      * @param treename Name of TTree/TNtuple to read
      * 
-     * Supports multiple formats:
+     * Supports multiple formats (see readFileList()):
      * - Plain file paths (one per line)
      * - ROOT code format: chain->Add("/path/to/file.root");
      * - Comments starting with # or //
+     *
+     * @param index_file Dataset index to use and keep up to date ("" = none:
+     *                   every file is opened to count its entries)
      */
-    void openFromList(const std::string& listfile, const std::string& treename) {
+    void openFromList(const std::string& listfile, const std::string& treename,
+                      const std::string& index_file = "") {
+        std::vector<std::string> files = readFileList(listfile);
+        std::cout << "NTupleReader: Found " << files.size() << " files in " << listfile << "\n";
+        if (index_file.empty() || format_ == Format::RNTuple) {
+            if (!index_file.empty()) {
+                std::cerr << "Warning: Dataset index " << index_file << " not used for RNTuple input\n";
+            }
+            openChain(files, treename);
+            return;
+        }
+        
+        DatasetIndex index = DatasetIndex::load(index_file);
+        int scanned = index.update(files, treename);
+        try {
+            index.save(index_file);
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: " << e.what() << " (index not saved)\n";
+        }
+        std::cout << "NTupleReader: Index " << index_file << ": " << index.files().size() << " files, "
+                  << scanned << " scanned\n";
+        openChain(index, treename);
+    }
+    
+    /**
+     * @brief File paths of a list file, without opening the files
+     */
+    static std::vector<std::string> readFileList(const std::string& listfile) {
         std::ifstream ifs(listfile);
         if (!ifs) {
             throw std::runtime_error("NTupleReader::openFromList() - Cannot open list file: " + listfile);
@@ -173,9 +482,86 @@ public:
         if (files.empty()) {
             throw std::runtime_error("NTupleReader::openFromList() - No files in list: " + listfile);
         }
+        return files;
+    }
+    
+    /**
+     * @brief Open the same input as another reader
+     * @param other Reader that is already open
+     *
+     * Used to give each worker thread its own reader. For chains the entry
+     * counts already known by 'other' are passed to TChain::Add(), so the
+     * files are not opened again just to count entries. An entry list of
+     * 'other' is taken over, and so is its input format.
+     */
+    void openLike(const NTupleReader& other) {
+        if (!other.tree_ && !other.rntuple_) {
+            throw std::runtime_error("NTupleReader::openLike() - Source reader has no tree loaded!");
+        }
         
-        std::cout << "NTupleReader: Found " << files.size() << " files in " << listfile << "\n";
-        openChain(files, treename);
+        format_ = other.format_;
+        if (other.rntuple_) {
+            releaseEntryList();
+            adoptRNTuple(std::make_unique<RNTupleSource>(other.inputFiles(), other.treename_), other.treename_);
+            if (other.has_entry_list_) setEntryList(other.entry_list_);
+            return;
+        }
+        
+        if (!other.is_chain_) {
+            open(other.filename_, other.treename_);
+            if (other.has_entry_list_) setEntryList(other.entry_list_);
+            return;
+        }
+        
+        releaseEntryList();
+        rntuple_.reset();
+        chain_ = std::make_unique<TChain>(other.treename_.c_str());
+        TObjArray* elements = other.chain_->GetListOfFiles();
+        for (int i = 0; i < elements->GetEntries(); ++i) {
+            TChainElement* element = dynamic_cast<TChainElement*>(elements->At(i));
+            if (!element || element->GetEntries() <= 0) continue;
+            chain_->Add(element->GetTitle(), element->GetEntries());
+        }
+        
+        tree_ = chain_.get();
+        treename_ = other.treename_;
+        is_chain_ = true;
+        allocateSlots();
+        cluster_starts_ = other.cluster_starts_;
+        if (other.has_entry_list_) setEntryList(other.entry_list_);
+    }
+    
+    /// Storage format of the input
+    enum class Format { TTree, RNTuple };
+    
+    /**
+     * @brief Format from its config name ("ttree" or "rntuple")
+     */
+    static Format parseFormat(const std::string& name) {
+        if (name == "ttree" || name == "tree") return Format::TTree;
+        if (name == "rntuple") return Format::RNTuple;
+        throw std::runtime_error("NTupleReader::parseFormat() - Unknown input format '" + name +
+                               "' (use ttree or rntuple)");
+    }
+    
+    /**
+     * @brief Format the next open*() call reads (default TTree)
+     */
+    void setFormat(Format format) { format_ = format; }
+    Format format() const { return format_; }
+    
+    /**
+     * @brief Open RNTuples, one file after the other
+     * @param filenames Files holding an RNTuple called 'name'
+     *
+     * What open()/openChain() do when setFormat(Format::RNTuple) is set.
+     * Every file is opened once to count its entries.
+     */
+    void openRNTuple(const std::vector<std::string>& filenames, const std::string& name) {
+        releaseEntryList();
+        adoptRNTuple(std::make_unique<RNTupleSource>(filenames, name), name);
+        std::cout << "NTupleReader: Opened RNTuple '" << name << "' with " << filenames.size()
+                  << " files (" << rntuple_->entries() << " entries)\n";
     }
     
     // ========================================================================
@@ -183,187 +569,1446 @@ public:
     // ========================================================================
     
     /**
-     * @brief Get total number of entries
+     * @brief Get total number of entries (listed entries with an entry list)
      */
     Long64_t entries() const {
-        if (!tree_) {
+        if (!tree_ && !rntuple_) {
             throw std::runtime_error("NTupleReader::entries() - No tree loaded!");
         }
-        return tree_->GetEntries();
+        return has_entry_list_ ? entry_list_.size() : treeEntries();
     }
     
     /**
      * @brief Load specific entry
-     * @param entry Entry number to load
+     * @param entry Entry number to load (position in the entry list, if set)
      * @return Bytes read (0 if error)
      */
     Int_t getEntry(Long64_t entry) {
-        if (!tree_) {
+        if (!tree_ && !rntuple_) {
             throw std::runtime_error("NTupleReader::getEntry() - No tree loaded!");
         }
-        current_entry_ = entry;
-        return tree_->GetEntry(entry);
+        if (has_entry_list_) {
+            if (entry < 0 || entry >= entry_list_.size()) return 0;
+            entry = entry_list_.entries()[entry];
+        }
+        return readTreeEntry(entry);
     }
     
     /**
-     * @brief Get current entry number
+     * @brief Get current entry number (tree/chain numbering, also with an
+     *        entry list)
      */
     Long64_t currentEntry() const {
         return current_entry_;
     }
     
+    /**
+     * @brief Counter advanced by every getEntry() call
+     *
+     * Per-event caches (EventCache) compare it to detect a new event,
+     * also when the same entry number is loaded again.
+     */
+    Long64_t readSerial() const {
+        return read_serial_;
+    }
+    
     // ========================================================================
-    // Variable Access (Reflection)
+    // Entry List (Skim Index)
     // ========================================================================
     
     /**
-     * @brief Access variable by name (lazy binding)
-     * @param varname Name of branch/leaf
-     * @return Reference to Float_t value
+     * @brief Files of the input with their first global entry
      *
-     * On first access, automatically binds the branch.
-     * Subsequent accesses use cached address.
+     * The numbering EntryList uses to store entries per file.
      */
-    Float_t& operator[](const std::string& varname) {
-        auto it = branch_values_.find(varname);
-        if (it != branch_values_.end()) {
-            return it->second;
+    std::vector<InputSegment> inputFiles() const {
+        std::vector<InputSegment> inputs;
+        if (rntuple_) return rntuple_->inputFiles();
+        if (!tree_) return inputs;
+        if (!is_chain_) {
+            inputs.push_back(InputSegment{filename_, 0, tree_->GetEntries()});
+            return inputs;
         }
         
-        // Lazy binding - bind branch on first access
-        return bindBranch(varname);
-    }
-    
-    /**
-     * @brief Const access to variable
-     */
-    const Float_t& operator[](const std::string& varname) const {
-        auto it = branch_values_.find(varname);
-        if (it == branch_values_.end()) {
-            throw std::runtime_error("NTupleReader::operator[] const - Variable '" + 
-                                   varname + "' not bound (use non-const access first)");
+        Long64_t first = 0;
+        TObjArray* elements = chain_->GetListOfFiles();
+        for (int i = 0; elements && i < elements->GetEntries(); ++i) {
+            TChainElement* element = dynamic_cast<TChainElement*>(elements->At(i));
+            if (!element) continue;
+            inputs.push_back(InputSegment{element->GetTitle(), first, element->GetEntries()});
+            first += element->GetEntries();
         }
-        return it->second;
+        return inputs;
     }
     
     /**
-     * @brief Check if variable exists in tree
+     * @brief First entry of every cluster (chain numbering)
+     *
+     * Known for chains opened from a dataset index and after
+     * loadClusterStarts(); empty otherwise.
      */
-    bool hasVariable(const std::string& varname) const {
-        if (!tree_) return false;
-        return tree_->GetLeaf(varname.c_str()) != nullptr;
-    }
+    const std::vector<Long64_t>& clusterStarts() const { return cluster_starts_; }
     
     /**
-     * @brief Get list of all branch names
+     * @brief Read the cluster boundaries from the trees (unless already known)
+     *
+     * Opens every file of a chain once to walk its cluster iterator, so
+     * prefer a dataset index for long lists of remote files. RNTuples are
+     * left without cluster starts.
      */
-    std::vector<std::string> listVariables() const {
-        std::vector<std::string> names;
-        if (!tree_) return names;
+    void loadClusterStarts() {
+        if (!cluster_starts_.empty() || !tree_ || rntuple_) return;
         
-        TObjArray* leaves = tree_->GetListOfLeaves();
-        for (int i = 0; i < leaves->GetEntries(); ++i) {
-            TLeaf* leaf = dynamic_cast<TLeaf*>(leaves->At(i));
-            if (leaf) {
-                names.push_back(leaf->GetName());
+        std::vector<Long64_t> starts;
+        for (const auto& input : inputFiles()) {
+            TTree* tree = tree_;
+            if (is_chain_) {
+                if (input.entries <= 0 || chain_->LoadTree(input.first) < 0) continue;
+                tree = chain_->GetTree();
+            }
+            TTree::TClusterIterator clusters = tree->GetClusterIterator(0);
+            Long64_t start;
+            while ((start = clusters()) < input.entries) {
+                starts.push_back(input.first + start);
             }
         }
-        return names;
+        
+        // Back to the file the reader was in
+        if (is_chain_) chain_->LoadTree(current_entry_ >= 0 ? current_entry_ : 0);
+        cluster_starts_ = std::move(starts);
     }
     
     /**
-     * @brief Pre-bind multiple variables (for performance)
-     * @param varnames List of variable names to bind
+     * @brief Iterate only the listed entries
+     * @param list Global entries of this input (EntryList::read())
+     *
+     * entries() and getEntry() then count positions in the list, so entry
+     * ranges, worker threads and start/max_events work on the selected
+     * events. The list is also set on the tree, which lets TTreeCache skip
+     * clusters without listed entries; in block mode each block starts at
+     * the next listed entry and entries sharing its baskets are served
+     * from the loaded columns.
      */
-    void bindVariables(const std::vector<std::string>& varnames) {
-        for (const auto& var : varnames) {
-            bindBranch(var);
+    void setEntryList(const EntryList& list) {
+        if (!tree_ && !rntuple_) {
+            throw std::runtime_error("NTupleReader::setEntryList() - No tree loaded!");
+        }
+        if (!list.empty() && list.entries().back() >= treeEntries()) {
+            throw std::runtime_error("NTupleReader::setEntryList() - Entry " +
+                                   std::to_string(list.entries().back()) + " is beyond the input (" +
+                                   std::to_string(treeEntries()) + " entries)");
         }
+        
+        releaseEntryList();
+        entry_list_ = list;
+        has_entry_list_ = true;
+        if (tree_) {
+            tree_list_ = entry_list_.toTEntryList(inputFiles(), treename_);
+            tree_->SetEntryList(tree_list_.get());
+        }
+        block_first_ = -1;
+        block_entries_ = 0;
     }
     
-    // ========================================================================
-    // Accessors
-    // ========================================================================
-    
-    TTree* getTree() { return tree_; }
-    const TTree* getTree() const { return tree_; }
-    const std::string& getTreeName() const { return treename_; }
-    bool isChain() const { return is_chain_; }
-    
     /**
-     * @brief Get number of bound variables
+     * @brief Back to iterating all entries
      */
-    size_t boundVariableCount() const {
-        return branch_values_.size();
+    void clearEntryList() {
+        releaseEntryList();
+        entry_list_.clear();
+        has_entry_list_ = false;
     }
     
-    /**
-     * @brief Print summary of reader state
-     */
-    void printSummary(std::ostream& os = std::cout) const {
-        os << "NTupleReader Summary:\n";
-        os << "  Tree: " << treename_ << "\n";
-        os << "  Type: " << (is_chain_ ? "TChain" : "TTree") << "\n";
-        os << "  Entries: " << (tree_ ? tree_->GetEntries() : 0) << "\n";
-        os << "  Bound variables: " << branch_values_.size() << "\n";
-        if (!branch_values_.empty()) {
-            os << "  Variables:\n";
-            for (const auto& pair : branch_values_) {
-                os << "    - " << pair.first << " = " << pair.second << "\n";
-            }
-        }
+    bool hasEntryList() const { return has_entry_list_; }
+    
+    /// Entries of the tree/chain, independent of an entry list
+    Long64_t treeEntries() const {
+        if (rntuple_) return rntuple_->entries();
+        return tree_ ? tree_->GetEntries() : 0;
     }
-
-private:
+    
     // ========================================================================
-    // Private Methods
+    // Block (Columnar) Reading
     // ========================================================================
     
     /**
-     * @brief Bind branch to internal storage
+     * @brief Switch to block reading
+     * @param block_size Events per block (0 = back to entry-by-entry reading)
+     *
+     * Bound Float_t branches are read a basket at a time with ROOT bulk I/O
+     * (TBulkBranchRead) into per-variable columns; branches without bulk
+     * support fall back to TBranch::GetEntry per event, still branch by
+     * branch. Unbound branches are disabled. Blocks never cross the file
+     * boundary of a chain. getEntry() and slots keep working unchanged.
      */
-    Float_t& bindBranch(const std::string& varname) {
-        if (!tree_) {
-            throw std::runtime_error("NTupleReader::bindBranch() - No tree loaded!");
+    void setBlockMode(Long64_t block_size) {
+        if (block_size > 0) requireTree("setBlockMode");
+        if (block_size > 0 && !arrays_.empty()) {
+            throw std::runtime_error("NTupleReader::setBlockMode() - Array branches ('" + arrays_.front()->name +
+                                     "') are read entry by entry; block mode needs scalar variables only");
+        }
+        if (block_size > 0 && !struct_branches_.empty()) {
+            throw std::runtime_error("NTupleReader::setBlockMode() - Variable '" + struct_branches_.front() +
+                                     "' is bound to an input struct and read entry by entry; "
+                                     "block mode needs slots only");
         }
+        if (block_size > 0 && !typed_.empty()) {
+            throw std::runtime_error("NTupleReader::setBlockMode() - " + typed_.front()->type + " variable '" +
+                                     typed_.front()->name + "' is read entry by entry; block mode needs Float_t only");
+        }
+        block_size_ = std::max<Long64_t>(block_size, 0);
+        block_columns_.assign(block_size_ > 0 ? slot_values_.size() * block_size_ : 0, 0.0f);
+        block_views_.assign(slot_values_.size(), nullptr);
+        column_cache_.reset();
+        cached_columns_.assign(slot_values_.size(), nullptr);
+        block_first_ = -1;
+        block_entries_ = 0;
         
-        // Check if branch exists
-        TBranch* branch = tree_->GetBranch(varname.c_str());
-        if (!branch) {
-            // Try leaf (for TNtuple with combined branches)
-            TLeaf* leaf = tree_->GetLeaf(varname.c_str());
-            if (!leaf) {
-                throw std::runtime_error("NTupleReader::bindBranch() - Variable '" + 
-                                       varname + "' not found in tree '" + treename_ + "'");
+        if (block_size_ > 0) {
+            disableUnboundBranches();
+            if (!bulk_buffer_) {
+                bulk_buffer_ = std::make_unique<TBufferFile>(TBuffer::kWrite, 32 * 1024);
             }
         }
+    }
+    
+    Long64_t blockSize() const { return block_size_; }
+    bool isBlockMode() const { return block_size_ > 0; }
+    
+    /**
+     * @brief Read the block starting at 'entry' into the column buffers
+     * @return Number of events in the block (0 if entry is out of range)
+     */
+    Long64_t loadBlock(Long64_t entry) {
+        if (block_size_ <= 0) {
+            throw std::runtime_error("NTupleReader::loadBlock() - Block mode not enabled!");
+        }
         
-        // Create storage and bind
-        branch_values_[varname] = 0.0f;
-        tree_->SetBranchAddress(varname.c_str(), &branch_values_[varname]);
+        block_first_ = -1;
+        block_entries_ = 0;
         
-        // Re-read current entry to get value
-        if (current_entry_ >= 0) {
-            tree_->GetEntry(current_entry_);
+        // A new file may bind variables absent so far (markBound() drops the
+        // block), so the block is only set once its columns are read
+        Long64_t local = tree_->LoadTree(entry);
+        if (local < 0) return 0;
+        if (is_chain_ && chain_->GetTreeNumber() != tree_number_ && watchesFiles()) {
+            onFileChange();
         }
         
-        return branch_values_[varname];
-    }
-    
-    // ========================================================================
-    // Data Members
-    // ========================================================================
-    
-    std::unique_ptr<TFile> file_;
+        // Work on the TTree of the current file, so the block ends with it
+        TTree* tree = tree_->GetTree();
+        Long64_t n = std::min(block_size_, tree->GetEntries() - local);
+        if (n <= 0) return 0;
+        
+        for (size_t idx : bound_list_) {
+            Float_t* column = &block_columns_[idx * block_size_];
+            block_views_[idx] = column;
+            if (!slot_present_[idx] || (!file_usable_ && !building_cache_)) {
+                std::fill(column, column + n, 0.0f);
+                continue;
+            }
+            if (cached_columns_[idx]) {
+                // Zero-copy: the block is a window of the mapped column
+                block_views_[idx] = cached_columns_[idx] + entry;
+                continue;
+            }
+            
+            TBranch* branch = tree->GetBranch(slot_names_[idx].c_str());
+            if (!branch) {
+                TLeaf* leaf = tree->GetLeaf(slot_names_[idx].c_str());
+                branch = leaf ? leaf->GetBranch() : nullptr;
+            }
+            if (!branch) {
+                throw std::runtime_error("NTupleReader::loadBlock() - Branch '" + slot_names_[idx] +
+                                       "' not found in " + currentFileName());
+            }
+            
+            if (!readBulkColumn(branch, local, n, column)) {
+                // Fallback: entry-wise, but only this branch is read
+                for (Long64_t row = 0; row < n; ++row) {
+                    branch->GetEntry(local + row);
+                    column[row] = slot_values_[idx];
+                }
+            }
+        }
+        
+        block_first_ = entry;
+        block_entries_ = n;
+        return n;
+    }
+    
+    /// First entry (global) of the loaded block
+    Long64_t blockFirst() const { return block_first_; }
+    
+    /// Number of events in the loaded block
+    Long64_t blockEntries() const { return block_entries_; }
+    
+    /**
+     * @brief Column of a bound variable in the loaded block
+     * @return Pointer to blockEntries() contiguous values
+     */
+    const Float_t* blockColumn(const std::string& varname) const {
+        auto it = slot_index_.find(varname);
+        if (it == slot_index_.end() || block_size_ <= 0) {
+            throw std::runtime_error("NTupleReader::blockColumn() - Variable '" + varname +
+                                   "' not bound or block mode not enabled");
+        }
+        const Float_t* view = block_views_[it->second];
+        return view ? view : &block_columns_[it->second * block_size_];
+    }
+    
+    /**
+     * @brief Serve the bound variables from a local column cache
+     * @param dir Cache directory (see ColumnCache)
+     * @param max_bytes Size limit of the directory (0 = none)
+     * @return true if blocks are now served from the cache
+     *
+     * Call in block mode, after binding. Without an entry for this input
+     * and these variables the cache is built first: the whole input is
+     * read once, block by block, and written as column files. Later passes
+     * (and the worker threads of this one, via openLike()) map the entry,
+     * and loadBlock() points the columns into the mapping instead of
+     * reading baskets. ROOT still opens each file when the loop reaches
+     * it, so optional and required variables are checked per file as
+     * before. Variables bound afterwards are read from ROOT.
+     */
+    bool setColumnCache(const std::string& dir, Long64_t max_bytes = 0) {
+        if (block_size_ <= 0) {
+            throw std::runtime_error("NTupleReader::setColumnCache() - Needs block mode (setBlockMode())");
+        }
+        column_cache_.reset();
+        cached_columns_.assign(slot_values_.size(), nullptr);
+        block_first_ = -1;
+        block_entries_ = 0;
+        
+        // loadBlock() can bind variables that appear in later files: the
+        // cache holds the ones bound now, later ones are read from ROOT
+        const std::vector<size_t> cached_slots = bound_list_;
+        std::vector<std::string> names;
+        for (size_t idx : cached_slots) names.push_back(slot_names_[idx]);
+        if (names.empty()) return false;
+        
+        auto cache = std::make_unique<ColumnCache>(dir, max_bytes);
+        if (!cache->open(treename_, inputFiles(), names)) {
+            if (!cache->beginWrite()) return false;
+            std::cout << "NTupleReader: Building column cache " << cache->path() << " ("
+                      << names.size() << " variables, " << cache->entries() << " entries)...\n";
+            building_cache_ = true;
+            try {
+                for (Long64_t entry = 0; entry < cache->entries(); ) {
+                    Long64_t n = loadBlock(entry);
+                    if (n <= 0) {
+                        throw std::runtime_error("NTupleReader::setColumnCache() - Cannot read entry " +
+                                               std::to_string(entry) + " of " + currentFileName());
+                    }
+                    for (size_t k = 0; k < cached_slots.size(); ++k) {
+                        cache->append(k, block_views_[cached_slots[k]], n);
+                    }
+                    entry += n;
+                }
+                building_cache_ = false;
+                cache->commit();
+            } catch (...) {
+                building_cache_ = false;
+                cache->abort();
+                throw;
+            }
+            block_first_ = -1;
+            block_entries_ = 0;
+        }
+        
+        for (size_t k = 0; k < cached_slots.size(); ++k) {
+            cached_columns_[cached_slots[k]] = cache->column(k);
+        }
+        std::cout << "NTupleReader: Column cache " << cache->path() << " ("
+                  << cache->bytes() / (1024 * 1024) << " MB mapped)\n";
+        column_cache_ = std::move(cache);
+        return true;
+    }
+    
+    /// True if blocks are served from a column cache
+    bool hasColumnCache() const { return column_cache_ != nullptr; }
+    
+    // ========================================================================
+    // Read Cache & Prefetch
+    // ========================================================================
+    
+    /**
+     * @brief Enable TTreeCache restricted to the bound branches
+     * @param bytes Cache size in bytes
+     *
+     * Call after binding; branches bound later are added automatically.
+     * The learning phase is skipped since the branch set is known. No-op
+     * for RNTuple input, which reads only the bound fields' pages anyway.
+     */
+    void setReadCache(Long64_t bytes) {
+        if (rntuple_) return;
+        if (!tree_) {
+            throw std::runtime_error("NTupleReader::setReadCache() - No tree loaded!");
+        }
+        tree_->SetCacheSize(bytes);
+        for (size_t idx : bound_list_) {
+            tree_->AddBranchToCache(slot_names_[idx].c_str(), true);
+        }
+        cache_enabled_ = true;
+        for (const auto& column : arrays_) {
+            enableArrayBranches(*column);
+        }
+        for (const auto& column : typed_) {
+            enableBranch(column->name);
+        }
+        for (const auto& name : struct_branches_) {
+            enableBranch(name);
+        }
+        tree_->StopCacheLearningPhase();
+    }
+    
+    /**
+     * @brief Read the next files of the chain ahead in a background thread
+     * @param depth Number of files to keep warmed ahead of the current one
+     *
+     * No-op for single-file input. See FilePrefetcher.
+     */
+    void enablePrefetch(int depth) {
+        if (depth <= 0) return;
+        
+        std::vector<std::string> files;
+        for (const InputSegment& input : inputFiles()) files.push_back(input.file);
+        if (files.size() < 2) return;
+        
+        prefetcher_ = std::make_unique<FilePrefetcher>(std::move(files), depth);
+        tree_number_ = -1;  // Report the starting file on the first read
+    }
+    
+    const FilePrefetcher* prefetcher() const { return prefetcher_.get(); }
+    
+    /**
+     * @brief Disable reading of all branches that are not bound
+     *
+     * Branches bound later are re-enabled automatically.
+     */
+    void disableUnboundBranches() {
+        if (!tree_) return;
+        tree_->SetBranchStatus("*", false);
+        for (size_t idx : bound_list_) {
+            tree_->SetBranchStatus(slot_names_[idx].c_str(), true);
+        }
+        unbound_disabled_ = true;
+        for (const auto& column : arrays_) {
+            enableArrayBranches(*column);
+        }
+        for (const auto& column : typed_) {
+            enableBranch(column->name);
+        }
+        for (const auto& name : struct_branches_) {
+            enableBranch(name);
+        }
+    }
+    
+    // ========================================================================
+    // Variable Access (Reflection)
+    // ========================================================================
+    
+    /**
+     * @brief Access variable by name (lazy binding)
+     * @param varname Name of branch/leaf
+     * @return Reference to Float_t value
+     *
+     * On first access, automatically binds the branch.
+     * Subsequent accesses use cached address.
+     */
+    Float_t& operator[](const std::string& varname) {
+        auto it = slot_index_.find(varname);
+        if (it != slot_index_.end()) {
+            return slot_values_[it->second];
+        }
+        
+        // Lazy binding - bind branch on first access
+        return slot_values_[bindBranch(varname)];
+    }
+    
+    /**
+     * @brief Const access to variable
+     */
+    const Float_t& operator[](const std::string& varname) const {
+        auto it = slot_index_.find(varname);
+        if (it == slot_index_.end()) {
+            throw std::runtime_error("NTupleReader::operator[] const - Variable '" + 
+                                   varname + "' not bound (use non-const access first)");
+        }
+        return slot_values_[it->second];
+    }
+    
+    /**
+     * @brief Resolve a required variable to a stable value pointer
+     * @param varname Name of branch/leaf
+     * @return Pointer into the reader's value buffer, updated by getEntry()
+     *
+     * Binds the branch if needed. Call once before the event loop and
+     * dereference per event; the pointer stays valid until the reader is
+     * re-opened or destroyed.
+     */
+    const Float_t* slot(const std::string& varname) {
+        auto it = slot_index_.find(varname);
+        size_t idx = (it != slot_index_.end()) ? it->second : bindBranch(varname);
+        return &slot_values_[idx];
+    }
+    
+    /**
+     * @brief Resolve a variable that may be missing in (some) input files
+     * @param varname Name of branch/leaf
+     * @return Handle with value pointer and cached presence flag
+     *
+     * Never throws for a missing variable. For chains, presence is
+     * re-checked once per file, not once per event.
+     */
+    OptionalSlot optionalSlot(const std::string& varname) {
+        auto it = slot_index_.find(varname);
+        size_t idx;
+        if (it != slot_index_.end()) {
+            idx = it->second;
+        } else if (hasVariable(varname)) {
+            idx = bindBranch(varname);
+        } else {
+            idx = reserveSlot(varname);
+        }
+        
+        if (std::find(optional_slots_.begin(), optional_slots_.end(), varname) == optional_slots_.end()) {
+            optional_slots_.push_back(varname);
+        }
+        refreshFileSlots();
+        return OptionalSlot(&slot_values_[idx], &slot_present_[idx]);
+    }
+    
+    /**
+     * @brief Resolve a scalar variable in its on-disk type to a stable pointer
+     * @tparam T C++ type matching the leaf type (Double_t, Int_t, Short_t, ...)
+     * @return Pointer into typed storage that ROOT reads into, updated by getEntry()
+     *
+     * Throws if the variable is missing, is an array, or is stored with
+     * another type (the message names the type to use). Float_t goes
+     * through slot(), so it also works in block mode; other types are
+     * read entry by entry and are not available in block mode.
+     */
+    template <typename T>
+    const T* typedSlot(const std::string& varname) {
+        if constexpr (std::is_same_v<T, Float_t>) {
+            return slot(varname);
+        } else {
+            // A union and its members share one address
+            return reinterpret_cast<const T*>(&bindTyped(varname, NativeType<T>::name)->value);
+        }
+    }
+    
+    /**
+     * @brief Value of a variable in its native type (binds on first access)
+     *
+     * Looks the name up on every call - inside the event loop prefer
+     * typedSlot().
+     */
+    template <typename T>
+    T get(const std::string& varname) {
+        return *typedSlot<T>(varname);
+    }
+    
+    /**
+     * @brief Bind the members of a generated input struct (schema_generator.h)
+     * @param struct_name Name of the struct, for messages
+     * @param fields Leaf name, expected type and address of every member
+     *
+     * All members are checked against the current tree first: missing,
+     * array or of another type, or already bound through slot() or
+     * typedSlot(). If any fails, nothing is bound and the error lists
+     * every mismatch - the struct is out of date, regenerate it. ROOT then
+     * reads straight into the struct. Not available in block mode.
+     */
+    void bindStruct(const std::string& struct_name, const std::vector<StructBinding>& fields) {
+        requireTree("bindStruct");
+        if (block_size_ > 0) {
+            throw std::runtime_error("NTupleReader::bindStruct() - " + struct_name +
+                                   " cannot be read in block mode");
+        }
+        
+        std::vector<std::string> problems;
+        for (const StructBinding& b : fields) {
+            std::string name = b.field.name;
+            TLeaf* leaf = tree_->GetLeaf(name.c_str());
+            if (!leaf) {
+                problems.push_back(name + ": not in the tree");
+            } else if (leaf->GetLeafCount() || leaf->GetLenStatic() != 1) {
+                problems.push_back(name + ": is an array in the tree");
+            } else if (std::string(leaf->GetTypeName()) != b.field.type) {
+                problems.push_back(name + ": " + b.field.type + " in the struct, " +
+                                   leaf->GetTypeName() + " in the tree");
+            } else if (slot_index_.count(name) || typed_index_.count(name) ||
+                       std::find(struct_branches_.begin(), struct_branches_.end(), name) != struct_branches_.end()) {
+                problems.push_back(name + ": already bound");
+            }
+        }
+        if (!problems.empty()) {
+            std::string msg = "NTupleReader::bindStruct() - " + struct_name + " does not match tree '" +
+                              treename_ + "' of " + currentFileName() + " (regenerate it with make schema):";
+            for (const auto& p : problems) msg += "\n  " + p;
+            throw std::runtime_error(msg);
+        }
+        
+        for (const StructBinding& b : fields) {
+            tree_->SetBranchAddress(b.field.name, b.address);
+            enableBranch(b.field.name);
+            struct_branches_.push_back(b.field.name);
+        }
+        if (current_entry_ >= 0) {
+            readTreeEntry(current_entry_);
+        }
+    }
+    
+    /**
+     * @brief Resolve an array branch to a per-event view
+     * @param varname Float_t array leaf ("p_p[n_p]/F", fixed or with a
+     *        counter leaf) or vector<float> branch
+     * @return View whose data and size follow getEntry()
+     *
+     * Throws if the branch is missing or of another type. The buffer of a
+     * Float_t array is sized to the largest counter value of the file and
+     * grows when a later file of a chain holds longer arrays. Not
+     * available in block mode.
+     */
+    ArraySlot arraySlot(const std::string& varname) {
+        requireTree("arraySlot");
+        if (block_size_ > 0) {
+            throw std::runtime_error("NTupleReader::arraySlot() - Array '" + varname +
+                                   "' cannot be read in block mode");
+        }
+        for (const auto& column : arrays_) {
+            if (column->name == varname) return ArraySlot(&column->view);
+        }
+        
+        TBranch* branch = tree_->GetBranch(varname.c_str());
+        TLeaf* leaf = tree_->GetLeaf(varname.c_str());
+        if (!branch && leaf) branch = leaf->GetBranch();
+        if (!branch) {
+            throw std::runtime_error("NTupleReader::arraySlot() - Variable '" + varname +
+                                   "' not found in tree '" + treename_ + "'");
+        }
+        
+        auto column = std::make_unique<ArrayColumn>();
+        column->name = varname;
+        if (std::string(branch->GetClassName()) == "vector<float>") {
+            column->address = &column->values;
+            tree_->SetBranchAddress(varname.c_str(), &column->address);
+        } else if (leaf && std::string(leaf->GetTypeName()) == "Float_t") {
+            if (TLeaf* count = leaf->GetLeafCount()) {
+                column->count_branch = count->GetBranch() ? count->GetBranch()->GetName() : count->GetName();
+            }
+            sizeArrayBuffer(*column);
+        } else {
+            throw std::runtime_error("NTupleReader::arraySlot() - Variable '" + varname +
+                                   "' is neither a Float_t array nor a vector<float>");
+        }
+        enableArrayBranches(*column);
+        arrays_.push_back(std::move(column));
+        
+        if (current_entry_ >= 0) {
+            readTreeEntry(current_entry_);
+        }
+        return ArraySlot(&arrays_.back()->view);
+    }
+    
+    /**
+     * @brief Declare variables the analysis cannot run without
+     * @param varnames Branch/leaf names
+     * @return Handle telling per event whether its file has all of them
+     *
+     * Validated now against the current file and again whenever a chain
+     * moves to the next file. Missing variables still get a slot (reading
+     * 0), so slot() works on them; files lacking any are listed in
+     * schemaIssues(). When no declared set is complete in a file, its
+     * entries are not read at all. Throws for single-file input missing a
+     * variable, since no entry could be analysed.
+     */
+    InputSchema requireVariables(const std::vector<std::string>& varnames) {
+        if (!tree_ && !rntuple_) {
+            throw std::runtime_error("NTupleReader::requireVariables() - No tree loaded!");
+        }
+        
+        auto schema = std::make_unique<Schema>();
+        for (const auto& name : varnames) {
+            auto it = slot_index_.find(name);
+            size_t idx;
+            if (it != slot_index_.end()) {
+                idx = it->second;
+            } else if (hasVariable(name)) {
+                idx = bindBranch(name);
+            } else {
+                idx = reserveSlot(name);
+            }
+            if (std::find(schema->slots.begin(), schema->slots.end(), idx) == schema->slots.end()) {
+                schema->slots.push_back(idx);
+            }
+            if (std::find(required_slots_.begin(), required_slots_.end(), idx) == required_slots_.end()) {
+                required_slots_.push_back(idx);
+            }
+        }
+        schemas_.push_back(std::move(schema));
+        refreshFileSlots();
+        
+        bool single_file = rntuple_ ? rntuple_->inputFiles().size() == 1 : !is_chain_;
+        if (single_file && !schemas_.back()->complete) {
+            std::string missing;
+            for (size_t idx : schemas_.back()->slots) {
+                if (!slot_present_[idx]) missing += (missing.empty() ? "" : ", ") + slot_names_[idx];
+            }
+            throw std::runtime_error("NTupleReader::requireVariables() - Not in tree '" + treename_ +
+                                   "' of " + currentFileName() + ": " + missing);
+        }
+        return InputSchema(&schemas_.back()->complete);
+    }
+    
+    /**
+     * @brief Files seen so far that lack required variables
+     */
+    const std::vector<SchemaIssue>& schemaIssues() const { return schema_issues_; }
+    
+    /**
+     * @brief Add issues of another reader (e.g. a worker), one per file
+     */
+    static void mergeSchemaIssues(std::vector<SchemaIssue>& into, const std::vector<SchemaIssue>& from) {
+        for (const SchemaIssue& issue : from) {
+            auto it = std::find_if(into.begin(), into.end(),
+                                   [&](const SchemaIssue& own) { return own.file == issue.file; });
+            if (it == into.end()) {
+                into.push_back(issue);
+                continue;
+            }
+            for (const auto& name : issue.missing) {
+                if (std::find(it->missing.begin(), it->missing.end(), name) == it->missing.end()) {
+                    it->missing.push_back(name);
+                }
+            }
+        }
+    }
+    
+    /**
+     * @brief Print the files lacking required variables (nothing if none)
+     */
+    static void printSchemaIssues(const std::vector<SchemaIssue>& issues, std::ostream& os = std::cout) {
+        if (issues.empty()) return;
+        auto fit = [](const std::string& text) {
+            return text.size() <= 62 ? text : "..." + text.substr(text.size() - 59);
+        };
+        os << "\n";
+        os << "╔════════════════════════════════════════════════════════════════╗\n";
+        os << "║                 INPUT FILES MISSING VARIABLES                  ║\n";
+        os << "╠════════════════════════════════════════════════════════════════╣\n";
+        for (const SchemaIssue& issue : issues) {
+            std::string missing;
+            for (const auto& name : issue.missing) missing += (missing.empty() ? "" : ", ") + name;
+            os << "║ " << std::left << std::setw(62) << fit(issue.file) << " ║\n";
+            os << "║ " << std::left << std::setw(62) << fit("  missing: " + missing) << " ║\n";
+        }
+        os << "╚════════════════════════════════════════════════════════════════╝\n";
+        os << "Events of these files were skipped (see the cut flow).\n";
+    }
+    
+    /**
+     * @brief Check if variable exists in tree
+     *
+     * Performs a leaf lookup - inside the event loop prefer optionalSlot().
+     */
+    bool hasVariable(const std::string& varname) const {
+        if (rntuple_) return rntuple_->hasField(varname);
+        if (!tree_) return false;
+        return tree_->GetLeaf(varname.c_str()) != nullptr;
+    }
+    
+    /**
+     * @brief Get list of all branch names
+     */
+    std::vector<std::string> listVariables() const {
+        std::vector<std::string> names;
+        if (rntuple_) {
+            for (const auto& field : rntuple_->fields()) names.push_back(field.first);
+            return names;
+        }
+        if (!tree_) return names;
+        
+        TObjArray* leaves = tree_->GetListOfLeaves();
+        for (int i = 0; i < leaves->GetEntries(); ++i) {
+            TLeaf* leaf = dynamic_cast<TLeaf*>(leaves->At(i));
+            if (leaf) {
+                names.push_back(leaf->GetName());
+            }
+        }
+        return names;
+    }
+    
+    /**
+     * @brief Pre-bind multiple variables (for performance)
+     * @param varnames List of variable names to bind
+     */
+    void bindVariables(const std::vector<std::string>& varnames) {
+        for (const auto& var : varnames) {
+            bindBranch(var);
+        }
+    }
+    
+    // ========================================================================
+    // Accessors
+    // ========================================================================
+    
+    TTree* getTree() { return tree_; }
+    const TTree* getTree() const { return tree_; }
+    const std::string& getTreeName() const { return treename_; }
+    bool isChain() const { return is_chain_; }
+    bool isRNTuple() const { return rntuple_ != nullptr; }
+    
+    /**
+     * @brief Get number of bound variables
+     */
+    size_t boundVariableCount() const {
+        return bound_list_.size();
+    }
+    
+    /**
+     * @brief Print summary of reader state
+     */
+    void printSummary(std::ostream& os = std::cout) const {
+        os << "NTupleReader Summary:\n";
+        os << "  Tree: " << treename_ << "\n";
+        os << "  Type: " << (rntuple_ ? "RNTuple" : is_chain_ ? "TChain" : "TTree") << "\n";
+        os << "  Entries: " << treeEntries() << "\n";
+        os << "  Bound variables: " << bound_list_.size() << "\n";
+        if (!slot_index_.empty()) {
+            os << "  Variables:\n";
+            for (const auto& pair : slot_index_) {
+                os << "    - " << pair.first << " = " << slot_values_[pair.second];
+                if (!slot_present_[pair.second]) os << " (not present)";
+                os << "\n";
+            }
+        }
+    }
+
+private:
+    struct ArrayColumn;
+    struct TypedColumn;
+    
+    // ========================================================================
+    // Private Methods
+    // ========================================================================
+    
+    /**
+     * @brief Load an entry in tree/chain numbering (getEntry() without the
+     *        entry-list lookup)
+     */
+    Int_t readTreeEntry(Long64_t entry) {
+        current_entry_ = entry;
+        ++read_serial_;
+        
+        // Block mode: copy the row out of the loaded columns
+        if (block_size_ > 0) {
+            if (entry < block_first_ || entry >= block_first_ + block_entries_) {
+                if (loadBlock(entry) == 0) return 0;
+            }
+            size_t row = static_cast<size_t>(entry - block_first_);
+            for (size_t idx : bound_list_) {
+                slot_values_[idx] = block_views_[idx][row];
+            }
+            return static_cast<Int_t>(bound_list_.size() * sizeof(Float_t));
+        }
+        
+        if (rntuple_) return readRNTupleEntry(entry);
+        
+        // Chains: per-file bookkeeping when the loop crosses a file boundary
+        if (is_chain_ && watchesFiles()) {
+            chain_->LoadTree(entry);
+            if (chain_->GetTreeNumber() != tree_number_) {
+                onFileChange();
+            }
+        }
+        
+        // No declared variable set is complete here: nothing will be analysed
+        if (!file_usable_) {
+            for (auto& column : arrays_) column->view = ArrayView{};
+            return 0;
+        }
+        
+        Int_t bytes = tree_->GetEntry(entry);
+        
+        // Keep absent optional variables at 0, not at the previous file's value
+        for (size_t idx : absent_slots_) {
+            slot_values_[idx] = 0.0f;
+        }
+        if (!arrays_.empty()) {
+            updateArrays();
+        }
+        return bytes;
+    }
+    
+    /**
+     * @brief readTreeEntry() for RNTuple input: the source copies the bound
+     *        fields into their slots
+     */
+    Int_t readRNTupleEntry(Long64_t entry) {
+        rntuple_->load(entry);
+        if (rntuple_->fileIndex() != tree_number_ && watchesFiles()) {
+            onFileChange();
+        }
+        if (!file_usable_) return 0;
+        for (size_t idx : absent_slots_) {
+            slot_values_[idx] = 0.0f;
+        }
+        return static_cast<Int_t>(bound_list_.size() * sizeof(Float_t));
+    }
+    
+    /**
+     * @brief Make an opened RNTuple source the input
+     */
+    void adoptRNTuple(std::unique_ptr<RNTupleSource> source, const std::string& name) {
+        tree_ = nullptr;
+        chain_.reset();
+        file_.reset();
+        rntuple_ = std::move(source);
+        treename_ = name;
+        filename_ = rntuple_->currentFile();
+        is_chain_ = false;
+        allocateSlots();
+    }
+    
+    /**
+     * @brief Refuse TTree-only features for RNTuple input
+     */
+    void requireTree(const char* caller) const {
+        if (rntuple_) {
+            throw std::runtime_error(std::string("NTupleReader::") + caller +
+                                   "() - Not available for RNTuple input (Float_t slots only)");
+        }
+        if (!tree_) {
+            throw std::runtime_error(std::string("NTupleReader::") + caller + "() - No tree loaded!");
+        }
+    }
+    
+    /**
+     * @brief Point the array views at the values of the entry just read
+     */
+    void updateArrays() {
+        for (auto& column : arrays_) {
+            if (column->address) {
+                column->view.data = column->address->data();
+                column->view.size = column->address->size();
+            } else {
+                size_t len = static_cast<size_t>(std::max(column->leaf->GetLen(), 0));
+                column->view.data = column->buffer.data();
+                column->view.size = std::min(len, column->buffer.size());
+            }
+        }
+    }
+    
+    /**
+     * @brief (Re)size the buffer of a Float_t array for the current file
+     *
+     * Capacity is the leaf length times the largest counter value the
+     * file records; the buffer only grows.
+     */
+    void sizeArrayBuffer(ArrayColumn& column) {
+        column.leaf = tree_->GetLeaf(column.name.c_str());
+        if (!column.leaf) {
+            throw std::runtime_error("NTupleReader: Array '" + column.name + "' not found in " +
+                                   currentFileName());
+        }
+        TLeaf* count = column.leaf->GetLeafCount();
+        size_t capacity = static_cast<size_t>(column.leaf->GetLenStatic()) *
+                          static_cast<size_t>(count ? std::max(count->GetMaximum(), 1) : 1);
+        if (capacity > column.buffer.size() || column.buffer.empty()) {
+            column.buffer.assign(std::max<size_t>(capacity, 1), 0.0f);
+        }
+        tree_->SetBranchAddress(column.name.c_str(), column.buffer.data());
+    }
+    
+    /**
+     * @brief Keep an array branch (and its counter) read and cached
+     */
+    void enableArrayBranches(const ArrayColumn& column) {
+        enableBranch(column.name);
+        if (!column.count_branch.empty()) enableBranch(column.count_branch);
+    }
+    
+    /**
+     * @brief Keep a branch bound outside the Float_t slots read and cached
+     */
+    void enableBranch(const std::string& name) {
+        if (unbound_disabled_) tree_->SetBranchStatus(name.c_str(), true);
+        if (cache_enabled_) tree_->AddBranchToCache(name.c_str(), true);
+    }
+    
+    /**
+     * @brief Refuse a second address for a branch read into an input struct
+     */
+    void checkNotInStruct(const std::string& varname, const char* caller) const {
+        if (std::find(struct_branches_.begin(), struct_branches_.end(), varname) != struct_branches_.end()) {
+            throw std::runtime_error(std::string("NTupleReader::") + caller + "() - Variable '" + varname +
+                                   "' is bound to an input struct, read it from there");
+        }
+    }
+    
+    /**
+     * @brief Bind a scalar branch to typed storage (or find the binding)
+     * @param type Expected leaf type name (NativeType<T>::name)
+     */
+    TypedColumn* bindTyped(const std::string& varname, const char* type) {
+        auto it = typed_index_.find(varname);
+        if (it != typed_index_.end()) {
+            TypedColumn* column = typed_[it->second].get();
+            if (column->type != type) {
+                throw std::runtime_error("NTupleReader::typedSlot() - Variable '" + varname + "' is stored as " +
+                                       column->type + ", not " + type);
+            }
+            return column;
+        }
+        
+        requireTree("typedSlot");
+        if (block_size_ > 0) {
+            throw std::runtime_error("NTupleReader::typedSlot() - " + std::string(type) + " variable '" +
+                                   varname + "' cannot be read in block mode");
+        }
+        TLeaf* leaf = tree_->GetLeaf(varname.c_str());
+        if (!leaf) {
+            throw std::runtime_error("NTupleReader::typedSlot() - Variable '" + varname +
+                                   "' not found in tree '" + treename_ + "'");
+        }
+        if (leaf->GetLeafCount() || leaf->GetLenStatic() != 1) {
+            throw std::runtime_error("NTupleReader::typedSlot() - Variable '" + varname +
+                                   "' is an array, use arraySlot()");
+        }
+        std::string native = leaf->GetTypeName();
+        if (native != type) {
+            throw std::runtime_error("NTupleReader::typedSlot() - Variable '" + varname + "' is stored as " +
+                                   native + ", use get<" + native + ">() (not " + type + ")");
+        }
+        
+        checkNotInStruct(varname, "typedSlot");
+        
+        auto column = std::make_unique<TypedColumn>();
+        column->name = varname;
+        column->type = native;
+        tree_->SetBranchAddress(varname.c_str(), &column->value);
+        enableBranch(varname);
+        typed_index_[varname] = typed_.size();
+        typed_.push_back(std::move(column));
+        
+        if (current_entry_ >= 0) {
+            readTreeEntry(current_entry_);
+        }
+        return typed_.back().get();
+    }
+    
+    /**
+     * @brief Common end of openChain(): check, adopt and size the chain
+     */
+    void finishChain(const std::string& treename, size_t n_files, std::vector<Long64_t> clusters) {
+        if (chain_->GetEntries() == 0) {
+            throw std::runtime_error("NTupleReader::openChain() - Chain is empty!");
+        }
+        
+        tree_ = chain_.get();
+        treename_ = treename;
+        is_chain_ = true;
+        allocateSlots();
+        cluster_starts_ = std::move(clusters);
+        
+        std::cout << "NTupleReader: Opened chain '" << treename << "' with " 
+                  << n_files << " files (" << tree_->GetEntries() << " entries)\n";
+    }
+    
+    /**
+     * @brief Detach the entry list from the tree before either goes away
+     */
+    void releaseEntryList() {
+        if (tree_ && tree_list_) tree_->SetEntryList(nullptr);
+        tree_list_.reset();
+    }
+    
+    /**
+     * @brief Size the value buffer for the current tree
+     *
+     * One slot per leaf is the upper bound of what can be bound, so the
+     * buffer is allocated once and never reallocated (ROOT keeps raw
+     * addresses into it).
+     */
+    void allocateSlots() {
+        size_t n_leaves = 0;
+        if (rntuple_) {
+            n_leaves = rntuple_->fields().size();
+        } else if (tree_) {
+            if (is_chain_) chain_->LoadTree(0);
+            TObjArray* leaves = tree_->GetListOfLeaves();
+            if (leaves) n_leaves = static_cast<size_t>(leaves->GetEntries());
+        }
+        
+        slot_index_.clear();
+        slot_names_.clear();
+        bound_list_.clear();
+        optional_slots_.clear();
+        absent_slots_.clear();
+        required_slots_.clear();
+        schemas_.clear();
+        schema_issues_.clear();
+        file_usable_ = true;
+        arrays_.clear();
+        typed_.clear();
+        typed_index_.clear();
+        struct_branches_.clear();
+        // Headroom for optional variables absent from the first file
+        n_leaves += kOptionalSlotHeadroom;
+        
+        slot_values_.assign(n_leaves, 0.0f);
+        slot_present_.assign(n_leaves, 0);
+        slot_bound_.assign(n_leaves, 0);
+        tree_number_ = rntuple_ ? rntuple_->fileIndex() : is_chain_ ? chain_->GetTreeNumber() : 0;
+        current_entry_ = -1;
+        
+        // Re-opened input: block buffers follow the new slot count
+        unbound_disabled_ = false;
+        cache_enabled_ = false;
+        prefetcher_.reset();
+        entry_list_.clear();
+        has_entry_list_ = false;
+        cluster_starts_.clear();
+        if (block_size_ > 0) setBlockMode(block_size_);
+    }
+    
+    /**
+     * @brief Assign the next free buffer slot to a variable name
+     */
+    size_t reserveSlot(const std::string& varname) {
+        size_t idx = slot_index_.size();
+        if (idx >= slot_values_.size()) {
+            throw std::runtime_error("NTupleReader::reserveSlot() - No free slot for '" + varname +
+                                   "' (" + std::to_string(slot_values_.size()) + " slots for tree '" +
+                                   treename_ + "')");
+        }
+        slot_index_[varname] = idx;
+        slot_names_.push_back(varname);
+        return idx;
+    }
+    
+    /**
+     * @brief Record that a slot has its branch address set
+     */
+    void markBound(size_t idx) {
+        slot_bound_[idx] = 1;
+        bound_list_.push_back(idx);
+        if (unbound_disabled_) {
+            tree_->SetBranchStatus(slot_names_[idx].c_str(), true);
+        }
+        if (cache_enabled_) {
+            tree_->AddBranchToCache(slot_names_[idx].c_str(), true);
+        }
+        // New column: the loaded block no longer covers all bound variables
+        block_first_ = -1;
+        block_entries_ = 0;
+    }
+    
+    /**
+     * @brief Read one column of a block with ROOT bulk I/O
+     * @param branch Branch of the current file's TTree
+     * @param local First entry, local to that TTree
+     * @return false if bulk reading is not supported for this branch
+     *
+     * GetBulkEntries() delivers a whole basket starting at the basket's
+     * first entry, so the block is stitched together basket by basket.
+     */
+    bool readBulkColumn(TBranch* branch, Long64_t local, Long64_t n, Float_t* column) {
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,20,0)
+        auto& bulk = branch->GetBulkRead();
+        TLeaf* leaf = branch->GetNleaves() == 1
+                      ? static_cast<TLeaf*>(branch->GetListOfLeaves()->At(0)) : nullptr;
+        if (!leaf || std::string(leaf->GetTypeName()) != "Float_t" || !bulk.SupportsBulkRead()) {
+            return false;
+        }
+        
+        Long64_t row = 0;
+        while (row < n) {
+            Long64_t entry = local + row;
+            Int_t count = bulk.GetBulkEntries(entry, *bulk_buffer_);
+            if (count <= 0) return false;
+            
+            Long64_t basket = TMath::BinarySearch(static_cast<Long64_t>(branch->GetWriteBasket() + 1),
+                                                  branch->GetBasketEntry(), entry);
+            Long64_t offset = entry - branch->GetBasketEntry()[basket];
+            Long64_t take = std::min<Long64_t>(count - offset, n - row);
+            if (take <= 0) return false;
+            
+            const Float_t* values = reinterpret_cast<const Float_t*>(bulk_buffer_->GetCurrent());
+            std::copy(values + offset, values + offset + take, column + row);
+            row += take;
+        }
+        return true;
+#else
+        (void)branch; (void)local; (void)n; (void)column;
+        return false;
+#endif
+    }
+    
+    std::string currentFileName() const {
+        if (rntuple_) return rntuple_->currentFile();
+        TFile* f = tree_ ? tree_->GetCurrentFile() : nullptr;
+        return f ? f->GetName() : filename_;
+    }
+    
+    /// True if getEntry() has to track chain file changes
+    bool watchesFiles() const {
+        return !optional_slots_.empty() || !schemas_.empty() || !arrays_.empty() || prefetcher_;
+    }
+    
+    /**
+     * @brief Called when a chain moves on to the next file
+     */
+    void onFileChange() {
+        tree_number_ = rntuple_ ? rntuple_->fileIndex() : chain_->GetTreeNumber();
+        if (!optional_slots_.empty() || !schemas_.empty()) {
+            refreshFileSlots();
+        }
+        for (auto& column : arrays_) {
+            if (!column->address) sizeArrayBuffer(*column);
+        }
+        if (prefetcher_) {
+            prefetcher_->advanceTo(tree_number_);
+        }
+    }
+    
+    /**
+     * @brief Re-check presence of optional and required variables in the
+     *        current file
+     *
+     * Binds variables that appear for the first time, records the ones
+     * absent in this file so getEntry() can zero them, and updates the
+     * InputSchema flags (and schemaIssues()).
+     */
+    void refreshFileSlots() {
+        absent_slots_.clear();
+        
+        for (const auto& name : optional_slots_) {
+            checkPresence(slot_index_.at(name));
+        }
+        if (schemas_.empty()) return;
+        
+        std::vector<std::string> missing;
+        for (size_t idx : required_slots_) {
+            if (!checkPresence(idx)) missing.push_back(slot_names_[idx]);
+        }
+        
+        file_usable_ = false;
+        for (auto& schema : schemas_) {
+            schema->complete = 1;
+            for (size_t idx : schema->slots) {
+                if (!slot_present_[idx]) schema->complete = 0;
+            }
+            file_usable_ = file_usable_ || schema->complete;
+        }
+        
+        if (!missing.empty()) {
+            mergeSchemaIssues(schema_issues_, {SchemaIssue{currentFileName(), missing}});
+        }
+    }
+    
+    /**
+     * @brief Presence of one slot's variable in the current file
+     *
+     * Binds it on first appearance; an absent one is zeroed and listed in
+     * absent_slots_.
+     */
+    bool checkPresence(size_t idx) {
+        const std::string& name = slot_names_[idx];
+        bool present = hasVariable(name);
+        if (present && !slot_bound_[idx]) {
+            setSlotAddress(idx);
+            markBound(idx);
+        }
+        slot_present_[idx] = present ? 1 : 0;
+        if (!present) {
+            slot_values_[idx] = 0.0f;
+            absent_slots_.push_back(idx);
+        }
+        return present;
+    }
+    
+    /**
+     * @brief Bind branch to internal storage
+     * @return Slot index of the bound variable
+     */
+    size_t bindBranch(const std::string& varname) {
+        if (rntuple_) return bindField(varname);
+        if (!tree_) {
+            throw std::runtime_error("NTupleReader::bindBranch() - No tree loaded!");
+        }
+        
+        // Check if branch exists
+        TBranch* branch = tree_->GetBranch(varname.c_str());
+        if (!branch) {
+            // Try leaf (for TNtuple with combined branches)
+            TLeaf* leaf = tree_->GetLeaf(varname.c_str());
+            if (!leaf) {
+                throw std::runtime_error("NTupleReader::bindBranch() - Variable '" + 
+                                       varname + "' not found in tree '" + treename_ + "'");
+            }
+        }
+        
+        // Float_t slots only: ROOT would refuse the address of another type
+        // and leave the slot at 0
+        TLeaf* leaf = tree_->GetLeaf(varname.c_str());
+        if (leaf && std::string(leaf->GetTypeName()) != "Float_t") {
+            throw std::runtime_error("NTupleReader::bindBranch() - Variable '" + varname + "' is stored as " +
+                                   leaf->GetTypeName() + ", use get<" + leaf->GetTypeName() +
+                                   ">() or typedSlot<" + leaf->GetTypeName() + ">()");
+        }
+        
+        checkNotInStruct(varname, "bindBranch");
+        
+        // Take the next slot of the contiguous buffer and bind
+        size_t idx = reserveSlot(varname);
+        setSlotAddress(idx);
+        slot_present_[idx] = 1;
+        markBound(idx);
+        
+        // Re-read current entry to get value
+        if (current_entry_ >= 0) {
+            readTreeEntry(current_entry_);
+        }
+        
+        return idx;
+    }
+    
+    /**
+     * @brief bindBranch() for RNTuple input (float fields only)
+     */
+    size_t bindField(const std::string& varname) {
+        std::string type = rntuple_->fieldType(varname);
+        if (type.empty()) {
+            throw std::runtime_error("NTupleReader::bindBranch() - Variable '" + varname +
+                                   "' not found in RNTuple '" + treename_ + "'");
+        }
+        if (type != "float") {
+            throw std::runtime_error("NTupleReader::bindBranch() - Variable '" + varname + "' is stored as " +
+                                   type + "; RNTuple input binds float fields only");
+        }
+        
+        size_t idx = reserveSlot(varname);
+        setSlotAddress(idx);
+        slot_present_[idx] = 1;
+        markBound(idx);
+        if (current_entry_ >= 0) {
+            readTreeEntry(current_entry_);
+        }
+        return idx;
+    }
+    
+    /**
+     * @brief Let the input write a slot's variable into its buffer place
+     */
+    void setSlotAddress(size_t idx) {
+        if (rntuple_) {
+            rntuple_->bind(slot_names_[idx], &slot_values_[idx]);
+        } else {
+            tree_->SetBranchAddress(slot_names_[idx].c_str(), &slot_values_[idx]);
+        }
+    }
+    
+    // ========================================================================
+    // Data Members
+    // ========================================================================
+    
+    std::unique_ptr<TFile> file_;
     std::unique_ptr<TChain> chain_;
     TTree* tree_ = nullptr;  // Points to either file's tree or chain
+    std::unique_ptr<RNTupleSource> rntuple_;  // RNTuple input instead of tree_
+    Format format_ = Format::TTree;
     
     std::string treename_;
+    std::string filename_;  // Single-file input (for openLike)
     bool is_chain_ = false;
     Long64_t current_entry_ = -1;
+    Long64_t read_serial_ = 0;
+    
+    static constexpr size_t kOptionalSlotHeadroom = 16;
+    
+    // Storage for branch values: name -> slot index into a contiguous buffer
+    std::map<std::string, size_t> slot_index_;
+    std::vector<Float_t> slot_values_;  // Never reallocated after allocateSlots()
+    std::vector<char> slot_present_;    // 1 if variable exists in current file
+    std::vector<char> slot_bound_;      // 1 once SetBranchAddress was applied
+    std::vector<std::string> slot_names_;
+    std::vector<size_t> bound_list_;    // Bound slot indices, in binding order
+    
+    // Optional variables (presence re-checked per file of a chain)
+    std::vector<std::string> optional_slots_;
+    std::vector<size_t> absent_slots_;
+    Int_t tree_number_ = -1;
+    
+    // Required variable sets (presence re-checked per file of a chain);
+    // heap-allocated so InputSchema keeps a stable pointer to 'complete'
+    struct Schema {
+        std::vector<size_t> slots;
+        char complete = 1;
+    };
+    std::vector<std::unique_ptr<Schema>> schemas_;
+    std::vector<size_t> required_slots_;
+    std::vector<SchemaIssue> schema_issues_;
+    bool file_usable_ = true;           // Some schema complete (or none declared)
+    
+    // Array branches; heap-allocated so ArraySlot and ROOT keep stable addresses
+    struct ArrayColumn {
+        std::string name;
+        std::string count_branch;           // Counter of a Float_t[n] array ("" otherwise)
+        TLeaf* leaf = nullptr;              // Float_t array leaf of the current file
+        std::vector<Float_t> buffer;        // Float_t array: values, sized to the maximum
+        std::vector<float> values;          // vector<float>: the object ROOT reads into
+        std::vector<float>* address = nullptr;  // &values for vector<float>, else nullptr
+        ArrayView view;
+    };
+    std::vector<std::unique_ptr<ArrayColumn>> arrays_;
+    
+    // Scalars in their on-disk type (typedSlot<T>()); ROOT reads straight
+    // into 'value', heap-allocated so its address stays stable
+    union NativeValue {
+        Double_t d; Long64_t l; ULong64_t ul; Int_t i; UInt_t ui;
+        Short_t s; UShort_t us; Char_t c; UChar_t uc; Bool_t b;
+    };
+    struct TypedColumn {
+        std::string name;
+        std::string type;                   // Leaf type name, e.g. "Int_t"
+        NativeValue value{};
+    };
+    std::vector<std::unique_ptr<TypedColumn>> typed_;
+    std::map<std::string, size_t> typed_index_;
+    
+    // Branches read straight into a generated input struct (bindStruct())
+    std::vector<std::string> struct_branches_;
+    
+    // Block mode: column-major buffer, column of slot i at [i * block_size_]
+    Long64_t block_size_ = 0;
+    std::vector<Float_t> block_columns_;
+    std::vector<const Float_t*> block_views_;     // Per slot: own column or cache mapping
+    Long64_t block_first_ = -1;
+    Long64_t block_entries_ = 0;
+    std::unique_ptr<TBufferFile> bulk_buffer_;
+    bool unbound_disabled_ = false;
+    
+    // Column cache: per slot the mapped column (all entries), or nullptr
+    std::unique_ptr<ColumnCache> column_cache_;
+    std::vector<const Float_t*> cached_columns_;
+    bool building_cache_ = false;
+    
+    // Read cache & prefetch
+    bool cache_enabled_ = false;
+    std::unique_ptr<FilePrefetcher> prefetcher_;
+    
+    // Entry list: positions -> tree entries; tree_list_ is set on tree_
+    EntryList entry_list_;
+    bool has_entry_list_ = false;
+    std::unique_ptr<TEntryList> tree_list_;
     
-    // Storage for branch values (reflection map)
-    std::map<std::string, Float_t> branch_values_;
+    // Cluster boundaries from the dataset index (chain numbering)
+    std::vector<Long64_t> cluster_starts_;
 };
 
 #endif // NTUPLE_READER_H
@@ -0,0 +1,295 @@
+/**
+ * @file output_merger.h
+ * @brief Merge the output files of batch jobs into one
+ *
+ * Walks the directory tree of all inputs together and writes one file
+ * with the same layout:
+ * - histograms (any TH1, including the cut_flow counters every job
+ *   writes) are added
+ * - ntuples (TNtuple / TTree of Float_t branches) are appended in input
+ *   order; the merged ntuple has the union of all variables, and
+ *   variables a job never discovered are backfilled with missing_value,
+ *   as DynamicHNtuple does for late-discovered variables
+ * - other objects are copied from the first input that has them
+ *
+ * Unlike hadd, ntuples with different variable sets are merged. RNTuples
+ * (output.ntuple_mode "rntuple") are refused; hadd merges those.
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef OUTPUT_MERGER_H
+#define OUTPUT_MERGER_H
+
+#include <TFile.h>
+#include <TDirectory.h>
+#include <TKey.h>
+#include <TList.h>
+#include <TH1.h>
+#include <TTree.h>
+#include <TNtuple.h>
+#include <TLeaf.h>
+#include <TObjArray.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// OutputMerger: Job Outputs -> One Output File
+// ============================================================================
+/**
+ * @class OutputMerger
+ * @brief Adds histograms and appends ntuples of several output files
+ *
+ * Usage Example:
+ * @code
+ *   OutputMerger merger(config.getMissingValue());
+ *   merger.setCompression(OutputOptions::parseCompression("zstd"));
+ *   merger.merge("output_ppip.root", {"output_ppip.job0.root", "output_ppip.job1.root"});
+ *   merger.printSummary();
+ * @endcode
+ *
+ * All inputs are open at the same time; an ntuple is read one input
+ * after the other, so memory use does not grow with its size.
+ */
+class OutputMerger {
+public:
+    explicit OutputMerger(Float_t missing_value = -1.0f) : missing_value_(missing_value) {}
+
+    /// ROOT compression setting of the merged file (-1 = ROOT default)
+    void setCompression(int setting) { compression_ = setting; }
+
+    /**
+     * @brief Merge the inputs (in the given order) into output (replaced)
+     */
+    void merge(const std::string& output, const std::vector<std::string>& inputs) {
+        if (inputs.empty()) {
+            throw std::runtime_error("OutputMerger::merge() - No input files");
+        }
+        for (const auto& input : inputs) {
+            if (input == output) {
+                throw std::runtime_error("OutputMerger::merge() - Output " + output + " is also an input");
+            }
+        }
+
+        std::vector<std::unique_ptr<TFile>> files;
+        std::vector<TDirectory*> dirs;
+        for (const auto& input : inputs) {
+            files.push_back(std::make_unique<TFile>(input.c_str(), "READ"));
+            if (files.back()->IsZombie()) {
+                throw std::runtime_error("OutputMerger::merge() - Cannot open " + input);
+            }
+            dirs.push_back(files.back().get());
+        }
+
+        TFile out(output.c_str(), "RECREATE");
+        if (out.IsZombie()) {
+            throw std::runtime_error("OutputMerger::merge() - Cannot create " + output);
+        }
+        if (compression_ >= 0) out.SetCompressionSettings(compression_);
+
+        inputs_ = static_cast<int>(inputs.size());
+        histograms_ = 0;
+        ntuples_.clear();
+        mergeDirectory(&out, dirs, "");
+        out.Close();
+
+        for (auto& file : files) file->Close();
+    }
+
+    /**
+     * @brief Print merged objects and ntuple sizes
+     */
+    void printSummary(std::ostream& os = std::cout) const {
+        os << "\n";
+        os << "╔════════════════════════════════════════════════════════════════╗\n";
+        os << "║                         MERGE SUMMARY                          ║\n";
+        os << "╠════════════════════════════════════════════════════════════════╣\n";
+        os << "║ Inputs: " << std::left << std::setw(55) << inputs_ << "║\n";
+        os << "║ Histograms added: " << std::left << std::setw(45) << histograms_ << "║\n";
+        for (const auto& nt : ntuples_) {
+            std::string line = nt.name + ": " + std::to_string(nt.entries) + " entries, " +
+                               std::to_string(nt.variables) + " variables";
+            if (nt.backfilled > 0) line += " (" + std::to_string(nt.backfilled) + " backfilled)";
+            os << "║ " << std::left << std::setw(63) << line << "║\n";
+        }
+        os << "╚════════════════════════════════════════════════════════════════╝\n";
+    }
+
+    /// Merged ntuple: rows, variables and inputs that lacked some variable
+    struct NtupleStats {
+        std::string name;
+        Long64_t entries = 0;
+        size_t variables = 0;
+        int backfilled = 0;
+    };
+
+    const std::vector<NtupleStats>& ntuples() const { return ntuples_; }
+    int histograms() const { return histograms_; }
+
+private:
+    /**
+     * @brief Merge one directory level of all inputs (nullptr = input lacks it)
+     */
+    void mergeDirectory(TDirectory* out, const std::vector<TDirectory*>& ins, const std::string& path) {
+        // Names in order of first appearance; highest key cycle only
+        std::vector<std::string> names;
+        std::set<std::string> seen;
+        for (TDirectory* dir : ins) {
+            if (!dir || !dir->GetListOfKeys()) continue;
+            TIter next(dir->GetListOfKeys());
+            while (TKey* key = static_cast<TKey*>(next())) {
+                if (std::string(key->GetClassName()).find("RNTuple") != std::string::npos) {
+                    throw std::runtime_error("OutputMerger::merge() - '" + std::string(key->GetName()) +
+                                           "' in " + dir->GetName() + " is an RNTuple; merge RNTuple "
+                                           "outputs with hadd");
+                }
+                if (seen.insert(key->GetName()).second) names.push_back(key->GetName());
+            }
+        }
+
+        for (const auto& name : names) {
+            std::vector<TObject*> objects;
+            TObject* first = nullptr;
+            for (TDirectory* dir : ins) {
+                TObject* obj = dir ? dir->Get(name.c_str()) : nullptr;
+                objects.push_back(obj);
+                if (!first) first = obj;
+            }
+            if (!first) continue;
+            std::string full = path.empty() ? name : path + "/" + name;
+
+            if (dynamic_cast<TDirectory*>(first)) {
+                std::vector<TDirectory*> subdirs;
+                for (TObject* obj : objects) subdirs.push_back(dynamic_cast<TDirectory*>(obj));
+                TDirectory* sub = out->mkdir(name.c_str());
+                mergeDirectory(sub, subdirs, full);
+            } else if (dynamic_cast<TTree*>(first)) {
+                std::vector<TTree*> trees;
+                for (TObject* obj : objects) trees.push_back(dynamic_cast<TTree*>(obj));
+                mergeTree(out, name, full, trees);
+            } else if (auto* hist = dynamic_cast<TH1*>(first)) {
+                std::unique_ptr<TH1> sum(static_cast<TH1*>(hist->Clone(name.c_str())));
+                sum->SetDirectory(nullptr);
+                for (TObject* obj : objects) {
+                    auto* other = dynamic_cast<TH1*>(obj);
+                    if (other && other != hist) sum->Add(other);
+                }
+                out->WriteTObject(sum.get(), name.c_str());
+                ++histograms_;
+                // Read copies belong to the input directories; free them now
+                for (TObject* obj : objects) delete obj;
+            } else {
+                out->WriteTObject(first, name.c_str());
+            }
+        }
+    }
+
+    /**
+     * @brief Append the rows of one ntuple from all inputs
+     *
+     * Variables: union over the inputs. When every input lists them in
+     * alphabetical order (DynamicHNtuple), the union is sorted too;
+     * otherwise it keeps the first input's order with new variables
+     * appended. A TNtuple stays a TNtuple.
+     */
+    void mergeTree(TDirectory* out, const std::string& name, const std::string& path,
+                   const std::vector<TTree*>& trees) {
+        std::vector<std::string> vars;
+        std::set<std::string> known;
+        bool sorted = true;
+        bool all_ntuples = true;
+        const TTree* first = nullptr;
+        for (TTree* tree : trees) {
+            if (!tree) continue;
+            if (!first) first = tree;
+            all_ntuples = all_ntuples && dynamic_cast<TNtuple*>(tree);
+            std::vector<std::string> own = floatLeaves(tree, path);
+            sorted = sorted && std::is_sorted(own.begin(), own.end());
+            for (const auto& v : own) {
+                if (known.insert(v).second) vars.push_back(v);
+            }
+        }
+        if (sorted) std::sort(vars.begin(), vars.end());
+
+        std::vector<Float_t> values(vars.size(), missing_value_);
+        out->cd();
+        std::unique_ptr<TTree> merged;
+        if (all_ntuples) {
+            std::string varlist;
+            for (size_t j = 0; j < vars.size(); ++j) varlist += (j ? ":" : "") + vars[j];
+            merged = std::make_unique<TNtuple>(name.c_str(), first->GetTitle(), varlist.c_str());
+        } else {
+            merged = std::make_unique<TTree>(name.c_str(), first->GetTitle());
+            for (size_t j = 0; j < vars.size(); ++j) {
+                merged->Branch(vars[j].c_str(), &values[j], (vars[j] + "/F").c_str());
+            }
+        }
+
+        NtupleStats stats;
+        stats.name = path;
+        stats.variables = vars.size();
+        for (TTree* tree : trees) {
+            if (!tree) continue;
+            bool complete = true;
+            for (size_t j = 0; j < vars.size(); ++j) {
+                values[j] = missing_value_;
+                if (tree->GetBranch(vars[j].c_str())) {
+                    tree->SetBranchAddress(vars[j].c_str(), &values[j]);
+                } else {
+                    complete = false;
+                }
+            }
+            stats.backfilled += !complete;
+
+            Long64_t n = tree->GetEntries();
+            for (Long64_t i = 0; i < n; ++i) {
+                tree->GetEntry(i);
+                if (all_ntuples) {
+                    static_cast<TNtuple*>(merged.get())->Fill(values.data());
+                } else {
+                    merged->Fill();
+                }
+            }
+            stats.entries += n;
+            tree->ResetBranchAddresses();
+        }
+
+        out->cd();
+        merged->Write();
+        merged.reset();
+        ntuples_.push_back(stats);
+    }
+
+    /**
+     * @brief Leaf names of a tree; every leaf must be a scalar Float_t
+     */
+    static std::vector<std::string> floatLeaves(TTree* tree, const std::string& path) {
+        std::vector<std::string> names;
+        TObjArray* leaves = tree->GetListOfLeaves();
+        for (int i = 0; leaves && i < leaves->GetEntries(); ++i) {
+            TLeaf* leaf = static_cast<TLeaf*>(leaves->At(i));
+            if (std::string(leaf->GetTypeName()) != "Float_t" || leaf->GetLen() != 1) {
+                throw std::runtime_error("OutputMerger: " + path + " - leaf '" + leaf->GetName() +
+                                       "' is not a scalar Float_t; merge this tree with hadd");
+            }
+            names.push_back(leaf->GetName());
+        }
+        return names;
+    }
+
+    Float_t missing_value_;
+    int compression_ = -1;
+    int inputs_ = 0;
+    int histograms_ = 0;
+    std::vector<NtupleStats> ntuples_;
+};
+
+#endif // OUTPUT_MERGER_H
@@ -0,0 +1,287 @@
+/**
+ * @file polygon_raster.h
+ * @brief Rasterized point-in-polygon test with exact TCutG semantics
+ *
+ * TCutG::IsInside walks every vertex on every call (a virtual call plus
+ * O(vertices) work). PID banana cuts have hundreds of points and are
+ * applied several times per event, so this dominates the cut stage.
+ *
+ * PolygonRaster precomputes an inside/outside bitmap over the polygon's
+ * bounding box. Cells away from the boundary answer directly; only cells
+ * touched by an edge fall back to the exact crossing test, and then only
+ * over the edges spanning that cell row. Results are identical to
+ * TCutG::IsInside (the same TMath::IsInside arithmetic is used).
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef POLYGON_RASTER_H
+#define POLYGON_RASTER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ============================================================================
+// PolygonRaster: O(1) Point-in-Polygon Lookup
+// ============================================================================
+/**
+ * @class PolygonRaster
+ * @brief Bitmap acceleration of TMath::IsInside for a fixed polygon
+ *
+ * The grid covers the bounding box plus a one-cell margin. Each cell is
+ * classified as outside, inside, or edge. A cell is marked edge when any
+ * polygon edge passes through it or a neighbouring cell, so rounding in the
+ * cell index can never move a point across the boundary. Points outside
+ * the grid are outside the polygon.
+ *
+ * Degenerate polygons (fewer than 3 points, zero-area bounding box) skip
+ * the grid and always use the exact test.
+ *
+ * Usage Example:
+ * @code
+ *   PolygonRaster raster(cutg->GetN(), cutg->GetX(), cutg->GetY());
+ *   bool inside = raster.contains(x, y);          // == cutg->IsInside(x, y)
+ *   raster.contains(xs, ys, n, out);               // batch, out[i] = 0/1
+ * @endcode
+ */
+class PolygonRaster {
+public:
+    static constexpr int kDefaultResolution = 256;
+
+    PolygonRaster() = default;
+
+    PolygonRaster(int n, const double* x, const double* y,
+                  int resolution = kDefaultResolution) {
+        build(n, x, y, resolution);
+    }
+
+    // ========================================================================
+    // Construction
+    // ========================================================================
+
+    /**
+     * @brief (Re)build the raster from polygon vertices
+     * @param n Number of vertices (TCutG::GetN)
+     * @param x,y Vertex coordinates (TCutG::GetX/GetY)
+     * @param resolution Cells per axis (including the margin cells)
+     */
+    void build(int n, const double* x, const double* y,
+               int resolution = kDefaultResolution) {
+        edges_.clear();
+        cells_.clear();
+        row_start_.clear();
+        row_edges_.clear();
+        gridded_ = false;
+        nx_ = ny_ = 0;
+        edge_cells_ = 0;
+
+        // Edge k joins vertex i = k with j = k-1 (j = n-1 for k = 0),
+        // the iteration order of TMath::IsInside
+        for (int i = 0, j = n - 1; i < n; j = i++) {
+            edges_.push_back(Edge{x[i], y[i], x[j], y[j]});
+        }
+        if (n < 3 || resolution < 3) return;
+
+        double xmin = *std::min_element(x, x + n);
+        double xmax = *std::max_element(x, x + n);
+        double ymin = *std::min_element(y, y + n);
+        double ymax = *std::max_element(y, y + n);
+        if (!(xmax > xmin) || !(ymax > ymin)) return;
+
+        nx_ = ny_ = resolution;
+        double w = (xmax - xmin) / (resolution - 2);
+        double h = (ymax - ymin) / (resolution - 2);
+        x0_ = xmin - w;
+        y0_ = ymin - h;
+        x1_ = x0_ + nx_ * w;
+        y1_ = y0_ + ny_ * h;
+        inv_w_ = 1.0 / w;
+        inv_h_ = 1.0 / h;
+
+        markEdges(h);
+        buildRowEdges();
+        fillInterior(w, h);
+        gridded_ = true;
+    }
+
+    // ========================================================================
+    // Queries
+    // ========================================================================
+
+    /**
+     * @brief Point-in-polygon test, identical to TCutG::IsInside
+     */
+    bool contains(double x, double y) const {
+        if (!gridded_) return crossings(edges_.data(), edges_.data() + edges_.size(), x, y);
+
+        // Also rejects NaN, for which IsInside is false as well
+        if (!(x >= x0_ && x < x1_ && y >= y0_ && y < y1_)) return false;
+
+        int ix = std::min(static_cast<int>((x - x0_) * inv_w_), nx_ - 1);
+        int iy = std::min(static_cast<int>((y - y0_) * inv_h_), ny_ - 1);
+        uint8_t cell = cells_[static_cast<size_t>(iy) * nx_ + ix];
+        if (cell != kEdge) return cell == kInside;
+
+        return crossings(row_edges_.data() + row_start_[iy],
+                         row_edges_.data() + row_start_[iy + 1], x, y);
+    }
+
+    /**
+     * @brief Batch test: out[i] = contains(x[i], y[i]) as 0/1
+     */
+    void contains(const double* x, const double* y, size_t n, uint8_t* out) const {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = contains(x[i], y[i]) ? 1 : 0;
+        }
+    }
+
+    /**
+     * @brief Reference test over all edges (TMath::IsInside)
+     */
+    bool exact(double x, double y) const {
+        return crossings(edges_.data(), edges_.data() + edges_.size(), x, y);
+    }
+
+    bool gridded() const { return gridded_; }
+    int resolution() const { return nx_; }
+    size_t vertexCount() const { return edges_.size(); }
+
+    /// Fraction of cells that need the exact fallback
+    double edgeCellFraction() const {
+        return cells_.empty() ? 1.0 : static_cast<double>(edge_cells_) / cells_.size();
+    }
+
+private:
+    enum : uint8_t { kOutside = 0, kInside = 1, kEdge = 2 };
+
+    /// Edge from vertex i to its predecessor j, as seen by TMath::IsInside
+    struct Edge {
+        double xi, yi;
+        double xj, yj;
+    };
+
+    /**
+     * @brief Crossing-number test with the exact TMath::IsInside arithmetic
+     *
+     * Only edges straddling yp contribute, so any superset of those edges
+     * in any order gives the same answer.
+     */
+    static bool crossings(const Edge* begin, const Edge* end, double xp, double yp) {
+        bool odd = false;
+        for (const Edge* e = begin; e != end; ++e) {
+            if ((e->yi < yp && e->yj >= yp) || (e->yj < yp && e->yi >= yp)) {
+                if (e->xi + (yp - e->yi) / (e->yj - e->yi) * (e->xj - e->xi) < xp) {
+                    odd = !odd;
+                }
+            }
+        }
+        return odd;
+    }
+
+    int rowOf(double y) const {
+        return static_cast<int>(std::floor((y - y0_) * inv_h_));
+    }
+
+    int colOf(double x) const {
+        return static_cast<int>(std::floor((x - x0_) * inv_w_));
+    }
+
+    /// Rows [first, last] an edge may influence, padded by one row
+    void rowRange(const Edge& e, int& first, int& last) const {
+        first = std::max(rowOf(std::min(e.yi, e.yj)) - 1, 0);
+        last = std::min(rowOf(std::max(e.yi, e.yj)) + 1, ny_ - 1);
+    }
+
+    /**
+     * @brief Mark every cell an edge passes through, padded by one cell
+     *
+     * Per row, the x-extent of the segment clipped to the row band is
+     * widened by one column on each side.
+     */
+    void markEdges(double h) {
+        cells_.assign(static_cast<size_t>(nx_) * ny_, kOutside);
+
+        for (const Edge& e : edges_) {
+            int r0, r1;
+            rowRange(e, r0, r1);
+            double ylo = std::min(e.yi, e.yj);
+            double yhi = std::max(e.yi, e.yj);
+
+            for (int r = r0; r <= r1; ++r) {
+                double band_lo = std::max(y0_ + r * h, ylo);
+                double band_hi = std::min(y0_ + (r + 1) * h, yhi);
+                double xa, xb;
+                if (band_lo > band_hi || e.yi == e.yj) {
+                    // Padding row or horizontal edge: whole x-extent
+                    xa = e.xi;
+                    xb = e.xj;
+                } else {
+                    double slope = (e.xj - e.xi) / (e.yj - e.yi);
+                    xa = e.xi + (band_lo - e.yi) * slope;
+                    xb = e.xi + (band_hi - e.yi) * slope;
+                }
+                int c0 = std::max(colOf(std::min(xa, xb)) - 1, 0);
+                int c1 = std::min(colOf(std::max(xa, xb)) + 1, nx_ - 1);
+                uint8_t* row = &cells_[static_cast<size_t>(r) * nx_];
+                for (int c = c0; c <= c1; ++c) row[c] = kEdge;
+            }
+        }
+    }
+
+    /// Per-row edge lists (CSR layout) for the exact fallback
+    void buildRowEdges() {
+        row_start_.assign(ny_ + 1, 0);
+        for (const Edge& e : edges_) {
+            int r0, r1;
+            rowRange(e, r0, r1);
+            for (int r = r0; r <= r1; ++r) ++row_start_[r + 1];
+        }
+        for (int r = 0; r < ny_; ++r) row_start_[r + 1] += row_start_[r];
+
+        row_edges_.resize(row_start_[ny_]);
+        std::vector<uint32_t> next(row_start_.begin(), row_start_.end() - 1);
+        for (const Edge& e : edges_) {
+            int r0, r1;
+            rowRange(e, r0, r1);
+            for (int r = r0; r <= r1; ++r) row_edges_[next[r]++] = e;
+        }
+    }
+
+    /**
+     * @brief Classify non-edge cells by the exact test at the cell centre
+     *
+     * No edge comes within a cell of such a cell, so the whole cell shares
+     * the centre's answer.
+     */
+    void fillInterior(double w, double h) {
+        for (int r = 0; r < ny_; ++r) {
+            const Edge* begin = row_edges_.data() + row_start_[r];
+            const Edge* end = row_edges_.data() + row_start_[r + 1];
+            double yc = y0_ + (r + 0.5) * h;
+            uint8_t* row = &cells_[static_cast<size_t>(r) * nx_];
+            for (int c = 0; c < nx_; ++c) {
+                if (row[c] == kEdge) {
+                    ++edge_cells_;
+                    continue;
+                }
+                row[c] = crossings(begin, end, x0_ + (c + 0.5) * w, yc) ? kInside : kOutside;
+            }
+        }
+    }
+
+    std::vector<Edge> edges_;             // all edges, TMath::IsInside order
+    std::vector<uint8_t> cells_;          // ny_ rows of nx_ cells
+    std::vector<uint32_t> row_start_;     // row r edges: [row_start_[r], row_start_[r+1])
+    std::vector<Edge> row_edges_;
+    double x0_ = 0, y0_ = 0, x1_ = 0, y1_ = 0;
+    double inv_w_ = 0, inv_h_ = 0;
+    int nx_ = 0, ny_ = 0;
+    size_t edge_cells_ = 0;
+    bool gridded_ = false;
+};
+
+#endif // POLYGON_RASTER_H
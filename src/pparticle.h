@@ -3,8 +3,11 @@
 
 #include "TLorentzVector.h"
 #include "TVector3.h"
+#include "four_vector.h"
 #include <memory>
 #include <string>
+#include <cstring>
+#include <iostream>
 #include <stdexcept>
 
 // ============================================================================
@@ -50,6 +53,13 @@ enum class MomentumType {
  * - Automatic mass assignment
  * - LAB frame preservation
  *
+ * Internally every representation is a plain FourVector (no TObject) and a
+ * bit mask records which ones are populated, so boosts and sums only touch
+ * the momenta that exist. The name is stored inline (no heap allocation),
+ * which makes PParticle cheap to create, copy and combine per event.
+ * vec()/labFrame() return TLorentzVector copies for ROOT interoperability;
+ * p4()/labP4() give direct access to the kernel in hot loops.
+ *
  * Usage Example:
  * @code
  *   // Create proton from spherical coordinates
@@ -67,6 +77,9 @@ enum class MomentumType {
  */
 class PParticle {
 public:
+    /// Longer names (deep composites) are truncated
+    static constexpr size_t kMaxNameLength = 31;
+
     // ========================================================================
     // Constructors
     // ========================================================================
@@ -76,8 +89,13 @@ public:
      * @param mass Rest mass in MeV/c^2
      * @param name Optional particle name for debugging
      */
-    explicit PParticle(double mass, const std::string& name = "")
-        : mass_(mass), name_(name) {}
+    explicit PParticle(double mass, const char* name = "")
+        : mass_(mass) {
+        setName(name);
+    }
+
+    PParticle(double mass, const std::string& name)
+        : PParticle(mass, name.c_str()) {}
 
     /**
      * @brief Construct from existing TLorentzVector
@@ -85,22 +103,22 @@ public:
      * @param name Optional particle name
      */
     PParticle(const TLorentzVector& p4, const std::string& name = "")
-        : mass_(p4.M()), name_(name) {
-        p4_reconstructed_ = p4;
-        lab_frame_reconstructed_ = p4;
-    }
+        : PParticle(FourVector::fromTLorentzVector(p4), name.c_str()) {}
 
     /**
-     * @brief Copy constructor with deep copy of all momentum representations
+     * @brief Construct from existing FourVector
+     * @param p4 Four-momentum vector
+     * @param name Optional particle name
      */
-    PParticle(const PParticle& other)
-        : mass_(other.mass_), name_(other.name_),
-          p4_reconstructed_(other.p4_reconstructed_),
-          p4_corrected_(other.p4_corrected_),
-          p4_simulated_(other.p4_simulated_),
-          lab_frame_reconstructed_(other.lab_frame_reconstructed_),
-          lab_frame_corrected_(other.lab_frame_corrected_),
-          lab_frame_simulated_(other.lab_frame_simulated_) {}
+    explicit PParticle(const FourVector& p4, const char* name = "")
+        : mass_(p4.m()) {
+        setName(name);
+        assign(MomentumType::RECONSTRUCTED, p4);
+    }
+
+    // Copy is a plain member-wise copy (all members are values)
+    PParticle(const PParticle& other) = default;
+    PParticle& operator=(const PParticle& other) = default;
 
     // ========================================================================
     // Momentum Setters: Spherical Coordinates (p, theta, phi)
@@ -115,8 +133,7 @@ public:
      */
     void setFromSpherical(double p, double theta_deg, double phi_deg,
                          MomentumType type = MomentumType::RECONSTRUCTED) {
-        TVector3 p3 = sphericalToCartesian(p, theta_deg, phi_deg);
-        setFromVector(p3, type);
+        assign(type, FourVector::fromSpherical(p, theta_deg, phi_deg, mass_));
     }
 
     /**
@@ -126,23 +143,7 @@ public:
      */
     void setFromVector(const TVector3& p3,
                       MomentumType type = MomentumType::RECONSTRUCTED) {
-        TLorentzVector p4;
-        p4.SetVectM(p3, mass_);
-
-        switch (type) {
-            case MomentumType::RECONSTRUCTED:
-                p4_reconstructed_ = p4;
-                lab_frame_reconstructed_ = p4;
-                break;
-            case MomentumType::CORRECTED:
-                p4_corrected_ = p4;
-                lab_frame_corrected_ = p4;
-                break;
-            case MomentumType::SIMULATED:
-                p4_simulated_ = p4;
-                lab_frame_simulated_ = p4;
-                break;
-        }
+        setFromCartesian(p3.X(), p3.Y(), p3.Z(), type);
     }
 
     /**
@@ -152,8 +153,7 @@ public:
      */
     void setFromCartesian(double px, double py, double pz,
                          MomentumType type = MomentumType::RECONSTRUCTED) {
-        TVector3 p3(px, py, pz);
-        setFromVector(p3, type);
+        assign(type, FourVector::fromVectM(px, py, pz, mass_));
     }
 
     // ========================================================================
@@ -161,70 +161,80 @@ public:
     // ========================================================================
 
     /**
-     * @brief Get four-momentum for specified type
+     * @brief Get four-momentum kernel for specified type (no copy)
      * @param type Momentum representation to retrieve
-     * @return Const reference to TLorentzVector
-     * @throws std::runtime_error if requested type not set
+     * @return Const reference to FourVector
+     * @throws std::runtime_error if CORRECTED or SIMULATED requested but not set
      */
-    const TLorentzVector& vec(MomentumType type = MomentumType::RECONSTRUCTED) const {
-        switch (type) {
-            case MomentumType::RECONSTRUCTED:
-                return p4_reconstructed_;
-            case MomentumType::CORRECTED:
-                if (p4_corrected_.E() == 0)
-                    throw std::runtime_error("Corrected momentum not set for " + name_);
-                return p4_corrected_;
-            case MomentumType::SIMULATED:
-                if (p4_simulated_.E() == 0)
-                    throw std::runtime_error("Simulated momentum not set for " + name_);
-                return p4_simulated_;
+    const FourVector& p4(MomentumType type = MomentumType::RECONSTRUCTED) const {
+        if (type != MomentumType::RECONSTRUCTED && !has(type)) {
+            throw std::runtime_error(std::string(type == MomentumType::CORRECTED ? "Corrected" : "Simulated") +
+                                     " momentum not set for " + name_);
         }
-        return p4_reconstructed_; // Default fallback
+        return p4_[index(type)];
     }
 
     /**
-     * @brief Get mutable reference to four-momentum
+     * @brief Get mutable four-momentum kernel (marks the type as set)
      * @warning Use sparingly; prefer immutable interface
      */
-    TLorentzVector& vecMutable(MomentumType type = MomentumType::RECONSTRUCTED) {
-        return const_cast<TLorentzVector&>(vec(type));
+    FourVector& p4Mutable(MomentumType type = MomentumType::RECONSTRUCTED) {
+        set_mask_ |= bit(type);
+        return p4_[index(type)];
+    }
+
+    /**
+     * @brief Get LAB frame kernel (before any boosts)
+     */
+    const FourVector& labP4(MomentumType type = MomentumType::RECONSTRUCTED) const {
+        return lab_[index(type)];
+    }
+
+    /**
+     * @brief Get four-momentum for specified type
+     * @param type Momentum representation to retrieve
+     * @return TLorentzVector copy of the current momentum
+     * @throws std::runtime_error if requested type not set
+     */
+    TLorentzVector vec(MomentumType type = MomentumType::RECONSTRUCTED) const {
+        return p4(type).toTLorentzVector();
     }
 
     /**
      * @brief Get LAB frame momentum (before any boosts)
      * @param type Momentum representation to retrieve
-     * @return Const reference to LAB frame TLorentzVector
-     */
-    const TLorentzVector& labFrame(MomentumType type = MomentumType::RECONSTRUCTED) const {
-        switch (type) {
-            case MomentumType::RECONSTRUCTED:
-                return lab_frame_reconstructed_;
-            case MomentumType::CORRECTED:
-                return lab_frame_corrected_;
-            case MomentumType::SIMULATED:
-                return lab_frame_simulated_;
-        }
-        return lab_frame_reconstructed_;
+     * @return TLorentzVector copy of the LAB frame momentum
+     */
+    TLorentzVector labFrame(MomentumType type = MomentumType::RECONSTRUCTED) const {
+        return labP4(type).toTLorentzVector();
     }
 
+    /// True if the given momentum representation has been set
+    bool has(MomentumType type) const { return (set_mask_ & bit(type)) != 0; }
+
     // ========================================================================
     // Reference Frame Transformations
     // ========================================================================
 
     /**
      * @brief Apply Lorentz boost to all momentum representations
-     * @param beta_vector Boost vector (beta_x, beta_y, beta_z)
+     * @param bx, by, bz Boost vector components
      *
      * This boosts ALL momentum types that have been set.
      * LAB frame copies remain unchanged for later reference.
      */
+    void boost(double bx, double by, double bz) {
+        for (int i = 0; i < kTypes; ++i) {
+            if (set_mask_ & (1u << i)) p4_[i].boost(bx, by, bz);
+        }
+    }
+
+    /**
+     * @brief Apply Lorentz boost to all momentum representations
+     * @param beta_vector Boost vector (beta_x, beta_y, beta_z)
+     */
     void boost(const TVector3& beta_vector) {
-        if (p4_reconstructed_.E() != 0)
-            p4_reconstructed_.Boost(beta_vector);
-        if (p4_corrected_.E() != 0)
-            p4_corrected_.Boost(beta_vector);
-        if (p4_simulated_.E() != 0)
-            p4_simulated_.Boost(beta_vector);
+        boost(beta_vector.X(), beta_vector.Y(), beta_vector.Z());
     }
 
     /**
@@ -232,7 +242,7 @@ public:
      * @param beta_z Boost velocity along z-axis [-1, 1]
      */
     void boostZ(double beta_z) {
-        boost(TVector3(0, 0, beta_z));
+        boost(0.0, 0.0, beta_z);
     }
 
     /**
@@ -242,17 +252,17 @@ public:
      */
     void boostToRestFrame(const PParticle& reference_system,
                          MomentumType type = MomentumType::RECONSTRUCTED) {
-        TVector3 boost_vec = -reference_system.vec(type).BoostVector();
-        boost(boost_vec);
+        const FourVector& ref = reference_system.p4(type);
+        boost(-ref.px / ref.e, -ref.py / ref.e, -ref.pz / ref.e);
     }
 
     /**
      * @brief Reset to LAB frame (undo all boosts)
      */
     void resetToLAB() {
-        p4_reconstructed_ = lab_frame_reconstructed_;
-        p4_corrected_ = lab_frame_corrected_;
-        p4_simulated_ = lab_frame_simulated_;
+        for (int i = 0; i < kTypes; ++i) {
+            p4_[i] = lab_[i];
+        }
     }
 
     // ========================================================================
@@ -268,25 +278,16 @@ public:
      * Composite mass is computed from invariant mass.
      */
     PParticle operator+(const PParticle& other) const {
-        TLorentzVector composite_p4 = p4_reconstructed_ + other.p4_reconstructed_;
-        PParticle composite(composite_p4.M(), name_ + "+" + other.name_);
-
-        // Reconstructed
-        composite.p4_reconstructed_ = composite_p4;
-        composite.lab_frame_reconstructed_ = composite_p4;
-
-        // Corrected (if both available)
-        if (p4_corrected_.E() != 0 && other.p4_corrected_.E() != 0) {
-            composite.p4_corrected_ = p4_corrected_ + other.p4_corrected_;
-            composite.lab_frame_corrected_ = composite.p4_corrected_;
+        PParticle composite(p4_[0] + other.p4_[0]);
+        composite.setName(name_, '+', other.name_);
+
+        // Corrected and simulated only if available in both
+        unsigned common = set_mask_ & other.set_mask_;
+        for (int i = 1; i < kTypes; ++i) {
+            if (common & (1u << i)) {
+                composite.assign(static_cast<MomentumType>(i), p4_[i] + other.p4_[i]);
+            }
         }
-
-        // Simulated (if both available)
-        if (p4_simulated_.E() != 0 && other.p4_simulated_.E() != 0) {
-            composite.p4_simulated_ = p4_simulated_ + other.p4_simulated_;
-            composite.lab_frame_simulated_ = composite.p4_simulated_;
-        }
-
         return composite;
     }
 
@@ -294,10 +295,8 @@ public:
      * @brief Subtract four-momentum (for missing mass calculations)
      */
     PParticle operator-(const PParticle& other) const {
-        TLorentzVector diff_p4 = p4_reconstructed_ - other.p4_reconstructed_;
-        PParticle result(diff_p4.M(), name_ + "-" + other.name_);
-        result.p4_reconstructed_ = diff_p4;
-        result.lab_frame_reconstructed_ = diff_p4;
+        PParticle result(p4_[0] - other.p4_[0]);
+        result.setName(name_, '-', other.name_);
         return result;
     }
 
@@ -306,43 +305,43 @@ public:
     // ========================================================================
 
     double mass(MomentumType type = MomentumType::RECONSTRUCTED) const {
-        return vec(type).M();
+        return p4(type).m();
     }
 
     double massGeV(MomentumType type = MomentumType::RECONSTRUCTED) const {
-        return vec(type).M() / 1000.0;
+        return p4(type).m() / 1000.0;
     }
 
     double momentum(MomentumType type = MomentumType::RECONSTRUCTED) const {
-        return vec(type).P();
+        return p4(type).p();
     }
 
     double energy(MomentumType type = MomentumType::RECONSTRUCTED) const {
-        return vec(type).E();
+        return p4(type).e;
     }
 
     double theta(MomentumType type = MomentumType::RECONSTRUCTED) const {
-        return vec(type).Theta() * Physics::R2D;
+        return p4(type).theta() * Physics::R2D;
     }
 
     double phi(MomentumType type = MomentumType::RECONSTRUCTED) const {
-        return vec(type).Phi() * Physics::R2D;
+        return p4(type).phi() * Physics::R2D;
     }
 
     double cosTheta(MomentumType type = MomentumType::RECONSTRUCTED) const {
-        return vec(type).CosTheta();
+        return p4(type).cosTheta();
     }
 
     double rapidity(MomentumType type = MomentumType::RECONSTRUCTED) const {
-        return vec(type).Rapidity();
+        return p4(type).rapidity();
     }
 
     double beta(MomentumType type = MomentumType::RECONSTRUCTED) const {
-        return vec(type).Beta();
+        return p4(type).beta();
     }
 
     TVector3 boostVector(MomentumType type = MomentumType::RECONSTRUCTED) const {
-        return vec(type).BoostVector();
+        return p4(type).boostVector();
     }
 
     // ========================================================================
@@ -357,7 +356,7 @@ public:
      */
     double openingAngle(const PParticle& other,
                        MomentumType type = MomentumType::RECONSTRUCTED) const {
-        return vec(type).Angle(other.vec(type).Vect()) * Physics::R2D;
+        return p4(type).angle(other.p4(type)) * Physics::R2D;
     }
 
     /**
@@ -368,26 +367,32 @@ public:
      */
     double deltaPhi(const PParticle& other,
                    MomentumType type = MomentumType::RECONSTRUCTED) const {
-        double dphi = vec(type).Phi() - other.vec(type).Phi();
+        double dphi = p4(type).phi() - other.p4(type).phi();
         // Wrap to [-pi, pi]
         while (dphi > TMath::Pi()) dphi -= 2*TMath::Pi();
         while (dphi < -TMath::Pi()) dphi += 2*TMath::Pi();
         return dphi * Physics::R2D;
     }
 
-    const std::string& name() const { return name_; }
-    void setName(const std::string& name) { name_ = name; }
+    std::string name() const { return name_; }
+    const char* nameCStr() const { return name_; }
+    void setName(const std::string& name) { setName(name.c_str()); }
+
+    void setName(const char* name) {
+        std::strncpy(name_, name, kMaxNameLength);
+        name_[kMaxNameLength] = '\0';
+    }
 
     /**
      * @brief Print particle information (for debugging)
      */
     void print(MomentumType type = MomentumType::RECONSTRUCTED) const {
-        const TLorentzVector& p4 = vec(type);
+        const FourVector& v = p4(type);
         std::cout << "PParticle: " << name_ << std::endl;
         std::cout << "  Mass: " << mass_ << " MeV/c^2" << std::endl;
         std::cout << "  (E, px, py, pz) = ("
-                  << p4.E() << ", " << p4.Px() << ", "
-                  << p4.Py() << ", " << p4.Pz() << ")" << std::endl;
+                  << v.e << ", " << v.px << ", "
+                  << v.py << ", " << v.pz << ")" << std::endl;
         std::cout << "  (p, theta, phi) = ("
                   << momentum(type) << ", " << theta(type) << ", "
                   << phi(type) << ")" << std::endl;
@@ -398,17 +403,29 @@ private:
     // Internal Helper Methods
     // ========================================================================
 
+    static constexpr int kTypes = 3;
+
+    static int index(MomentumType type) { return static_cast<int>(type); }
+    static unsigned bit(MomentumType type) { return 1u << index(type); }
+
+    /**
+     * @brief Set current and LAB momentum of one representation
+     */
+    void assign(MomentumType type, const FourVector& p4) {
+        p4_[index(type)] = p4;
+        lab_[index(type)] = p4;
+        set_mask_ |= bit(type);
+    }
+
     /**
-     * @brief Convert spherical to Cartesian coordinates
+     * @brief Compose "a<op>b" into the inline name buffer (truncating)
      */
-    static TVector3 sphericalToCartesian(double p, double theta_deg, double phi_deg) {
-        double theta_rad = theta_deg * Physics::D2R;
-        double phi_rad = phi_deg * Physics::D2R;
-        return TVector3(
-            p * sin(theta_rad) * cos(phi_rad),
-            p * sin(theta_rad) * sin(phi_rad),
-            p * cos(theta_rad)
-        );
+    void setName(const char* a, char op, const char* b) {
+        size_t n = 0;
+        for (; *a && n < kMaxNameLength; ++a) name_[n++] = *a;
+        if (n < kMaxNameLength) name_[n++] = op;
+        for (; *b && n < kMaxNameLength; ++b) name_[n++] = *b;
+        name_[n] = '\0';
     }
 
     // ========================================================================
@@ -416,17 +433,12 @@ private:
     // ========================================================================
 
     double mass_;                           ///< Rest mass in MeV/c^2
-    std::string name_;                      ///< Particle identifier
-
-    // Current four-momenta (subject to boosts)
-    TLorentzVector p4_reconstructed_;       ///< Measured momentum
-    TLorentzVector p4_corrected_;           ///< Energy loss corrected
-    TLorentzVector p4_simulated_;           ///< MC truth (if available)
+    char name_[kMaxNameLength + 1];         ///< Particle identifier (inline)
+    unsigned set_mask_ = 0;                 ///< Bit i set: MomentumType i populated
 
-    // LAB frame copies (immune to boosts)
-    TLorentzVector lab_frame_reconstructed_;
-    TLorentzVector lab_frame_corrected_;
-    TLorentzVector lab_frame_simulated_;
+    // Indexed by MomentumType: RECONSTRUCTED, CORRECTED, SIMULATED
+    FourVector p4_[kTypes];                 ///< Current four-momenta (subject to boosts)
+    FourVector lab_[kTypes];                ///< LAB frame copies (immune to boosts)
 };
 
 // ============================================================================
@@ -16,6 +16,7 @@
 #include <sstream>
 #include <csignal>
 #include <atomic>
+#include <memory>
 #include <Rtypes.h>
 
 // ============================================================================
@@ -60,6 +61,46 @@ namespace SignalHandler {
     }
 }
 
+// ============================================================================
+// ProgressCounters: one event counter per worker thread
+// ============================================================================
+
+/**
+ * @brief Per-thread event counters, summed when the progress is shown
+ *
+ * A single std::atomic incremented by every worker puts all threads on
+ * one cache line. Here each worker increments only its own counter, each
+ * on a cache line of its own, and the reporting thread adds them up.
+ *
+ * Usage:
+ *   ProgressCounters counters(n_threads);
+ *   ++counters[t];                       // worker t, once per event
+ *   progress.update(counters);           // main thread
+ */
+class ProgressCounters {
+public:
+    explicit ProgressCounters(size_t n) : n_(n), counters_(new Counter[n]) {}
+    
+    std::atomic<Long64_t>& operator[](size_t i) { return counters_[i].value; }
+    
+    size_t size() const { return n_; }
+    
+    /// Events counted by all threads (may lag behind by events in flight)
+    Long64_t total() const {
+        Long64_t sum = 0;
+        for (size_t i = 0; i < n_; ++i) sum += counters_[i].value.load(std::memory_order_relaxed);
+        return sum;
+    }
+    
+private:
+    struct alignas(64) Counter {
+        std::atomic<Long64_t> value{0};
+    };
+    
+    size_t n_;
+    std::unique_ptr<Counter[]> counters_;
+};
+
 // ============================================================================
 // ProgressBar class with time estimation
 // ============================================================================
@@ -82,6 +123,7 @@ private:
     int bar_width_;
     std::chrono::steady_clock::time_point start_time_;
     double last_update_percent_;
+    Long64_t offset_ = 0;  // Items done before this run (resumed job)
     
     std::string formatTime(double seconds) const {
         if (seconds < 0) return "--:--";
@@ -148,11 +190,10 @@ public:
         auto now = std::chrono::steady_clock::now();
         double elapsed = std::chrono::duration<double>(now - start_time_).count();
         
-        // Calculate ETA (start from 0.1% progress)
+        // Calculate ETA (start from 0.1% progress) from the rate of this run
         std::string eta_str;
-        if (percent >= 0.1 && progress > 0.0001) {
-            double total_estimated = elapsed / progress;
-            double remaining = total_estimated - elapsed;
+        if (percent >= 0.1 && progress > 0.0001 && current > offset_) {
+            double remaining = elapsed / (current - offset_) * (total_ - current);
             eta_str = formatTime(remaining);
         } else {
             eta_str = "--:--";
@@ -176,6 +217,13 @@ public:
         std::cout.flush();
     }
     
+    /**
+     * @brief Update from per-thread counters (items after resumeFrom())
+     */
+    void update(const ProgressCounters& counters) {
+        update(offset_ + counters.total());
+    }
+    
     /**
      * @brief Finish progress bar (prints newline and elapsed time)
      * @param interrupted If true, indicates early termination
@@ -203,6 +251,15 @@ public:
         }
     }
     
+    /**
+     * @brief Start from items already done (e.g. restored from a checkpoint)
+     *
+     * The ETA is then based on the items processed since.
+     */
+    void resumeFrom(Long64_t done) {
+        offset_ = done;
+    }
+    
     /**
      * @brief Reset progress bar for reuse
      * @param new_total New total count (optional, keeps old if 0)
@@ -0,0 +1,418 @@
+/**
+ * @file rntuple_backend.h
+ * @brief RNTuple storage for NTupleReader input and DynamicHNtuple output
+ *
+ * RNTuple is ROOT's columnar successor of TTree: faster to read, smaller
+ * files and writing from several threads at once. Two small adapters keep
+ * the framework's API unchanged on top of it:
+ *
+ * - RNTupleSource: the input files of NTupleReader ("input.format":
+ *   "rntuple"), read one file after the other through float views. Bound
+ *   variables are copied into the reader's slots, so operator[], slot()
+ *   and optionalSlot() work as with a TChain.
+ * - RNTupleSink: one output RNTuple written with RNTupleParallelWriter.
+ *   Every DynamicHNtuple using it (the main ntuple and one per worker
+ *   shard) fills through its own fill context, so worker threads write
+ *   concurrently instead of buffering until the end of the job.
+ *
+ * Needs ROOT 6.36 or newer (RNTuple API outside ROOT::Experimental). With
+ * an older ROOT everything compiles and the constructors throw.
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef RNTUPLE_BACKEND_H
+#define RNTUPLE_BACKEND_H
+
+#include <TDirectory.h>
+#include <RVersion.h>
+#include "entry_list.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,36,0)
+#define FAT_HAS_RNTUPLE 1
+#include <ROOT/REntry.hxx>
+#include <ROOT/RNTupleFillContext.hxx>
+#include <ROOT/RNTupleFillStatus.hxx>
+#include <ROOT/RNTupleModel.hxx>
+#include <ROOT/RNTupleParallelWriter.hxx>
+#include <ROOT/RNTupleReader.hxx>
+#include <ROOT/RNTupleView.hxx>
+#include <ROOT/RNTupleWriteOptions.hxx>
+
+namespace FatRNTuple {
+using ROOT::REntry;
+using ROOT::RNTupleFillStatus;
+using ROOT::RNTupleModel;
+using ROOT::RNTupleReader;
+using ROOT::RNTupleWriteOptions;
+using FloatView = ROOT::RNTupleView<float>;
+// The parallel writer left ROOT::Experimental one release later
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,38,0)
+using ROOT::RNTupleFillContext;
+using ROOT::RNTupleParallelWriter;
+#else
+using ROOT::Experimental::RNTupleFillContext;
+using ROOT::Experimental::RNTupleParallelWriter;
+#endif
+}  // namespace FatRNTuple
+#endif
+
+// ============================================================================
+// RNTupleSource: Input Files Read as One Sequence of Entries
+// ============================================================================
+/**
+ * @class RNTupleSource
+ * @brief RNTuple counterpart of a TChain for Float_t variables
+ *
+ * Usage Example (what NTupleReader does with "input.format": "rntuple"):
+ * @code
+ *   RNTupleSource source({"run1.root", "run2.root"}, "PPip_ID");
+ *   Float_t p_p = 0;
+ *   source.bind("p_p", &p_p);
+ *   for (Long64_t i = 0; i < source.entries(); ++i) {
+ *       if (source.load(i)) { ... file changed ... }
+ *       use(p_p);
+ *   }
+ * @endcode
+ *
+ * Every file is opened once at construction to count its entries. A bound
+ * variable missing in a file is left untouched there (hasField() tells).
+ */
+class RNTupleSource {
+public:
+    RNTupleSource(const std::vector<std::string>& files, const std::string& name) : name_(name) {
+#ifdef FAT_HAS_RNTUPLE
+        Long64_t first = 0;
+        for (const auto& file : files) {
+            Long64_t n = static_cast<Long64_t>(FatRNTuple::RNTupleReader::Open(name, file)->GetNEntries());
+            if (n <= 0) continue;
+            files_.push_back(InputSegment{file, first, n});
+            first += n;
+        }
+        entries_ = first;
+        start();
+#else
+        (void)files;
+        unsupported();
+#endif
+    }
+
+    /**
+     * @brief Same files with their entry counts known (worker readers)
+     */
+    RNTupleSource(const std::vector<InputSegment>& files, const std::string& name)
+        : name_(name), files_(files) {
+#ifdef FAT_HAS_RNTUPLE
+        entries_ = files_.empty() ? 0 : files_.back().first + files_.back().entries;
+        start();
+#else
+        unsupported();
+#endif
+    }
+
+    Long64_t entries() const { return entries_; }
+    const std::vector<InputSegment>& inputFiles() const { return files_; }
+    const std::string& name() const { return name_; }
+
+    /// Index of the file of the last load() (opened at construction: 0)
+    int fileIndex() const { return current_; }
+    std::string currentFile() const { return current_ >= 0 ? files_[current_].file : ""; }
+
+    /**
+     * @brief Top-level fields of the current file: name and type ("float", ...)
+     */
+    std::vector<std::pair<std::string, std::string>> fields() const {
+        std::vector<std::pair<std::string, std::string>> out;
+#ifdef FAT_HAS_RNTUPLE
+        if (!reader_) return out;
+        for (const auto& field : reader_->GetDescriptor().GetTopLevelFields()) {
+            out.emplace_back(field.GetFieldName(), field.GetTypeName());
+        }
+#endif
+        return out;
+    }
+
+    /// Type of a field of the current file ("" if absent)
+    std::string fieldType(const std::string& field) const {
+        for (const auto& f : fields()) {
+            if (f.first == field) return f.second;
+        }
+        return "";
+    }
+
+    bool hasField(const std::string& field) const { return !fieldType(field).empty(); }
+
+    /**
+     * @brief Read a float field into target on every load()
+     *
+     * Throws if the field exists in the current file with another type.
+     */
+    void bind(const std::string& field, Float_t* target) {
+        bindings_.push_back(Binding{field, target, nullptr});
+        attach(bindings_.back());
+    }
+
+    /**
+     * @brief Read the bound fields of an entry
+     * @return true if the entry is in another file than the previous one
+     */
+    bool load(Long64_t entry) {
+        auto it = std::upper_bound(files_.begin(), files_.end(), entry,
+                                   [](Long64_t e, const InputSegment& f) { return e < f.first; });
+        int k = static_cast<int>(it - files_.begin()) - 1;
+        if (k < 0 || entry >= entries_) {
+            throw std::runtime_error("RNTupleSource::load() - Entry " + std::to_string(entry) +
+                                     " out of range (" + std::to_string(entries_) + " entries)");
+        }
+        bool changed = k != current_;
+        if (changed) openFile(k);
+        readEntry(entry - files_[k].first);
+        return changed;
+    }
+
+private:
+    void start() {
+        if (entries_ <= 0) {
+            throw std::runtime_error("RNTupleSource - No entries in RNTuple '" + name_ + "'");
+        }
+        openFile(0);
+    }
+
+    [[noreturn]] static void unsupported() {
+        throw std::runtime_error("RNTupleSource - RNTuple input needs ROOT 6.36 or newer (this is " +
+                                 std::string(ROOT_RELEASE) + ")");
+    }
+
+    struct Binding {
+        std::string field;
+        Float_t* target;
+#ifdef FAT_HAS_RNTUPLE
+        std::unique_ptr<FatRNTuple::FloatView> view;   // nullptr: absent in this file
+#else
+        std::nullptr_t view;
+#endif
+    };
+
+#ifdef FAT_HAS_RNTUPLE
+    void openFile(int k) {
+        current_ = k;
+        // Views belong to the reader's page source: drop them before it goes
+        for (auto& b : bindings_) b.view.reset();
+        reader_ = FatRNTuple::RNTupleReader::Open(name_, files_[k].file);
+        for (auto& b : bindings_) attach(b);
+    }
+
+    void attach(Binding& b) {
+        b.view.reset();
+        std::string type = fieldType(b.field);
+        if (type.empty()) return;
+        if (type != "float") {
+            throw std::runtime_error("RNTupleSource - Field '" + b.field + "' of " + currentFile() +
+                                     " is " + type + "; only float fields can be bound");
+        }
+        b.view = std::make_unique<FatRNTuple::FloatView>(reader_->GetView<float>(b.field));
+    }
+
+    void readEntry(Long64_t local) {
+        for (auto& b : bindings_) {
+            if (b.view) *b.target = (*b.view)(static_cast<ROOT::NTupleSize_t>(local));
+        }
+    }
+
+    std::unique_ptr<FatRNTuple::RNTupleReader> reader_;
+#else
+    void openFile(int k) { current_ = k; }
+    void attach(Binding&) {}
+    void readEntry(Long64_t) {}
+#endif
+
+    std::string name_;
+    std::vector<InputSegment> files_;
+    Long64_t entries_ = 0;
+    int current_ = -1;
+    std::vector<Binding> bindings_;   // Views re-created per file
+};
+
+// ============================================================================
+// RNTupleSink: One Output RNTuple, Filled From Several Threads
+// ============================================================================
+/**
+ * @class RNTupleSink
+ * @brief Parallel writer of one RNTuple of Float_t fields
+ *
+ * The fields are fixed by the first context() (its variables, in
+ * alphabetical order): RNTuple cannot add a column later and backfill it
+ * with a sentinel the way DynamicHNtuple does for TTrees. Later contexts
+ * may know fewer variables (those fields get missing_value), not more.
+ *
+ * Entries of one context stay in fill order; clusters of different
+ * contexts (worker threads) can interleave in the file.
+ *
+ * Each parallel writer only serialises its own contexts. Sinks writing
+ * into the same directory (several rntuple-mode ntuples in one output
+ * file) therefore share one file lock, taken whenever a context flushes
+ * a cluster, is destroyed (flush of the rest) or the writer is closed.
+ * Filling itself only appends to the context's buffers and takes no lock.
+ */
+class RNTupleSink {
+public:
+    /**
+     * @brief Fills of one thread, read from the owner's value storage
+     */
+    class Context {
+    public:
+        ~Context() {
+#ifdef FAT_HAS_RNTUPLE
+            // Destroying the context writes its last cluster
+            std::lock_guard<std::mutex> lock(*file_mutex_);
+            entry_.reset();
+            context_.reset();
+#endif
+        }
+
+        void fill() {
+#ifdef FAT_HAS_RNTUPLE
+            FatRNTuple::RNTupleFillStatus status;
+            context_->FillNoFlush(*entry_, status);
+            if (status.ShouldFlushCluster()) {
+                std::lock_guard<std::mutex> lock(*file_mutex_);
+                context_->FlushCluster();
+            }
+#endif
+        }
+
+    private:
+        friend class RNTupleSink;
+#ifdef FAT_HAS_RNTUPLE
+        std::shared_ptr<FatRNTuple::RNTupleFillContext> context_;
+        std::unique_ptr<FatRNTuple::REntry> entry_;
+#endif
+        std::shared_ptr<std::mutex> file_mutex_;
+        std::vector<Float_t> missing_;   // Fields the owner does not have
+    };
+
+    /**
+     * @param dir Output file or directory the RNTuple is written to
+     * @param compression ROOT compression setting (-1 = RNTuple default)
+     */
+    RNTupleSink(const std::string& name, TDirectory* dir, int compression = -1)
+        : name_(name), dir_(dir), compression_(compression), file_mutex_(fileMutex(dir)) {
+#ifndef FAT_HAS_RNTUPLE
+        throw std::runtime_error("RNTupleSink - RNTuple output needs ROOT 6.36 or newer (this is " +
+                                 std::string(ROOT_RELEASE) + ")");
+#endif
+    }
+
+    /**
+     * @brief Fill context bound to the given values (thread-safe)
+     * @param values Variable name -> storage read at every fill()
+     *
+     * The first call creates the writer with these variables as fields.
+     */
+    std::unique_ptr<Context> context(const std::map<std::string, Float_t*>& values, Float_t missing_value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) {
+            throw std::runtime_error("RNTupleSink - '" + name_ + "' is already written");
+        }
+        if (fields_.empty()) {
+            if (values.empty()) {
+                throw std::runtime_error("RNTupleSink - '" + name_ + "' has no variables");
+            }
+            for (const auto& pair : values) fields_.push_back(pair.first);
+            createWriter();
+        }
+        for (const auto& pair : values) {
+            if (!std::binary_search(fields_.begin(), fields_.end(), pair.first)) {
+                throw std::runtime_error("RNTupleSink - Variable '" + pair.first + "' of '" + name_ +
+                                         "' appeared after writing started; declare() it "
+                                         "(RNTuple fields are fixed at the first fill)");
+            }
+        }
+
+        auto context = std::make_unique<Context>();
+        context->file_mutex_ = file_mutex_;
+        context->missing_.assign(fields_.size(), missing_value);
+#ifdef FAT_HAS_RNTUPLE
+        context->context_ = writer_->CreateFillContext();
+        context->entry_ = context->context_->CreateEntry();
+        for (size_t j = 0; j < fields_.size(); ++j) {
+            auto it = values.find(fields_[j]);
+            context->entry_->BindRawPtr<float>(fields_[j], it != values.end() ? it->second
+                                                                             : &context->missing_[j]);
+        }
+#endif
+        return context;
+    }
+
+    /// True once the fields are fixed
+    bool started() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return !fields_.empty();
+    }
+
+    /**
+     * @brief Write the RNTuple (destroy all contexts first)
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+#ifdef FAT_HAS_RNTUPLE
+        {
+            std::lock_guard<std::mutex> file_lock(*file_mutex_);
+            writer_.reset();
+        }
+#endif
+        closed_ = true;
+    }
+
+    const std::string& name() const { return name_; }
+    const std::vector<std::string>& fields() const { return fields_; }
+
+private:
+    /**
+     * @brief The lock shared by all sinks writing into dir
+     */
+    static std::shared_ptr<std::mutex> fileMutex(TDirectory* dir) {
+        static std::mutex registry_mutex;
+        static std::map<TDirectory*, std::weak_ptr<std::mutex>> registry;
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        std::shared_ptr<std::mutex> mutex = registry[dir].lock();
+        if (!mutex) {
+            mutex = std::make_shared<std::mutex>();
+            registry[dir] = mutex;
+        }
+        return mutex;
+    }
+
+    void createWriter() {
+#ifdef FAT_HAS_RNTUPLE
+        auto model = FatRNTuple::RNTupleModel::CreateBare();
+        for (const auto& field : fields_) model->MakeField<float>(field);
+        FatRNTuple::RNTupleWriteOptions options;
+        if (compression_ >= 0) options.SetCompression(static_cast<std::uint32_t>(compression_));
+        std::lock_guard<std::mutex> file_lock(*file_mutex_);
+        writer_ = FatRNTuple::RNTupleParallelWriter::Append(std::move(model), name_, *dir_, options);
+#endif
+    }
+
+    std::string name_;
+    TDirectory* dir_;
+    int compression_;
+    std::shared_ptr<std::mutex> file_mutex_;   // Shared with the other sinks of dir_
+    std::vector<std::string> fields_;   // Sorted
+    bool closed_ = false;
+    mutable std::mutex mutex_;
+#ifdef FAT_HAS_RNTUPLE
+    std::unique_ptr<FatRNTuple::RNTupleParallelWriter> writer_;
+#endif
+};
+
+#endif // RNTUPLE_BACKEND_H
@@ -0,0 +1,241 @@
+/**
+ * @file schema_generator.h
+ * @brief Generate a typed input struct from the variables of a tree
+ *
+ * reader["p_p"] looks the name up on every call, and slot() needs one
+ * pointer per variable held by hand. The generated header instead gives
+ * the tree as a plain struct - one member per scalar leaf, in its on-disk
+ * type - that ROOT reads into directly:
+ *
+ *   make schema                     (or ./ana config.json --schema [header])
+ *     -> src/ppip_id_schema.h with struct PPip_IDEvent
+ *
+ *   #include "ppip_id_schema.h"
+ *   PPip_IDEvent ev;
+ *   ev.bind(reader);                // checks every member against the tree
+ *   reader.getEntry(i);
+ *   h_mom.fill(ev.p_p);
+ *
+ * Each struct carries its members as constexpr metadata (kFields), so
+ * code can iterate over them without a tree at hand. bind() goes through
+ * NTupleReader::bindStruct(), which reports every member that no longer
+ * matches the tree before anything is bound.
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef SCHEMA_GENERATOR_H
+#define SCHEMA_GENERATOR_H
+
+#include "ntuple_reader.h"
+#include <TLeaf.h>
+#include <TBranch.h>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// SchemaGenerator: Tree Variables -> C++ Header
+// ============================================================================
+/**
+ * @class SchemaGenerator
+ * @brief Inspects the current tree of a reader and writes its input struct
+ *
+ * Usage Example:
+ * @code
+ *   SchemaGenerator schema(reader);
+ *   schema.write(SchemaGenerator::defaultHeader(reader.getTreeName()), config.getInputSource());
+ *   schema.printSummary();
+ * @endcode
+ *
+ * Scalar leaves of the NativeType types become members. Arrays and leaves
+ * of other types (objects, Long_t, ...) are left out and listed as
+ * comments in the header; read them with arraySlot() or plain ROOT.
+ */
+class SchemaGenerator {
+public:
+    /// One member of the struct
+    struct Member {
+        std::string leaf;       ///< Leaf name in the tree
+        std::string type;       ///< Leaf type name (member type)
+        std::string member;     ///< C++ identifier
+    };
+
+    /// A leaf without a member, and why
+    struct Skipped {
+        std::string leaf;
+        std::string reason;
+    };
+
+    explicit SchemaGenerator(NTupleReader& reader) : treename_(reader.getTreeName()) {
+        if (reader.isRNTuple()) {
+            throw std::runtime_error("SchemaGenerator - Input structs are generated from TTrees, not RNTuples");
+        }
+        TTree* tree = reader.getTree();
+        if (!tree) {
+            throw std::runtime_error("SchemaGenerator - No tree loaded!");
+        }
+
+        std::set<std::string> used;
+        for (const auto& name : reader.listVariables()) {
+            TLeaf* leaf = tree->GetLeaf(name.c_str());
+            if (!leaf) continue;
+            std::string type = leaf->GetTypeName();
+            if (leaf->GetLeafCount() || leaf->GetLenStatic() != 1) {
+                skipped_.push_back({name, "array " + type + ", use arraySlot()"});
+            } else if (!isNativeType(type)) {
+                skipped_.push_back({name, "type " + type + " not supported"});
+            } else {
+                members_.push_back({name, type, uniqueIdentifier(name, used)});
+            }
+        }
+        if (members_.empty()) {
+            throw std::runtime_error("SchemaGenerator - Tree '" + treename_ + "' has no scalar variables");
+        }
+    }
+
+    // ========================================================================
+    // Names
+    // ========================================================================
+
+    /// Struct name for a tree ("PPip_ID" -> "PPip_IDEvent")
+    static std::string structName(const std::string& treename) {
+        return identifier(treename) + "Event";
+    }
+
+    /// Default header for a tree ("PPip_ID" -> "src/ppip_id_schema.h")
+    static std::string defaultHeader(const std::string& treename) {
+        std::string base = identifier(treename);
+        for (char& c : base) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return "src/" + base + "_schema.h";
+    }
+
+    // ========================================================================
+    // Output
+    // ========================================================================
+
+    /**
+     * @brief Write the header (replaced)
+     * @param source Input the tree was read from, noted in the header
+     */
+    void write(const std::string& filename, const std::string& source) {
+        std::string name = structName(treename_);
+        std::string guard = identifier(filename.substr(filename.find_last_of('/') + 1));
+        for (char& c : guard) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+
+        std::ofstream out(filename);
+        if (!out) {
+            throw std::runtime_error("SchemaGenerator: Cannot write " + filename);
+        }
+        out << "/**\n"
+            << " * @file " << filename.substr(filename.find_last_of('/') + 1) << "\n"
+            << " * @brief Input struct of tree " << treename_ << " (generated, do not edit)\n"
+            << " *\n"
+            << " * Generated by ./ana --schema from " << source << ":\n"
+            << " * " << members_.size() << " members, " << skipped_.size() << " leaves skipped.\n"
+            << " * Regenerate with make schema when the input changes; bind() refuses\n"
+            << " * a tree that no longer matches.\n"
+            << " */\n\n"
+            << "#ifndef " << guard << "\n"
+            << "#define " << guard << "\n\n"
+            << "#include \"ntuple_reader.h\"\n"
+            << "#include <array>\n\n"
+            << "struct " << name << " {\n";
+        for (const auto& m : members_) {
+            out << "    " << std::left << std::setw(10) << m.type << " " << m.member << " = 0;";
+            if (m.member != m.leaf) out << "   // " << m.leaf;
+            out << "\n";
+        }
+        for (const auto& s : skipped_) {
+            out << "    // skipped: " << s.leaf << " (" << s.reason << ")\n";
+        }
+
+        out << "\n    static constexpr const char* kTree = \"" << treename_ << "\";\n"
+            << "    static constexpr std::array<StructField, " << members_.size() << "> kFields = {{\n";
+        for (const auto& m : members_) {
+            out << "        {\"" << m.leaf << "\", \"" << m.type << "\"},\n";
+        }
+        out << "    }};\n\n"
+            << "    /// Bind every member to the reader (throws if the tree does not match)\n"
+            << "    void bind(NTupleReader& reader) {\n"
+            << "        reader.bindStruct(\"" << name << "\", {\n";
+        for (size_t i = 0; i < members_.size(); ++i) {
+            out << "            {kFields[" << i << "], &" << members_[i].member << "},\n";
+        }
+        out << "        });\n"
+            << "    }\n"
+            << "};\n\n"
+            << "#endif // " << guard << "\n";
+        if (!out) {
+            throw std::runtime_error("SchemaGenerator: Failed writing " + filename);
+        }
+        header_ = filename;
+    }
+
+    /**
+     * @brief Print the generated struct and the skipped leaves
+     */
+    void printSummary(std::ostream& os = std::cout) const {
+        os << "\n";
+        os << "╔════════════════════════════════════════════════════════════════╗\n";
+        os << "║                         INPUT SCHEMA                           ║\n";
+        os << "╠════════════════════════════════════════════════════════════════╣\n";
+        os << "║ Struct: " << std::left << std::setw(55) << structName(treename_) << "║\n";
+        os << "║ Header: " << std::left << std::setw(55) << header_ << "║\n";
+        os << "║ Members: " << std::left << std::setw(54) << members_.size() << "║\n";
+        for (const auto& s : skipped_) {
+            os << "║ " << std::left << std::setw(63) << ("skipped " + s.leaf + ": " + s.reason) << "║\n";
+        }
+        os << "╚════════════════════════════════════════════════════════════════╝\n";
+    }
+
+    const std::vector<Member>& members() const { return members_; }
+    const std::vector<Skipped>& skipped() const { return skipped_; }
+
+private:
+    /// Leaf types NTupleReader binds natively (NativeType in ntuple_reader.h)
+    static bool isNativeType(const std::string& type) {
+        static const std::set<std::string> types = {
+            "Double_t", "Float_t", "Long64_t", "ULong64_t", "Int_t", "UInt_t",
+            "Short_t", "UShort_t", "Char_t", "UChar_t", "Bool_t"};
+        return types.count(type) > 0;
+    }
+
+    /// Valid C++ identifier: other characters become '_', no leading digit
+    static std::string identifier(const std::string& name) {
+        std::string id;
+        for (char c : name) {
+            id += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+        }
+        if (id.empty() || std::isdigit(static_cast<unsigned char>(id[0]))) id = "_" + id;
+        return id;
+    }
+
+    /// Identifier not used by an earlier member, the struct's own names or a keyword
+    static std::string uniqueIdentifier(const std::string& leaf, std::set<std::string>& used) {
+        static const std::set<std::string> reserved = {
+            "kTree", "kFields", "bind", "auto", "bool", "break", "case", "char", "class",
+            "const", "default", "delete", "do", "double", "else", "enum", "float", "for",
+            "if", "int", "long", "new", "private", "public", "return", "short", "signed",
+            "static", "struct", "switch", "this", "union", "unsigned", "void", "while"};
+        std::string base = identifier(leaf);
+        if (reserved.count(base)) base += "_";
+        std::string id = base;
+        for (int k = 2; used.count(id); ++k) id = base + "_" + std::to_string(k);
+        used.insert(id);
+        return id;
+    }
+
+    std::string treename_;
+    std::vector<Member> members_;
+    std::vector<Skipped> skipped_;
+    std::string header_;
+};
+
+#endif // SCHEMA_GENERATOR_H
@@ -15,24 +15,42 @@
 #include "cut_manager.h"
 #include <iostream>
 
+/**
+ * @brief Handles to the cuts applied in processEvent()
+ *
+ * Filled by setupCuts(); processEvent() evaluates through these
+ * (cuts.passRangeCut(c.neutron_mass, m_n)) so no cut name is looked up
+ * per event. A handle left invalid (cut commented out) accepts every event.
+ *
+ * EDIT THIS STRUCT together with setupCuts() when adding cuts.
+ */
+struct CutHandles {
+    RangeCutId neutron_mass;
+    RangeCutId deltaPP_mass;
+};
+
 /**
  * @brief Define all cuts for the analysis
  * @param cuts CutManager object for cut definition
+ * @return Handles used by processEvent()
  *
  * EDIT THIS FUNCTION to customize cuts for your analysis.
+ * The sequential cut flow follows definition order, so define cuts
+ * in the order processEvent() applies them.
  */
-inline void setupCuts(CutManager& cuts) {
+inline CutHandles setupCuts(CutManager& cuts) {
     std::cout << "Setting up cuts...\n";
+    CutHandles c;
     
     // ========================================================================
     // Range Cuts (min <= value <= max)
     // ========================================================================
     
     // Missing mass (neutron) cut
-    cuts.defineRangeCut("neutron_mass", 0.899, 0.986, "Neutron mass window [GeV]");
+    c.neutron_mass = cuts.defineRangeCut("neutron_mass", 0.899, 0.986, "Neutron mass window [GeV]");
     
     // Delta++ mass cut
-    cuts.defineRangeCut("deltaPP_mass", 0.8, 1.8, "Delta++ mass window [GeV]");
+    c.deltaPP_mass = cuts.defineRangeCut("deltaPP_mass", 0.8, 1.8, "Delta++ mass window [GeV]");
     
     // Example: Momentum cuts (uncomment if needed)
     // cuts.defineRangeCut("proton_momentum", 100.0, 3000.0, "Proton p range [MeV/c]");
@@ -59,6 +77,7 @@ inline void setupCuts(CutManager& cuts) {
     // }
     
     cuts.printDefinedCuts();
+    return c;
 }
 
 #endif // SETUP_CUTS_H
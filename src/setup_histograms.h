@@ -15,135 +15,193 @@
 #include "manager.h"
 #include <iostream>
 
+/**
+ * @brief Handles to all analysis histograms
+ *
+ * Filled by setupHistograms(); processEvent() fills through these
+ * (h.mass_n.fill(m_n)) so no histogram name is looked up per event.
+ *
+ * EDIT THIS STRUCT together with setupHistograms() when adding histograms.
+ */
+struct HistogramHandles {
+    // Quality control
+    H1Handle mass_n;
+    H1Handle mass_n_cut;
+    H1Handle mass_p;
+    H1Handle mass_pip;
+    H1Handle eVertX;
+    H1Handle eVertY;
+    H1Handle eVertZ;
+    H1Handle mass_deltaPP;
+    H1Handle mass_deltaP;
+    H1Handle mass_ppip;
+    H1Handle mass_npip;
+    H1Handle mass_pn;
+    H1Handle p_p_lab;
+    H1Handle pip_p_lab;
+    H1Handle n_p_lab;
+    H1Handle p_theta_lab;
+    H1Handle pip_theta_lab;
+    H1Handle n_theta_lab;
+    H1Handle cos_theta_deltaPP_cms;
+    H1Handle cos_theta_deltaP_cms;
+    H1Handle cos_theta_p_cms;
+    H1Handle cos_theta_pip_cms;
+    H1Handle cos_theta_n_cms;
+    H1Handle p_p_cms;
+    H1Handle pip_p_cms;
+    H1Handle n_p_cms;
+    H1Handle oa_ppip;
+    H1Handle oa_npip;
+    H1Handle oa_pn;
+    H1Handle pwa_pip_helicity_ppip;
+    H1Handle pwa_n_helicity_ppip;
+    H1Handle pwa_pip_gj_ppip;
+
+    // 2D correlations
+    H2Handle dalitz_ppip_npip;
+    H2Handle mass_vs_costh_deltaPP;
+    H2Handle theta_p_vs_pip_lab;
+};
+
 /**
  * @brief Define all histograms for the analysis
  * @param mgr Manager object for histogram creation
+ * @return Handles to the created histograms
  *
  * EDIT THIS FUNCTION to customize histograms for your analysis.
  */
-inline void setupHistograms(Manager& mgr) {
+inline HistogramHandles setupHistograms(Manager& mgr) {
     std::cout << "Setting up histogram system...\n";
     
+    HistogramHandles h;
+    
     // ========================================================================
     // Quality Control Histograms
     // ========================================================================
     
     // Missing mass (neutron)
-    mgr.create1D("mass_n", "Missing mass (neutron);M [GeV/c^{2}];Counts", 
-                 200, 0.5, 1.5, "quality");
-    mgr.create1D("mass_n_cut", "Missing mass (after cuts);M [GeV/c^{2}];Counts", 
-                 200, 0.5, 1.5, "quality");
+    h.mass_n = mgr.create1D("mass_n", "Missing mass (neutron);M [GeV/c^{2}];Counts", 
+                            200, 0.5, 1.5, "quality");
+    h.mass_n_cut = mgr.create1D("mass_n_cut", "Missing mass (after cuts);M [GeV/c^{2}];Counts", 
+                                200, 0.5, 1.5, "quality");
     
     // Proton mass check
-    mgr.create1D("mass_p", "Proton mass;M [GeV/c^{2}];Counts", 
-                 200, 0.5, 1.5, "quality");
+    h.mass_p = mgr.create1D("mass_p", "Proton mass;M [GeV/c^{2}];Counts", 
+                            200, 0.5, 1.5, "quality");
     
     // Pion mass check
-    mgr.create1D("mass_pip", "Pion mass;M [GeV/c^{2}];Counts", 
-                 200, 0.0, 0.5, "quality");
+    h.mass_pip = mgr.create1D("mass_pip", "Pion mass;M [GeV/c^{2}];Counts", 
+                              200, 0.0, 0.5, "quality");
     
     // Event vertex
-    mgr.create1D("eVertX", "Event Vertex X;X [mm];Counts", 200, -100, 100, "quality");
-    mgr.create1D("eVertY", "Event Vertex Y;Y [mm];Counts", 200, -100, 100, "quality");
-    mgr.create1D("eVertZ", "Event Vertex Z;Z [mm];Counts", 500, -400, 100, "quality");
+    h.eVertX = mgr.create1D("eVertX", "Event Vertex X;X [mm];Counts", 200, -100, 100, "quality");
+    h.eVertY = mgr.create1D("eVertY", "Event Vertex Y;Y [mm];Counts", 200, -100, 100, "quality");
+    h.eVertZ = mgr.create1D("eVertZ", "Event Vertex Z;Z [mm];Counts", 500, -400, 100, "quality");
     
     // ========================================================================
     // Composite Particle Masses
     // ========================================================================
     
-    mgr.create1D("mass_deltaPP", "#Delta^{++} mass;M [GeV/c^{2}];Counts", 
-                 100, 0.8, 1.8, "composites");
-    mgr.create1D("mass_deltaP", "#Delta^{+} mass;M [GeV/c^{2}];Counts", 
-                 100, 0.8, 1.8, "composites");
-    mgr.create1D("mass_ppip", "p#pi^{+} invariant mass;M [GeV/c^{2}];Counts", 
-                 100, 1.0, 2.0, "composites");
-    mgr.create1D("mass_npip", "n#pi^{+} invariant mass;M [GeV/c^{2}];Counts", 
-                 100, 1.0, 2.0, "composites");
-    mgr.create1D("mass_pn", "pn invariant mass;M [GeV/c^{2}];Counts", 
-                 100, 1.7, 2.5, "composites");
+    h.mass_deltaPP = mgr.create1D("mass_deltaPP", "#Delta^{++} mass;M [GeV/c^{2}];Counts", 
+                                  100, 0.8, 1.8, "composites");
+    h.mass_deltaP = mgr.create1D("mass_deltaP", "#Delta^{+} mass;M [GeV/c^{2}];Counts", 
+                                 100, 0.8, 1.8, "composites");
+    h.mass_ppip = mgr.create1D("mass_ppip", "p#pi^{+} invariant mass;M [GeV/c^{2}];Counts", 
+                               100, 1.0, 2.0, "composites");
+    h.mass_npip = mgr.create1D("mass_npip", "n#pi^{+} invariant mass;M [GeV/c^{2}];Counts", 
+                               100, 1.0, 2.0, "composites");
+    h.mass_pn = mgr.create1D("mass_pn", "pn invariant mass;M [GeV/c^{2}];Counts", 
+                             100, 1.7, 2.5, "composites");
     
     // ========================================================================
     // LAB Frame Kinematics
     // ========================================================================
     
     // Momenta
-    mgr.create1D("p_p_lab", "Proton momentum (LAB);p [MeV/c];Counts", 
-                 100, 0, 3000, "lab/momentum");
-    mgr.create1D("pip_p_lab", "#pi^{+} momentum (LAB);p [MeV/c];Counts", 
-                 100, 0, 2000, "lab/momentum");
-    mgr.create1D("n_p_lab", "Neutron momentum (LAB);p [MeV/c];Counts", 
-                 100, 0, 2000, "lab/momentum");
+    h.p_p_lab = mgr.create1D("p_p_lab", "Proton momentum (LAB);p [MeV/c];Counts", 
+                             100, 0, 3000, "lab/momentum");
+    h.pip_p_lab = mgr.create1D("pip_p_lab", "#pi^{+} momentum (LAB);p [MeV/c];Counts", 
+                               100, 0, 2000, "lab/momentum");
+    h.n_p_lab = mgr.create1D("n_p_lab", "Neutron momentum (LAB);p [MeV/c];Counts", 
+                             100, 0, 2000, "lab/momentum");
     
     // Angular distributions
-    mgr.create1D("p_theta_lab", "Proton #theta (LAB);#theta [deg];Counts", 
-                 90, 0, 90, "lab/angular");
-    mgr.create1D("pip_theta_lab", "#pi^{+} #theta (LAB);#theta [deg];Counts", 
-                 90, 0, 90, "lab/angular");
-    mgr.create1D("n_theta_lab", "Neutron #theta (LAB);#theta [deg];Counts", 
-                 180, 0, 180, "lab/angular");
+    h.p_theta_lab = mgr.create1D("p_theta_lab", "Proton #theta (LAB);#theta [deg];Counts", 
+                                 90, 0, 90, "lab/angular");
+    h.pip_theta_lab = mgr.create1D("pip_theta_lab", "#pi^{+} #theta (LAB);#theta [deg];Counts", 
+                                   90, 0, 90, "lab/angular");
+    h.n_theta_lab = mgr.create1D("n_theta_lab", "Neutron #theta (LAB);#theta [deg];Counts", 
+                                 180, 0, 180, "lab/angular");
     
     // ========================================================================
     // CMS Kinematics
     // ========================================================================
     
-    mgr.create1D("cos_theta_deltaPP_cms", "#Delta^{++} cos#theta (CMS);cos#theta;Counts", 
-                 40, -1, 1, "cms/angular");
-    mgr.create1D("cos_theta_deltaP_cms", "#Delta^{+} cos#theta (CMS);cos#theta;Counts", 
-                 40, -1, 1, "cms/angular");
-    mgr.create1D("cos_theta_p_cms", "Proton cos#theta (CMS);cos#theta;Counts", 
-                 40, -1, 1, "cms/angular");
-    mgr.create1D("cos_theta_pip_cms", "#pi^{+} cos#theta (CMS);cos#theta;Counts", 
-                 40, -1, 1, "cms/angular");
-    mgr.create1D("cos_theta_n_cms", "Neutron cos#theta (CMS);cos#theta;Counts", 
-                 40, -1, 1, "cms/angular");
+    h.cos_theta_deltaPP_cms = mgr.create1D("cos_theta_deltaPP_cms", "#Delta^{++} cos#theta (CMS);cos#theta;Counts", 
+                                           40, -1, 1, "cms/angular");
+    h.cos_theta_deltaP_cms = mgr.create1D("cos_theta_deltaP_cms", "#Delta^{+} cos#theta (CMS);cos#theta;Counts", 
+                                          40, -1, 1, "cms/angular");
+    h.cos_theta_p_cms = mgr.create1D("cos_theta_p_cms", "Proton cos#theta (CMS);cos#theta;Counts", 
+                                     40, -1, 1, "cms/angular");
+    h.cos_theta_pip_cms = mgr.create1D("cos_theta_pip_cms", "#pi^{+} cos#theta (CMS);cos#theta;Counts", 
+                                       40, -1, 1, "cms/angular");
+    h.cos_theta_n_cms = mgr.create1D("cos_theta_n_cms", "Neutron cos#theta (CMS);cos#theta;Counts", 
+                                     40, -1, 1, "cms/angular");
     
     // CMS momenta
-    mgr.create1D("p_p_cms", "Proton momentum (CMS);p [MeV/c];Counts", 
-                 100, 0, 1500, "cms/momentum");
-    mgr.create1D("pip_p_cms", "#pi^{+} momentum (CMS);p [MeV/c];Counts", 
-                 100, 0, 1000, "cms/momentum");
-    mgr.create1D("n_p_cms", "Neutron momentum (CMS);p [MeV/c];Counts", 
-                 100, 0, 1500, "cms/momentum");
+    h.p_p_cms = mgr.create1D("p_p_cms", "Proton momentum (CMS);p [MeV/c];Counts", 
+                             100, 0, 1500, "cms/momentum");
+    h.pip_p_cms = mgr.create1D("pip_p_cms", "#pi^{+} momentum (CMS);p [MeV/c];Counts", 
+                               100, 0, 1000, "cms/momentum");
+    h.n_p_cms = mgr.create1D("n_p_cms", "Neutron momentum (CMS);p [MeV/c];Counts", 
+                             100, 0, 1500, "cms/momentum");
     
     // ========================================================================
     // Opening Angles
     // ========================================================================
     
-    mgr.create1D("oa_ppip", "Opening angle p-#pi^{+};#alpha [deg];Counts", 
-                 180, 0, 180, "opening_angles");
-    mgr.create1D("oa_npip", "Opening angle n-#pi^{+};#alpha [deg];Counts", 
-                 180, 0, 180, "opening_angles");
-    mgr.create1D("oa_pn", "Opening angle p-n;#alpha [deg];Counts", 
-                 180, 0, 180, "opening_angles");
+    h.oa_ppip = mgr.create1D("oa_ppip", "Opening angle p-#pi^{+};#alpha [deg];Counts", 
+                             180, 0, 180, "opening_angles");
+    h.oa_npip = mgr.create1D("oa_npip", "Opening angle n-#pi^{+};#alpha [deg];Counts", 
+                             180, 0, 180, "opening_angles");
+    h.oa_pn = mgr.create1D("oa_pn", "Opening angle p-n;#alpha [deg];Counts", 
+                           180, 0, 180, "opening_angles");
     
     // ========================================================================
     // 2D Correlations
     // ========================================================================
+    // Fine-binned or mostly empty 2D/3D histograms (and large create2DArray
+    // sets) can pass a storage as the last argument:
+    //   HistogramStorage::Sparse  memory scales with filled bins, written as TH2D
+    //   HistogramStorage::Int32   TH2I,  HistogramStorage::Double  TH2D
     
-    mgr.create2D("dalitz_ppip_npip", "Dalitz plot;M^{2}(p#pi^{+}) [GeV^{2}/c^{4}];M^{2}(n#pi^{+}) [GeV^{2}/c^{4}]",
-                 100, 1.0, 4.0, 100, 1.0, 4.0, "correlations");
+    h.dalitz_ppip_npip = mgr.create2D("dalitz_ppip_npip", "Dalitz plot;M^{2}(p#pi^{+}) [GeV^{2}/c^{4}];M^{2}(n#pi^{+}) [GeV^{2}/c^{4}]",
+                                      100, 1.0, 4.0, 100, 1.0, 4.0, "correlations");
     
-    mgr.create2D("mass_vs_costh_deltaPP", "#Delta^{++}: M vs cos#theta;M [GeV/c^{2}];cos#theta",
-                 50, 1.0, 1.6, 40, -1, 1, "correlations");
+    h.mass_vs_costh_deltaPP = mgr.create2D("mass_vs_costh_deltaPP", "#Delta^{++}: M vs cos#theta;M [GeV/c^{2}];cos#theta",
+                                           50, 1.0, 1.6, 40, -1, 1, "correlations");
     
-    mgr.create2D("theta_p_vs_pip_lab", "#theta_{p} vs #theta_{#pi^{+}} (LAB);#theta_{#pi^{+}} [deg];#theta_{p} [deg]",
-                 90, 0, 90, 90, 0, 90, "correlations");
+    h.theta_p_vs_pip_lab = mgr.create2D("theta_p_vs_pip_lab", "#theta_{p} vs #theta_{#pi^{+}} (LAB);#theta_{#pi^{+}} [deg];#theta_{p} [deg]",
+                                        90, 0, 90, 90, 0, 90, "correlations");
     
     // ========================================================================
     // PWA Variables (Partial Wave Analysis)
     // ========================================================================
     
     // Helicity angles
-    mgr.create1D("pwa_pip_helicity_ppip", "#pi^{+} helicity in p#pi^{+} frame;cos#theta_{H};Counts",
-                 40, -1, 1, "pwa/helicity");
-    mgr.create1D("pwa_n_helicity_ppip", "n helicity in p#pi^{+} frame;cos#theta_{H};Counts",
-                 40, -1, 1, "pwa/helicity");
+    h.pwa_pip_helicity_ppip = mgr.create1D("pwa_pip_helicity_ppip", "#pi^{+} helicity in p#pi^{+} frame;cos#theta_{H};Counts",
+                                           40, -1, 1, "pwa/helicity");
+    h.pwa_n_helicity_ppip = mgr.create1D("pwa_n_helicity_ppip", "n helicity in p#pi^{+} frame;cos#theta_{H};Counts",
+                                         40, -1, 1, "pwa/helicity");
     
     // Gottfried-Jackson angles  
-    mgr.create1D("pwa_pip_gj_ppip", "#pi^{+} GJ angle in p#pi^{+} frame;cos#theta_{GJ};Counts",
-                 40, -1, 1, "pwa/gottfried_jackson");
+    h.pwa_pip_gj_ppip = mgr.create1D("pwa_pip_gj_ppip", "#pi^{+} GJ angle in p#pi^{+} frame;cos#theta_{GJ};Counts",
+                                     40, -1, 1, "pwa/gottfried_jackson");
     
     std::cout << "✓ Created " << mgr.histogramCount() << " histograms\n";
+    
+    return h;
 }
 
 #endif // SETUP_HISTOGRAMS_H
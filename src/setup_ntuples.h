@@ -13,7 +13,8 @@
  *
  * Key features of DynamicHNtuple:
  *   - Add variables at ANY time (no prebooking needed)
- *   - Uses TTree internally for dynamic schema
+ *   - Uses TTree internally for dynamic schema (or a column buffer,
+ *     see output.ntuple_mode)
  *   - Converts to flat TNtuple at finalization
  *   - Missing values filled with configurable sentinel (default: -1)
  *
@@ -27,6 +28,66 @@
 #include "manager.h"
 #include "analysis_config.h"
 
+/**
+ * @brief Slots of the declared variables of nt_particles
+ */
+struct ParticleNtupleSlots {
+    DynamicHNtuple* nt = nullptr;
+    DynamicHNtuple::Slot p_p;
+    DynamicHNtuple::Slot p_theta;
+    DynamicHNtuple::Slot p_phi;
+    DynamicHNtuple::Slot p_mass;
+    DynamicHNtuple::Slot pip_p;
+    DynamicHNtuple::Slot pip_theta;
+    DynamicHNtuple::Slot pip_phi;
+    DynamicHNtuple::Slot pip_mass;
+    DynamicHNtuple::Slot n_p;
+    DynamicHNtuple::Slot n_theta;
+    DynamicHNtuple::Slot n_phi;
+    DynamicHNtuple::Slot n_mass;
+    DynamicHNtuple::Slot weight;
+};
+
+/**
+ * @brief Slots of the declared variables of nt_compound
+ */
+struct CompoundNtupleSlots {
+    DynamicHNtuple* nt = nullptr;
+    DynamicHNtuple::Slot m_deltaPP;
+    DynamicHNtuple::Slot m_deltaP;
+    DynamicHNtuple::Slot m_ppip;
+    DynamicHNtuple::Slot m_npip;
+    DynamicHNtuple::Slot m_pn;
+    DynamicHNtuple::Slot cos_th_deltaPP_cms;
+    DynamicHNtuple::Slot cos_th_deltaP_cms;
+    DynamicHNtuple::Slot cos_th_p_cms;
+    DynamicHNtuple::Slot cos_th_pip_cms;
+    DynamicHNtuple::Slot cos_th_n_cms;
+    DynamicHNtuple::Slot oa_ppip;
+    DynamicHNtuple::Slot oa_npip;
+    DynamicHNtuple::Slot oa_pn;
+    DynamicHNtuple::Slot pip_helicity;
+    DynamicHNtuple::Slot pip_gj;
+    DynamicHNtuple::Slot n_helicity;
+    DynamicHNtuple::Slot m2_ppip;
+    DynamicHNtuple::Slot m2_npip;
+    DynamicHNtuple::Slot weight;
+};
+
+/**
+ * @brief Handles to all output ntuples
+ *
+ * Returned by setupNtuples(); processEvent() fills through the slots
+ * (nt_particles[np.p_p] = ...) so no variable name is looked up per event.
+ *
+ * EDIT THESE STRUCTS together with setupNtuples() when adding variables.
+ * Variables that are not declared can still be filled by name.
+ */
+struct NtupleHandles {
+    ParticleNtupleSlots particles;
+    CompoundNtupleSlots compound;
+};
+
 /**
  * @brief Setup all output ntuples
  *
@@ -37,6 +98,7 @@
  *
  * @param manager Reference to the Manager
  * @param config Reference to AnalysisConfig (for missing_value and keep_intermediate options)
+ * @return Ntuple pointers and slots of the declared variables
  *
  * Example adding a new ntuple:
  * @code
@@ -44,35 +106,89 @@
  *       "nt_systematics",           // name
  *       "Systematic checks",        // title
  *       config.getMissingValue(),   // sentinel for missing values
- *       config.getKeepIntermediateTree()  // keep TTree file?
+ *       config.getKeepIntermediateTree(),  // keep TTree file?
+ *       DynamicHNtuple::parseMode(config.getNtupleMode("nt_systematics")),  // convert/memory/tree/rntuple
+ *       config.getSpillMB()         // memory mode spill threshold
  *   );
  * @endcode
  */
-inline void setupNtuples(Manager& manager, const AnalysisConfig& config) {
+inline NtupleHandles setupNtuples(Manager& manager, const AnalysisConfig& config) {
+    
+    NtupleHandles nt;
     
     // ========================================================================
     // Ntuple 1: Basic particle observables (p, π+, n)
     // ========================================================================
     // Contains: momenta, angles, masses of individual particles
     
-    manager.createDynamicNtuple(
+    DynamicHNtuple& particles = manager.createDynamicNtuple(
         "nt_particles",
         "Basic particle observables",
         config.getMissingValue(),
-        config.getKeepIntermediateTree()
+        config.getKeepIntermediateTree(),
+        DynamicHNtuple::parseMode(config.getNtupleMode("nt_particles")),
+        config.getSpillMB()
     );
+    particles.declare({
+        "p_p", "p_theta", "p_phi", "p_mass", "pip_p", "pip_theta", "pip_phi",
+        "pip_mass", "n_p", "n_theta", "n_phi", "n_mass", "weight"
+    });
+    
+    nt.particles.nt = &particles;
+    nt.particles.p_p = particles.slot("p_p");
+    nt.particles.p_theta = particles.slot("p_theta");
+    nt.particles.p_phi = particles.slot("p_phi");
+    nt.particles.p_mass = particles.slot("p_mass");
+    nt.particles.pip_p = particles.slot("pip_p");
+    nt.particles.pip_theta = particles.slot("pip_theta");
+    nt.particles.pip_phi = particles.slot("pip_phi");
+    nt.particles.pip_mass = particles.slot("pip_mass");
+    nt.particles.n_p = particles.slot("n_p");
+    nt.particles.n_theta = particles.slot("n_theta");
+    nt.particles.n_phi = particles.slot("n_phi");
+    nt.particles.n_mass = particles.slot("n_mass");
+    nt.particles.weight = particles.slot("weight");
     
     // ========================================================================
     // Ntuple 2: Compound observables (Δ++, Δ+, pπ+, etc.)
     // ========================================================================
     // Contains: composite masses, CMS angles, opening angles, PWA variables
     
-    manager.createDynamicNtuple(
+    DynamicHNtuple& compound = manager.createDynamicNtuple(
         "nt_compound",
         "Compound particle observables",
         config.getMissingValue(),
-        config.getKeepIntermediateTree()
+        config.getKeepIntermediateTree(),
+        DynamicHNtuple::parseMode(config.getNtupleMode("nt_compound")),
+        config.getSpillMB()
     );
+    compound.declare({
+        "m_deltaPP", "m_deltaP", "m_ppip", "m_npip", "m_pn",
+        "cos_th_deltaPP_cms", "cos_th_deltaP_cms", "cos_th_p_cms",
+        "cos_th_pip_cms", "cos_th_n_cms", "oa_ppip", "oa_npip", "oa_pn",
+        "pip_helicity", "pip_gj", "n_helicity", "m2_ppip", "m2_npip", "weight"
+    });
+    
+    nt.compound.nt = &compound;
+    nt.compound.m_deltaPP = compound.slot("m_deltaPP");
+    nt.compound.m_deltaP = compound.slot("m_deltaP");
+    nt.compound.m_ppip = compound.slot("m_ppip");
+    nt.compound.m_npip = compound.slot("m_npip");
+    nt.compound.m_pn = compound.slot("m_pn");
+    nt.compound.cos_th_deltaPP_cms = compound.slot("cos_th_deltaPP_cms");
+    nt.compound.cos_th_deltaP_cms = compound.slot("cos_th_deltaP_cms");
+    nt.compound.cos_th_p_cms = compound.slot("cos_th_p_cms");
+    nt.compound.cos_th_pip_cms = compound.slot("cos_th_pip_cms");
+    nt.compound.cos_th_n_cms = compound.slot("cos_th_n_cms");
+    nt.compound.oa_ppip = compound.slot("oa_ppip");
+    nt.compound.oa_npip = compound.slot("oa_npip");
+    nt.compound.oa_pn = compound.slot("oa_pn");
+    nt.compound.pip_helicity = compound.slot("pip_helicity");
+    nt.compound.pip_gj = compound.slot("pip_gj");
+    nt.compound.n_helicity = compound.slot("n_helicity");
+    nt.compound.m2_ppip = compound.slot("m2_ppip");
+    nt.compound.m2_npip = compound.slot("m2_npip");
+    nt.compound.weight = compound.slot("weight");
     
     // ========================================================================
     // Additional ntuples (examples - uncomment to use)
@@ -83,8 +199,12 @@ inline void setupNtuples(Manager& manager, const AnalysisConfig& config) {
     //     "nt_control",
     //     "Control distributions",
     //     config.getMissingValue(),
-    //     config.getKeepIntermediateTree()
+    //     config.getKeepIntermediateTree(),
+    //     DynamicHNtuple::parseMode(config.getNtupleMode("nt_control")),
+    //     config.getSpillMB()
     // );
+    
+    return nt;
 }
 
 #endif // SETUP_NTUPLES_H
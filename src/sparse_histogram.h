@@ -0,0 +1,477 @@
+/**
+ * @file sparse_histogram.h
+ * @brief Occupancy-proportional histogram storage and storage selection
+ *
+ * Dense TH2F/TH3F allocate every bin up front, so large 2D arrays and 3D
+ * histograms cost gigabytes even when few bins are ever hit, and worker
+ * shards duplicate that per thread. SparseHistogram keeps only the bins
+ * that were filled (hash table keyed by the ROOT global bin number) and is
+ * converted to a standard TH1D/TH2D/TH3D when the registry writes it.
+ * Checkpoint snapshots keep the occupied bins only (writeCells()).
+ *
+ * HistogramStorage selects the backend per histogram:
+ * - Dense:  TH1F/TH2F/TH3F (default, unchanged behaviour)
+ * - Sparse: SparseHistogram, written as TH1D/TH2D/TH3D
+ * - Int32:  TH1I/TH2I/TH3I (exact counts, same size as float)
+ * - Double: TH1D/TH2D/TH3D (no float rounding for large counts)
+ *
+ * Usage Example:
+ * @code
+ *   H2Handle h = histogram().name("h_dalitz").bins(1000, 0, 4).binsY(1000, 0, 4)
+ *                           .storage(HistogramStorage::Sparse)
+ *                           .buildAndRegister2D(manager.registry());
+ *   h.fill(m2_ppip, m2_npip);   // same handle API as dense histograms
+ * @endcode
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef SPARSE_HISTOGRAM_H
+#define SPARSE_HISTOGRAM_H
+
+#include <TH1D.h>
+#include <TH2D.h>
+#include <TH3D.h>
+#include <TDirectory.h>
+#include <TTree.h>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// HistogramStorage: Backend Selection
+// ============================================================================
+
+enum class HistogramStorage {
+    Dense,    ///< TH1F/TH2F/TH3F
+    Sparse,   ///< SparseHistogram -> TH1D/TH2D/TH3D at write
+    Int32,    ///< TH1I/TH2I/TH3I
+    Double    ///< TH1D/TH2D/TH3D
+};
+
+/**
+ * @brief Parse storage name from configuration ("dense", "sparse", "int32", "double")
+ */
+inline HistogramStorage parseHistogramStorage(const std::string& name) {
+    if (name == "dense") return HistogramStorage::Dense;
+    if (name == "sparse") return HistogramStorage::Sparse;
+    if (name == "int32") return HistogramStorage::Int32;
+    if (name == "double") return HistogramStorage::Double;
+    throw std::runtime_error("Unknown histogram storage '" + name +
+                           "' (use dense, sparse, int32 or double)");
+}
+
+inline const char* histogramStorageName(HistogramStorage storage) {
+    switch (storage) {
+        case HistogramStorage::Sparse: return "sparse";
+        case HistogramStorage::Int32:  return "int32";
+        case HistogramStorage::Double: return "double";
+        default:                       return "dense";
+    }
+}
+
+// ============================================================================
+// SparseHistogram: Filled Bins Only
+// ============================================================================
+/**
+ * @class SparseHistogram
+ * @brief 1-3D fixed-binning histogram storing only occupied bins
+ *
+ * Binning, under/overflow handling, entries and statistics (sum of
+ * weights and moments for GetMean()/GetRMS()) follow TH1::Fill exactly,
+ * so the converted histogram is indistinguishable from one filled
+ * directly, except that contents are accumulated in double precision.
+ *
+ * Each occupied bin takes a 24-byte cell of an open-addressing table that
+ * is kept at most half full and doubles when it fills: 48 to 96 bytes per
+ * occupied bin, independent of the number of bins booked.
+ */
+class SparseHistogram {
+public:
+    SparseHistogram(const std::string& name, const std::string& title,
+                    int nbinsx, double xlow, double xup)
+        : SparseHistogram(name, title, 1, {Axis{nbinsx, xlow, xup}, Axis{}, Axis{}}) {}
+
+    SparseHistogram(const std::string& name, const std::string& title,
+                    int nbinsx, double xlow, double xup,
+                    int nbinsy, double ylow, double yup)
+        : SparseHistogram(name, title, 2,
+                          {Axis{nbinsx, xlow, xup}, Axis{nbinsy, ylow, yup}, Axis{}}) {}
+
+    SparseHistogram(const std::string& name, const std::string& title,
+                    int nbinsx, double xlow, double xup,
+                    int nbinsy, double ylow, double yup,
+                    int nbinsz, double zlow, double zup)
+        : SparseHistogram(name, title, 3,
+                          {Axis{nbinsx, xlow, xup}, Axis{nbinsy, ylow, yup},
+                           Axis{nbinsz, zlow, zup}}) {}
+
+    // ========================================================================
+    // Filling (TH1::Fill semantics)
+    // ========================================================================
+
+    void fill(double x) { fillWeighted(x, 1.0); }
+    void fill(double x, double y) { fillWeighted(x, y, 1.0); }
+    void fill(double x, double y, double z) { fillWeighted(x, y, z, 1.0); }
+
+    void fillWeighted(double x, double w) {
+        int bx = axes_[0].find(x);
+        accumulate(bx, w);
+        if (!axes_[0].inRange(bx)) return;
+        addMoments(w, x);
+    }
+
+    void fillWeighted(double x, double y, double w) {
+        int bx = axes_[0].find(x);
+        int by = axes_[1].find(y);
+        accumulate(bx + strideY_ * by, w);
+        if (!axes_[0].inRange(bx) || !axes_[1].inRange(by)) return;
+        addMoments(w, x);
+        stats_[4] += w * y;
+        stats_[5] += w * y * y;
+        stats_[6] += w * x * y;
+    }
+
+    void fillWeighted(double x, double y, double z, double w) {
+        int bx = axes_[0].find(x);
+        int by = axes_[1].find(y);
+        int bz = axes_[2].find(z);
+        accumulate(bx + strideY_ * by + strideZ_ * bz, w);
+        if (!axes_[0].inRange(bx) || !axes_[1].inRange(by) || !axes_[2].inRange(bz)) return;
+        addMoments(w, x);
+        stats_[4] += w * y;
+        stats_[5] += w * y * y;
+        stats_[6] += w * x * y;
+        stats_[7] += w * z;
+        stats_[8] += w * z * z;
+        stats_[9] += w * x * z;
+        stats_[10] += w * y * z;
+    }
+
+    // ========================================================================
+    // Merging and Conversion
+    // ========================================================================
+
+    /**
+     * @brief Add another sparse histogram with identical binning (TH1::Add)
+     */
+    void merge(const SparseHistogram& other) {
+        if (other.dim_ != dim_) {
+            throw std::runtime_error("SparseHistogram::merge() - '" + name_ +
+                                   "' has a different dimension!");
+        }
+        for (int a = 0; a < dim_; ++a) {
+            if (!axes_[a].sameAs(other.axes_[a])) {
+                throw std::runtime_error("SparseHistogram::merge() - '" + name_ +
+                                       "' has a different binning!");
+            }
+        }
+        for (const Cell& c : other.cells_) {
+            if (c.bin < 0) continue;
+            Cell& own = cell(c.bin);
+            own.w += c.w;
+            own.w2 += c.w2;
+        }
+        for (int i = 0; i < kStats; ++i) stats_[i] += other.stats_[i];
+        entries_ += other.entries_;
+        weighted_ = weighted_ || other.weighted_;
+    }
+
+    /**
+     * @brief Add a dense histogram with identical binning (e.g. a saved
+     *        toHistogram() snapshot), including its statistics
+     */
+    void add(const TH1& h) {
+        if (h.GetDimension() != dim_) {
+            throw std::runtime_error("SparseHistogram::add() - '" + name_ +
+                                   "' has a different dimension!");
+        }
+        const TAxis* axes[3] = {h.GetXaxis(), h.GetYaxis(), h.GetZaxis()};
+        for (int a = 0; a < dim_; ++a) {
+            Axis other{axes[a]->GetNbins(), axes[a]->GetXmin(), axes[a]->GetXmax()};
+            if (!axes_[a].sameAs(other)) {
+                throw std::runtime_error("SparseHistogram::add() - '" + name_ +
+                                       "' has a different binning!");
+            }
+        }
+        bool weighted = h.GetSumw2N() > 0;
+        for (Long64_t bin = 0; bin < denseBins(); ++bin) {
+            double w = h.GetBinContent(static_cast<Int_t>(bin));
+            double e = h.GetBinError(static_cast<Int_t>(bin));
+            if (w == 0.0 && e == 0.0) continue;
+            Cell& own = cell(bin);
+            own.w += w;
+            own.w2 += weighted ? e * e : w;
+        }
+        double stats[kStats] = {};
+        h.GetStats(stats);
+        for (int i = 0; i < kStats; ++i) stats_[i] += stats[i];
+        entries_ += static_cast<Long64_t>(h.GetEntries());
+        weighted_ = weighted_ || weighted;
+    }
+
+    /**
+     * @brief Equivalent dense ROOT histogram (TH1D/TH2D/TH3D, not attached
+     *        to any directory)
+     */
+    std::unique_ptr<TH1> toHistogram() const {
+        std::unique_ptr<TH1> h;
+        const Axis& ax = axes_[0];
+        const Axis& ay = axes_[1];
+        const Axis& az = axes_[2];
+        if (dim_ == 1) {
+            h = std::make_unique<TH1D>(name_.c_str(), title_.c_str(), ax.nbins, ax.low, ax.up);
+        } else if (dim_ == 2) {
+            h = std::make_unique<TH2D>(name_.c_str(), title_.c_str(), ax.nbins, ax.low, ax.up,
+                                       ay.nbins, ay.low, ay.up);
+        } else {
+            h = std::make_unique<TH3D>(name_.c_str(), title_.c_str(), ax.nbins, ax.low, ax.up,
+                                       ay.nbins, ay.low, ay.up, az.nbins, az.low, az.up);
+        }
+        h->SetDirectory(nullptr);
+        if (weighted_) h->Sumw2();
+
+        for (const Cell& c : cells_) {
+            if (c.bin < 0) continue;
+            h->SetBinContent(static_cast<Int_t>(c.bin), c.w);
+            if (weighted_) h->SetBinError(static_cast<Int_t>(c.bin), std::sqrt(c.w2));
+        }
+
+        // SetBinContent() resets the statistics: restore the filled ones
+        double stats[kStats];
+        for (int i = 0; i < kStats; ++i) stats[i] = stats_[i];
+        h->PutStats(stats);
+        h->SetEntries(static_cast<double>(entries_));
+        return h;
+    }
+
+    /**
+     * @brief Write the occupied bins as a TTree 'key' in dir (checkpoints)
+     *
+     * One row (bin, w, w2) per occupied bin, so a snapshot grows with
+     * occupancy rather than with the binning. Rows with a negative bin
+     * come first and carry the header: dimension, binning, entries,
+     * weighted flag and statistics, one value per row in w.
+     */
+    void writeCells(TDirectory* dir, const std::string& key) const {
+        std::vector<double> header{static_cast<double>(dim_)};
+        for (int a = 0; a < dim_; ++a) {
+            header.insert(header.end(), {static_cast<double>(axes_[a].nbins), axes_[a].low, axes_[a].up});
+        }
+        header.push_back(static_cast<double>(entries_));
+        header.push_back(weighted_ ? 1.0 : 0.0);
+        header.insert(header.end(), stats_, stats_ + kStats);
+
+        TTree tree(key.c_str(), title_.c_str(), 99, dir);
+        Long64_t bin = 0;
+        double w = 0.0;
+        double w2 = 0.0;
+        tree.Branch("bin", &bin, "bin/L");
+        tree.Branch("w", &w, "w/D");
+        tree.Branch("w2", &w2, "w2/D");
+        for (size_t i = 0; i < header.size(); ++i) {
+            bin = -1 - static_cast<Long64_t>(i);
+            w = header[i];
+            w2 = 0.0;
+            tree.Fill();
+        }
+        for (const Cell& c : cells_) {
+            if (c.bin < 0) continue;
+            bin = c.bin;
+            w = c.w;
+            w2 = c.w2;
+            tree.Fill();
+        }
+        tree.Write();
+    }
+
+    /**
+     * @brief Add the bins and statistics of a writeCells() tree
+     */
+    void addCells(TTree& tree) {
+        Long64_t bin = 0;
+        double w = 0.0;
+        double w2 = 0.0;
+        tree.SetBranchAddress("bin", &bin);
+        tree.SetBranchAddress("w", &w);
+        tree.SetBranchAddress("w2", &w2);
+
+        std::vector<double> header;
+        Long64_t n = tree.GetEntries();
+        Long64_t row = 0;
+        for (; row < n; ++row) {
+            tree.GetEntry(row);
+            if (bin >= 0) break;
+            header.push_back(w);
+        }
+        const size_t expected = 1 + 3 * static_cast<size_t>(dim_) + 2 + kStats;
+        if (header.size() != expected || static_cast<int>(header[0]) != dim_) {
+            tree.ResetBranchAddresses();
+            throw std::runtime_error("SparseHistogram::addCells() - '" + name_ +
+                                   "' has a different dimension!");
+        }
+        for (int a = 0; a < dim_; ++a) {
+            Axis other{static_cast<int>(header[1 + 3 * a]), header[2 + 3 * a], header[3 + 3 * a]};
+            if (!axes_[a].sameAs(other)) {
+                tree.ResetBranchAddresses();
+                throw std::runtime_error("SparseHistogram::addCells() - '" + name_ +
+                                       "' has a different binning!");
+            }
+        }
+
+        for (; row < n; ++row) {
+            tree.GetEntry(row);
+            Cell& own = cell(bin);
+            own.w += w;
+            own.w2 += w2;
+        }
+        tree.ResetBranchAddresses();
+
+        const double* saved = header.data() + 1 + 3 * dim_;
+        entries_ += static_cast<Long64_t>(saved[0]);
+        weighted_ = weighted_ || saved[1] != 0.0;
+        for (int i = 0; i < kStats; ++i) stats_[i] += saved[2 + i];
+    }
+
+    // ========================================================================
+    // Access
+    // ========================================================================
+
+    const std::string& getName() const { return name_; }
+    const std::string& getTitle() const { return title_; }
+    int getDimension() const { return dim_; }
+    Long64_t getEntries() const { return entries_; }
+
+    /// Content of a ROOT global bin (TH1::GetBin numbering)
+    double getBinContent(Long64_t bin) const {
+        const Cell* c = find(bin);
+        return c ? c->w : 0.0;
+    }
+
+    /// Bins filled at least once / bins a dense histogram would allocate
+    size_t occupiedBins() const { return used_; }
+    Long64_t denseBins() const {
+        Long64_t n = 1;
+        for (int a = 0; a < dim_; ++a) n *= axes_[a].nbins + 2;
+        return n;
+    }
+    size_t memoryBytes() const { return cells_.capacity() * sizeof(Cell); }
+
+private:
+    static constexpr int kStats = 11;   // TH3 PutStats() layout
+    static constexpr size_t kInitialCapacity = 64;
+
+    struct Axis {
+        int nbins = 0;
+        double low = 0.0;
+        double up = 1.0;
+
+        /// TAxis::FindBin() for fixed bins (0 = underflow, nbins+1 = overflow)
+        int find(double x) const {
+            if (x < low) return 0;
+            if (!(x < up)) return nbins + 1;
+            return 1 + static_cast<int>(nbins * (x - low) / (up - low));
+        }
+
+        bool inRange(int bin) const { return bin > 0 && bin <= nbins; }
+
+        bool sameAs(const Axis& o) const {
+            return nbins == o.nbins && low == o.low && up == o.up;
+        }
+    };
+
+    struct Cell {
+        Long64_t bin = -1;   // -1 = empty slot
+        double w = 0.0;
+        double w2 = 0.0;
+    };
+
+    SparseHistogram(const std::string& name, const std::string& title, int dim,
+                    const Axis (&axes)[3])
+        : name_(name), title_(title.empty() ? name : title), dim_(dim) {
+        for (int a = 0; a < 3; ++a) {
+            axes_[a] = axes[a];
+            if (a < dim && (axes_[a].nbins <= 0 || !(axes_[a].up > axes_[a].low))) {
+                throw std::runtime_error("SparseHistogram: invalid binning for '" + name + "'!");
+            }
+        }
+        strideY_ = axes_[0].nbins + 2;
+        strideZ_ = strideY_ * (axes_[1].nbins + 2);
+        cells_.resize(kInitialCapacity);
+    }
+
+    void accumulate(Long64_t bin, double w) {
+        ++entries_;
+        if (w != 1.0) weighted_ = true;
+        Cell& c = cell(bin);
+        c.w += w;
+        c.w2 += w * w;
+    }
+
+    void addMoments(double w, double x) {
+        stats_[0] += w;
+        stats_[1] += w * w;
+        stats_[2] += w * x;
+        stats_[3] += w * x * x;
+    }
+
+    size_t slotOf(Long64_t bin) const {
+        uint64_t h = static_cast<uint64_t>(bin) * 0x9E3779B97F4A7C15ULL;
+        return static_cast<size_t>(h >> 32) & (cells_.size() - 1);
+    }
+
+    const Cell* find(Long64_t bin) const {
+        for (size_t i = slotOf(bin);; i = (i + 1) & (cells_.size() - 1)) {
+            if (cells_[i].bin == bin) return &cells_[i];
+            if (cells_[i].bin < 0) return nullptr;
+        }
+    }
+
+    /// Cell of a bin, inserted if new (linear probing, load <= 1/2)
+    Cell& cell(Long64_t bin) {
+        size_t i = slotOf(bin);
+        while (cells_[i].bin != bin) {
+            if (cells_[i].bin < 0) {
+                if (2 * (used_ + 1) > cells_.size()) {
+                    grow();
+                    return cell(bin);
+                }
+                cells_[i].bin = bin;
+                ++used_;
+                break;
+            }
+            i = (i + 1) & (cells_.size() - 1);
+        }
+        return cells_[i];
+    }
+
+    void grow() {
+        std::vector<Cell> old(cells_.size() * 2);
+        old.swap(cells_);
+        for (const Cell& c : old) {
+            if (c.bin < 0) continue;
+            size_t i = slotOf(c.bin);
+            while (cells_[i].bin >= 0) i = (i + 1) & (cells_.size() - 1);
+            cells_[i] = c;
+        }
+    }
+
+    std::string name_;
+    std::string title_;
+    int dim_;
+    Axis axes_[3];
+    Long64_t strideY_ = 1;
+    Long64_t strideZ_ = 1;
+
+    std::vector<Cell> cells_;   // power-of-two open-addressing table
+    size_t used_ = 0;
+    double stats_[kStats] = {};
+    Long64_t entries_ = 0;
+    bool weighted_ = false;
+};
+
+#endif // SPARSE_HISTOGRAM_H
@@ -0,0 +1,177 @@
+/**
+ * @file thread_affinity.h
+ * @brief Pin event-loop worker threads to CPUs or NUMA nodes
+ *
+ * Unpinned workers migrate between cores and, on multi-socket machines,
+ * between memory nodes: the baskets and histograms a worker allocated on
+ * one node are then read through the interconnect. Pinning keeps each
+ * worker where its memory was first touched.
+ *
+ *   "none"   leave placement to the OS (default)
+ *   "cores"  worker t on the t-th usable CPU
+ *   "numa"   workers spread round-robin over the NUMA nodes, each free to
+ *            move between the CPUs of its node
+ *
+ * Example usage:
+ *   ThreadAffinity affinity(ThreadAffinity::parseMode("numa"), n_threads);
+ *   // in worker thread t:
+ *   affinity.pin(t);
+ *
+ * The topology is read from /sys (no libnuma needed) and restricted to
+ * the CPUs the process may use (batch slots, taskset). Only Linux is
+ * supported; elsewhere pin() does nothing.
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef THREAD_AFFINITY_H
+#define THREAD_AFFINITY_H
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// ============================================================================
+// ThreadAffinity: CPU Set per Worker
+// ============================================================================
+/**
+ * @class ThreadAffinity
+ * @brief Computes one CPU set per worker and applies it to the calling thread
+ */
+class ThreadAffinity {
+public:
+    enum class Mode { None, Cores, Numa };
+
+    static constexpr int kMaxNodes = 256;
+
+    /// "none", "cores" or "numa" (throws on anything else)
+    static Mode parseMode(const std::string& name) {
+        if (name == "none" || name.empty()) return Mode::None;
+        if (name == "cores") return Mode::Cores;
+        if (name == "numa") return Mode::Numa;
+        throw std::runtime_error("ThreadAffinity - Unknown pin mode '" + name +
+                                 "' (expected none, cores or numa)");
+    }
+
+    ThreadAffinity(Mode mode, int n_workers) : mode_(mode) {
+        if (mode_ == Mode::None || n_workers <= 0) return;
+
+        std::vector<int> usable = usableCpus();
+        if (usable.empty()) {
+            mode_ = Mode::None;
+            return;
+        }
+
+        std::vector<std::vector<int>> nodes;
+        std::vector<int> node_ids;
+        if (mode_ == Mode::Numa) {
+            // Node numbers may have gaps
+            for (int node = 0; node < kMaxNodes; ++node) {
+                std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+                if (!in) continue;
+                std::string list;
+                std::getline(in, list);
+                std::vector<int> cpus;
+                for (int cpu : parseCpuList(list)) {
+                    if (std::binary_search(usable.begin(), usable.end(), cpu)) cpus.push_back(cpu);
+                }
+                if (!cpus.empty()) {
+                    nodes.push_back(cpus);
+                    node_ids.push_back(node);
+                }
+            }
+            // No NUMA information (containers, single node): one CPU per worker
+            if (nodes.size() <= 1) mode_ = Mode::Cores;
+        }
+
+        for (int t = 0; t < n_workers; ++t) {
+            if (mode_ == Mode::Numa) {
+                sets_.push_back(nodes[t % nodes.size()]);
+                node_.push_back(node_ids[t % nodes.size()]);
+            } else {
+                sets_.push_back({usable[t % usable.size()]});
+                node_.push_back(-1);
+            }
+        }
+    }
+
+    Mode mode() const { return mode_; }
+    bool enabled() const { return mode_ != Mode::None; }
+
+    /**
+     * @brief Pin the calling thread to the CPUs of worker t
+     * @return false if pinning is off, unsupported or refused by the OS
+     */
+    bool pin(int t) const {
+        if (!enabled() || t < 0 || t >= static_cast<int>(sets_.size())) return false;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : sets_[t]) CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
+
+    /// "cpu 3" or "node 1 (8 cpus)"; empty when not pinned
+    std::string describe(int t) const {
+        if (!enabled() || t < 0 || t >= static_cast<int>(sets_.size())) return "";
+        const std::vector<int>& cpus = sets_[t];
+        if (node_[t] < 0) return "cpu " + std::to_string(cpus.front());
+        return "node " + std::to_string(node_[t]) + " (" + std::to_string(cpus.size()) + " cpus)";
+    }
+
+    /**
+     * @brief CPUs of a /sys cpulist ("0-3,8,10-11"), ascending
+     */
+    static std::vector<int> parseCpuList(const std::string& list) {
+        std::vector<int> cpus;
+        std::stringstream ss(list);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (item.empty()) continue;
+            size_t dash = item.find('-');
+            try {
+                int lo = std::stoi(item.substr(0, dash));
+                int hi = dash == std::string::npos ? lo : std::stoi(item.substr(dash + 1));
+                for (int cpu = lo; cpu <= hi; ++cpu) cpus.push_back(cpu);
+            } catch (const std::exception&) {
+                continue;   // malformed entry: skip it
+            }
+        }
+        std::sort(cpus.begin(), cpus.end());
+        cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+        return cpus;
+    }
+
+private:
+    /// CPUs this process may run on, ascending
+    static std::vector<int> usableCpus() {
+        std::vector<int> cpus;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+            }
+        }
+#endif
+        return cpus;
+    }
+
+    Mode mode_ = Mode::None;
+    std::vector<std::vector<int>> sets_;
+    std::vector<int> node_;      ///< NUMA node of worker t (-1 = single CPU)
+};
+
+#endif // THREAD_AFFINITY_H
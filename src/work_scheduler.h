@@ -0,0 +1,224 @@
+/**
+ * @file work_scheduler.h
+ * @brief Cluster-granular work stealing for the parallel event loop
+ *
+ * A fixed share of entries per worker finishes only as fast as its
+ * slowest share: a worker whose files are larger, remote or compressed
+ * harder keeps running while the others idle. The WorkScheduler hands the
+ * entries out in chunks instead. Each worker starts on its own range and
+ * claims it chunk by chunk, in ascending order; a chunk ends at a cluster
+ * start, so no two threads decompress the same baskets. A worker whose
+ * ranges are used up steals the back half of the range with the most
+ * entries left, again split at a cluster start, and continues there.
+ *
+ *   worker 0: [0 ............ 400)  claims [0,50) [50,100) ...
+ *   worker 1: [400 .. 800)          done early -> steals [250,400) of worker 0
+ *
+ * Within a range the worker's own chain and TTreeCache move forward, so
+ * every file is opened once per range and its cache is reused for all
+ * chunks in it. Stolen tails are large (half of what is left) so steals
+ * stay rare.
+ *
+ * Example usage:
+ *   WorkScheduler scheduler(state.ranges, reader.clusterStarts(), 0, true);
+ *   WorkScheduler::Chunk chunk;
+ *   while (scheduler.claim(t, chunk)) {                 // worker thread t
+ *       runEventRange(..., chunk.first, chunk.last, ...);
+ *       scheduler.finish(chunk, stopped_at);            // stopped early: rest goes back
+ *   }
+ *   state.ranges = scheduler.ranges();                  // checkpoint
+ *
+ * All methods take one mutex. They are called once per chunk of many
+ * events, so the lock is never contended in practice.
+ *
+ * @author Witold Przygoda (witold.przygoda@uj.edu.pl)
+ * @date 2025
+ */
+
+#ifndef WORK_SCHEDULER_H
+#define WORK_SCHEDULER_H
+
+#include <Rtypes.h>
+#include "checkpoint.h"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+// ============================================================================
+// WorkScheduler: Chunks of Entry Ranges for Worker Threads
+// ============================================================================
+/**
+ * @class WorkScheduler
+ * @brief Hands out cluster-aligned chunks; idle workers steal range tails
+ *
+ * Ranges are CheckpointState::Range, so the state of the scheduler is
+ * exactly what a checkpoint stores: entries before next are done, and a
+ * stolen tail is a new range owned by the thief. With stealing off every
+ * worker processes only its own ranges (the static schedule).
+ */
+class WorkScheduler {
+public:
+    /// Entries used per chunk when no cluster boundaries are known
+    static constexpr Long64_t kDefaultChunk = 10000;
+
+    /// Entries [first, last) of range 'range', claimed by one worker
+    struct Chunk {
+        Long64_t first = 0;
+        Long64_t last = 0;
+        size_t range = 0;
+    };
+
+    /**
+     * @param ranges Initial ranges with their owners (fresh or from a checkpoint)
+     * @param cluster_starts First entry of every cluster, ascending (may be empty)
+     * @param chunk_events Minimum entries per chunk (0 = one cluster)
+     * @param steal Let idle workers take over the tails of other ranges
+     */
+    WorkScheduler(const std::vector<CheckpointState::Range>& ranges,
+                  std::vector<Long64_t> cluster_starts, Long64_t chunk_events, bool steal)
+        : starts_(std::move(cluster_starts)), steal_(steal) {
+        chunk_ = chunk_events > 0 ? chunk_events : starts_.empty() ? kDefaultChunk : 1;
+        for (const auto& r : ranges) {
+            slots_.push_back(Slot{r, r.next});
+        }
+    }
+
+    // ========================================================================
+    // Worker Interface
+    // ========================================================================
+
+    /**
+     * @brief Next chunk for a worker: its own ranges first, then a stolen tail
+     * @return false once no entries are left that this worker may take
+     */
+    bool claim(int worker, Chunk& chunk) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            Slot& s = slots_[i];
+            if (s.range.worker == worker && s.claimed < s.range.last) {
+                chunk = take(i);
+                return true;
+            }
+        }
+        if (!steal_) return false;
+
+        // Victim: the range with the most unclaimed entries
+        size_t victim = slots_.size();
+        Long64_t most = 0;
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            Long64_t left = slots_[i].range.last - slots_[i].claimed;
+            if (left > most) {
+                most = left;
+                victim = i;
+            }
+        }
+        if (victim == slots_.size()) return false;
+
+        // Its back half becomes a range of this worker; a short rest, or
+        // one without a cluster start to split at, is taken whole
+        Slot& v = slots_[victim];
+        Long64_t split = splitPoint(v.claimed, v.range.last);
+        CheckpointState::Range tail{split, split, v.range.last, worker};
+        v.range.last = split;
+        slots_.push_back(Slot{tail, split});
+        ++steals_;
+        chunk = take(slots_.size() - 1);
+        return true;
+    }
+
+    /**
+     * @brief Report a claimed chunk as processed up to stopped_at
+     *
+     * A chunk stopped early (checkpoint, Ctrl+C, error) returns its rest
+     * to the range, to be claimed again after a resume.
+     */
+    void finish(const Chunk& chunk, Long64_t stopped_at) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot& s = slots_[chunk.range];
+        s.range.next = std::clamp(stopped_at, chunk.first, chunk.last);
+        if (s.range.next < chunk.last) s.claimed = s.range.next;
+    }
+
+    // ========================================================================
+    // State
+    // ========================================================================
+
+    /// Current ranges (for a checkpoint; call while no chunk is claimed)
+    std::vector<CheckpointState::Range> ranges() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<CheckpointState::Range> result;
+        for (const Slot& s : slots_) result.push_back(s.range);
+        return result;
+    }
+
+    /// Entries not yet claimed by any worker
+    Long64_t unclaimed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Long64_t left = 0;
+        for (const Slot& s : slots_) left += s.range.last - s.claimed;
+        return left;
+    }
+
+    /// Number of range tails taken over by idle workers
+    int steals() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return steals_;
+    }
+
+    Long64_t chunkEvents() const { return chunk_; }
+    bool stealing() const { return steal_; }
+
+private:
+    /// A range and the end of what its workers have claimed so far
+    struct Slot {
+        CheckpointState::Range range;
+        Long64_t claimed = 0;
+    };
+
+    /**
+     * @brief Claim the next chunk of slot i (lock held)
+     *
+     * The chunk covers at least chunk_ entries and ends at the next
+     * cluster start after that (or at the end of the range).
+     */
+    Chunk take(size_t i) {
+        Slot& s = slots_[i];
+        Long64_t end = s.range.last;
+        if (starts_.empty()) {
+            end = std::min(s.claimed + chunk_, end);
+        } else {
+            auto it = std::lower_bound(starts_.begin(), starts_.end(), s.claimed + chunk_);
+            if (it != starts_.end()) end = std::min(*it, end);
+        }
+        Chunk chunk{s.claimed, end, i};
+        s.claimed = end;
+        return chunk;
+    }
+
+    /**
+     * @brief Where to cut [lo, hi) for a steal (lo = take everything)
+     *
+     * Without cluster starts the middle, if both halves hold at least one
+     * chunk; with them the first cluster start from the middle on.
+     */
+    Long64_t splitPoint(Long64_t lo, Long64_t hi) const {
+        Long64_t mid = lo + (hi - lo) / 2;
+        if (starts_.empty()) {
+            return hi - lo >= 2 * chunk_ ? mid : lo;
+        }
+        auto it = std::lower_bound(starts_.begin(), starts_.end(), mid);
+        if (it != starts_.end() && *it < hi) return *it;
+        // No cluster start in the back half: the last one in the front half
+        if (it != starts_.begin() && *(it - 1) > lo) return *(it - 1);
+        return lo;
+    }
+
+    std::vector<Long64_t> starts_;
+    Long64_t chunk_ = kDefaultChunk;
+    bool steal_ = true;
+    std::vector<Slot> slots_;
+    int steals_ = 0;
+    mutable std::mutex mutex_;
+};
+
+#endif // WORK_SCHEDULER_H